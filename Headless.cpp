@@ -0,0 +1,282 @@
+#include "Headless.h"
+
+// GLEW
+#include <GL/glew.h>
+
+// SDL
+#include <SDL2/SDL.h>
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "FrameTiming.h"
+#include "HeadlessContext.h"
+#include "InputRecording.h"
+#include "MyApp.h"
+
+namespace
+{
+	struct HeadlessOptions
+	{
+		int width = 1280;
+		int height = 720;
+		bool sizeGiven = false;		// --size nélkül visszajátszáskor a felvétel mérete
+		int frames = 600;			// ennyi képkocka kerül a statisztikába
+		int warmupFrames = 60;		// előtte legalább ennyi nem (shaderváltozatok, textúrák betöltése)
+		std::string replayFileName;	// --replay
+		std::string traceFileName;	// --trace
+	};
+
+	// ennyi ideig várjuk legfeljebb a betöltést a bemelegítő képkockák alatt
+	constexpr double MAX_WARMUP_MS = 60000.0;
+
+	bool ParseCount(const char* text, int minimum, int& value)
+	{
+		char* end = nullptr;
+		const long parsed = std::strtol(text, &end, 10);
+		if (end == text || *end != '\0' || parsed < minimum || parsed > 1000000) return false;
+		value = static_cast<int>(parsed);
+		return true;
+	}
+
+	bool ParseOptions(int argc, char* args[], HeadlessOptions& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const bool hasValue = i + 1 < argc;
+			if (std::strcmp(args[i], "--headless") == 0) continue;
+
+			if (std::strcmp(args[i], "--size") == 0 && hasValue)
+			{
+				int width = 0, height = 0;
+				char separator = 0;
+				if (std::sscanf(args[++i], "%d%c%d", &width, &separator, &height) != 3 || separator != 'x' || width <= 0 || height <= 0) return false;
+				options.width = width;
+				options.height = height;
+				options.sizeGiven = true;
+			}
+			else if (std::strcmp(args[i], "--frames") == 0 && hasValue)
+			{
+				if (!ParseCount(args[++i], 1, options.frames)) return false;
+			}
+			else if (std::strcmp(args[i], "--warmup") == 0 && hasValue)
+			{
+				if (!ParseCount(args[++i], 0, options.warmupFrames)) return false;
+			}
+			else if (std::strcmp(args[i], "--replay") == 0 && hasValue)
+			{
+				options.replayFileName = args[++i];
+			}
+			else if (std::strcmp(args[i], "--trace") == 0 && hasValue)
+			{
+				options.traceFileName = args[++i];
+			}
+			else
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Mint a main eseménykezelése ImGui nélkül: a felvételben csak az alkalmazásnak továbbított események vannak.
+	// Az ablakméret nem változik, a kép mérete végig --size (vagy a felvétel kezdeti mérete).
+	void DispatchEvent(CMyApp& app, const SDL_Event& ev)
+	{
+		if (ev.type != SDL_WINDOWEVENT && ev.type != SDL_QUIT) app.HandleInput(ev);
+	}
+
+	void PrintSummary(const char* name, const std::vector<double>& samplesMs)
+	{
+		const TimingSummary summary = SummarizeTimings(samplesMs);
+		std::printf("%-10s %9.3f %9.3f %9.3f %9.3f %9.3f\n", name, summary.min, summary.median, summary.p99, summary.max, summary.mean);
+	}
+
+	bool WriteTrace(const std::string& fileName, const std::vector<double>& cpuMs, const std::vector<double>& gpuMs)
+	{
+		std::ofstream traceStrm(fileName, std::ios::trunc);
+		traceStrm << "frame,cpu_ms,gpu_ms\n";
+		char line[64];
+		for (std::size_t frame = 0; frame < cpuMs.size(); ++frame)
+		{
+			std::snprintf(line, sizeof(line), "%zu,%.4f,%.4f\n", frame, cpuMs[frame], frame < gpuMs.size() ? gpuMs[frame] : 0.0);
+			traceStrm << line;
+		}
+		return static_cast<bool>(traceStrm);
+	}
+}
+
+bool IsHeadlessRun(int argc, char* args[])
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(args[i], "--headless") == 0 || std::strcmp(args[i], "--replay") == 0) return true;
+	}
+	return false;
+}
+
+int RunHeadless(int argc, char* args[])
+{
+	SDL_LogSetPriority(SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_ERROR);
+
+	HeadlessOptions options;
+	if (!ParseOptions(argc, args, options))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "[Headless] Usage: %s --headless [--size WxH] [--frames N] [--warmup N] [--replay file] [--trace file.csv]", args[0]);
+		return 1;
+	}
+
+	// visszajátszáskor a felvétel adja a képkockák számát, az időlépéseket és (alapból) a méretet
+	InputRecording replay;
+	const bool replaying = !options.replayFileName.empty();
+	if (replaying)
+	{
+		if (!replay.Load(options.replayFileName)) return 1;
+		options.frames = static_cast<int>(replay.FrameCount());
+		if (!options.sizeGiven && replay.WindowWidth() > 0 && replay.WindowHeight() > 0)
+		{
+			options.width = replay.WindowWidth();
+			options.height = replay.WindowHeight();
+		}
+	}
+
+	// OpenGL context ablak és felület nélkül (EGL), a debug callback ugyanúgy működik, mint az ablakos változatban
+#ifdef _DEBUG
+	const bool debugContext = true;
+#else
+	const bool debugContext = false;
+#endif
+	HeadlessContext context;
+	if (!context.Init(debugContext))
+	{
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "[Headless] Could not create an OpenGL context without a window: %s", context.Error());
+		return 1;
+	}
+
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Running OpenGL %s (%s) without a window",
+		reinterpret_cast<const char*>(glGetString(GL_VERSION)), reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+	int result = 0;
+	{
+		// az ablak helyett ebbe kerül a kész kép, a 0-s framebuffer felület nélkül nem teljes
+		GLuint colorRenderbufferID = 0;
+		GLuint framebufferID = 0;
+		glCreateRenderbuffers(1, &colorRenderbufferID);
+		glNamedRenderbufferStorage(colorRenderbufferID, GL_RGBA8, options.width, options.height);
+		glCreateFramebuffers(1, &framebufferID);
+		glNamedFramebufferRenderbuffer(framebufferID, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbufferID);
+
+		CMyApp app;
+		if (!app.Init())
+		{
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "[app.Init] Error during the initialization of the application!");
+			result = 1;
+		}
+		else
+		{
+			app.SetPresentFramebuffer(framebufferID);
+			app.Resize(options.width, options.height);
+
+			// legfeljebb ennyi képkockával járhat a CPU a GPU előtt (nincs SwapWindow, ami megállítaná)
+			GPUFrameTimer gpuTimer;
+			gpuTimer.Init(3);
+
+			using Clock = std::chrono::steady_clock;
+			std::vector<double> cpuMs;
+			cpuMs.reserve(options.warmupFrames + options.frames);
+
+			// ugyanúgy léptet, mint a main: a képkocka idejébe férő szimulációs lépések, utána interpolált rajzolás;
+			// egy szálon (mint a main --no-render-thread kapcsolóval), a két oldal ideje együtt számít
+			FixedTimestep timestep(CMyApp::SIMULATION_STEP_IN_SEC);
+			SFramePacket packet;
+			auto runFrame = [&](double frameTimeInSec)
+			{
+				gpuTimer.Begin();
+				const Clock::time_point frameStart = Clock::now();
+				timestep.Advance(frameTimeInSec);
+				while (timestep.Step())
+				{
+					app.Update(SUpdateInfo{ timestep.SimulationTime(), static_cast<float>(timestep.StepInSec()) });
+				}
+				app.BuildFramePacket(SRenderInfo{ timestep.RenderTime(), timestep.Interpolation() }, packet);
+				app.Render(packet);
+				cpuMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+				gpuTimer.End();
+
+				glFlush();
+				gpuTimer.Collect(false);
+			};
+
+			// bemelegítés: az idő áll, így a mért képkockák ugyanonnan indulnak, akárhány bemelegítő képkocka kellett
+			const Clock::time_point warmupStart = Clock::now();
+			int warmupFrameCount = 0;
+			while (warmupFrameCount < options.warmupFrames
+				|| (app.IsLoading() && std::chrono::duration<double, std::milli>(Clock::now() - warmupStart).count() < MAX_WARMUP_MS))
+			{
+				runFrame(0.0);
+				++warmupFrameCount;
+			}
+			if (app.IsLoading())
+				SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN, "[Headless] Still loading after %d warm-up frames, measuring anyway", warmupFrameCount);
+
+			// rögzített képkockaidő: minden futás ugyanazokat a képkockákat rajzolja, a valós időtől függetlenül;
+			// visszajátszáskor a felvett képkockaidők és események, így ugyanazok a szimulációs lépések is
+			const double fixedFrameTime = 1.0 / 60.0;
+			double elapsedTime = 0.0;
+			const Clock::time_point runStart = Clock::now();
+			for (int frame = 0; frame < options.frames; ++frame)
+			{
+				double frameTime = fixedFrameTime;
+				if (replaying)
+				{
+					const InputRecording::Frame& recorded = replay.GetFrame(frame);
+					for (std::uint32_t i = 0; i < recorded.eventCount; ++i)
+						DispatchEvent(app, replay.Event(recorded.firstEvent + i));
+					frameTime = recorded.deltaTimeInSec;
+				}
+				elapsedTime += frameTime;
+				runFrame(frameTime);
+			}
+			glFinish();
+			const double runMs = std::chrono::duration<double, std::milli>(Clock::now() - runStart).count();
+			gpuTimer.Collect(true);
+
+			// a bemelegítő képkockák nem kerülnek a statisztikába
+			const std::vector<double> measuredCpuMs(cpuMs.begin() + warmupFrameCount, cpuMs.end());
+			const std::vector<double>& gpuMs = gpuTimer.SamplesMs();
+			const std::vector<double> measuredGpuMs(gpuMs.begin() + std::min<std::size_t>(warmupFrameCount, gpuMs.size()), gpuMs.end());
+
+			if (replaying)
+				std::printf("%dx%d, replaying %s: %d frames (+%d warm-up), %.1f s recorded\n", options.width, options.height,
+					options.replayFileName.c_str(), options.frames, warmupFrameCount, elapsedTime);
+			else
+				std::printf("%dx%d, %d frames (+%d warm-up), %.4f s per frame, %.4f s simulation step\n", options.width, options.height, options.frames, warmupFrameCount,
+					fixedFrameTime, CMyApp::SIMULATION_STEP_IN_SEC);
+			std::printf("%-10s %9s %9s %9s %9s %9s\n", "[ms]", "min", "median", "p99", "max", "mean");
+			PrintSummary("CPU", measuredCpuMs);
+			PrintSummary("GPU", measuredGpuMs);
+			std::printf("%d frames in %.1f ms, %.1f frames/s\n", options.frames, runMs, options.frames * 1000.0 / runMs);
+
+			if (!options.traceFileName.empty() && !WriteTrace(options.traceFileName, measuredCpuMs, measuredGpuMs))
+			{
+				SDL_LogError(SDL_LOG_CATEGORY_ERROR, "[Headless] Could not write %s", options.traceFileName.c_str());
+				result = 1;
+			}
+
+			app.Clean();
+		}
+
+		glDeleteFramebuffers(1, &framebufferID);
+		glDeleteRenderbuffers(1, &colorRenderbufferID);
+	} // az app destruktora még élő contexttel fut le
+
+	context.Clean();
+	return result;
+}
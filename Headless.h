@@ -0,0 +1,17 @@
+#pragma once
+
+// Ablak nélküli futás (--headless): a CMyApp egy framebuffer objektumba rajzol, rögzített számú képkockán át,
+// vsync és ImGui nélkül, a végén kiírja a képkockánkénti CPU és GPU idők statisztikáját.
+// A mért képkockák előtt legalább --warmup képkocka fut, és megvárja, amíg minden betöltődik (CMyApp::IsLoading).
+//
+//   ZH_Base --headless [--size 1280x720] [--frames 600] [--warmup 60] [--trace idok.csv]
+//
+// --replay <fájl>: a --record-dal (main.cpp) rögzített bemenetet játssza vissza, képkockáról képkockára a felvett
+// eseményekkel és képkockaidőkkel (InputRecording), így két build ugyanazokat a képkockákat rajzolja. A --frames helyett
+// a felvétel hossza számít, a méret alapból a felvételé. --trace: képkockánkénti idők CSV-ben, az összevetéshez.
+
+// Szerepel-e a parancssorban a --headless vagy a --replay kapcsoló?
+bool IsHeadlessRun(int argc, char* args[]);
+
+// A main visszatérési értéke: 0, ha minden képkocka lefutott.
+int RunHeadless(int argc, char* args[]);
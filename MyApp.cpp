@@ -1,8 +1,11 @@
 #include "MyApp.h"
 #include "includes/ObjParser.h"
+#include "includes/VertexQuantization.h"
 #include "includes/SDL_GLDebugMessageCallback.h"
 #include "imgui/imgui.h"
 
+#include <cmath>
+
 CMyApp::CMyApp()
 {
 }
@@ -27,15 +30,100 @@ void CMyApp::SetupDebugCallback()
 
 void CMyApp::InitShaders()
 {
-	m_programID = glCreateProgram();
-	AttachShader(m_programID, GL_VERTEX_SHADER, "Shaders/Vert_PosNormTex.vert");
-	AttachShader(m_programID, GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag");
-	LinkProgram(m_programID);
+	const Uint64 startTicks = SDL_GetPerformanceCounter();
+	const ProgramBinaryCache::Stats cacheStatsBefore = m_programBinaryCache.GetStats();
+
+	// Frag_ZH.frag változatai: az anyag állapota (SHADER_STATE_*) x vörös fény be/ki, családonként 3 x 2 program
+	// a linkelt programok bináris formában a lemezre kerülnek, a következő indításkor (vagy Ctrl+F5-re változatlan forrásnál) onnan töltődnek
+	const std::vector<ShaderVariants::Option> materialOptions = { { "STATE", 3 }, { "RED_LIGHT", 2 } };
+	// a bindless textúrázás nem változat: a driver egyszer dönt róla, minden program (a tartalék is) azzal fordul
+	std::vector<std::pair<std::string, int>> commonDefines;
+	if (BindlessMaterials::IsSupported()) commonDefines.emplace_back("BINDLESS", 1);
+
+	m_programs.Init({ { GL_VERTEX_SHADER, "Shaders/Vert_PosNormTex.vert" }, { GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" } }, materialOptions, &m_programBinaryCache, commonDefines);
+	m_instancedPrograms.Init({ { GL_VERTEX_SHADER, "Shaders/Vert_Instanced.vert" }, { GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" } }, materialOptions, &m_programBinaryCache, commonDefines);
+	m_indirectPrograms.Init({ { GL_VERTEX_SHADER, "Shaders/Vert_Indirect.vert" }, { GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" } }, materialOptions, &m_programBinaryCache, commonDefines);
+
+	// mind most indul, de nem várunk rájuk: KHR_parallel_shader_compile mellett a driver a háttérben, párhuzamosan fordít,
+	// addig a tartalék (definíciók nélküli) program rajzol; a kész változatokat az Update veszi át
+	const bool parallelCompile = EnableParallelShaderCompile();
+	m_programs.StartCompileAll();
+	m_instancedPrograms.StartCompileAll();
+	m_indirectPrograms.StartCompileAll();
+	m_readyProgramCount = 0;
+
+	const ProgramBinaryCache::Stats& cacheStats = m_programBinaryCache.GetStats();
+	SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+		"[InitShaders] %zu programs issued in %.1f ms (%u from the binary cache, %u compiling%s)",
+		m_programs.VariantCount() + m_instancedPrograms.VariantCount() + m_indirectPrograms.VariantCount(),
+		(SDL_GetPerformanceCounter() - startTicks) * 1000.0 / SDL_GetPerformanceFrequency(),
+		cacheStats.hits - cacheStatsBefore.hits,
+		(cacheStats.misses - cacheStatsBefore.misses) + (cacheStats.rejected - cacheStatsBefore.rejected),
+		parallelCompile ? " in parallel" : "");
+}
+
+const ShaderProgram& CMyApp::MaterialProgram(ShaderVariants& programs, int state)
+{
+	const ShaderProgram& program = programs.ReadyProgram(programs.MakeKey({ state, enableLight ? 1 : 0 }));
+
+	// a tartalék programban az állapot uniform, a változatokban konstans (ott nincs ilyen uniform)
+	const GLint stateLocation = ul(program, "state");
+	if (stateLocation >= 0) glProgramUniform1i(program.ID(), stateLocation, state);
+	return program;
 }
 
 void CMyApp::CleanShaders()
 {
-	glDeleteProgram(m_programID);
+	m_programs.Clean();
+	m_instancedPrograms.Clean();
+	m_indirectPrograms.Clean();
+}
+
+void CMyApp::InitUniformBuffers()
+{
+	glCreateBuffers(1, &m_frameUniformBufferID);
+	glNamedBufferStorage(m_frameUniformBufferID, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+	// a rajzolásonkénti adatoknak egymás utáni slotok, a glBindBufferRange offset-jének igazítva kell lennie
+	m_objectUniformSlotStride = UniformSlotStride(sizeof(ObjectUniforms));
+	glCreateBuffers(1, &m_objectUniformBufferID);
+	glNamedBufferData(m_objectUniformBufferID, m_objectUniformSlotStride * m_objectUniformSlotCount, nullptr, GL_STREAM_DRAW);
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, m_frameUniformBufferID);
+}
+
+void CMyApp::CleanUniformBuffers()
+{
+	glDeleteBuffers(1, &m_frameUniformBufferID);
+	glDeleteBuffers(1, &m_objectUniformBufferID);
+	glDeleteBuffers(1, &m_fishInstanceBufferID);
+}
+
+static glm::mat4 PufferFishWorld(int i, int N)
+{
+	return glm::translate(glm::vec3(100*cos(2*M_PI*i/N), -140+130*i/N, 100*sin(2*M_PI*i/N)));
+}
+
+void CMyApp::UpdateFishInstances()
+{
+	if (m_fishInstanceCount == m_fishCount) return; // csak a raj méretének változásakor töltünk fel
+
+	std::vector<glm::mat4> instanceWorld(m_fishCount);
+	m_jobs->ParallelFor(m_fishCount, FISH_JOB_GRAIN_SIZE, [&](std::size_t i)
+	{
+		instanceWorld[i] = PufferFishWorld(static_cast<int>(i), m_fishCount);
+	});
+
+	if (m_fishCount > m_fishInstanceCapacity)
+	{
+		// nem fér bele: új, nagyobb buffer (a méret duplázásával ritkán kell újra foglalni)
+		glDeleteBuffers(1, &m_fishInstanceBufferID);
+		m_fishInstanceCapacity = std::max<GLsizei>(m_fishCount, 2 * m_fishInstanceCapacity);
+		glCreateBuffers(1, &m_fishInstanceBufferID);
+		glNamedBufferStorage(m_fishInstanceBufferID, m_fishInstanceCapacity * sizeof(glm::mat4), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	}
+	glNamedBufferSubData(m_fishInstanceBufferID, 0, m_fishCount * sizeof(glm::mat4), instanceWorld.data());
+	m_fishInstanceCount = m_fishCount;
 }
 
 MeshObject<Vertex> createQuad()
@@ -58,6 +146,55 @@ MeshObject<Vertex> createQuad()
 	return mesh;
 }
 
+void CMyApp::InitSceneGraph()
+{
+	// a csomópontok a SceneNode sorrendjében, a szülő mindig előbb: az azonosítók a felsorolás értékei
+	const float halfPi = float(M_PI / 2);
+	m_sceneGraph.Clear();
+	m_sceneGraph.AddNode(SceneGraph::NO_PARENT, { glm::vec3(0, -150, 0), glm::angleAxis(halfPi, glm::vec3(1, 0, 0)), glm::vec3(1000) });
+	m_sceneGraph.AddNode(SceneGraph::NO_PARENT, { glm::vec3(0), glm::angleAxis(halfPi, glm::vec3(1, 0, 0)), glm::vec3(1000) });
+	m_sceneGraph.AddNode(SceneGraph::NO_PARENT, { glm::vec3(0, -140, 0) });
+	m_sceneGraph.AddNode(NODE_SUB);
+	m_sceneGraph.AddNode(NODE_ARM);
+	m_sceneGraph.AddNode(NODE_ARM);
+	UpdateSceneGraph();
+}
+
+void CMyApp::UpdateSceneGraph()
+{
+	// a forgatások lokális transzformációk: ha a csúszka nem mozdult, a SetLocal nem jelöl semmit
+	const glm::quat arm = glm::angleAxis(armRotation.load(), glm::vec3(0, 1, 0));
+	const glm::quat claw = glm::angleAxis(clawRotation.load(), glm::vec3(0, 1, 0));
+	m_sceneGraph.SetLocal(NODE_ARM, { glm::vec3(18.75, -3.75, 0), arm });
+	m_sceneGraph.SetLocal(NODE_RIGHT_CLAW, { glm::vec3(9, 0, 1.75), glm::angleAxis(float(M_PI), glm::vec3(1, 0, 0)) * claw });
+	m_sceneGraph.SetLocal(NODE_LEFT_CLAW, { glm::vec3(9, 0, -1.75), claw });
+	m_updatedNodeCount = m_sceneGraph.Update();
+}
+
+void CMyApp::StartMeshLoading()
+{
+	static const char* const MESH_FILE_NAMES[LOADED_MESH_COUNT] = { "Assets/PufferFish.obj", "Assets/sub.obj", "Assets/Arm.obj", "Assets/Claw.obj" };
+
+	// modellenként egy munka, a gyökér mindegyiket megvárja
+	m_meshLoadJob = m_jobs->CreateJob([]() {});
+	for (int mesh = 0; mesh < LOADED_MESH_COUNT; ++mesh)
+	{
+		m_jobs->Run(m_jobs->CreateChildJob(m_meshLoadJob, [this, mesh]()
+		{
+			// a mesheket vertex cache-re és overdraw-ra optimalizálva tároljuk (csak cache készítéskor fut)
+			try
+			{
+				m_loadedMeshes[mesh] = ObjParser::parseCached(MESH_FILE_NAMES[mesh], ObjParser::PARSE_OPTIMIZE_MESH);
+			}
+			catch (...)
+			{
+				m_meshLoadErrors[mesh] = std::current_exception();
+			}
+		}));
+	}
+	m_jobs->Run(m_meshLoadJob);
+}
+
 void CMyApp::InitGeometry()
 {
 	const std::initializer_list<VertexAttributeDescriptor> vertexAttribList =
@@ -68,15 +205,48 @@ void CMyApp::InitGeometry()
 	};
 
 	m_quadGPU = CreateGLObjectFromMesh(createQuad(), vertexAttribList);
-	m_pufferFishGPU = CreateGLObjectFromMesh(ObjParser::parse("Assets/PufferFish.obj"), vertexAttribList);
-	m_subGPU = CreateGLObjectFromMesh(ObjParser::parse("Assets/sub.obj"), vertexAttribList);
-	m_armGPU = CreateGLObjectFromMesh(ObjParser::parse("Assets/Arm.obj"), vertexAttribList);
-	m_clawGPU = CreateGLObjectFromMesh(ObjParser::parse("Assets/Claw.obj"), vertexAttribList);
+	// a bináris mesh cache-ből töltünk: második indítástól a mappelt fájlból megy a feltöltés
+	// a StartMeshLoading munkái közül ami még nem futott le, azt most ez a szál futtatja
+	m_jobs->Wait(m_meshLoadJob);
+	m_meshLoadJob = nullptr;
+	for (const std::exception_ptr& error : m_meshLoadErrors)
+	{
+		if (error) std::rethrow_exception(error);
+	}
+
+	// a modellek 16 bájtos kvantált vertexekkel kerülnek a GPU-ra (32 bájt helyett), a shader a dequant mátrixszal alakítja vissza
+	const ObjParser::CachedMesh& pufferFish = m_loadedMeshes[MESH_PUFFERFISH];
+	const ObjParser::CachedMesh& sub = m_loadedMeshes[MESH_SUB];
+	const ObjParser::CachedMesh& arm = m_loadedMeshes[MESH_ARM];
+	const ObjParser::CachedMesh& claw = m_loadedMeshes[MESH_CLAW];
+	m_pufferFishGPU = CreateQuantizedGLObjectFromMesh(pufferFish.View());
+	m_subGPU = CreateQuantizedGLObjectFromMesh(sub.View());
+	m_armGPU = CreateQuantizedGLObjectFromMesh(arm.View());
+	m_clawGPU = CreateQuantizedGLObjectFromMesh(claw.View());
+
+	// ugyanezek egy közös vertex és index bufferben a glMultiDrawElementsIndirect-hez
+	// a befoglaló gömböket a betöltéskor számolt határokból kapják (a GPU-s vágáshoz)
+	const MeshObject<Vertex> quad = createQuad();
+	m_quadRange = m_sceneMeshes.Add(MakeMeshView(quad), ObjParser::computeBounds(MakeMeshView(quad)));
+	m_pufferFishRange = m_sceneMeshes.Add(pufferFish.View(), pufferFish.Bounds());
+	m_subRange = m_sceneMeshes.Add(sub.View(), sub.Bounds());
+	m_armRange = m_sceneMeshes.Add(arm.View(), arm.Bounds());
+	m_clawRange = m_sceneMeshes.Add(claw.View(), claw.Bounds());
+	m_sceneMeshes.Upload();
+	m_loadedMeshes = {}; // feltöltve: a mappelt fájlok és a memóriában levő meshek felszabadítása
+
+	glCreateBuffers(1, &m_drawCommandBufferID);
+	glNamedBufferStorage(m_drawCommandBufferID, DRAW_COMMAND_COUNT * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_STORAGE_BIT);
 }
 
 void CMyApp::CleanGeometry()
 {
 	CleanOGLObject(m_quadGPU);
+	m_sceneMeshes.Clean();
+	glDeleteBuffers(1, &m_drawDataBufferID);
+	glDeleteBuffers(1, &m_cullRecordBufferID);
+	glDeleteBuffers(1, &m_visibleRecordBufferID);
+	glDeleteBuffers(1, &m_drawCommandBufferID);
 }
 
 void CMyApp::InitTextures()
@@ -87,52 +257,55 @@ void CMyApp::InitTextures()
 	glSamplerParameteri(m_SamplerID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	glSamplerParameteri(m_SamplerID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
+	// a képek dekódolása (és tükrözése, mip szintjei) háttérszálakon fut, közben a GL szál a shadereket és a mesheket tölti
+	// a szálak egyenesen a staging bufferbe írnak (az 5 kép mip szintekkel kb. 20 MiB); ami nem fér el, vagy ha a buffer
+	// nem jött létre, az kliens memóriából töltődik fel
+	const bool staging = m_textureStaging.Init(24 * 1024 * 1024);
+	m_textureLoader = std::make_unique<TextureLoader>(ThreadPool::HardwareThreadCount(), staging ? &m_textureStaging : nullptr);
+
+	// az anyagok rétegei: BC1 (a színtér összes anyaga átlátszatlan), a ZH_AssetCook --size 1024x1024 fájljai egyből
+	// feltölthetők, a többit a háttérszál skálázza és tömöríti; S3TC nélkül tömörítetlen
+	const GLenum materialFormat = GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_RGBA8;
+	m_materialTextures.Init(MATERIAL_LAYER_COUNT, MATERIAL_LAYER_SIZE, MATERIAL_LAYER_SIZE, materialFormat);
+	const bool bindless = m_bindlessMaterials.Init(MATERIAL_LAYER_COUNT); // a handle-ök csak a betöltés végén
+	m_textureLoader->Load("Assets/ocean.png", m_materialTextures, LAYER_OCEAN); // a legnagyobb előre, az a leghosszabb
+	m_textureLoader->Load("Assets/oceanbottom.png", m_materialTextures, LAYER_OCEAN_BOTTOM);
+	m_textureLoader->Load("Assets/sub.png", m_materialTextures, LAYER_SUB);
+	m_textureLoader->Load("Assets/Caustics.png", m_CausticsTextureID);
+	m_textureLoader->Load("Assets/PufferFish.png", m_materialTextures, LAYER_PUFFERFISH);
+
+	SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO, "[InitTextures] Material textures: %s",
+		bindless ? "bindless (GL_ARB_bindless_texture) once loaded" : "bound once per frame");
+}
+
+void CMyApp::UpdateTextures()
+{
+	if (!m_textureLoader) return;
+
+	// képkockánként legfeljebb TEXTURE_UPLOAD_BUDGET bájt: egy nagy textúra sem akasztja meg a képkockát
+	// amíg egy kép nincs kész, 0 textúrával (fekete) rajzol, utána egyre élesebb mip szinttel
+	m_textureLoader->UploadReady(TEXTURE_UPLOAD_BUDGET);
+	if (m_textureLoader->PendingCount() > 0) return;
+
+	m_textureLoader->LogTimings();
+	m_textureLoader.reset();
+
+	// a handle befagyasztja a textúra és a mintavételező állapotát (a streamelés még a BASE_LEVEL-t állította),
+	// ezért csak most: innentől a Render nem köti a textúrát
+	for (GLsizei layer = 0; layer < MATERIAL_LAYER_COUNT; ++layer)
 	{
-		ImageRGBA image = ImageFromFile("Assets/oceanbottom.png");
-		glCreateTextures(GL_TEXTURE_2D, 1, &m_OceanBottomTextureID);
-		glTextureStorage2D(m_OceanBottomTextureID, NumberOfMIPLevels(image), GL_RGBA8, image.width, image.height);
-		glTextureSubImage2D(m_OceanBottomTextureID, 0, 0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, image.data());
-		glGenerateTextureMipmap(m_OceanBottomTextureID);
-	}
-	{
-		ImageRGBA image = ImageFromFile("Assets/ocean.png");
-		glCreateTextures(GL_TEXTURE_2D, 1, &m_OceanTextureID);
-		glTextureStorage2D(m_OceanTextureID, NumberOfMIPLevels(image), GL_RGBA8, image.width, image.height);
-		glTextureSubImage2D(m_OceanTextureID, 0, 0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, image.data());
-		glGenerateTextureMipmap(m_OceanTextureID);
-	}
-	{
-		ImageRGBA image = ImageFromFile("Assets/sub.png");
-		glCreateTextures(GL_TEXTURE_2D, 1, &m_SubTextureID);
-		glTextureStorage2D(m_SubTextureID, NumberOfMIPLevels(image), GL_RGBA8, image.width, image.height);
-		glTextureSubImage2D(m_SubTextureID, 0, 0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, image.data());
-		glGenerateTextureMipmap(m_SubTextureID);
-	}
-	{
-		ImageRGBA image = ImageFromFile("Assets/Caustics.png");
-		glCreateTextures(GL_TEXTURE_2D, 1, &m_CausticsTextureID);
-		glTextureStorage2D(m_CausticsTextureID, NumberOfMIPLevels(image), GL_RGBA8, image.width, image.height);
-		glTextureSubImage2D(m_CausticsTextureID, 0, 0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, image.data());
-		glGenerateTextureMipmap(m_CausticsTextureID);
-	}
-	{
-		ImageRGBA image = ImageFromFile("Assets/PufferFish.png");
-		glCreateTextures(GL_TEXTURE_2D, 1, &m_PufferFishTextureID);
-		glTextureStorage2D(m_PufferFishTextureID, NumberOfMIPLevels(image), GL_RGBA8, image.width, image.height);
-		glTextureSubImage2D(m_PufferFishTextureID, 0, 0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, image.data());
-		glGenerateTextureMipmap(m_PufferFishTextureID);
+		m_bindlessMaterials.SetTexture(layer, m_materialTextures.ID(), m_SamplerID);
 	}
-	
 }
 
 void CMyApp::CleanTextures()
 {
+	m_textureLoader.reset(); // a még be nem fejezett textúrák is
+	m_textureStaging.Clean();
+	m_bindlessMaterials.Clean(); // a textúrák előtt
 	glDeleteSamplers(1, &m_SamplerID);
-	glDeleteTextures(1, &m_OceanTextureID);
-	glDeleteTextures(1, &m_OceanBottomTextureID);
+	m_materialTextures.Clean();
 	glDeleteTextures(1, &m_CausticsTextureID);
-	glDeleteTextures(1, &m_SubTextureID);
-	glDeleteTextures(1, &m_PufferFishTextureID);
 
 }
 
@@ -142,9 +315,15 @@ bool CMyApp::Init()
 
 	glClearColor(0.125f, 0.25f, 0.5f, 1.0f);
 
+	m_jobs = std::make_unique<JobSystem>(ThreadPool::HardwareThreadCount());
+
+	InitTextures(); // előre: a képek dekódolása párhuzamosan fut a többivel
+	StartMeshLoading(); // a modelleké is, az InitGeometry várja meg
 	InitShaders();
+	InitUniformBuffers();
+	m_culling.Init();
 	InitGeometry();
-	InitTextures();
+	InitSceneGraph();
 
 
 
@@ -160,6 +339,9 @@ bool CMyApp::Init()
 		glm::vec3(0.0, 1.0, 0.0)); // felfelé mutató irány a világban - up
 
 	m_cameraManipulator.SetCamera(&m_camera);
+	m_previousEye = m_camera.GetEye();
+	m_previousAt = m_camera.GetAt();
+	m_renderCamera = m_camera;
 
 	return true;
 }
@@ -167,8 +349,12 @@ bool CMyApp::Init()
 void CMyApp::Clean()
 {
 	CleanShaders();
+	CleanUniformBuffers();
+	CleanSceneFramebuffer();
+	m_culling.Clean();
 	CleanGeometry();
 	CleanTextures();
+	m_jobs.reset();
 }
 
 static bool HitPlane(const Ray& ray, const glm::vec3& planeQ, const glm::vec3& planeI, const glm::vec3& planeJ, Intersection& result)
@@ -251,6 +437,8 @@ Ray CMyApp::CalculatePixelRay(glm::vec2 pixel) const
 void CMyApp::Update(const SUpdateInfo& updateInfo)
 {
 	m_ElapsedTimeInSec = updateInfo.ElapsedTimeInSec;
+	m_previousEye = m_camera.GetEye();
+	m_previousAt = m_camera.GetAt();
 
 	if (m_IsPicking) {
 		// a felhasználó Ctrl + kattintott, itt kezeljük le
@@ -261,99 +449,411 @@ void CMyApp::Update(const SUpdateInfo& updateInfo)
 	}
 
 	m_cameraManipulator.Update(updateInfo.DeltaTimeInSec);
+}
 
-	glm::vec3 cam = m_camera.GetEye();
-	float y = cam.y;
-	glm::vec3 clr = glm::exp(glm::vec3(0.014f, 0.01f, 0.004f) * glm::min(0.0f, y));
-	glClearColor(clr.r, clr.g, clr.b, 1.0f);
+void CMyApp::UpdateRenderCamera(float interpolation)
+{
+	m_renderCamera = m_camera;
+	m_renderCamera.SetView(
+		glm::mix(m_previousEye, m_camera.GetEye(), interpolation),
+		glm::mix(m_previousAt, m_camera.GetAt(), interpolation),
+		m_camera.GetWorldUp());
+}
+
+void CMyApp::BuildFramePacket(const SRenderInfo& renderInfo, SFramePacket& packet)
+{
+	// képkockánként egyszer, akárhány szimulációs lépés volt előtte
+	UpdateRenderCamera(renderInfo.Interpolation);
+	UpdateSceneGraph();
+
+	packet.ElapsedTimeInSec = renderInfo.ElapsedTimeInSec;
+	packet.viewProj = m_renderCamera.GetViewProj();
+	packet.cameraPos = m_renderCamera.GetEye();
+	packet.windowSize = m_windowSize;
+	packet.nodeWorld.resize(m_sceneGraph.NodeCount());
+	packet.nodeNormal.resize(m_sceneGraph.NodeCount());
+	for (SceneGraph::NodeID node = 0; node < m_sceneGraph.NodeCount(); ++node)
+	{
+		packet.nodeWorld[node] = m_sceneGraph.World(node);
+		packet.nodeNormal[node] = m_sceneGraph.NormalMatrix(node);
+	}
+	packet.updatedNodeCount = m_updatedNodeCount;
+	packet.wireframe = m_wireframe;
+	packet.shaderReloadCount = m_shaderReloadCount;
 }
 
-void CMyApp::SetCommonUniforms()
+void CMyApp::SetCommonUniforms(const SFramePacket& packet)
 {
-	// - Uniform paraméterek
+	// - Uniform paraméterek: képkockánként egyszer, egyetlen bufferfeltöltéssel
+
+	FrameUniforms frame = {};
+	frame.viewProj = packet.viewProj; // view és projekciós mátrix
+	frame.cameraPos = packet.cameraPos;
+	// float-ban hetek után már nem mozdulna (2^21 s fölött 0.25 s a lépésköz): a shaderek időfüggő mintái
+	// SHADER_TIME_PERIOD_IN_SEC-enként ismétlődnek, így a körbefordított idő ugyanazt a képet adja
+	frame.elapsedTimeInSec = static_cast<float>(std::fmod(packet.ElapsedTimeInSec, SHADER_TIME_PERIOD_IN_SEC));
+	frame.lightPos = m_lightPos;
+	frame.lightPos2 = m_lightPos2;
+	frame.La = m_La;
+	frame.Ld = m_Ld;
+	frame.Ls = m_Ls;
+	frame.lightConstantAttenuation = m_lightConstantAttenuation;
+	frame.lightLinearAttenuation = m_lightLinearAttenuation;
+	frame.lightQuadraticAttenuation = m_lightQuadraticAttenuation;
+	frame.enableRedLight = enableLight;
+
+	glNamedBufferSubData(m_frameUniformBufferID, 0, sizeof(FrameUniforms), &frame);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, m_frameUniformBufferID);
+
+	// az előző képkocka rajzolásonkénti slotjai még használatban lehetnek: új tárterületet kérünk (orphaning)
+	glNamedBufferData(m_objectUniformBufferID, m_objectUniformSlotStride * m_objectUniformSlotCount, nullptr, GL_STREAM_DRAW);
+	m_nextObjectUniformSlot = 0;
+}
 
-	// view és projekciós mátrix
-	glProgramUniformMatrix4fv(m_programID, ul(m_programID, "viewProj"), 1, GL_FALSE, glm::value_ptr(m_camera.GetViewProj()));
 
-	glProgramUniform3fv(m_programID, ul(m_programID, "cameraPos"), 1, glm::value_ptr(m_camera.GetEye()));
-	glProgramUniform4fv(m_programID, ul(m_programID, "lightPos"), 1, glm::value_ptr(m_lightPos));
-	glProgramUniform4fv(m_programID, ul(m_programID, "lightPos2"), 1, glm::value_ptr(m_lightPos2));
-	
-	glProgramUniform3fv(m_programID, ul(m_programID, "La"), 1, glm::value_ptr(m_La));
-	glProgramUniform3fv(m_programID, ul(m_programID, "Ld"), 1, glm::value_ptr(m_Ld));
-	glProgramUniform3fv(m_programID, ul(m_programID, "Ls"), 1, glm::value_ptr(m_Ls));
-	
-	glProgramUniform1f(m_programID, ul(m_programID, "lightConstantAttenuation"), m_lightConstantAttenuation);
-	glProgramUniform1f(m_programID, ul(m_programID, "lightLinearAttenuation"), m_lightLinearAttenuation);
-	glProgramUniform1f(m_programID, ul(m_programID, "lightQuadraticAttenuation"), m_lightQuadraticAttenuation);
-	glProgramUniform3fv(m_programID, ul(m_programID, "cameraPos"), 1, glm::value_ptr(m_camera.GetEye()));
+void CMyApp::WriteObjectUniforms(const OGLObject& gpu, const glm::mat4& world, const glm::mat4& worldIT, GLint layer)
+{
+	if (m_nextObjectUniformSlot == m_objectUniformSlotCount)
+	{
+		// elfogytak a slotok: a buffer elejéről folytatjuk, az eddigi tartalmat a driver megtartja a még futó rajzolásoknak
+		glNamedBufferData(m_objectUniformBufferID, m_objectUniformSlotStride * m_objectUniformSlotCount, nullptr, GL_STREAM_DRAW);
+		m_nextObjectUniformSlot = 0;
+	}
 
-	glProgramUniform1f(m_programID, ul(m_programID, "m_ElapsedTimeInSec"), m_ElapsedTimeInSec);
+	ObjectUniforms object;
+	object.world = world;
+	object.worldIT = worldIT;
+	object.dequant = gpu.dequantization;
+	object.material.layer = layer;
 
+	const GLintptr slotOffset = m_objectUniformSlotStride * m_nextObjectUniformSlot++;
+	glNamedBufferSubData(m_objectUniformBufferID, slotOffset, sizeof(ObjectUniforms), &object);
+	glBindBufferRange(GL_UNIFORM_BUFFER, OBJECT_UNIFORM_BINDING, m_objectUniformBufferID, slotOffset, sizeof(ObjectUniforms));
 }
 
+// az anyagok textúratömbjét a Render köti egyszer, a rajzolás csak a rétegét adja meg
+// a normál mátrixot (transpose(inverse(world))) a hívó adja: a színtér gráfban el van tárolva
+void CMyApp::Draw(OGLObject gpu, GLint layer, const glm::mat4& world, const glm::mat4& worldIT){
+	WriteObjectUniforms(gpu, world, worldIT, layer);
 
-void CMyApp::Draw(OGLObject gpu, GLuint textureID, glm::mat4 world){
-	SetCommonUniforms();
-	glUseProgram(m_programID);
-	glProgramUniformMatrix4fv(m_programID, ul(m_programID, "world"), 1, GL_FALSE, glm::value_ptr(world));
-	glProgramUniformMatrix4fv(m_programID, ul(m_programID, "worldIT"), 1, GL_FALSE, glm::value_ptr(glm::transpose(glm::inverse(world))));
-	glProgramUniform1i(m_programID, ul(m_programID, "texImage"), 0);
 	glBindVertexArray(gpu.vaoID);
-	glBindTextureUnit(0, textureID);
-	glBindSampler(0, m_SamplerID);
 	glDrawElements(GL_TRIANGLES, gpu.count, GL_UNSIGNED_INT, nullptr);
-	glBindTextureUnit(0, 0);
-	glBindSampler(0, 0);
 	glBindVertexArray(0);
 }
 
-void CMyApp::Render()
+// a példányok világ mátrixai a bufferben vannak, world mindegyikre (balról) ráhat
+void CMyApp::DrawInstanced(OGLObject gpu, GLint layer, glm::mat4 world, GLsizei instanceCount){
+	WriteObjectUniforms(gpu, world, glm::transpose(glm::inverse(world)), layer);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_STORAGE_BINDING, m_fishInstanceBufferID);
+	glBindVertexArray(gpu.vaoID);
+	glDrawElementsInstanced(GL_TRIANGLES, gpu.count, GL_UNSIGNED_INT, nullptr, instanceCount);
+	glBindVertexArray(0);
+}
+
+void CMyApp::UpdateIndirectDrawData(const SFramePacket& packet)
 {
+	const GLuint recordCount = RECORD_FIRST_FISH + m_fishCount;
+	if (recordCount > m_drawDataCapacity)
+	{
+		// nem fér bele: nagyobb buffer, a halak rekordjait is újra fel kell tölteni
+		glDeleteBuffers(1, &m_drawDataBufferID);
+		m_drawDataCapacity = std::max(recordCount, 2 * m_drawDataCapacity);
+		glCreateBuffers(1, &m_drawDataBufferID);
+		glNamedBufferStorage(m_drawDataBufferID, m_drawDataCapacity * sizeof(DrawData), nullptr, GL_DYNAMIC_STORAGE_BIT);
+		glDeleteBuffers(1, &m_cullRecordBufferID);
+		glCreateBuffers(1, &m_cullRecordBufferID);
+		glNamedBufferStorage(m_cullRecordBufferID, m_drawDataCapacity * sizeof(CullRecord), nullptr, GL_DYNAMIC_STORAGE_BIT);
+		glDeleteBuffers(1, &m_visibleRecordBufferID);
+		glCreateBuffers(1, &m_visibleRecordBufferID);
+		glNamedBufferStorage(m_visibleRecordBufferID, m_drawDataCapacity * sizeof(GLuint), nullptr, 0);
+		m_sceneMeshes.ReserveDrawIndices(m_drawDataCapacity);
+		m_indirectFishCount = 0;
+	}
+
+	// a mozgó objektumok rekordjai minden képkockában
+	m_drawData.resize(RECORD_FIRST_FISH);
+	const MeshRange* sceneMesh[RECORD_FIRST_FISH] = { &m_quadRange, &m_quadRange, &m_subRange, &m_armRange, &m_clawRange, &m_clawRange };
+	const GLint sceneLayer[RECORD_FIRST_FISH] = { LAYER_OCEAN_BOTTOM, LAYER_OCEAN, LAYER_SUB, LAYER_SUB, LAYER_SUB, LAYER_SUB };
+	const SceneNode sceneNode[RECORD_FIRST_FISH] = { NODE_OCEAN_BOTTOM, NODE_OCEAN_SURFACE, NODE_SUB, NODE_ARM, NODE_RIGHT_CLAW, NODE_LEFT_CLAW };
+	for (int i = 0; i < RECORD_FIRST_FISH; ++i)
+	{
+		m_drawData[i] = { packet.nodeWorld[sceneNode[i]], sceneMesh[i]->dequantization };
+		m_drawData[i].material.layer = sceneLayer[i];
+	}
+
+	// a halaké csak a raj méretének változásakor, a vágás adatai (befoglaló gömb, parancs) is csak ekkor változnak
+	if (m_indirectFishCount != m_fishCount)
+	{
+		m_drawData.resize(recordCount);
+		m_jobs->ParallelFor(m_fishCount, FISH_JOB_GRAIN_SIZE, [&](std::size_t i)
+		{
+			m_drawData[RECORD_FIRST_FISH + i] = { PufferFishWorld(static_cast<int>(i), m_fishCount), m_pufferFishRange.dequantization };
+			m_drawData[RECORD_FIRST_FISH + i].material.layer = LAYER_PUFFERFISH;
+		});
+
+		// a rekordok parancsai: lásd a commands tömböt lent
+		const GLuint sceneCommand[RECORD_FIRST_FISH] = { 0, 1, 3, 4, 5, 6 };
+		std::vector<CullRecord> cullRecords(recordCount);
+		for (int i = 0; i < RECORD_FIRST_FISH; ++i)
+		{
+			cullRecords[i] = { sceneMesh[i]->boundingSphere, sceneCommand[i] };
+		}
+		for (GLuint i = RECORD_FIRST_FISH; i < recordCount; ++i)
+		{
+			cullRecords[i] = { m_pufferFishRange.boundingSphere, 2 };
+		}
+		glNamedBufferSubData(m_cullRecordBufferID, 0, recordCount * sizeof(CullRecord), cullRecords.data());
+
+		m_indirectFishCount = m_fishCount;
+	}
+	glNamedBufferSubData(m_drawDataBufferID, 0, m_drawData.size() * sizeof(DrawData), m_drawData.data());
+
+	// a rajzolási parancsok (rajzolás csoportonként egymás után), a példányszámot a vágás számolja fel 0-ról:
+	// baseInstance = a parancs tartományának eleje a látható rekordok listájában
+	const GLuint fishCount = m_fishCount;
+	const DrawElementsIndirectCommand commands[DRAW_COMMAND_COUNT] = {
+		m_quadRange.Command(0, 0),
+		m_quadRange.Command(0, 1),
+		m_pufferFishRange.Command(0, 2),
+		m_subRange.Command(0, 2 + fishCount),
+		m_armRange.Command(0, 3 + fishCount),
+		m_clawRange.Command(0, 4 + fishCount),
+		m_clawRange.Command(0, 5 + fishCount),
+	};
+	glNamedBufferSubData(m_drawCommandBufferID, 0, sizeof(commands), commands);
+}
+
+void CMyApp::RenderIndirect(const SFramePacket& packet)
+{
+	UpdateIndirectDrawData(packet);
+
+	// a nézeti gúlán kívüli és az előző képkocka mélysége szerint takart rekordok kihagyása (compute shader)
+	const glm::mat4& viewProj = packet.viewProj;
+	m_culling.Cull(m_cullingSettings, viewProj, RECORD_FIRST_FISH + m_fishCount,
+		m_drawDataBufferID, m_cullRecordBufferID, m_drawCommandBufferID, m_visibleRecordBufferID);
+
+	// állapotonként (programonként) egy glMultiDrawElementsIndirect, a textúra réteget a rekord adja:
+	// a textúrák nem bontják csoportokra a rajzolást, a rajzolások száma ettől független
+	struct DrawGroup
+	{
+		int state;
+		GLsizei firstCommand;
+		GLsizei commandCount;
+	};
+	const DrawGroup groups[] = {
+		{ SHADER_STATE_OCEAN, 0, 1 },
+		{ SHADER_STATE_OCEAN_SURFACE, 1, 1 },
+		{ SHADER_STATE_DEFAULT, 2, 5 },
+	};
+
+	glBindVertexArray(m_sceneMeshes.VAO());
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_drawCommandBufferID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_STORAGE_BINDING, m_drawDataBufferID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_RECORD_STORAGE_BINDING, m_visibleRecordBufferID);
+
+	for (const DrawGroup& group : groups)
+	{
+		glUseProgram(MaterialProgram(m_indirectPrograms, group.state).ID());
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+			reinterpret_cast<const void*>(group.firstCommand * sizeof(DrawElementsIndirectCommand)), group.commandCount, 0);
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	// a következő képkocka takarási vizsgálatához
+	if (m_cullingSettings.occlusionCulling && m_sceneFramebufferID != 0)
+	{
+		m_culling.BuildDepthPyramid(m_sceneDepthTextureID, viewProj);
+	}
+}
+
+void CMyApp::Render(const SFramePacket& packet)
+{
+	// a szimuláció GL-t igénylő kérései: új ablakméret, drótváz mód (F1), shaderek újrafordítása (Ctrl+F5)
+	if (packet.windowSize != m_sceneFramebufferSize)
+	{
+		m_sceneFramebufferSize = packet.windowSize;
+		glViewport(0, 0, packet.windowSize.x, packet.windowSize.y);
+		InitSceneFramebuffer(packet.windowSize.x, packet.windowSize.y);
+	}
+	glPolygonMode(GL_FRONT_AND_BACK, packet.wireframe ? GL_LINE : GL_FILL);
+	if (packet.shaderReloadCount != m_renderedShaderReloadCount)
+	{
+		m_renderedShaderReloadCount = packet.shaderReloadCount;
+		CleanShaders();
+		InitShaders();
+	}
+	m_renderedNodeUpdateCount = packet.updatedNodeCount;
+
+	UpdateTextures();
+
+	// a háttérben lefordult programváltozatok átvétele (várakozás nélkül)
+	m_readyProgramCount = m_programs.FinishReady() + m_instancedPrograms.FinishReady() + m_indirectPrograms.FinishReady();
+
+	glm::vec3 cam = packet.cameraPos;
+	float y = cam.y;
+	glm::vec3 clr = glm::exp(glm::vec3(0.014f, 0.01f, 0.004f) * glm::min(0.0f, y));
+	glClearColor(clr.r, clr.g, clr.b, 1.0f);
+
+	// a színtér saját framebufferbe kerül (a mélységét olvassa a Hi-Z piramis), a végén átmásoljuk az ablakba
+	glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebufferID != 0 ? m_sceneFramebufferID : m_presentFramebufferID);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+	// a tengeralattjáró fényének helye (a képkocka összes rajzolása ugyanezt látja)
+	const glm::mat4& sub = packet.nodeWorld[NODE_SUB];
+	m_lightPos2 = m_lightPos2 * sub * glm::translate(glm::vec3(-13,9,0)); 
+
+	SetCommonUniforms(packet);
+
+	// minden anyag ebből a textúratömbből mintavételez: egyetlen kötés a képkockára,
+	// bindless módban egy sem (a handle-ök a storage bufferben)
+	const bool bindTextures = !m_bindlessMaterials.IsResident();
+	m_bindlessMaterials.Bind();
+	if (bindTextures)
+	{
+		glBindTextureUnit(0, m_materialTextures.ID());
+		glBindSampler(0, m_SamplerID);
+	}
+
+	// a világ és normál mátrixok a csomagból (BuildFramePacket), itt nem számolunk egyet sem
+	auto drawNode = [&](const OGLObject& gpu, GLint layer, SceneNode node)
+	{
+		Draw(gpu, layer, packet.nodeWorld[node], packet.nodeNormal[node]);
+	};
+
+	if (m_indirectRendering)
+	{
+		RenderIndirect(packet);
+		if (bindTextures)
+		{
+			glBindTextureUnit(0, 0);
+			glBindSampler(0, 0);
+		}
+		PresentSceneFramebuffer();
+		return;
+	}
+
+	// anyagonként a neki fordított programváltozat; közvetlenül a rajzolás előtt kérjük le: amíg a változatok
+	// fordulnak, minden állapot ugyanazt a tartalék programot kapja, aminek a MaterialProgram átírja a state uniformját
 	
 	//ocean
-	glProgramUniform1i(m_programID, ul(m_programID, "state"), SHADER_STATE_OCEAN);
-	glm::mat4 oceanBottom = glm::mat4(1.f);
-	oceanBottom = glm::translate(glm::vec3(.0,-150.0,.0)) * glm::scale(glm::vec3(1000.)) * glm::rotate(oceanBottom,float(M_PI/2),glm::vec3(1.,0.,0.));
-	Draw(m_quadGPU, m_OceanBottomTextureID, oceanBottom);
-
-	glProgramUniform1i(m_programID, ul(m_programID, "state"), SHADER_STATE_OCEAN_SURFACE);
-	glm::mat4 oceanSurface = glm::mat4(1.f);
-	oceanSurface = glm::scale(glm::vec3(1000.)) * glm::rotate(oceanSurface,float(M_PI/2),glm::vec3(1.,0.,0.));
-	Draw(m_quadGPU, m_OceanTextureID, oceanSurface);
+	glUseProgram(MaterialProgram(m_programs, SHADER_STATE_OCEAN).ID());
+	drawNode(m_quadGPU, LAYER_OCEAN_BOTTOM, NODE_OCEAN_BOTTOM);
+
+	glUseProgram(MaterialProgram(m_programs, SHADER_STATE_OCEAN_SURFACE).ID());
+	drawNode(m_quadGPU, LAYER_OCEAN, NODE_OCEAN_SURFACE);
 	//pufferfishes
-	glProgramUniform1i(m_programID, ul(m_programID, "state"), SHADER_STATE_DEFAULT);
-	int N = 5;
-	glm::mat4 pos;
-	for(int i = 0; i < N; ++i){
-		pos = glm::translate(glm::vec3(100*cos(2*M_PI*i/N), -140+130*i/N, 100*sin(2*M_PI*i/N)));
-		Draw(m_pufferFishGPU, m_PufferFishTextureID, pos);
+	glUseProgram(MaterialProgram(m_programs, SHADER_STATE_DEFAULT).ID());
+	if (m_instancedFish)
+	{
+		// az egész raj egy rajzolás, a normál mátrixot a shader számolja
+		UpdateFishInstances();
+		glUseProgram(MaterialProgram(m_instancedPrograms, SHADER_STATE_DEFAULT).ID());
+		DrawInstanced(m_pufferFishGPU, LAYER_PUFFERFISH, glm::mat4(1.0f), m_fishInstanceCount);
+		glUseProgram(MaterialProgram(m_programs, SHADER_STATE_DEFAULT).ID());
+	}
+	else
+	{
+		for(int i = 0; i < m_fishCount; ++i){
+			Draw(m_pufferFishGPU, LAYER_PUFFERFISH, PufferFishWorld(i, m_fishCount), glm::mat4(1.0f)); // csak eltolás
+		}
 	}
 	//sub
-	glm::mat4 sub = glm::translate(glm::vec3(0,-140,0));
-	m_lightPos2 = m_lightPos2 * sub * glm::translate(glm::vec3(-13,9,0)); 
-	Draw(m_subGPU,m_SubTextureID, sub);
-	glm::mat4 arm = sub * glm::translate(glm::vec3(18.75,-3.75,0.)) *glm::rotate(armRotation,glm::vec3(0,1,0));
-	Draw(m_armGPU,m_SubTextureID,arm);
-	glm::mat4 rclaw = arm * glm::translate(glm::vec3(9,0,1.75)) * glm::rotate(float(M_PI), glm::vec3(1,0,0))* glm::rotate(clawRotation, glm::vec3(0,1,0));
-	glm::mat4 lclaw = arm * glm::translate(glm::vec3(9,0,-1.75)) * glm::rotate(clawRotation, glm::vec3(0,1,0));
-	Draw(m_clawGPU,m_SubTextureID,rclaw);
-	Draw(m_clawGPU,m_SubTextureID,lclaw);
+	drawNode(m_subGPU, LAYER_SUB, NODE_SUB);
+	drawNode(m_armGPU, LAYER_SUB, NODE_ARM);
+	drawNode(m_clawGPU, LAYER_SUB, NODE_RIGHT_CLAW);
+	drawNode(m_clawGPU, LAYER_SUB, NODE_LEFT_CLAW);
 	glBindVertexArray(0);
+	if (bindTextures)
+	{
+		glBindTextureUnit(0, 0);
+		glBindSampler(0, 0);
+	}
 	// shader kikapcsolasa
 	glUseProgram(0);
+
+	PresentSceneFramebuffer();
+}
+
+bool CMyApp::IsLoading() const
+{
+	return m_textureLoader != nullptr
+		|| m_readyProgramCount < m_programs.VariantCount() + m_instancedPrograms.VariantCount() + m_indirectPrograms.VariantCount();
+}
+
+void CMyApp::PresentSceneFramebuffer()
+{
+	if (m_sceneFramebufferID == 0) return;
+
+	glBlitNamedFramebuffer(m_sceneFramebufferID, m_presentFramebufferID,
+		0, 0, m_sceneFramebufferSize.x, m_sceneFramebufferSize.y,
+		0, 0, m_sceneFramebufferSize.x, m_sceneFramebufferSize.y,
+		GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_presentFramebufferID);
+}
+
+void CMyApp::InitSceneFramebuffer(int width, int height)
+{
+	CleanSceneFramebuffer();
+	if (width <= 0 || height <= 0) return;
+
+	glCreateTextures(GL_TEXTURE_2D, 1, &m_sceneColorTextureID);
+	glTextureStorage2D(m_sceneColorTextureID, 1, GL_RGBA8, width, height);
+	glCreateTextures(GL_TEXTURE_2D, 1, &m_sceneDepthTextureID);
+	glTextureStorage2D(m_sceneDepthTextureID, 1, GL_DEPTH_COMPONENT32F, width, height);
+
+	glCreateFramebuffers(1, &m_sceneFramebufferID);
+	glNamedFramebufferTexture(m_sceneFramebufferID, GL_COLOR_ATTACHMENT0, m_sceneColorTextureID, 0);
+	glNamedFramebufferTexture(m_sceneFramebufferID, GL_DEPTH_ATTACHMENT, m_sceneDepthTextureID, 0);
+
+	if (glCheckNamedFramebufferStatus(m_sceneFramebufferID, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		SDL_LogMessage(SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_ERROR, "[InitSceneFramebuffer] Incomplete framebuffer, rendering directly to the window");
+		CleanSceneFramebuffer();
+		return;
+	}
+
+	m_culling.Resize(width, height);
+}
+
+void CMyApp::CleanSceneFramebuffer()
+{
+	glDeleteFramebuffers(1, &m_sceneFramebufferID);
+	glDeleteTextures(1, &m_sceneColorTextureID);
+	glDeleteTextures(1, &m_sceneDepthTextureID);
+	m_sceneFramebufferID = m_sceneColorTextureID = m_sceneDepthTextureID = 0;
+	m_culling.Resize(0, 0);
 }
 
 void CMyApp::RenderGUI()
 {
-	ImGui::SliderAngle("Arm rotation:", &armRotation, -90, 90);
-	ImGui::SliderAngle("Claw rotation:", &clawRotation, 0, 90);
+	// a szimuláció a következő BuildFramePacket-ben olvassa
+	float arm = armRotation.load();
+	float claw = clawRotation.load();
+	if (ImGui::SliderAngle("Arm rotation:", &arm, -90, 90)) armRotation.store(arm);
+	if (ImGui::SliderAngle("Claw rotation:", &claw, 0, 90)) clawRotation.store(claw);
+	ImGui::Text("Scene graph: %zu / %d nodes updated", m_renderedNodeUpdateCount, int(SCENE_NODE_COUNT));
 
 	
-	ImGui::Checkbox("Red signal light", &enableLight);
-	glProgramUniform1i(m_programID, ul(m_programID, "enableRedLight"), enableLight);
+	ImGui::Checkbox("Red signal light", &enableLight); // a következő képkocka FrameUniforms-ába kerül
+
+	ImGui::SliderInt("Pufferfish count", &m_fishCount, 1, 50000, "%d", ImGuiSliderFlags_Logarithmic);
+	ImGui::Checkbox("Instanced pufferfish", &m_instancedFish);
+	ImGui::Checkbox("GPU-driven (multi-draw indirect)", &m_indirectRendering);
+	if (m_indirectRendering)
+	{
+		ImGui::Checkbox("Frustum culling", &m_cullingSettings.frustumCulling);
+		ImGui::Checkbox("Occlusion culling (Hi-Z)", &m_cullingSettings.occlusionCulling);
+		// néhány képkockával korábbi számok (várakozás nélkül visszaolvasva)
+		const GPUCulling::Stats& stats = m_culling.LastStats();
+		ImGui::Text("Visible: %u, frustum culled: %u, occlusion culled: %u", stats.visible, stats.frustumCulled, stats.occlusionCulled);
+	}
+	ImGui::Text("Shader variants ready: %zu / %zu", m_readyProgramCount,
+		m_programs.VariantCount() + m_instancedPrograms.VariantCount() + m_indirectPrograms.VariantCount());
+	ImGui::Text("Material textures: %s", m_bindlessMaterials.IsResident() ? "bindless" : "bound");
 }
 
 
@@ -361,19 +861,14 @@ void CMyApp::KeyboardDown(const SDL_KeyboardEvent& key)
 {
 	if (key.repeat == 0) // Először lett megnyomva
 	{
+		// GL hívás itt nem lehet (szimulációs szál): a kérés a csomagba kerül, a Render teljesíti
 		if (key.keysym.sym == SDLK_F5 && key.keysym.mod & KMOD_CTRL)
 		{
-			CleanShaders();
-			InitShaders();
+			++m_shaderReloadCount;
 		}
 		if (key.keysym.sym == SDLK_F1)
 		{
-			GLint polygonModeFrontAndBack[2] = {};
-			// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glGet.xhtml
-			glGetIntegerv(GL_POLYGON_MODE, polygonModeFrontAndBack); // Kérdezzük le a jelenlegi polygon módot! Külön adja a front és back módokat.
-			GLenum polygonMode = (polygonModeFrontAndBack[0] != GL_FILL ? GL_FILL : GL_LINE); // Váltogassuk FILL és LINE között!
-			// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glPolygonMode.xhtml
-			glPolygonMode(GL_FRONT_AND_BACK, polygonMode); // Állítsuk be az újat!
+			m_wireframe = !m_wireframe; // FILL és LINE között váltogatunk (glPolygonMode)
 		}
 
 		if (key.keysym.sym == SDLK_LCTRL || key.keysym.sym == SDLK_RCTRL)
@@ -424,11 +919,42 @@ void CMyApp::MouseWheel(const SDL_MouseWheelEvent& wheel)
 
 void CMyApp::Resize(int _w, int _h)
 {
-	glViewport(0, 0, _w, _h);
+	// a viewport és a framebuffer a Render dolga, amikor az első ilyen méretű csomag odaér
 	m_windowSize = glm::uvec2(_w, _h);
 	m_camera.SetAspect(static_cast<float>(_w) / _h);
 }
 
+void CMyApp::HandleInput(const SDL_Event& ev)
+{
+	switch (ev.type)
+	{
+		case SDL_KEYDOWN:
+			KeyboardDown(ev.key);
+			break;
+		case SDL_KEYUP:
+			KeyboardUp(ev.key);
+			break;
+		case SDL_MOUSEBUTTONDOWN:
+			MouseDown(ev.button);
+			break;
+		case SDL_MOUSEBUTTONUP:
+			MouseUp(ev.button);
+			break;
+		case SDL_MOUSEWHEEL:
+			MouseWheel(ev.wheel);
+			break;
+		case SDL_MOUSEMOTION:
+			MouseMove(ev.motion);
+			break;
+		case SDL_WINDOWEVENT:
+			if (ev.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+				Resize(ev.window.data1, ev.window.data2);
+			break;
+		default:
+			OtherEvent(ev);
+	}
+}
+
 
 void CMyApp::OtherEvent(const SDL_Event& ev)
 {
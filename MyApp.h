@@ -1,5 +1,11 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <vector>
+
 // GLM
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -13,16 +19,52 @@
 #include <SDL2/SDL_opengl.h>
 
 // Utils
+#include "includes/BindlessMaterials.h"
 #include "includes/Camera.h"
 #include "includes/CameraManipulator.h"
 #include "includes/GLUtils.hpp"
-
+#include "includes/GPUCulling.h"
+#include "includes/JobSystem.h"
+#include "includes/MeshBuffer.h"
+#include "includes/ObjParser.h"
+#include "includes/ProgramBinaryCache.h"
+#include "includes/ShaderProgram.h"
+#include "includes/SceneGraph.h"
+#include "includes/ShaderVariants.h"
+#include "includes/TextureArray.h"
+#include "includes/TextureLoader.h"
+#include "includes/UniformBlocks.h"
+
+// Egy szimulációs lépés (a main rögzített időlépéssel hívja, FixedTimestep)
 struct SUpdateInfo
 {
-	float ElapsedTimeInSec = 0.0f; // Program indulása óta eltelt idő
+	double ElapsedTimeInSec = 0.0; // Program indulása óta eltelt szimulációs idő, a lépés végén
 	float DeltaTimeInSec = 0.0f;   // Előző Update óta eltelt idő
 };
 
+// Egy képkocka rajzolása: az utolsó két Update állapota közé eső pillanat
+struct SRenderInfo
+{
+	double ElapsedTimeInSec = 0.0; // a rajzolt pillanat ideje
+	float Interpolation = 1.0f;    // 0: az utolsó Update előtti állapot, 1: az utána levő
+};
+
+// Egy képkocka a szimulációtól a rajzolásnak: minden, amit a Render a szimuláció állapotából olvas.
+// A BuildFramePacket tölti ki, utána a Render csak olvassa, így a két oldal külön szálon futhat (main.cpp).
+// A csomagokat újrahasznosítjuk, a vektorok kapacitása megmarad.
+struct SFramePacket
+{
+	double ElapsedTimeInSec = 0.0;            // a rajzolt pillanat (SRenderInfo)
+	glm::mat4 viewProj = glm::mat4(1.0f);     // az interpolált kamerából
+	glm::vec3 cameraPos = glm::vec3(0.0f);
+	glm::uvec2 windowSize = glm::uvec2(0, 0);
+	std::vector<glm::mat4> nodeWorld;         // a színtér gráf csomópontjai (CMyApp::SceneNode sorrendben)
+	std::vector<glm::mat4> nodeNormal;
+	std::size_t updatedNodeCount = 0;         // ennyit számolt újra a színtér gráf
+	bool wireframe = false;                   // F1
+	unsigned int shaderReloadCount = 0;       // Ctrl+F5: ha nőtt, a Render újrafordítja a shadereket
+};
+
 struct Ray
 {
 	glm::vec3 origin;
@@ -35,6 +77,9 @@ struct Intersection
 	float t;
 };
 
+// Két oldala van: a szimuláció (Update, az események, Resize, BuildFramePacket) és a rajzolás (Init, Render,
+// RenderGUI, Clean: ezek a GL contextet használják). A kettő csak az SFramePacket-en és a csúszkák atomic
+// változóin keresztül ér egymáshoz, így a main külön szálon futtathatja őket.
 class CMyApp
 {
 public:
@@ -44,11 +89,16 @@ public:
 	bool Init();
 	void Clean();
 
+	// az Update lépésköze (az ablakos és a --headless futás is ezzel léptet, FixedTimestep)
+	static constexpr double SIMULATION_STEP_IN_SEC = 1.0 / 120.0;
+
 	void Update(const SUpdateInfo&);
-	void Render();
+	void BuildFramePacket(const SRenderInfo&, SFramePacket&);
+	void Render(const SFramePacket&);
 	void RenderGUI();
 
-	void Draw(OGLObject, GLuint, glm::mat4);
+	void Draw(OGLObject, GLint, const glm::mat4& world, const glm::mat4& worldIT);
+	void DrawInstanced(OGLObject, GLint, glm::mat4, GLsizei);
 
 	void KeyboardDown(const SDL_KeyboardEvent&);
 	void KeyboardUp(const SDL_KeyboardEvent&);
@@ -57,6 +107,12 @@ public:
 	void MouseUp(const SDL_MouseButtonEvent&);
 	void MouseWheel(const SDL_MouseWheelEvent&);
 	void Resize(int, int);
+	// a fenti eseménykezelők egyike az esemény típusa szerint (a SIZE_CHANGED ablakesemény: Resize)
+	void HandleInput(const SDL_Event&);
+	// ide kerül a kész kép (alapból 0, az ablak); ablak nélkül (--headless) egy framebuffer objektum
+	void SetPresentFramebuffer(GLuint framebufferID) { m_presentFramebufferID = framebufferID; }
+	// tölt-e még valamit a háttérben (textúrák, programváltozatok)? Az ismételhető mérések ezt kivárják.
+	bool IsLoading() const;
 
 	void OtherEvent(const SDL_Event&);
 
@@ -67,7 +123,7 @@ protected:
 	// Adat változók
 	//
 
-	float m_ElapsedTimeInSec = 0.0f;
+	double m_ElapsedTimeInSec = 0.0;	// a szimulációé
 
 	// Picking
 
@@ -84,12 +140,25 @@ protected:
 	Camera m_camera;
 	CameraManipulator m_cameraManipulator;
 
+	// a kamera az utolsó Update előtt; a rajzolás ebből és a jelenlegiből interpolál (SRenderInfo::Interpolation)
+	glm::vec3 m_previousEye = glm::vec3(0.0f);
+	glm::vec3 m_previousAt = glm::vec3(0.0f);
+	// ezzel rajzolunk: a m_camera másolata az interpolált nézettel, képkockánként frissül
+	Camera m_renderCamera;
+	void UpdateRenderCamera(float interpolation);
+
+	bool m_wireframe = false;
+	unsigned int m_shaderReloadCount = 0;		// a szimuláció kérései (Ctrl+F5)
+	unsigned int m_renderedShaderReloadCount = 0;	// a Render által már teljesítettek
+	std::size_t m_renderedNodeUpdateCount = 0;	// az utoljára rajzolt csomag updatedNodeCount-ja (RenderGUI)
+
 	//
 	// OpenGL-es dolgok
 	//
 
 	// shaderekhez szükséges változók
-	GLuint m_programID = 0; // shaderek programja
+	ProgramBinaryCache m_programBinaryCache = ProgramBinaryCache("ShaderCache"); // linkelt programok a lemezen (glGetProgramBinary)
+	ShaderVariants m_programs; // shaderek programjai, anyagonként (state x vörös fény) külön lefordított változat
 	glm::vec4 m_lightPos = glm::vec4(0,1,0,0);
 	glm::vec3 m_La = glm::vec3(0.0, 0.0, 0.0 );
 	glm::vec3 m_Ld = glm::vec3(1.0, 1.0, 1.0 );
@@ -104,9 +173,71 @@ protected:
 	void InitShaders();
 	void CleanShaders();
 
+	// az anyag (SHADER_STATE_*) és a vörös fény jelenlegi állása szerinti változat a családból,
+	// amíg az nem fordult le, a definíciók nélküli tartalék program (state uniformmal)
+	const ShaderProgram& MaterialProgram(ShaderVariants&, int state);
+	std::size_t m_readyProgramCount = 0; // a már lefordult változatok száma (képkockánként frissül)
+
+	// Uniform bufferek: a képkockánként közös adatok egyszer, a rajzolásonkéntiek saját slotba kerülnek
+	GLuint m_frameUniformBufferID = 0;
+	GLuint m_objectUniformBufferID = 0;
+	GLsizeiptr m_objectUniformSlotStride = 0;
+	GLuint m_objectUniformSlotCount = 64;
+	GLuint m_nextObjectUniformSlot = 0;
+
+	void InitUniformBuffers();
+	void CleanUniformBuffers();
+	void WriteObjectUniforms(const OGLObject&, const glm::mat4& world, const glm::mat4& worldIT, GLint layer);
+
+	// Pufferhal raj: példányonkénti világ mátrixok egy SSBO-ban, egyetlen glDrawElementsInstanced
+	ShaderVariants m_instancedPrograms;
+	GLuint m_fishInstanceBufferID = 0;
+	GLsizei m_fishInstanceCapacity = 0; // ennyi mátrix fér a bufferbe
+	GLsizei m_fishInstanceCount = 0;    // ennyi van feltöltve
+	int m_fishCount = 5;
+	bool m_instancedFish = true;
+	static constexpr std::size_t FISH_JOB_GRAIN_SIZE = 1024; // ennyi hal mátrixa egy munka (JobSystem::ParallelFor)
+
+	void UpdateFishInstances();
+
+	// GPU-vezérelt rajzolás: minden mesh egy közös bufferben (MeshBuffer), a rajzolásonkénti adatok egy SSBO-ban,
+	// a színtér anyag állapotonként (state) egyetlen glMultiDrawElementsIndirect, a textúra réteg a rekordban
+	enum SceneDrawRecord { RECORD_OCEAN_BOTTOM, RECORD_OCEAN_SURFACE, RECORD_SUB, RECORD_ARM, RECORD_RIGHT_CLAW, RECORD_LEFT_CLAW, RECORD_FIRST_FISH };
+	static constexpr int DRAW_COMMAND_COUNT = 7;
+
+	ShaderVariants m_indirectPrograms;
+	MeshBuffer m_sceneMeshes;
+	MeshRange m_quadRange, m_pufferFishRange, m_subRange, m_armRange, m_clawRange;
+	GLuint m_drawDataBufferID = 0;
+	GLuint m_cullRecordBufferID = 0;    // CullRecord rekordonként
+	GLuint m_visibleRecordBufferID = 0; // a vágás után látható rekordok indexei
+	GLuint m_drawDataCapacity = 0;  // ennyi rekord fér a bufferekbe
+	int m_indirectFishCount = 0;    // ennyi hal rekordja van feltöltve
+	GLuint m_drawCommandBufferID = 0;
+	std::vector<DrawData> m_drawData;
+	bool m_indirectRendering = true;
+
+	void UpdateIndirectDrawData(const SFramePacket&);
+	void RenderIndirect(const SFramePacket&);
+
+	// Láthatósági vágás a GPU-n (nézeti gúla + Hi-Z takarás), a rajzolási parancsok példányszámát a compute shader írja
+	GPUCulling m_culling;
+	GPUCulling::Settings m_cullingSettings;
+
+	// A színtér framebuffere: a mélységi textúrából készül a következő képkocka Hi-Z piramisa
+	GLuint m_sceneFramebufferID = 0;
+	GLuint m_sceneColorTextureID = 0;
+	GLuint m_sceneDepthTextureID = 0;
+	GLuint m_presentFramebufferID = 0;
+	glm::uvec2 m_sceneFramebufferSize = glm::uvec2(0, 0); // a Render hozza létre újra, ha a csomag ablakmérete más
+
+	void InitSceneFramebuffer(int, int);
+	void CleanSceneFramebuffer();
+	void PresentSceneFramebuffer();
+
 	// Geometriával kapcsolatos változók
 
-	void SetCommonUniforms();
+	void SetCommonUniforms(const SFramePacket&);
 
 	OGLObject m_quadGPU = {};
 	OGLObject m_pufferFishGPU = {};
@@ -115,24 +246,57 @@ protected:
 	OGLObject m_armGPU = {};
 
 	// Geometria inicializálása, és törlése
+	// a modellfájlok beolvasása (első indításkor a feldolgozásuk és a cache írása is) munkákként fut: a StartMeshLoading
+	// elindítja, amíg a GL szál a shadereket és a buffereket hozza létre, az InitGeometry megvárja és feltölti őket
+	enum LoadedMesh { MESH_PUFFERFISH, MESH_SUB, MESH_ARM, MESH_CLAW, LOADED_MESH_COUNT };
+	std::array<ObjParser::CachedMesh, LOADED_MESH_COUNT> m_loadedMeshes;
+	std::array<std::exception_ptr, LOADED_MESH_COUNT> m_meshLoadErrors; // a munkából nem jöhet ki kivétel
+	JobSystem::Job* m_meshLoadJob = nullptr;
+	void StartMeshLoading();
 	void InitGeometry();
 	void CleanGeometry();
 
 	// Textúrázás, és változói
 	GLuint m_SamplerID = 0;
 
-	GLuint m_OceanBottomTextureID = 0;
-	GLuint m_OceanTextureID = 0;
-	GLuint m_PufferFishTextureID = 0;
-	GLuint m_SubTextureID = 0;
+	// a színtér anyagai egy textúratömb rétegei: képkockánként egyetlen kötés, a rajzolás a réteget adja meg
+	// (a képek a réteg méretére skálázódnak, lásd TextureLoader; ZH_AssetCook --size-zal előre)
+	enum MaterialLayer { LAYER_OCEAN_BOTTOM, LAYER_OCEAN, LAYER_SUB, LAYER_PUFFERFISH, MATERIAL_LAYER_COUNT };
+	static constexpr GLsizei MATERIAL_LAYER_SIZE = 1024;
+	TextureArray m_materialTextures;
+
+	// GL_ARB_bindless_texture mellett a rétegek handle-jei egy storage bufferben: ha a tömb minden szintje megérkezett
+	// (UpdateTextures), a textúrát többé nem kell kötni; a bővítmény nélkül (pl. llvmpipe) marad a kötés
+	BindlessMaterials m_bindlessMaterials;
+
 	GLuint m_CausticsTextureID = 0;
 	GLuint m_ClawTextureID = 0;
 
+	// InitTextures csak elindítja a képek dekódolását a háttérszálakon, a textúrák képkockánként, mip szintenként
+	// töltődnek fel (UpdateTextures) a perzisztensen mappelt staging bufferből, a legdurvább szinttől kezdve
+	StagingRing m_textureStaging;
+	std::unique_ptr<TextureLoader> m_textureLoader;
+	static constexpr std::size_t TEXTURE_UPLOAD_BUDGET = 2 * 1024 * 1024; // bájt / képkocka
 	void InitTextures();
+	void UpdateTextures();
 	void CleanTextures();
 
-	float armRotation = 0.;
-	float clawRotation = 45.;
+	// a párhuzamosítható CPU munka ütemezője (Init: a modellek betöltése, Render: a halak mátrixai); az Init hozza
+	// létre, ezért csak a rajzoló szálról és a munkákból használható
+	std::unique_ptr<JobSystem> m_jobs;
+
+	// a csúszkák (RenderGUI) a szimuláció bemenetei: a GUI a rajzoló szálon fut
+	std::atomic<float> armRotation = 0.0f;
+	std::atomic<float> clawRotation = 45.0f;
+
+	// a tenger síkjai és a tengeralattjáró -> kar -> ollók lánc egy transzformációs hierarchiában: a világ és a normál
+	// mátrixok képkockák között megmaradnak, csak a megváltozott (pl. a csúszkákkal forgatott) ágat számoljuk újra
+	enum SceneNode { NODE_OCEAN_BOTTOM, NODE_OCEAN_SURFACE, NODE_SUB, NODE_ARM, NODE_RIGHT_CLAW, NODE_LEFT_CLAW, SCENE_NODE_COUNT };
+	SceneGraph m_sceneGraph;
+	std::size_t m_updatedNodeCount = 0; // az utolsó Update-ben újraszámolt csomópontok
+
+	void InitSceneGraph();
+	void UpdateSceneGraph();
 
 	bool enableLight = true;
 
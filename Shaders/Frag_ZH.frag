@@ -1,9 +1,15 @@
 #version 430
 
+// BINDLESS: a C++ oldal csak GL_ARB_bindless_texture mellett definiálja (includes/BindlessMaterials.h)
+#ifdef BINDLESS
+#extension GL_ARB_bindless_texture : require
+#endif
+
 // pipeline-ból bejövő per-fragment attribútumok
 in vec3 vs_out_pos;
 in vec3 vs_out_norm;
 in vec2 vs_out_tex;
+flat in int vs_out_layer;
 
 // kimenő érték - a fragment színe
 out vec4 fs_out_col;
@@ -13,25 +19,54 @@ const int SHADER_STATE_OCEAN = 0;
 const int SHADER_STATE_DEFAULT = 1;
 const int SHADER_STATE_OCEAN_SURFACE = 2;
 
+// Változatok (includes/ShaderVariants.h): a C++ oldal a #version után definiálja a STATE-et és a RED_LIGHT-ot,
+// ilyenkor fordítási idejű konstansok, a fordító csak az anyag saját útját tartja meg.
+// Definíciók nélkül a régi, futásidőben elágazó shader: state uniform, a vörös fény a FrameData-ból.
+#ifdef STATE
+const int state = STATE;
+#else
 uniform int state;
+#endif
 
 
-uniform sampler2D texImage;
-uniform float m_ElapsedTimeInSec;
-uniform vec4 lightPos = vec4( 0.0, 1.0, 0.0, 0.0);
-uniform vec4 lightPos2 = vec4( 0.0, 1.0, 0.0, 1.0);
-uniform vec3 cameraPos;
-
+// a színtér összes anyaga egy textúratömbben (includes/TextureArray.h), a réteget a rajzolás adja
+layout( binding = 0 ) uniform sampler2DArray texImage;
 
-uniform vec3 La = vec3(0.0, 0.0, 0.0 );
-uniform vec3 Ld = vec3(1.0, 1.0, 1.0 );
-uniform vec3 Ls = vec3(1.0, 1.0, 1.0 );
+#ifdef BINDLESS
+// anyagonként a textúra + mintavételező 64 bites handle-je (includes/UniformBlocks.h: MATERIAL_STORAGE_BINDING),
+// 0 amíg a textúra töltődik: addig a kötött texImage-ből olvasunk
+layout( std430, binding = 6 ) readonly buffer MaterialTextures
+{
+	uvec2 materialTextures[];
+};
+#endif
 
-uniform float lightConstantAttenuation    = 1.0;
-uniform float lightLinearAttenuation      = 0.0;
-uniform float lightQuadraticAttenuation   = 0.0;
+vec4 MaterialTexture( vec2 uv )
+{
+#ifdef BINDLESS
+	// a réteg rajzolásonként állandó, így a handle is
+	uvec2 handle = materialTextures[ vs_out_layer ];
+	if ( handle != uvec2( 0 ) ) return texture( sampler2DArray( handle ), vec3( uv, vs_out_layer ) );
+#endif
+	return texture( texImage, vec3( uv, vs_out_layer ) );
+}
 
-uniform bool enableRedLight;
+// képkockánként egyszer feltöltött adatok (includes/UniformBlocks.h: FrameUniforms)
+layout( std140, binding = 0 ) uniform FrameData
+{
+	mat4  viewProj;
+	vec3  cameraPos;
+	float elapsedTimeInSec;
+	vec4  lightPos;
+	vec4  lightPos2;
+	vec3  La;
+	float lightConstantAttenuation;
+	vec3  Ld;
+	float lightLinearAttenuation;
+	vec3  Ls;
+	float lightQuadraticAttenuation;
+	bool  enableRedLight;
+};
 
 // anyag tulajdonsagok
 
@@ -104,15 +139,16 @@ vec3 lighting(LightProperties light){
 
 void main()
 {
-    vec4 texColor = texture(texImage, vs_out_tex);
+    vec4 texColor = MaterialTexture(vs_out_tex);
 
     if(state == SHADER_STATE_OCEAN){
         fs_out_col = texColor;
     }
 
     if(state == SHADER_STATE_OCEAN_SURFACE){
-        vec2 uv = vs_out_tex + vec2(m_ElapsedTimeInSec, m_ElapsedTimeInSec) / 150.0;
-        fs_out_col = texture(texImage, uv);
+        // az idő SHADER_TIME_PERIOD_IN_SEC (300 s) után körbefordul: 300 / 150 = 2, a mirrored repeat periódusa
+        vec2 uv = vs_out_tex + vec2(elapsedTimeInSec, elapsedTimeInSec) / 150.0;
+        fs_out_col = MaterialTexture(uv);
     }
 
     if(state == SHADER_STATE_DEFAULT){
@@ -134,7 +170,11 @@ void main()
     fs_out_col *= vec4(absorb, 1.0);
 
     vec3 redAdd = vec3(0.0);
+#ifdef RED_LIGHT
+    if (RED_LIGHT != 0) {
+#else
     if (enableRedLight) {
+#endif
         redAdd = redPointLight(vs_out_pos);
     }
 
@@ -0,0 +1,78 @@
+#version 430
+
+// Vert_PosNormTex.vert változata a glMultiDrawElementsIndirect-tel rajzolt színtérhez (lásd includes/MeshBuffer.h)
+
+// VBO-ból érkező változók
+layout( location = 0 ) in vec3 vs_in_pos;
+layout( location = 1 ) in vec3 vs_in_norm;
+layout( location = 2 ) in vec2 vs_in_tex;
+layout( location = 3 ) in uint vs_in_drawIndex; // példányonkénti attribútum: baseInstance + példány sorszáma, a látható rekordok listájában
+
+// a pipeline-ban tovább adandó értékek
+out vec3 vs_out_pos;
+out vec3 vs_out_norm;
+out vec2 vs_out_tex;
+flat out int vs_out_layer; // a textúratömb rétege
+
+// képkockánként egyszer feltöltött adatok (includes/UniformBlocks.h: FrameUniforms)
+layout( std140, binding = 0 ) uniform FrameData
+{
+	mat4  viewProj;
+	vec3  cameraPos;
+	float elapsedTimeInSec;
+	vec4  lightPos;
+	vec4  lightPos2;
+	vec3  La;
+	float lightConstantAttenuation;
+	vec3  Ld;
+	float lightLinearAttenuation;
+	vec3  Ls;
+	float lightQuadraticAttenuation;
+	bool  enableRedLight;
+};
+
+// hol mintavételez a rajzolás az anyagok textúratömbjéből (includes/UniformBlocks.h: MaterialUniforms)
+struct Material
+{
+	vec4 uvTransform; // textúrakoordináta * xy + zw
+	int  layer;
+};
+
+// rajzolásonkénti adatok (includes/UniformBlocks.h: DrawData, DRAW_DATA_STORAGE_BINDING)
+struct DrawData
+{
+	mat4 world;
+	mat4 dequant; // a mesh kvantált pozícióinak visszaalakítása modell térbe
+	Material material;
+};
+
+layout( std430, binding = 1 ) readonly buffer DrawDataBuffer
+{
+	DrawData drawData[];
+};
+
+// a vágás után megmaradt rekordok indexei, parancsonként a baseInstance-tól (includes/GPUCulling.h)
+layout( std430, binding = 4 ) readonly buffer VisibleRecordBuffer
+{
+	uint visibleRecords[];
+};
+
+void main()
+{
+	uint record  = visibleRecords[ vs_in_drawIndex ];
+	mat4 world   = drawData[ record ].world;
+	mat4 dequant = drawData[ record ].dequant;
+	// inverz transzponált helyett a kofaktor mátrix: det-szeresében tér el, a fragment shader úgyis normalizál
+	// (tükröző, det < 0 transzformáció nincs a színtérben)
+	mat3 m3 = mat3( world );
+	mat3 normalMatrix = mat3( cross( m3[1], m3[2] ), cross( m3[2], m3[0] ), cross( m3[0], m3[1] ) );
+
+	vec4 pos = dequant * vec4( vs_in_pos, 1 );
+	gl_Position = viewProj * world * pos;
+	vs_out_pos  = (world * pos).xyz;
+	vs_out_norm = normalMatrix * vs_in_norm;
+
+	Material material = drawData[ record ].material;
+	vs_out_tex   = vs_in_tex * material.uvTransform.xy + material.uvTransform.zw;
+	vs_out_layer = material.layer;
+}
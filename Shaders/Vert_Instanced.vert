@@ -0,0 +1,71 @@
+#version 430
+
+// Vert_PosNormTex.vert példányosított (glDrawElementsInstanced) változata
+
+// VBO-ból érkező változók
+layout( location = 0 ) in vec3 vs_in_pos;
+layout( location = 1 ) in vec3 vs_in_norm;
+layout( location = 2 ) in vec2 vs_in_tex;
+
+// a pipeline-ban tovább adandó értékek
+out vec3 vs_out_pos;
+out vec3 vs_out_norm;
+out vec2 vs_out_tex;
+flat out int vs_out_layer; // a textúratömb rétege
+
+// képkockánként egyszer feltöltött adatok (includes/UniformBlocks.h: FrameUniforms)
+layout( std140, binding = 0 ) uniform FrameData
+{
+	mat4  viewProj;
+	vec3  cameraPos;
+	float elapsedTimeInSec;
+	vec4  lightPos;
+	vec4  lightPos2;
+	vec3  La;
+	float lightConstantAttenuation;
+	vec3  Ld;
+	float lightLinearAttenuation;
+	vec3  Ls;
+	float lightQuadraticAttenuation;
+	bool  enableRedLight;
+};
+
+// hol mintavételez a rajzolás az anyagok textúratömbjéből (includes/UniformBlocks.h: MaterialUniforms)
+struct Material
+{
+	vec4 uvTransform; // textúrakoordináta * xy + zw
+	int  layer;
+};
+
+// rajzolásonkénti adatok (includes/UniformBlocks.h: ObjectUniforms)
+layout( std140, binding = 1 ) uniform ObjectData
+{
+	mat4 world;
+	mat4 worldIT;
+	mat4 dequant; // kvantált (VertexQuantized) pozíciók visszaalakítása modell térbe, float vertexeknél egységmátrix
+	Material material;
+};
+
+// példányonkénti világ transzformációk (includes/UniformBlocks.h: INSTANCE_STORAGE_BINDING)
+layout( std430, binding = 0 ) readonly buffer InstanceData
+{
+	mat4 instanceWorld[];
+};
+
+void main()
+{
+	// a példány transzformációja az objektumé után, a normál mátrixot itt számoljuk (nincs CPU-s inverz példányonként)
+	mat4 model = world * instanceWorld[ gl_InstanceID ];
+	// inverz transzponált helyett a kofaktor mátrix: det-szeresében tér el, a fragment shader úgyis normalizál
+	// (tükröző, det < 0 transzformáció nincs a színtérben)
+	mat3 m3 = mat3( model );
+	mat3 normalMatrix = mat3( cross( m3[1], m3[2] ), cross( m3[2], m3[0] ), cross( m3[0], m3[1] ) );
+
+	vec4 pos = dequant * vec4( vs_in_pos, 1 );
+	gl_Position = viewProj * model * pos;
+	vs_out_pos  = (model * pos).xyz;
+	vs_out_norm = normalMatrix * vs_in_norm;
+
+	vs_out_tex   = vs_in_tex * material.uvTransform.xy + material.uvTransform.zw;
+	vs_out_layer = material.layer;
+}
@@ -9,17 +9,48 @@ layout( location = 2 ) in vec2 vs_in_tex;
 out vec3 vs_out_pos;
 out vec3 vs_out_norm;
 out vec2 vs_out_tex;
+flat out int vs_out_layer; // a textúratömb rétege
 
-// shader külső paraméterei - most a három transzformációs mátrixot külön-külön vesszük át
-uniform mat4 world;
-uniform mat4 worldIT;
-uniform mat4 viewProj;
+// képkockánként egyszer feltöltött adatok (includes/UniformBlocks.h: FrameUniforms)
+layout( std140, binding = 0 ) uniform FrameData
+{
+	mat4  viewProj;
+	vec3  cameraPos;
+	float elapsedTimeInSec;
+	vec4  lightPos;
+	vec4  lightPos2;
+	vec3  La;
+	float lightConstantAttenuation;
+	vec3  Ld;
+	float lightLinearAttenuation;
+	vec3  Ls;
+	float lightQuadraticAttenuation;
+	bool  enableRedLight;
+};
+
+// hol mintavételez a rajzolás az anyagok textúratömbjéből (includes/UniformBlocks.h: MaterialUniforms)
+struct Material
+{
+	vec4 uvTransform; // textúrakoordináta * xy + zw
+	int  layer;
+};
+
+// rajzolásonkénti adatok (includes/UniformBlocks.h: ObjectUniforms)
+layout( std140, binding = 1 ) uniform ObjectData
+{
+	mat4 world;
+	mat4 worldIT;
+	mat4 dequant; // kvantált (VertexQuantized) pozíciók visszaalakítása modell térbe, float vertexeknél egységmátrix
+	Material material;
+};
 
 void main()
 {
-	gl_Position = viewProj * world * vec4( vs_in_pos, 1 );
-	vs_out_pos  = (world   * vec4(vs_in_pos,  1)).xyz;
+	vec4 pos = dequant * vec4( vs_in_pos, 1 );
+	gl_Position = viewProj * world * pos;
+	vs_out_pos  = (world   * pos).xyz;
 	vs_out_norm = (worldIT * vec4(vs_in_norm, 0)).xyz;
 
-	vs_out_tex = vs_in_tex;
-}
\ No newline at end of file
+	vs_out_tex   = vs_in_tex * material.uvTransform.xy + material.uvTransform.zw;
+	vs_out_layer = material.layer;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+// Minimal benchmark harness for the ZH_Bench executable.
+// Every benchmark registers itself with the BENCHMARK macro and is run by name from BenchMain.cpp.
+// The benchmarks expect to be started from the project root (like run.sh does), so Assets/ is reachable.
+
+namespace Bench
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct Entry
+	{
+		const char* name;
+		const char* description;
+		void ( *function )();
+	};
+
+	std::vector<Entry>& Registry();
+
+	struct Registrar
+	{
+		Registrar( const char* name, const char* description, void ( *function )() )
+		{
+			Registry().push_back( { name, description, function } );
+		}
+	};
+
+	inline double ElapsedMs( Clock::time_point start, Clock::time_point end )
+	{
+		return std::chrono::duration<double, std::milli>( end - start ).count();
+	}
+
+	// Runs func repeatCount times and returns the median wall clock time in milliseconds.
+	template <typename F>
+	double MedianMs( int repeatCount, F&& func )
+	{
+		std::vector<double> times;
+		times.reserve( repeatCount );
+		for ( int i = 0; i < repeatCount; ++i )
+		{
+			Clock::time_point start = Clock::now();
+			func();
+			times.push_back( ElapsedMs( start, Clock::now() ) );
+		}
+		std::sort( times.begin(), times.end() );
+		return times[ times.size() / 2 ];
+	}
+
+	// Copies the files into an emptied temp_directory_path() / directoryName and returns the copies. The benchmarks of
+	// the image path load these, so the cooked Assets/*.ktx2 files of ZH_AssetCook are not picked up instead.
+	template <typename Container>
+	std::vector<std::filesystem::path> CopyToTempDirectory( const Container& fileNames, const char* directoryName )
+	{
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / directoryName;
+		std::error_code ec;
+		std::filesystem::remove_all( directory, ec );
+		std::filesystem::create_directories( directory, ec );
+
+		std::vector<std::filesystem::path> copies;
+		for ( const auto& fileName : fileNames )
+		{
+			copies.push_back( directory / std::filesystem::path( fileName ).filename() );
+			std::filesystem::copy_file( fileName, copies.back(), ec );
+		}
+		return copies;
+	}
+
+	// Keeps the optimizer from throwing away results that are only computed for timing.
+	template <typename T>
+	inline void DoNotOptimize( const T& value )
+	{
+		static volatile const void* sink;
+		sink = &value;
+	}
+}
+
+#define BENCHMARK( name, description )                                                  \
+	static void Bench_##name();                                                         \
+	static Bench::Registrar s_benchRegistrar_##name( #name, description, &Bench_##name ); \
+	static void Bench_##name()
@@ -0,0 +1,61 @@
+#include "BenchGL.h"
+
+#include <cstdio>
+
+Bench::GLContext::GLContext( int width, int height )
+{
+	if ( SDL_Init( SDL_INIT_VIDEO ) == -1 )
+	{
+		std::printf( "SDL_Init failed: %s\n", SDL_GetError() );
+		return;
+	}
+
+	SDL_GL_SetAttribute( SDL_GL_CONTEXT_MAJOR_VERSION, 4 );
+	SDL_GL_SetAttribute( SDL_GL_CONTEXT_MINOR_VERSION, 5 );
+	SDL_GL_SetAttribute( SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE );
+	SDL_GL_SetAttribute( SDL_GL_DOUBLEBUFFER, 1 );
+	SDL_GL_SetAttribute( SDL_GL_DEPTH_SIZE, 24 );
+
+	m_window = SDL_CreateWindow( "ZH_Bench", 0, 0, width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN );
+	if ( m_window == nullptr )
+	{
+		std::printf( "SDL_CreateWindow failed: %s\n", SDL_GetError() );
+		return;
+	}
+
+	m_context = SDL_GL_CreateContext( m_window );
+	if ( m_context == nullptr )
+	{
+		std::printf( "SDL_GL_CreateContext failed: %s\n", SDL_GetError() );
+		return;
+	}
+
+	// no vsync, the benchmarks measure the submission cost
+	SDL_GL_SetSwapInterval( 0 );
+
+	glewExperimental = GL_TRUE;
+	if ( glewInit() != GLEW_OK )
+	{
+		std::printf( "glewInit failed\n" );
+		SDL_GL_DeleteContext( m_context );
+		m_context = nullptr;
+		return;
+	}
+
+	std::printf( "GL: %s, %s\n", reinterpret_cast<const char*>( glGetString( GL_RENDERER ) ), reinterpret_cast<const char*>( glGetString( GL_VERSION ) ) );
+
+	glViewport( 0, 0, width, height );
+	glEnable( GL_DEPTH_TEST );
+	glEnable( GL_CULL_FACE );
+}
+
+Bench::GLContext::~GLContext()
+{
+	if ( m_context ) SDL_GL_DeleteContext( m_context );
+	if ( m_window ) SDL_DestroyWindow( m_window );
+}
+
+void Bench::GLContext::Swap()
+{
+	SDL_GL_SwapWindow( m_window );
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <SDL2/SDL.h>
+
+// OpenGL context for the GPU side benchmarks: a hidden window with the same context settings as main.cpp.
+namespace Bench
+{
+	class GLContext
+	{
+	public:
+		GLContext( int width = 1280, int height = 720 );
+		~GLContext();
+
+		GLContext( const GLContext& ) = delete;
+		GLContext& operator=( const GLContext& ) = delete;
+
+		// false, if there is no GL 4.5 context (e.g. no display), the benchmark should be skipped then
+		explicit operator bool() const noexcept { return m_context != nullptr; }
+
+		void Swap();
+
+	private:
+		SDL_Window* m_window = nullptr;
+		SDL_GLContext m_context = nullptr;
+	};
+}
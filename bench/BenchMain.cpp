@@ -0,0 +1,55 @@
+#include "Bench.h"
+
+#include <cstring>
+
+std::vector<Bench::Entry>& Bench::Registry()
+{
+	static std::vector<Entry> registry;
+	return registry;
+}
+
+// Usage: ZH_Bench [--list] [benchmark names...]
+// Without names every registered benchmark is run.
+int main( int argc, char* argv[] )
+{
+	std::vector<Bench::Entry>& registry = Bench::Registry();
+	std::sort( registry.begin(), registry.end(),
+			   []( const Bench::Entry& a, const Bench::Entry& b ) { return std::strcmp( a.name, b.name ) < 0; } );
+
+	if ( argc > 1 && std::strcmp( argv[ 1 ], "--list" ) == 0 )
+	{
+		for ( const Bench::Entry& entry : registry )
+		{
+			std::printf( "%-24s %s\n", entry.name, entry.description );
+		}
+		return 0;
+	}
+
+	int result = 0;
+	for ( int i = 1; i < argc; ++i )
+	{
+		bool found = std::any_of( registry.cbegin(), registry.cend(),
+								  [ name = argv[ i ] ]( const Bench::Entry& entry ) { return std::strcmp( entry.name, name ) == 0; } );
+		if ( !found )
+		{
+			std::fprintf( stderr, "Unknown benchmark: %s (use --list)\n", argv[ i ] );
+			result = 1;
+		}
+	}
+
+	for ( const Bench::Entry& entry : registry )
+	{
+		bool selected = ( argc == 1 );
+		for ( int i = 1; i < argc; ++i )
+		{
+			selected = selected || std::strcmp( entry.name, argv[ i ] ) == 0;
+		}
+		if ( !selected ) continue;
+
+		std::printf( "=== %s: %s\n", entry.name, entry.description );
+		entry.function();
+		std::printf( "\n" );
+	}
+
+	return result;
+}
@@ -0,0 +1,59 @@
+#include "BenchObj.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+std::filesystem::path Bench::WriteSyntheticObj( unsigned int gridSize, bool withNormals )
+{
+	std::filesystem::path fileName = std::filesystem::temp_directory_path() /
+		( "zh_bench_grid_" + std::to_string( gridSize ) + ( withNormals ? "_vn.obj" : "_tri.obj" ) );
+
+	if ( std::filesystem::exists( fileName ) ) return fileName;
+
+	std::ofstream obj( fileName, std::ios::binary );
+	char line[ 128 ];
+
+	for ( unsigned int y = 0; y < gridSize; ++y )
+	{
+		for ( unsigned int x = 0; x < gridSize; ++x )
+		{
+			float h = 2.0f * std::sin( x * 0.05f ) * std::cos( y * 0.07f );
+			obj.write( line, std::snprintf( line, sizeof( line ), "v %.6f %.6f %.6f\n", x * 0.5f, h, y * 0.5f ) );
+			obj.write( line, std::snprintf( line, sizeof( line ), "vt %.6f %.6f\n", x / float( gridSize - 1 ), y / float( gridSize - 1 ) ) );
+			if ( withNormals )
+			{
+				obj.write( line, std::snprintf( line, sizeof( line ), "vn %.6f %.6f %.6f\n", -h * 0.1f, 1.0f, h * 0.05f ) );
+			}
+		}
+	}
+
+	for ( unsigned int y = 0; y + 1 < gridSize; ++y )
+	{
+		for ( unsigned int x = 0; x + 1 < gridSize; ++x )
+		{
+			unsigned int i0 = y * gridSize + x + 1, i1 = i0 + 1, i2 = i0 + gridSize + 1, i3 = i0 + gridSize;
+			if ( withNormals )
+			{
+				obj.write( line, std::snprintf( line, sizeof( line ), "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n",
+												i0, i0, i0, i3, i3, i3, i2, i2, i2, i1, i1, i1 ) );
+			}
+			else
+			{
+				obj.write( line, std::snprintf( line, sizeof( line ), "f %u/%u %u/%u %u/%u\nf %u/%u %u/%u %u/%u\n",
+												i0, i0, i3, i3, i2, i2, i0, i0, i2, i2, i1, i1 ) );
+			}
+		}
+	}
+
+	return fileName;
+}
+
+bool Bench::SameMesh( const ObjParser::Mesh& a, const ObjParser::Mesh& b )
+{
+	return a.vertexArray.size() == b.vertexArray.size() && a.indexArray.size() == b.indexArray.size()
+		&& std::memcmp( a.vertexArray.data(), b.vertexArray.data(), a.vertexArray.size() * sizeof( Vertex ) ) == 0
+		&& std::memcmp( a.indexArray.data(), b.indexArray.data(), a.indexArray.size() * sizeof( GLuint ) ) == 0;
+}
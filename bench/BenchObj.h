@@ -0,0 +1,16 @@
+#pragma once
+
+#include "ObjParser.h"
+
+#include <filesystem>
+
+// Shared helpers for the .obj parsing benchmarks.
+namespace Bench
+{
+	// Writes a gridSize x gridSize vertex height field as .obj into the temp directory (once) and returns its path.
+	// withNormals: v/vt/vn quads, otherwise v/vt triangles, so the parser has to compute the normals.
+	std::filesystem::path WriteSyntheticObj( unsigned int gridSize, bool withNormals );
+
+	// Byte-wise comparison of the vertex and index arrays.
+	bool SameMesh( const ObjParser::Mesh& a, const ObjParser::Mesh& b );
+}
@@ -0,0 +1,235 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "BindlessMaterials.h"
+#include "GLUtils.hpp"
+#include "ObjParser.h"
+#include "ShaderVariants.h"
+#include "TextureArray.h"
+#include "UniformBlocks.h"
+#include "VertexQuantization.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Texture state of the per-draw path of CMyApp::Render: a texture + sampler bind per draw (one texture per
+// material, the Draw of before the TextureArray), the TextureArray bound once per frame, and bindless handles in the
+// BindlessMaterials storage buffer (no bind at all, GL_ARB_bindless_texture only). CPU submission cost and the
+// number of texture binds per frame, the images have to match the first row.
+
+namespace
+{
+	constexpr int IMAGE_SIZE = 128;
+	constexpr int DRAW_COUNT = 1000;
+	constexpr GLsizei MATERIAL_COUNT = 4; // CMyApp::MATERIAL_LAYER_COUNT
+	constexpr GLsizei MATERIAL_SIZE = 64;
+
+	std::vector<std::uint32_t> MaterialTexels( int material )
+	{
+		std::srand( material + 1 );
+		const std::uint32_t colour = 0xFF000000u | ( static_cast<std::uint32_t>( std::rand() ) & 0xFFFFFFu );
+		std::vector<std::uint32_t> texels( MATERIAL_SIZE * MATERIAL_SIZE );
+		for ( GLsizei y = 0; y < MATERIAL_SIZE; ++y )
+		{
+			for ( GLsizei x = 0; x < MATERIAL_SIZE; ++x ) texels[ y * MATERIAL_SIZE + x ] = ( ( x / 8 + y / 8 ) & 1 ) ? colour : 0xFFFFFFFFu;
+		}
+		return texels;
+	}
+
+	std::vector<std::uint8_t> ReadImage()
+	{
+		std::vector<std::uint8_t> pixels( IMAGE_SIZE * IMAGE_SIZE * 4 );
+		glReadPixels( 0, 0, IMAGE_SIZE, IMAGE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data() );
+		return pixels;
+	}
+}
+
+BENCHMARK( BindlessTextures, "Material textures per draw: bind per draw vs texture array bound once vs ARB_bindless_texture handles" )
+{
+	constexpr int REPEAT = 5;
+	constexpr int FRAMES = 10;
+
+	Bench::GLContext context( IMAGE_SIZE, IMAGE_SIZE );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	OGLObject claw = CreateQuantizedGLObjectFromMesh( MakeMeshView( ObjParser::parse( "Assets/Claw.obj" ) ) );
+
+	// the same textures three ways: one-layer arrays per material, layers of a TextureArray, handles of that array
+	GLuint sampler = 0;
+	glCreateSamplers( 1, &sampler );
+	glSamplerParameteri( sampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+	glSamplerParameteri( sampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+	std::vector<GLuint> textures( MATERIAL_COUNT );
+	glCreateTextures( GL_TEXTURE_2D_ARRAY, MATERIAL_COUNT, textures.data() );
+	TextureArray array;
+	array.Init( MATERIAL_COUNT, MATERIAL_SIZE, MATERIAL_SIZE, GL_RGBA8 );
+	for ( GLsizei m = 0; m < MATERIAL_COUNT; ++m )
+	{
+		const std::vector<std::uint32_t> texels = MaterialTexels( m );
+		glTextureStorage3D( textures[ m ], 1, GL_RGBA8, MATERIAL_SIZE, MATERIAL_SIZE, 1 );
+		glTextureSubImage3D( textures[ m ], 0, 0, 0, 0, MATERIAL_SIZE, MATERIAL_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE, texels.data() );
+		glTextureSubImage3D( array.ID(), 0, 0, 0, m, MATERIAL_SIZE, MATERIAL_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE, texels.data() );
+		array.SetLayerLevel( m, 0 );
+	}
+	BindlessMaterials bindless;
+	if ( bindless.Init( MATERIAL_COUNT ) )
+	{
+		for ( GLsizei m = 0; m < MATERIAL_COUNT; ++m ) bindless.SetTexture( m, array.ID(), sampler );
+	}
+
+	// like CMyApp::InitShaders: BINDLESS is a common define when the driver has the extension
+	std::vector<std::pair<std::string, int>> commonDefines;
+	if ( BindlessMaterials::IsSupported() ) commonDefines.emplace_back( "BINDLESS", 1 );
+	ShaderVariants programs;
+	programs.Init( { { GL_VERTEX_SHADER, "Shaders/Vert_PosNormTex.vert" }, { GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" } }, { { "STATE", 3 }, { "RED_LIGHT", 2 } },
+				   nullptr, commonDefines );
+	const ShaderProgram& program = programs.Program( programs.MakeKey( { 1, 0 } ) ); // SHADER_STATE_DEFAULT
+
+	FrameUniforms frame = {};
+	frame.viewProj = glm::perspective( glm::radians( 60.0f ), 1.0f, 0.1f, 100.0f );
+	frame.lightPos = glm::vec4( 0, 1, 1, 0 );
+	frame.Ld = frame.Ls = frame.La = glm::vec3( 1.0f );
+	frame.lightConstantAttenuation = 1.0f;
+	GLuint frameBuffer = 0, objectBuffer = 0;
+	glCreateBuffers( 1, &frameBuffer );
+	glNamedBufferStorage( frameBuffer, sizeof( FrameUniforms ), &frame, 0 );
+	glBindBufferBase( GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frameBuffer );
+
+	// every draw has its own slot, written before the timed frames (setLayers): only the texture state differs between the paths
+	const GLsizeiptr slotStride = UniformSlotStride( sizeof( ObjectUniforms ) );
+	std::vector<std::byte> slots( slotStride * DRAW_COUNT );
+	const int side = static_cast<int>( std::ceil( std::sqrt( static_cast<double>( DRAW_COUNT ) ) ) );
+	const float spacing = 20.0f / side;
+	for ( int i = 0; i < DRAW_COUNT; ++i )
+	{
+		const float x = ( i % side + 0.5f ) * spacing - 10.0f;
+		const float y = ( i / side + 0.5f ) * spacing - 10.0f;
+		const glm::mat4 world = glm::translate( glm::vec3( x, y, -25.0f ) ) * glm::scale( glm::vec3( 0.1f * spacing ) ) * glm::rotate( 0.3f * i, glm::vec3( 0, 1, 0 ) );
+		const ObjectUniforms uniforms = { world, glm::transpose( glm::inverse( world ) ), claw.dequantization };
+		std::copy_n( reinterpret_cast<const std::byte*>( &uniforms ), sizeof( uniforms ), slots.data() + slotStride * i );
+	}
+
+	enum class Path { BIND_PER_DRAW, ARRAY_ONCE, BINDLESS };
+	std::size_t binds = 0;
+	auto render = [ & ]( Path path )
+	{
+		binds = 0;
+		glUseProgram( program.ID() );
+		glBindVertexArray( claw.vaoID );
+		bindless.Bind();
+		if ( path == Path::ARRAY_ONCE )
+		{
+			glBindTextureUnit( 0, array.ID() );
+			glBindSampler( 0, sampler );
+			binds += 2;
+		}
+		for ( int i = 0; i < DRAW_COUNT; ++i )
+		{
+			glBindBufferRange( GL_UNIFORM_BUFFER, OBJECT_UNIFORM_BINDING, objectBuffer, slotStride * i, sizeof( ObjectUniforms ) );
+			if ( path == Path::BIND_PER_DRAW )
+			{
+				glBindTextureUnit( 0, textures[ i % MATERIAL_COUNT ] );
+				glBindSampler( 0, sampler );
+				binds += 2;
+			}
+			glDrawElements( GL_TRIANGLES, claw.count, GL_UNSIGNED_INT, nullptr );
+		}
+		glBindTextureUnit( 0, 0 );
+		glBindSampler( 0, 0 );
+		glBindVertexArray( 0 );
+	};
+
+	// the per draw textures are one-layer arrays: layer 0 of each, not the layer of the draw
+	auto setLayers = [ & ]( bool perMaterial )
+	{
+		for ( int i = 0; i < DRAW_COUNT; ++i )
+		{
+			const GLint layer = perMaterial ? i % MATERIAL_COUNT : 0;
+			std::copy_n( reinterpret_cast<const std::byte*>( &layer ), sizeof( layer ), slots.data() + slotStride * i + offsetof( ObjectUniforms, material.layer ) );
+		}
+		glDeleteBuffers( 1, &objectBuffer );
+		glCreateBuffers( 1, &objectBuffer );
+		glNamedBufferStorage( objectBuffer, static_cast<GLsizeiptr>( slots.size() ), slots.data(), 0 );
+	};
+
+	auto cpuMs = [ & ]( Path path )
+	{
+		std::vector<double> times;
+		for ( int r = 0; r < REPEAT; ++r )
+		{
+			double ms = 0.0;
+			for ( int f = 0; f < FRAMES; ++f )
+			{
+				glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+				const Bench::Clock::time_point start = Bench::Clock::now();
+				render( path );
+				ms += Bench::ElapsedMs( start, Bench::Clock::now() );
+				glFinish();
+			}
+			times.push_back( ms / FRAMES );
+		}
+		std::sort( times.begin(), times.end() );
+		return times[ times.size() / 2 ];
+	};
+
+	struct Row
+	{
+		const char* name;
+		Path path;
+		bool perMaterialLayers;
+	};
+	const Row rows[] = {
+		{ "bind per draw (texture per material)", Path::BIND_PER_DRAW, false },
+		{ "TextureArray bound once", Path::ARRAY_ONCE, true },
+		{ "bindless handles", Path::BINDLESS, true },
+	};
+
+	std::printf( "%d draws, %d materials\n", DRAW_COUNT, MATERIAL_COUNT );
+	std::printf( "%-38s %12s %12s %9s %12s\n", "texture state", "binds/frame", "CPU [ms]", "speedup", "image diff" );
+	std::vector<std::uint8_t> reference;
+	double referenceMs = 0.0;
+	for ( const Row& row : rows )
+	{
+		if ( row.path == Path::BINDLESS && !bindless.IsResident() )
+		{
+			std::printf( "%-38s skipped, no GL_ARB_bindless_texture\n", row.name );
+			continue;
+		}
+		setLayers( row.perMaterialLayers );
+
+		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+		render( row.path );
+		const std::vector<std::uint8_t> image = ReadImage();
+		if ( reference.empty() ) reference = image;
+		int differentPixels = 0;
+		for ( std::size_t p = 0; p < image.size(); p += 4 )
+		{
+			int maxDiff = 0;
+			for ( int c = 0; c < 3; ++c ) maxDiff = std::max( maxDiff, std::abs( image[ p + c ] - reference[ p + c ] ) );
+			differentPixels += maxDiff > 2;
+		}
+
+		const double ms = cpuMs( row.path );
+		if ( referenceMs == 0.0 ) referenceMs = ms;
+		std::printf( "%-38s %12zu %12.3f %8.2fx %12d\n", row.name, binds, ms, referenceMs / ms, differentPixels );
+	}
+
+	glUseProgram( 0 );
+	programs.Clean();
+	bindless.Clean();
+	array.Clean();
+	glDeleteTextures( MATERIAL_COUNT, textures.data() );
+	glDeleteSamplers( 1, &sampler );
+	glDeleteBuffers( 1, &objectBuffer );
+	glDeleteBuffers( 1, &frameBuffer );
+	CleanOGLObject( claw );
+}
@@ -0,0 +1,178 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "GLUtils.hpp"
+#include "TextureCooking.h"
+#include "TextureLoader.h"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+// The texture set of CMyApp::InitTextures as PNGs against the KTX2 files of ZH_AssetCook: VRAM of the whole mip
+// chain (RGBA8 vs the block format, queried from GL), the load time through TextureLoader (everything uploaded, no
+// staging ring) and the quality of level 0 (PSNR of the RGB channels, the texture read back through the driver's
+// decoder, against ImageFromFile). BC7 is cooked too for comparison, even where the auto choice is BC1.
+// The images are copied into a temporary directory, Assets/ is left alone.
+
+namespace
+{
+	const std::array<const char*, 5> TEXTURE_FILES = {
+		"Assets/ocean.png", "Assets/oceanbottom.png", "Assets/sub.png", "Assets/Caustics.png", "Assets/PufferFish.png",
+	};
+
+	const char* FormatName( TextureCooking::BlockFormat format )
+	{
+		switch ( format )
+		{
+		case TextureCooking::BlockFormat::BC1: return "BC1";
+		case TextureCooking::BlockFormat::BC3: return "BC3";
+		case TextureCooking::BlockFormat::BC7: return "BC7";
+		}
+		return "?";
+	}
+
+	std::size_t TextureBytes( GLuint texture )
+	{
+		GLint levelCount = 0, compressed = GL_FALSE;
+		glGetTextureParameteriv( texture, GL_TEXTURE_IMMUTABLE_LEVELS, &levelCount );
+		glGetTextureLevelParameteriv( texture, 0, GL_TEXTURE_COMPRESSED, &compressed );
+		std::size_t bytes = 0;
+		for ( GLint level = 0; level < levelCount; ++level )
+		{
+			GLint width = 0, height = 0, size = 0;
+			glGetTextureLevelParameteriv( texture, level, GL_TEXTURE_WIDTH, &width );
+			glGetTextureLevelParameteriv( texture, level, GL_TEXTURE_HEIGHT, &height );
+			if ( compressed ) glGetTextureLevelParameteriv( texture, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size );
+			bytes += compressed ? std::size_t( size ) : std::size_t( width ) * height * 4;
+		}
+		return bytes;
+	}
+
+	double PSNR( GLuint texture, const ImageRGBA& reference )
+	{
+		std::vector<ImageRGBA::TexelRGBA> texels( reference.texelData.size() );
+		glGetTextureImage( texture, 0, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<GLsizei>( texels.size() * sizeof( texels[ 0 ] ) ), texels.data() );
+		double squaredError = 0.0;
+		for ( std::size_t i = 0; i < texels.size(); ++i )
+		{
+			for ( int c = 0; c < 3; ++c )
+			{
+				const double d = double( texels[ i ][ c ] ) - double( reference.texelData[ i ][ c ] );
+				squaredError += d * d;
+			}
+		}
+		const double mse = squaredError / ( texels.size() * 3.0 );
+		return mse > 0.0 ? 10.0 * std::log10( 255.0 * 255.0 / mse ) : 99.0;
+	}
+
+	struct LoadResult
+	{
+		double ms = 0.0;
+		std::array<GLuint, 5> textures = {};
+		std::vector<TextureLoader::Timing> timings;
+	};
+
+	LoadResult Load( const std::vector<std::filesystem::path>& files )
+	{
+		LoadResult result;
+		const Bench::Clock::time_point start = Bench::Clock::now();
+		{
+			TextureLoader loader;
+			for ( std::size_t i = 0; i < files.size(); ++i ) loader.Load( files[ i ], result.textures[ i ] );
+			loader.UploadAll();
+			glFinish();
+			result.timings = loader.Timings();
+		}
+		result.ms = Bench::ElapsedMs( start, Bench::Clock::now() );
+		return result;
+	}
+
+	void Delete( LoadResult& result )
+	{
+		glDeleteTextures( static_cast<GLsizei>( result.textures.size() ), result.textures.data() );
+		result.textures.fill( 0 );
+	}
+}
+
+BENCHMARK( CompressedTextures, "InitTextures assets: PNG + RGBA8 mips vs cooked BC1/BC7 KTX2 (VRAM, load time, PSNR)" )
+{
+	constexpr int REPEAT = 5;
+
+	Bench::GLContext context( 64, 64 );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	const std::vector<std::filesystem::path> files = Bench::CopyToTempDirectory( TEXTURE_FILES, "ZH_BenchCompressedTextures" );
+	std::vector<ImageRGBA> references;
+	for ( const char* fileName : TEXTURE_FILES ) references.push_back( ImageFromFile( fileName ) );
+
+	// PNG: no cooked files next to the copies yet
+	LoadResult png;
+	const double pngMs = Bench::MedianMs( REPEAT, [ & ]() { Delete( png ); png = Load( files ); } );
+
+	auto cook = [ & ]( std::optional<TextureCooking::BlockFormat> format, std::vector<double>& cookMs, std::vector<TextureCooking::BlockFormat>& formats )
+	{
+		for ( const std::filesystem::path& file : files )
+		{
+			const Bench::Clock::time_point start = Bench::Clock::now();
+			formats.push_back( TextureCooking::Cook( file, TextureCooking::CookedPath( file ), { format } ).value_or( TextureCooking::BlockFormat::BC3 ) );
+			cookMs.push_back( Bench::ElapsedMs( start, Bench::Clock::now() ) );
+		}
+	};
+
+	std::vector<double> bc7CookMs, autoCookMs;
+	std::vector<TextureCooking::BlockFormat> bc7Formats, autoFormats;
+	cook( TextureCooking::BlockFormat::BC7, bc7CookMs, bc7Formats );
+	LoadResult bc7;
+	const double bc7Ms = Bench::MedianMs( REPEAT, [ & ]() { Delete( bc7 ); bc7 = Load( files ); } );
+
+	cook( std::nullopt, autoCookMs, autoFormats );
+	LoadResult cooked;
+	const double cookedMs = Bench::MedianMs( REPEAT, [ & ]() { Delete( cooked ); cooked = Load( files ); } );
+
+	std::printf( "%-16s %9s | %6s %10s %6s %9s | %10s %6s %9s\n", "asset", "PNG [KiB]", "auto", "VRAM [KiB]", "PSNR", "cook [ms]",
+				 "BC7 [KiB]", "PSNR", "cook [ms]" );
+	std::size_t pngBytes = 0, cookedBytes = 0, bc7Bytes = 0;
+	for ( std::size_t i = 0; i < files.size(); ++i )
+	{
+		const std::size_t rgbaSize = TextureBytes( png.textures[ i ] );
+		const std::size_t cookedSize = TextureBytes( cooked.textures[ i ] );
+		const std::size_t bc7Size = TextureBytes( bc7.textures[ i ] );
+		pngBytes += rgbaSize;
+		cookedBytes += cookedSize;
+		bc7Bytes += bc7Size;
+		std::printf( "%-16s %9.0f | %6s %10.0f %6.1f %9.0f | %10.0f %6.1f %9.0f\n", files[ i ].filename().string().c_str(), rgbaSize / 1024.0,
+					 FormatName( autoFormats[ i ] ), cookedSize / 1024.0, PSNR( cooked.textures[ i ], references[ i ] ), autoCookMs[ i ],
+					 bc7Size / 1024.0, PSNR( bc7.textures[ i ], references[ i ] ), bc7CookMs[ i ] );
+	}
+	std::printf( "VRAM, every level: RGBA8 %.1f MiB, auto %.1f MiB (%.1fx smaller), BC7 %.1f MiB (%.1fx smaller)\n",
+				 pngBytes / 1048576.0, cookedBytes / 1048576.0, double( pngBytes ) / cookedBytes, bc7Bytes / 1048576.0, double( pngBytes ) / bc7Bytes );
+
+	auto uploadMs = []( const LoadResult& result )
+	{
+		double ms = 0.0;
+		for ( const TextureLoader::Timing& timing : result.timings ) ms += timing.uploadMs;
+		return ms;
+	};
+	auto allCooked = []( const LoadResult& result )
+	{
+		return std::all_of( result.timings.cbegin(), result.timings.cend(), []( const TextureLoader::Timing& timing ) { return timing.cooked; } );
+	};
+	std::printf( "%-28s %12s %16s %9s\n", "load (TextureLoader)", "total [ms]", "GL upload [ms]", "speedup" );
+	std::printf( "%-28s %12.1f %16.1f %8.2fx\n", "PNG, mips built at load", pngMs, uploadMs( png ), 1.0 );
+	std::printf( "%-28s %12.1f %16.1f %8.2fx%s\n", "KTX2, auto", cookedMs, uploadMs( cooked ), pngMs / cookedMs, allCooked( cooked ) ? "" : " (NOT all cooked)" );
+	std::printf( "%-28s %12.1f %16.1f %8.2fx%s\n", "KTX2, BC7", bc7Ms, uploadMs( bc7 ), pngMs / bc7Ms, allCooked( bc7 ) ? "" : " (NOT all cooked)" );
+
+	Delete( png );
+	Delete( bc7 );
+	Delete( cooked );
+	std::error_code ec;
+	std::filesystem::remove_all( files.front().parent_path(), ec );
+}
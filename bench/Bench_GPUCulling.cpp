@@ -0,0 +1,204 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "GLUtils.hpp"
+#include "GPUCulling.h"
+#include "MeshBuffer.h"
+#include "ObjParser.h"
+#include "ShaderProgram.h"
+#include "UniformBlocks.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// GPUCulling on a pufferfish field behind a wall: part of the fish is outside of the frustum, part is hidden by the wall.
+// Frame time and culled counts without culling, with frustum culling and with frustum + Hi-Z occlusion culling.
+// The images of the three have to be the same (static camera, so the pyramid of the previous frame is exact).
+
+namespace
+{
+	constexpr int IMAGE_SIZE = 256;
+
+	MeshObject<Vertex> CreateWall()
+	{
+		MeshObject<Vertex> mesh;
+		mesh.vertexArray = {
+			{ { -0.5f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } },
+			{ {  0.5f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f } },
+			{ {  0.5f,  0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f } },
+			{ { -0.5f,  0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f } },
+		};
+		mesh.indexArray = { 0, 1, 2, 2, 3, 0 };
+		return mesh;
+	}
+}
+
+BENCHMARK( GPUCulling, "Compute shader frustum + Hi-Z occlusion culling of a pufferfish field (frame time, culled counts)" )
+{
+	constexpr int FISH_X = 40, FISH_Y = 40, FISH_Z = 8;
+	constexpr GLuint RECORD_COUNT = 1 + FISH_X * FISH_Y * FISH_Z;
+	constexpr int FRAMES = 5;
+	constexpr int REPEAT = 3;
+
+	Bench::GLContext context( IMAGE_SIZE, IMAGE_SIZE );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	MeshBuffer meshBuffer;
+	const MeshObject<Vertex> wall = CreateWall();
+	const MeshRange wallRange = meshBuffer.Add( MakeMeshView( wall ), ObjParser::computeBounds( MakeMeshView( wall ) ) );
+	const ObjParser::Mesh fish = ObjParser::parse( "Assets/PufferFish.obj" );
+	const MeshRange fishRange = meshBuffer.Add( MakeMeshView( fish ), ObjParser::computeBounds( MakeMeshView( fish ) ) );
+	meshBuffer.Upload();
+	meshBuffer.ReserveDrawIndices( RECORD_COUNT );
+
+	// record 0: the wall (command 0), the rest: the fish field (command 1)
+	std::vector<DrawData> drawData( RECORD_COUNT );
+	std::vector<CullRecord> cullRecords( RECORD_COUNT );
+	drawData[ 0 ] = { glm::translate( glm::vec3( 0, 0, -30 ) ) * glm::scale( glm::vec3( 20.0f ) ), wallRange.dequantization };
+	cullRecords[ 0 ] = { wallRange.boundingSphere, 0 };
+	const glm::vec3 fishSize = ObjParser::computeBounds( MakeMeshView( fish ) ).aabbMax - ObjParser::computeBounds( MakeMeshView( fish ) ).aabbMin;
+	const float fishScale = 4.0f / std::max( std::max( fishSize.x, fishSize.y ), fishSize.z );
+	for ( GLuint i = 1; i < RECORD_COUNT; ++i )
+	{
+		const int f = i - 1;
+		const glm::vec3 position( ( f % FISH_X ) * 8.0f - 160.0f, ( f / FISH_X % FISH_Y ) * 8.0f - 160.0f, -60.0f - ( f / ( FISH_X * FISH_Y ) ) * 16.0f );
+		drawData[ i ] = { glm::translate( position ) * glm::scale( glm::vec3( fishScale ) ), fishRange.dequantization };
+		cullRecords[ i ] = { fishRange.boundingSphere, 1 };
+	}
+
+	GLuint drawDataBuffer = 0, cullRecordBuffer = 0, commandBuffer = 0, visibleRecordBuffer = 0;
+	glCreateBuffers( 1, &drawDataBuffer );
+	glNamedBufferStorage( drawDataBuffer, RECORD_COUNT * sizeof( DrawData ), drawData.data(), 0 );
+	glCreateBuffers( 1, &cullRecordBuffer );
+	glNamedBufferStorage( cullRecordBuffer, RECORD_COUNT * sizeof( CullRecord ), cullRecords.data(), 0 );
+	glCreateBuffers( 1, &commandBuffer );
+	glNamedBufferStorage( commandBuffer, 2 * sizeof( DrawElementsIndirectCommand ), nullptr, GL_DYNAMIC_STORAGE_BIT );
+	glCreateBuffers( 1, &visibleRecordBuffer );
+	glNamedBufferStorage( visibleRecordBuffer, RECORD_COUNT * sizeof( GLuint ), nullptr, 0 );
+
+	ShaderProgram program;
+	program.Create();
+	program.AttachShader( GL_VERTEX_SHADER, "Shaders/Vert_Indirect.vert" );
+	program.AttachShader( GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" );
+	program.Link();
+	glProgramUniform1i( program.ID(), ul( program, "state" ), 1 ); // SHADER_STATE_DEFAULT
+
+	GLuint texture = 0;
+	const GLuint white = 0xFFFFFFFFu;
+	glCreateTextures( GL_TEXTURE_2D_ARRAY, 1, &texture ); // Frag_ZH.frag samples the material layer of an array
+	glTextureStorage3D( texture, 1, GL_RGBA8, 1, 1, 1 );
+	glTextureSubImage3D( texture, 0, 0, 0, 0, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &white );
+
+	const glm::mat4 viewProj = glm::perspective( glm::radians( 60.0f ), 1.0f, 0.5f, 500.0f );
+	FrameUniforms frame = {};
+	frame.viewProj = viewProj;
+	frame.lightPos = glm::vec4( 0, 1, 1, 0 );
+	frame.Ld = frame.Ls = glm::vec3( 1.0f );
+	frame.lightConstantAttenuation = 1.0f;
+	GLuint frameBuffer = 0;
+	glCreateBuffers( 1, &frameBuffer );
+	glNamedBufferStorage( frameBuffer, sizeof( FrameUniforms ), &frame, 0 );
+	glBindBufferBase( GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frameBuffer );
+
+	// the scene framebuffer of CMyApp: its depth texture feeds the pyramid
+	GLuint colorTexture = 0, depthTexture = 0, framebuffer = 0;
+	glCreateTextures( GL_TEXTURE_2D, 1, &colorTexture );
+	glTextureStorage2D( colorTexture, 1, GL_RGBA8, IMAGE_SIZE, IMAGE_SIZE );
+	glCreateTextures( GL_TEXTURE_2D, 1, &depthTexture );
+	glTextureStorage2D( depthTexture, 1, GL_DEPTH_COMPONENT32F, IMAGE_SIZE, IMAGE_SIZE );
+	glCreateFramebuffers( 1, &framebuffer );
+	glNamedFramebufferTexture( framebuffer, GL_COLOR_ATTACHMENT0, colorTexture, 0 );
+	glNamedFramebufferTexture( framebuffer, GL_DEPTH_ATTACHMENT, depthTexture, 0 );
+	glBindFramebuffer( GL_FRAMEBUFFER, framebuffer );
+	glClearColor( 0.125f, 0.25f, 0.5f, 1.0f );
+
+	GPUCulling culling;
+	culling.Init();
+
+	auto renderFrame = [ & ]( const GPUCulling::Settings& settings )
+	{
+		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+		const DrawElementsIndirectCommand commands[ 2 ] = { wallRange.Command( 0, 0 ), fishRange.Command( 0, 1 ) };
+		glNamedBufferSubData( commandBuffer, 0, sizeof( commands ), commands );
+		culling.Cull( settings, viewProj, RECORD_COUNT, drawDataBuffer, cullRecordBuffer, commandBuffer, visibleRecordBuffer );
+
+		glUseProgram( program.ID() );
+		glBindVertexArray( meshBuffer.VAO() );
+		glBindBuffer( GL_DRAW_INDIRECT_BUFFER, commandBuffer );
+		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, DRAW_DATA_STORAGE_BINDING, drawDataBuffer );
+		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, VISIBLE_RECORD_STORAGE_BINDING, visibleRecordBuffer );
+		glBindTextureUnit( 0, texture );
+		glMultiDrawElementsIndirect( GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 2, 0 );
+		glBindVertexArray( 0 );
+		glUseProgram( 0 );
+
+		if ( settings.occlusionCulling ) culling.BuildDepthPyramid( depthTexture, viewProj );
+	};
+
+	struct Variant
+	{
+		const char* name;
+		GPUCulling::Settings settings;
+	};
+	const Variant variants[] = {
+		{ "no culling", { false, false } },
+		{ "frustum", { true, false } },
+		{ "frustum + occlusion", { true, true } },
+	};
+
+	std::printf( "%u records (wall + %d fish), %d x %d\n", RECORD_COUNT, RECORD_COUNT - 1, IMAGE_SIZE, IMAGE_SIZE );
+	std::printf( "%-22s %12s %10s %10s %10s %12s\n", "culling", "frame [ms]", "visible", "frustum", "occlusion", "image diff" );
+
+	std::vector<std::uint8_t> reference;
+	for ( const Variant& variant : variants )
+	{
+		culling.Resize( IMAGE_SIZE, IMAGE_SIZE );
+		renderFrame( variant.settings ); // builds the first pyramid
+
+		const double frameMs = Bench::MedianMs( REPEAT, [ & ]()
+		{
+			for ( int f = 0; f < FRAMES; ++f ) renderFrame( variant.settings );
+			glFinish();
+		} ) / FRAMES;
+
+		std::vector<std::uint8_t> image( IMAGE_SIZE * IMAGE_SIZE * 4 );
+		glReadPixels( 0, 0, IMAGE_SIZE, IMAGE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, image.data() );
+		if ( reference.empty() ) reference = image;
+		int differentPixels = 0;
+		for ( std::size_t p = 0; p < image.size(); p += 4 )
+		{
+			int maxDiff = 0;
+			for ( int c = 0; c < 3; ++c ) maxDiff = std::max( maxDiff, std::abs( image[ p + c ] - reference[ p + c ] ) );
+			differentPixels += maxDiff > 2;
+		}
+
+		// the counters arrive asynchronously: one more frame after the GPU finished picks them up
+		glFinish();
+		renderFrame( variant.settings );
+		const GPUCulling::Stats stats = culling.LastStats();
+
+		std::printf( "%-22s %12.2f %10u %10u %10u %12d\n", variant.name, frameMs, stats.visible, stats.frustumCulled, stats.occlusionCulled, differentPixels );
+	}
+
+	glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+	culling.Clean();
+	glDeleteFramebuffers( 1, &framebuffer );
+	glDeleteTextures( 1, &colorTexture );
+	glDeleteTextures( 1, &depthTexture );
+	glDeleteTextures( 1, &texture );
+	glDeleteBuffers( 1, &frameBuffer );
+	glDeleteBuffers( 1, &drawDataBuffer );
+	glDeleteBuffers( 1, &cullRecordBuffer );
+	glDeleteBuffers( 1, &commandBuffer );
+	glDeleteBuffers( 1, &visibleRecordBuffer );
+	meshBuffer.Clean();
+}
@@ -0,0 +1,177 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "GLUtils.hpp"
+#include "ObjParser.h"
+#include "ShaderProgram.h"
+#include "UniformBlocks.h"
+#include "VertexQuantization.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// The pufferfish school of CMyApp::Render: one Draw() per fish (ObjectUniforms slot + CPU inverse per fish)
+// vs the instanced path (world matrices in an SSBO, one glDrawElementsInstanced), frame time vs fish count.
+
+namespace
+{
+	glm::mat4 PufferFishWorld( int i, int N )
+	{
+		const float angle = glm::two_pi<float>() * i / N;
+		return glm::translate( glm::vec3( 100 * std::cos( angle ), -140 + 130 * i / N, 100 * std::sin( angle ) ) );
+	}
+
+	struct ObjectSlots
+	{
+		GLuint buffer = 0;
+		GLsizeiptr stride = 0;
+		GLuint count = 64;
+		GLuint next = 0;
+
+		void Write( const OGLObject& gpu, const glm::mat4& world )
+		{
+			if ( next == count )
+			{
+				glNamedBufferData( buffer, stride * count, nullptr, GL_STREAM_DRAW );
+				next = 0;
+			}
+			ObjectUniforms object;
+			object.world = world;
+			object.worldIT = glm::transpose( glm::inverse( world ) );
+			object.dequant = gpu.dequantization;
+
+			const GLintptr offset = stride * next++;
+			glNamedBufferSubData( buffer, offset, sizeof( ObjectUniforms ), &object );
+			glBindBufferRange( GL_UNIFORM_BUFFER, OBJECT_UNIFORM_BINDING, buffer, offset, sizeof( ObjectUniforms ) );
+		}
+	};
+
+	void LinkProgram( ShaderProgram& program, const char* vertexShader )
+	{
+		program.Create();
+		program.AttachShader( GL_VERTEX_SHADER, vertexShader );
+		program.AttachShader( GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" );
+		program.Link();
+		glProgramUniform1i( program.ID(), ul( program, "state" ), 1 ); // SHADER_STATE_DEFAULT
+	}
+}
+
+BENCHMARK( InstancedFish, "Pufferfish school: one draw per fish vs one instanced draw, frame time vs instance count" )
+{
+	constexpr int REPEAT = 5;
+	const int fishCounts[] = { 5, 100, 1000, 10000, 50000 };
+
+	Bench::GLContext context( 256, 256 );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	OGLObject fish = CreateQuantizedGLObjectFromMesh( MakeMeshView( ObjParser::parse( "Assets/PufferFish.obj" ) ) );
+
+	GLuint texture = 0;
+	const GLuint white = 0xFFFFFFFFu;
+	glCreateTextures( GL_TEXTURE_2D_ARRAY, 1, &texture ); // Frag_ZH.frag samples the material layer of an array
+	glTextureStorage3D( texture, 1, GL_RGBA8, 1, 1, 1 );
+	glTextureSubImage3D( texture, 0, 0, 0, 0, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &white );
+	glBindTextureUnit( 0, texture );
+
+	ShaderProgram perDrawProgram, instancedProgram;
+	LinkProgram( perDrawProgram, "Shaders/Vert_PosNormTex.vert" );
+	LinkProgram( instancedProgram, "Shaders/Vert_Instanced.vert" );
+
+	FrameUniforms frame = {};
+	frame.viewProj = glm::perspective( glm::radians( 60.0f ), 1.0f, 0.01f, 1000.0f ) *
+					 glm::lookAt( glm::vec3( 0.0, -55.0, 250.0 ), glm::vec3( 0.0, -75.0, 0.0 ), glm::vec3( 0.0, 1.0, 0.0 ) );
+	frame.lightPos = glm::vec4( 0, 1, 0, 0 );
+	frame.Ld = frame.Ls = glm::vec3( 1.0f );
+	frame.lightConstantAttenuation = 1.0f;
+
+	GLuint frameBuffer = 0;
+	glCreateBuffers( 1, &frameBuffer );
+	glNamedBufferStorage( frameBuffer, sizeof( FrameUniforms ), &frame, 0 );
+	glBindBufferBase( GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frameBuffer );
+
+	ObjectSlots slots;
+	slots.stride = UniformSlotStride( sizeof( ObjectUniforms ) );
+	glCreateBuffers( 1, &slots.buffer );
+	glNamedBufferData( slots.buffer, slots.stride * slots.count, nullptr, GL_STREAM_DRAW );
+
+	GLuint instanceBuffer = 0;
+	glCreateBuffers( 1, &instanceBuffer );
+
+	glBindVertexArray( fish.vaoID );
+
+	std::printf( "%d indices per fish, frame = submit + glFinish\n", fish.count );
+	std::printf( "%8s | %14s %14s | %14s %14s | %8s\n", "fish", "draws CPU[ms]", "draws frame", "inst. CPU[ms]", "inst. frame", "speedup" );
+
+	for ( int fishCount : fishCounts )
+	{
+		const int frames = std::max( 3, 2000 / fishCount );
+
+		std::vector<glm::mat4> instanceWorld( fishCount );
+		for ( int i = 0; i < fishCount; ++i ) instanceWorld[ i ] = PufferFishWorld( i, fishCount );
+		glNamedBufferData( instanceBuffer, fishCount * sizeof( glm::mat4 ), instanceWorld.data(), GL_STATIC_DRAW );
+		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, INSTANCE_STORAGE_BINDING, instanceBuffer );
+
+		// returns the median frame time (GPU included), cpuMs gets the median submission time
+		auto measure = [ & ]( auto&& renderSchool, double& cpuMs )
+		{
+			std::vector<double> cpuTimes;
+			const double frameMs = Bench::MedianMs( REPEAT, [ & ]()
+			{
+				double submitMs = 0.0;
+				for ( int f = 0; f < frames; ++f )
+				{
+					glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+					const Bench::Clock::time_point start = Bench::Clock::now();
+					renderSchool();
+					submitMs += Bench::ElapsedMs( start, Bench::Clock::now() );
+					glFinish();
+				}
+				cpuTimes.push_back( submitMs / frames );
+			} ) / frames;
+			std::sort( cpuTimes.begin(), cpuTimes.end() );
+			cpuMs = cpuTimes[ cpuTimes.size() / 2 ];
+			return frameMs;
+		};
+
+		double drawsCpuMs = 0.0, instancedCpuMs = 0.0;
+		const double drawsMs = measure( [ & ]()
+		{
+			glUseProgram( perDrawProgram.ID() );
+			glNamedBufferData( slots.buffer, slots.stride * slots.count, nullptr, GL_STREAM_DRAW );
+			slots.next = 0;
+			for ( int i = 0; i < fishCount; ++i )
+			{
+				slots.Write( fish, PufferFishWorld( i, fishCount ) );
+				glDrawElements( GL_TRIANGLES, fish.count, GL_UNSIGNED_INT, nullptr );
+			}
+		}, drawsCpuMs );
+		const double instancedMs = measure( [ & ]()
+		{
+			glUseProgram( instancedProgram.ID() );
+			glNamedBufferData( slots.buffer, slots.stride * slots.count, nullptr, GL_STREAM_DRAW );
+			slots.next = 0;
+			slots.Write( fish, glm::mat4( 1.0f ) );
+			glDrawElementsInstanced( GL_TRIANGLES, fish.count, GL_UNSIGNED_INT, nullptr, fishCount );
+		}, instancedCpuMs );
+
+		std::printf( "%8d | %14.3f %14.3f | %14.3f %14.3f | %7.2fx\n",
+					 fishCount, drawsCpuMs, drawsMs, instancedCpuMs, instancedMs, drawsMs / instancedMs );
+	}
+
+	glBindVertexArray( 0 );
+	glUseProgram( 0 );
+	glDeleteBuffers( 1, &instanceBuffer );
+	glDeleteBuffers( 1, &slots.buffer );
+	glDeleteBuffers( 1, &frameBuffer );
+	glDeleteTextures( 1, &texture );
+	CleanOGLObject( fish );
+}
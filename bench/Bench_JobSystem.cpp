@@ -0,0 +1,107 @@
+#include "Bench.h"
+
+#include "JobSystem.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstdio>
+
+// Scheduler overhead, with empty work so nothing but the scheduling is measured:
+// - throughput: empty jobs per second, created in batches as the children of a root and waited for, and the same
+//   count of empty indices through JobSystem::ParallelFor (grain size 1 and 64) and ThreadPool::ParallelFor;
+// - fan-out / fan-in latency: one empty job per thread started and waited for, the shortest possible parallel
+//   section (JobSystem vs ThreadPool::ParallelFor of threadCount indices).
+// Every run checks that all the calls happened.
+
+namespace
+{
+	constexpr std::size_t TASK_COUNT = 1 << 18;
+	constexpr std::size_t BATCH_SIZE = 1024; // the root and its children fit into the job ring of the thread
+	constexpr int REPEAT = 5;
+	constexpr int FAN_OUT_REPEAT = 2000;
+
+	void PrintThroughput( const char* name, double ms, bool complete )
+	{
+		std::printf( "%-36s %10.2f %12.1f %10.1f %9s\n", name, ms, TASK_COUNT / ( ms * 1000.0 ), ms * 1.0e6 / TASK_COUNT, complete ? "yes" : "NO" );
+	}
+}
+
+BENCHMARK( JobSystem, "Work-stealing JobSystem: empty job throughput and fan-out/fan-in latency, vs the ThreadPool" )
+{
+	const unsigned int threadCount = ThreadPool::HardwareThreadCount();
+	std::printf( "%u threads, %zu empty tasks\n", threadCount, TASK_COUNT );
+
+	JobSystem jobs( threadCount );
+	ThreadPool pool( threadCount );
+	std::atomic<std::size_t> calls = 0;
+
+	std::printf( "%-36s %10s %12s %10s %9s\n", "throughput", "time [ms]", "Mtasks/s", "ns/task", "complete" );
+
+	bool complete = true;
+	double ms = Bench::MedianMs( REPEAT, [ & ]()
+	{
+		calls = 0;
+		for ( std::size_t first = 0; first < TASK_COUNT; first += BATCH_SIZE )
+		{
+			JobSystem::Job* root = jobs.CreateJob( []() {} );
+			for ( std::size_t i = 0; i < BATCH_SIZE; ++i )
+			{
+				jobs.Run( jobs.CreateChildJob( root, [ &calls ]() { calls.fetch_add( 1, std::memory_order_relaxed ); } ) );
+			}
+			jobs.Run( root );
+			jobs.Wait( root );
+		}
+		complete = complete && calls == TASK_COUNT;
+	} );
+	PrintThroughput( "JobSystem children of a root", ms, complete );
+
+	for ( std::size_t grainSize : { std::size_t( 1 ), std::size_t( 64 ) } )
+	{
+		complete = true;
+		ms = Bench::MedianMs( REPEAT, [ & ]()
+		{
+			calls = 0;
+			jobs.ParallelFor( TASK_COUNT, grainSize, [ &calls ]( std::size_t ) { calls.fetch_add( 1, std::memory_order_relaxed ); } );
+			complete = complete && calls == TASK_COUNT;
+		} );
+		char name[ 64 ];
+		std::snprintf( name, sizeof( name ), "JobSystem::ParallelFor, grain %zu", grainSize );
+		PrintThroughput( name, ms, complete );
+	}
+
+	complete = true;
+	ms = Bench::MedianMs( REPEAT, [ & ]()
+	{
+		calls = 0;
+		pool.ParallelFor( TASK_COUNT, [ &calls ]( std::size_t ) { calls.fetch_add( 1, std::memory_order_relaxed ); } );
+		complete = complete && calls == TASK_COUNT;
+	} );
+	PrintThroughput( "ThreadPool::ParallelFor", ms, complete );
+
+	// fan-out / fan-in: the median of many short parallel sections
+	std::printf( "%-36s %10s %10s\n", "fan-out / fan-in latency", "median [us]", "complete" );
+
+	complete = true;
+	ms = Bench::MedianMs( FAN_OUT_REPEAT, [ & ]()
+	{
+		calls = 0;
+		JobSystem::Job* root = jobs.CreateJob( []() {} );
+		for ( unsigned int i = 0; i < threadCount; ++i )
+		{
+			jobs.Run( jobs.CreateChildJob( root, [ &calls ]() { calls.fetch_add( 1, std::memory_order_relaxed ); } ) );
+		}
+		jobs.Run( root );
+		jobs.Wait( root );
+		complete = complete && calls == threadCount;
+	} );
+	std::printf( "%-36s %10.2f %10s\n", "JobSystem", ms * 1000.0, complete ? "yes" : "NO" );
+
+	complete = true;
+	ms = Bench::MedianMs( FAN_OUT_REPEAT, [ & ]()
+	{
+		calls = 0;
+		pool.ParallelFor( threadCount, [ &calls ]( std::size_t ) { calls.fetch_add( 1, std::memory_order_relaxed ); } );
+		complete = complete && calls == threadCount;
+	} );
+	std::printf( "%-36s %10.2f %10s\n", "ThreadPool::ParallelFor", ms * 1000.0, complete ? "yes" : "NO" );
+}
@@ -0,0 +1,72 @@
+#include "Bench.h"
+
+#include "ObjParser.h"
+
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+	const char* const s_assets[] = { "Assets/Arm.obj", "Assets/sub.obj", "Assets/Claw.obj", "Assets/PufferFish.obj" };
+
+	// Reads every byte of the mesh, like the GL upload would.
+	// Without this the mapped cache would only be measured up to the first page fault.
+	std::uint64_t TouchMesh( const MeshView<Vertex>& view )
+	{
+		std::uint64_t sum = 0;
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>( view.vertexData );
+		for ( std::size_t i = 0; i < view.vertexCount * sizeof( Vertex ); i += 64 ) sum += bytes[ i ];
+		for ( std::size_t i = 0; i < view.indexCount; i += 16 ) sum += view.indexData[ i ];
+		return sum;
+	}
+}
+
+BENCHMARK( MeshCache, "Startup cost per asset: text .obj parse vs binary mesh cache load" )
+{
+	constexpr int REPEAT = 7;
+
+	std::printf( "%-24s %10s %10s %12s %12s %12s %9s\n",
+				 "asset", "vertices", "indices", "parse [ms]", "cold [ms]", "cached [ms]", "speedup" );
+
+	for ( const char* asset : s_assets )
+	{
+		double parseMs = Bench::MedianMs( REPEAT, [ asset ]()
+		{
+			ObjParser::Mesh mesh = ObjParser::parse( asset );
+			Bench::DoNotOptimize( TouchMesh( MakeMeshView( mesh ) ) );
+		} );
+
+		// first start: parse + writing the cache
+		std::error_code ec;
+		std::filesystem::remove( ObjParser::cachePath( asset ), ec );
+		Bench::Clock::time_point coldStart = Bench::Clock::now();
+		MeshView<Vertex> coldView;
+		{
+			ObjParser::CachedMesh mesh = ObjParser::parseCached( asset );
+			coldView = mesh.View();
+			Bench::DoNotOptimize( TouchMesh( mesh.View() ) );
+		}
+		double coldMs = Bench::ElapsedMs( coldStart, Bench::Clock::now() );
+
+		// later starts: hashing the source, mapping and validating the cache
+		bool mapped = true;
+		{
+			ObjParser::Mesh parsed = ObjParser::parse( asset );
+			ObjParser::CachedMesh cached = ObjParser::parseCached( asset );
+			MeshView<Vertex> view = cached.View();
+			mapped = view.vertexCount == parsed.vertexArray.size() && view.indexCount == parsed.indexArray.size()
+				&& std::memcmp( view.vertexData, parsed.vertexArray.data(), view.vertexCount * sizeof( Vertex ) ) == 0
+				&& std::memcmp( view.indexData, parsed.indexArray.data(), view.indexCount * sizeof( GLuint ) ) == 0;
+		}
+		double cachedMs = Bench::MedianMs( REPEAT, [ asset, &mapped ]()
+		{
+			ObjParser::CachedMesh mesh = ObjParser::parseCached( asset );
+			mapped = mapped && mesh.IsMapped();
+			Bench::DoNotOptimize( TouchMesh( mesh.View() ) );
+		} );
+
+		std::printf( "%-24s %10zu %10zu %12.3f %12.3f %12.3f %8.1fx%s\n",
+					 asset, coldView.vertexCount, coldView.indexCount,
+					 parseMs, coldMs, cachedMs, parseMs / cachedMs, mapped ? "" : " (cache not used or differs from parse!)" );
+	}
+}
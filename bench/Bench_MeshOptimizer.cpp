@@ -0,0 +1,86 @@
+#include "Bench.h"
+
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Every shipped .obj asset, in name order.
+	std::vector<std::filesystem::path> ObjAssets()
+	{
+		std::vector<std::filesystem::path> assets;
+		for ( const auto& entry : std::filesystem::directory_iterator( "Assets" ) )
+		{
+			if ( entry.path().extension() == ".obj" ) assets.push_back( entry.path() );
+		}
+		std::sort( assets.begin(), assets.end() );
+		return assets;
+	}
+
+	MeshOptimizer::VertexCacheStats Analyze( const ObjParser::Mesh& mesh )
+	{
+		return MeshOptimizer::AnalyzeVertexCache( mesh.indexArray.data(), mesh.indexArray.size(), mesh.vertexArray.size() );
+	}
+
+	// The triangles as vertex data, each rotated to start with its smallest vertex (the winding is kept), sorted.
+	// Equal for two meshes, if they render the same triangles.
+	std::vector<std::string> TriangleSet( const ObjParser::Mesh& mesh )
+	{
+		std::vector<std::string> triangles;
+		triangles.reserve( mesh.indexArray.size() / 3 );
+		for ( std::size_t i = 0; i + 2 < mesh.indexArray.size(); i += 3 )
+		{
+			std::string corners[ 3 ];
+			for ( int k = 0; k < 3; ++k )
+			{
+				corners[ k ].assign( reinterpret_cast<const char*>( &mesh.vertexArray[ mesh.indexArray[ i + k ] ] ), sizeof( Vertex ) );
+			}
+			const int first = static_cast<int>( std::min_element( corners, corners + 3 ) - corners );
+			triangles.push_back( corners[ first ] + corners[ ( first + 1 ) % 3 ] + corners[ ( first + 2 ) % 3 ] );
+		}
+		std::sort( triangles.begin(), triangles.end() );
+		return triangles;
+	}
+}
+
+BENCHMARK( MeshOptimizer, "ACMR/ATVR of every asset before and after the vertex cache, overdraw and vertex fetch passes" )
+{
+	std::printf( "FIFO cache size: %u\n", MeshOptimizer::ANALYZE_CACHE_SIZE );
+	std::printf( "%-18s %10s %-14s %8s %8s %10s %10s\n", "asset", "triangles", "stage", "ACMR", "ATVR", "time [ms]", "identical" );
+
+	for ( const std::filesystem::path& asset : ObjAssets() )
+	{
+		const ObjParser::Mesh original = ObjParser::parse( asset );
+		const std::vector<std::string> originalTriangles = TriangleSet( original );
+		const std::string name = asset.filename().string();
+		const std::size_t triangleCount = original.indexArray.size() / 3;
+
+		auto report = [ & ]( const char* stage, const ObjParser::Mesh& mesh, double ms )
+		{
+			const MeshOptimizer::VertexCacheStats stats = Analyze( mesh );
+			std::printf( "%-18s %10zu %-14s %8.3f %8.3f %10.2f %10s\n", name.c_str(), triangleCount, stage, stats.acmr, stats.atvr, ms,
+						 TriangleSet( mesh ) == originalTriangles ? "yes" : "NO" );
+		};
+
+		report( "file order", original, 0.0 );
+
+		ObjParser::Mesh mesh = original;
+		Bench::Clock::time_point start = Bench::Clock::now();
+		MeshOptimizer::OptimizeVertexCache( mesh.indexArray, mesh.vertexArray.size() );
+		report( "vertex cache", mesh, Bench::ElapsedMs( start, Bench::Clock::now() ) );
+
+		start = Bench::Clock::now();
+		MeshOptimizer::OptimizeOverdraw( mesh.indexArray, mesh.vertexArray );
+		report( "+ overdraw", mesh, Bench::ElapsedMs( start, Bench::Clock::now() ) );
+
+		start = Bench::Clock::now();
+		MeshOptimizer::OptimizeVertexFetch( mesh.vertexArray, mesh.indexArray );
+		report( "+ fetch", mesh, Bench::ElapsedMs( start, Bench::Clock::now() ) );
+	}
+}
@@ -0,0 +1,243 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "GLUtils.hpp"
+#include "MeshBuffer.h"
+#include "ObjParser.h"
+#include "ShaderProgram.h"
+#include "UniformBlocks.h"
+#include "VertexQuantization.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+// One Draw() per object (own VAO, ObjectUniforms slot, glDrawElements) vs the GPU-driven path of CMyApp::RenderIndirect
+// (shared MeshBuffer, DrawData records, one glMultiDrawElementsIndirect), CPU submission cost vs object count.
+// The first run renders the same objects both ways and compares the images.
+
+namespace
+{
+	constexpr int IMAGE_SIZE = 128;
+
+	struct SceneObject
+	{
+		int mesh;
+		glm::mat4 world;
+	};
+
+	// n objects on a grid in front of the camera, cycling through the meshes
+	std::vector<SceneObject> MakeObjects( int n, int meshCount )
+	{
+		std::vector<SceneObject> objects( n );
+		const int side = static_cast<int>( std::ceil( std::sqrt( static_cast<double>( n ) ) ) );
+		const float spacing = 20.0f / side;
+		for ( int i = 0; i < n; ++i )
+		{
+			const float x = ( i % side + 0.5f ) * spacing - 10.0f;
+			const float y = ( i / side + 0.5f ) * spacing - 10.0f;
+			objects[ i ] = { i % meshCount, glm::translate( glm::vec3( x, y, -25.0f ) ) * glm::scale( glm::vec3( 0.8f * spacing ) ) * glm::rotate( 0.3f * i, glm::vec3( 0, 1, 0 ) ) };
+		}
+		return objects;
+	}
+
+	std::vector<std::uint8_t> ReadImage()
+	{
+		std::vector<std::uint8_t> pixels( IMAGE_SIZE * IMAGE_SIZE * 4 );
+		glReadPixels( 0, 0, IMAGE_SIZE, IMAGE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data() );
+		return pixels;
+	}
+}
+
+BENCHMARK( MultiDrawIndirect, "Scene submission: one draw per object vs glMultiDrawElementsIndirect over a shared mesh buffer" )
+{
+	constexpr int REPEAT = 5;
+	const int objectCounts[] = { 11, 100, 1000, 10000 };
+
+	Bench::GLContext context( IMAGE_SIZE, IMAGE_SIZE );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	// meshes of the scene, centered and scaled into the unit cube so they fit a grid cell
+	const char* const assets[] = { "Assets/PufferFish.obj", "Assets/Arm.obj", "Assets/Claw.obj" };
+	std::vector<OGLObject> objectsGPU;
+	std::vector<MeshRange> ranges;
+	MeshBuffer meshBuffer;
+	for ( const char* asset : assets )
+	{
+		ObjParser::Mesh mesh = ObjParser::parse( asset );
+		glm::vec3 aabbMin( FLT_MAX ), aabbMax( -FLT_MAX );
+		for ( const Vertex& v : mesh.vertexArray ) { aabbMin = glm::min( aabbMin, v.position ); aabbMax = glm::max( aabbMax, v.position ); }
+		const glm::vec3 center = ( aabbMin + aabbMax ) * 0.5f;
+		const float extent = glm::max( glm::max( aabbMax.x - aabbMin.x, aabbMax.y - aabbMin.y ), aabbMax.z - aabbMin.z );
+		for ( Vertex& v : mesh.vertexArray ) v.position = ( v.position - center ) / extent;
+
+		objectsGPU.push_back( CreateQuantizedGLObjectFromMesh( MakeMeshView( mesh ) ) );
+		ranges.push_back( meshBuffer.Add( MakeMeshView( mesh ), ObjParser::computeBounds( MakeMeshView( mesh ) ) ) );
+	}
+	meshBuffer.Upload();
+	const int meshCount = static_cast<int>( ranges.size() );
+
+	GLuint texture = 0;
+	const GLuint white = 0xFFFFFFFFu;
+	glCreateTextures( GL_TEXTURE_2D_ARRAY, 1, &texture ); // Frag_ZH.frag samples the material layer of an array
+	glTextureStorage3D( texture, 1, GL_RGBA8, 1, 1, 1 );
+	glTextureSubImage3D( texture, 0, 0, 0, 0, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &white );
+	glBindTextureUnit( 0, texture );
+
+	ShaderProgram perDrawProgram, indirectProgram;
+	for ( auto [ program, vertexShader ] : { std::make_pair( &perDrawProgram, "Shaders/Vert_PosNormTex.vert" ), std::make_pair( &indirectProgram, "Shaders/Vert_Indirect.vert" ) } )
+	{
+		program->Create();
+		program->AttachShader( GL_VERTEX_SHADER, vertexShader );
+		program->AttachShader( GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" );
+		program->Link();
+		glProgramUniform1i( program->ID(), ul( *program, "state" ), 1 ); // SHADER_STATE_DEFAULT
+	}
+
+	FrameUniforms frame = {};
+	frame.viewProj = glm::perspective( glm::radians( 60.0f ), 1.0f, 0.1f, 100.0f );
+	frame.lightPos = glm::vec4( 0, 1, 1, 0 );
+	frame.Ld = frame.Ls = glm::vec3( 1.0f );
+	frame.lightConstantAttenuation = 1.0f;
+	GLuint frameBuffer = 0;
+	glCreateBuffers( 1, &frameBuffer );
+	glNamedBufferStorage( frameBuffer, sizeof( FrameUniforms ), &frame, 0 );
+	glBindBufferBase( GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frameBuffer );
+
+	const GLsizeiptr slotStride = UniformSlotStride( sizeof( ObjectUniforms ) );
+	constexpr GLuint SLOT_COUNT = 64;
+	GLuint objectBuffer = 0, drawDataBuffer = 0, commandBuffer = 0, visibleRecordBuffer = 0;
+	glCreateBuffers( 1, &objectBuffer );
+	glCreateBuffers( 1, &drawDataBuffer );
+	glCreateBuffers( 1, &visibleRecordBuffer );
+	glCreateBuffers( 1, &commandBuffer );
+
+	std::printf( "%8s | %12s %12s | %12s %12s | %8s | %s\n", "objects", "draws calls", "CPU [ms]", "MDI calls", "CPU [ms]", "speedup", "image diff" );
+
+	for ( int objectCount : objectCounts )
+	{
+		const std::vector<SceneObject> objects = MakeObjects( objectCount, meshCount );
+		const int frames = std::max( 3, 3000 / objectCount );
+		std::vector<DrawData> drawData( objectCount );
+		std::vector<DrawElementsIndirectCommand> commands( objectCount );
+
+		glNamedBufferData( drawDataBuffer, objectCount * sizeof( DrawData ), nullptr, GL_DYNAMIC_DRAW );
+		glNamedBufferData( commandBuffer, objectCount * sizeof( DrawElementsIndirectCommand ), nullptr, GL_DYNAMIC_DRAW );
+		meshBuffer.ReserveDrawIndices( objectCount );
+
+		// no culling here: every record is visible, in order
+		std::vector<GLuint> visibleRecords( objectCount );
+		std::iota( visibleRecords.begin(), visibleRecords.end(), 0u );
+		glNamedBufferData( visibleRecordBuffer, objectCount * sizeof( GLuint ), visibleRecords.data(), GL_STATIC_DRAW );
+
+		std::size_t perDrawCalls = 0, indirectCalls = 0;
+		auto renderPerDraw = [ & ]()
+		{
+			glUseProgram( perDrawProgram.ID() );
+			glNamedBufferData( objectBuffer, slotStride * SLOT_COUNT, nullptr, GL_STREAM_DRAW );
+			perDrawCalls = 2;
+			GLuint slot = 0;
+			for ( const SceneObject& object : objects )
+			{
+				if ( slot == SLOT_COUNT )
+				{
+					glNamedBufferData( objectBuffer, slotStride * SLOT_COUNT, nullptr, GL_STREAM_DRAW );
+					slot = 0;
+					++perDrawCalls;
+				}
+				const OGLObject& gpu = objectsGPU[ object.mesh ];
+				const ObjectUniforms uniforms = { object.world, glm::transpose( glm::inverse( object.world ) ), gpu.dequantization };
+				const GLintptr offset = slotStride * slot++;
+				glNamedBufferSubData( objectBuffer, offset, sizeof( ObjectUniforms ), &uniforms );
+				glBindBufferRange( GL_UNIFORM_BUFFER, OBJECT_UNIFORM_BINDING, objectBuffer, offset, sizeof( ObjectUniforms ) );
+				glBindVertexArray( gpu.vaoID );
+				glDrawElements( GL_TRIANGLES, gpu.count, GL_UNSIGNED_INT, nullptr );
+				perDrawCalls += 4;
+			}
+			glBindVertexArray( 0 );
+		};
+		auto renderIndirect = [ & ]()
+		{
+			for ( int i = 0; i < objectCount; ++i )
+			{
+				const MeshRange& range = ranges[ objects[ i ].mesh ];
+				drawData[ i ] = { objects[ i ].world, range.dequantization };
+				commands[ i ] = range.Command( 1, i );
+			}
+			glNamedBufferSubData( drawDataBuffer, 0, objectCount * sizeof( DrawData ), drawData.data() );
+			glNamedBufferSubData( commandBuffer, 0, objectCount * sizeof( DrawElementsIndirectCommand ), commands.data() );
+			glUseProgram( indirectProgram.ID() );
+			glBindVertexArray( meshBuffer.VAO() );
+			glBindBuffer( GL_DRAW_INDIRECT_BUFFER, commandBuffer );
+			glBindBufferBase( GL_SHADER_STORAGE_BUFFER, DRAW_DATA_STORAGE_BINDING, drawDataBuffer );
+			glBindBufferBase( GL_SHADER_STORAGE_BUFFER, VISIBLE_RECORD_STORAGE_BINDING, visibleRecordBuffer );
+			glMultiDrawElementsIndirect( GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, objectCount, 0 );
+			glBindVertexArray( 0 );
+			indirectCalls = 8;
+		};
+
+		// both paths have to produce the same image
+		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+		renderPerDraw();
+		const std::vector<std::uint8_t> perDrawImage = ReadImage();
+		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+		renderIndirect();
+		const std::vector<std::uint8_t> indirectImage = ReadImage();
+		int differentPixels = 0, coveredPixels = 0;
+		for ( std::size_t p = 0; p < perDrawImage.size(); p += 4 )
+		{
+			int maxDiff = 0;
+			for ( int c = 0; c < 3; ++c ) maxDiff = std::max( maxDiff, std::abs( perDrawImage[ p + c ] - indirectImage[ p + c ] ) );
+			differentPixels += maxDiff > 2;
+			coveredPixels += perDrawImage[ p ] != 0 || perDrawImage[ p + 1 ] != 0 || perDrawImage[ p + 2 ] != 0;
+		}
+
+		// CPU time of issuing the frame, the GPU is waited for outside of the timed part
+		auto cpuMs = [ & ]( auto&& render )
+		{
+			std::vector<double> times;
+			for ( int r = 0; r < REPEAT; ++r )
+			{
+				double ms = 0.0;
+				for ( int f = 0; f < frames; ++f )
+				{
+					glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+					const Bench::Clock::time_point start = Bench::Clock::now();
+					render();
+					ms += Bench::ElapsedMs( start, Bench::Clock::now() );
+					glFinish();
+				}
+				times.push_back( ms / frames );
+			}
+			std::sort( times.begin(), times.end() );
+			return times[ times.size() / 2 ];
+		};
+
+		const double perDrawMs = cpuMs( renderPerDraw );
+		const double indirectMs = cpuMs( renderIndirect );
+
+		std::printf( "%8d | %12zu %12.3f | %12zu %12.3f | %7.2fx | %d of %d covered pixels\n",
+					 objectCount, perDrawCalls, perDrawMs, indirectCalls, indirectMs, perDrawMs / indirectMs, differentPixels, coveredPixels );
+	}
+
+	glBindBuffer( GL_DRAW_INDIRECT_BUFFER, 0 );
+	glUseProgram( 0 );
+	glDeleteBuffers( 1, &objectBuffer );
+	glDeleteBuffers( 1, &drawDataBuffer );
+	glDeleteBuffers( 1, &visibleRecordBuffer );
+	glDeleteBuffers( 1, &commandBuffer );
+	glDeleteBuffers( 1, &frameBuffer );
+	glDeleteTextures( 1, &texture );
+	meshBuffer.Clean();
+	for ( OGLObject& gpu : objectsGPU ) CleanOGLObject( gpu );
+}
@@ -0,0 +1,39 @@
+#include "Bench.h"
+
+#include "BenchObj.h"
+#include "ThreadPool.h"
+
+BENCHMARK( ObjParseScaling, "ObjParser::parse wall time for 1..N threads on synthetic large .obj files" )
+{
+	constexpr int REPEAT = 3;
+	const unsigned int maxThreads = std::max( ThreadPool::HardwareThreadCount(), 4u );
+
+	struct Input { unsigned int gridSize; bool withNormals; };
+	const Input inputs[] = { { 700, true }, { 700, false } };
+
+	for ( const Input& input : inputs )
+	{
+		std::filesystem::path fileName = Bench::WriteSyntheticObj( input.gridSize, input.withNormals );
+		const double fileMB = std::filesystem::file_size( fileName ) / ( 1024.0 * 1024.0 );
+
+		std::printf( "%s (%.1f MB, %s)\n", fileName.filename().string().c_str(), fileMB,
+					 input.withNormals ? "v/vt/vn quads" : "v/vt triangles, computed normals" );
+		std::printf( "%8s %12s %10s %9s %10s\n", "threads", "time [ms]", "MB/s", "speedup", "identical" );
+
+		ObjParser::Mesh serial = ObjParser::parse( fileName, 1 );
+
+		double serialMs = 0.0;
+		for ( unsigned int threads = 1; threads <= maxThreads; threads *= 2 )
+		{
+			bool identical = true;
+			double ms = Bench::MedianMs( REPEAT, [ & ]()
+			{
+				ObjParser::Mesh mesh = ObjParser::parse( fileName, threads );
+				identical = identical && Bench::SameMesh( mesh, serial );
+			} );
+			if ( threads == 1 ) serialMs = ms;
+
+			std::printf( "%8u %12.1f %10.1f %8.2fx %10s\n", threads, ms, fileMB / ( ms / 1000.0 ), serialMs / ms, identical ? "yes" : "NO" );
+		}
+	}
+}
@@ -0,0 +1,197 @@
+#include "Bench.h"
+
+#include "BenchObj.h"
+#include "ObjTokenizer.h"
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using ScanImpl = InMemoryTokenizer::ScanImpl;
+
+	constexpr ScanImpl s_scanImpls[] = { ScanImpl::SCALAR, ScanImpl::SSE2, ScanImpl::AVX2 };
+
+	std::vector<char> ReadFile( const std::filesystem::path& fileName )
+	{
+		std::ifstream file( fileName, std::ios::binary );
+		return std::vector<char>( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+	}
+
+	// Walks the file the way ObjParser does: first token of the line, then the rest on the same line.
+	// Returns a checksum of the token lengths and positions to compare the implementations.
+	uint64_t TokenizeAll( const std::vector<char>& data )
+	{
+		InMemoryTokenizer tokenizer;
+		tokenizer.SetData( data.data(), data.size() );
+
+		uint64_t checksum = 0;
+		while ( tokenizer )
+		{
+			std::string_view token = tokenizer.NextToken();
+			while ( !token.empty() )
+			{
+				checksum = checksum * 31 + static_cast<uint64_t>( token.data() - data.data() ) * 7 + token.size();
+				token = tokenizer.NextToken( true );
+			}
+			tokenizer.ToNextLine();
+		}
+		return checksum;
+	}
+
+	bool SameFloat( float a, float b )
+	{
+		return std::memcmp( &a, &b, sizeof( float ) ) == 0;
+	}
+
+	// Compares ParseObjFloat with std::from_chars on every number of the file and on random decimal strings.
+	// Returns the number of mismatches.
+	size_t CheckFloats( const std::vector<char>& data, size_t& checkedCount )
+	{
+		size_t mismatchCount = 0;
+		auto check = [ & ]( std::string_view token )
+		{
+			float expected = 0.0f, actual = 0.0f;
+			std::from_chars( token.data(), token.data() + token.size(), expected );
+			ParseObjFloat( token, actual );
+			if ( !SameFloat( expected, actual ) )
+			{
+				if ( mismatchCount < 10 ) std::printf( "  float mismatch: '%.*s' %.9g != %.9g\n", int( token.size() ), token.data(), actual, expected );
+				++mismatchCount;
+			}
+			++checkedCount;
+		};
+
+		InMemoryTokenizer tokenizer;
+		tokenizer.SetData( data.data(), data.size() );
+		while ( tokenizer )
+		{
+			std::string_view type = tokenizer.NextToken();
+			if ( type == "v" || type == "vt" || type == "vn" )
+			{
+				for ( std::string_view token = tokenizer.NextToken( true ); !token.empty(); token = tokenizer.NextToken( true ) ) check( token );
+			}
+			tokenizer.ToNextLine();
+		}
+
+		std::mt19937_64 random( 42 );
+		char buffer[ 32 ];
+		for ( int i = 0; i < 2000000; ++i )
+		{
+			const uint64_t bits = random();
+			const int digitCount = 1 + int( bits % 17 );
+			const int pointPos = int( ( bits >> 8 ) % ( digitCount + 1 ) );
+			int length = 0;
+			if ( bits & ( 1ull << 20 ) ) buffer[ length++ ] = '-';
+			for ( int d = 0; d < digitCount; ++d )
+			{
+				if ( d == pointPos ) buffer[ length++ ] = '.';
+				buffer[ length++ ] = char( '0' + random() % 10 );
+			}
+			check( std::string_view( buffer, length ) );
+		}
+
+		return mismatchCount;
+	}
+}
+
+BENCHMARK( ObjTokenizer, "InMemoryTokenizer throughput per scan implementation and float parsing correctness" )
+{
+	constexpr int REPEAT = 5;
+
+	const ScanImpl bestImpl = InMemoryTokenizer::BestScanImpl();
+	std::printf( "best scan implementation on this CPU: %s\n", InMemoryTokenizer::ScanImplName( bestImpl ) );
+
+	const std::filesystem::path fileNames[] =
+	{
+		"Assets/Arm.obj", "Assets/Claw.obj", "Assets/PufferFish.obj", "Assets/sub.obj",
+		Bench::WriteSyntheticObj( 700, true ),
+	};
+
+	std::printf( "%-24s %9s %10s %12s %10s %12s %10s\n", "file", "MB", "scan", "tokenize MB/s", "identical", "parse MB/s", "identical" );
+	for ( const std::filesystem::path& fileName : fileNames )
+	{
+		if ( !std::filesystem::exists( fileName ) )
+		{
+			std::printf( "%-24s missing\n", fileName.filename().string().c_str() );
+			continue;
+		}
+
+		const std::vector<char> data = ReadFile( fileName );
+		const double fileMB = data.size() / ( 1024.0 * 1024.0 );
+
+		InMemoryTokenizer::SetScanImpl( ScanImpl::SCALAR );
+		const uint64_t scalarChecksum = TokenizeAll( data );
+		const ObjParser::Mesh scalarMesh = ObjParser::parse( fileName );
+
+		for ( ScanImpl impl : s_scanImpls )
+		{
+			if ( !InMemoryTokenizer::SetScanImpl( impl ) ) continue;
+
+			uint64_t checksum = 0;
+			const double tokenizeMs = Bench::MedianMs( REPEAT, [ & ]() { checksum = TokenizeAll( data ); } );
+
+			bool sameMesh = true;
+			const double parseMs = Bench::MedianMs( REPEAT, [ & ]()
+			{
+				ObjParser::Mesh mesh = ObjParser::parse( fileName );
+				sameMesh = sameMesh && Bench::SameMesh( mesh, scalarMesh );
+			} );
+
+			std::printf( "%-24s %9.2f %10s %12.1f %10s %12.1f %10s\n", fileName.filename().string().c_str(), fileMB,
+						 InMemoryTokenizer::ScanImplName( impl ), fileMB / ( tokenizeMs / 1000.0 ), checksum == scalarChecksum ? "yes" : "NO",
+						 fileMB / ( parseMs / 1000.0 ), sameMesh ? "yes" : "NO" );
+		}
+	}
+	InMemoryTokenizer::SetScanImpl( bestImpl );
+
+	// float parsing: the fast path has to give the same bits as std::from_chars
+	const std::vector<char> data = ReadFile( Bench::WriteSyntheticObj( 700, true ) );
+	size_t checkedCount = 0;
+	const size_t mismatchCount = CheckFloats( data, checkedCount );
+	std::printf( "ParseObjFloat vs std::from_chars: %zu numbers checked, %zu mismatches\n", checkedCount, mismatchCount );
+
+	std::vector<std::string_view> numbers;
+	{
+		InMemoryTokenizer tokenizer;
+		tokenizer.SetData( data.data(), data.size() );
+		while ( tokenizer )
+		{
+			std::string_view type = tokenizer.NextToken();
+			if ( type == "v" || type == "vt" || type == "vn" )
+			{
+				for ( std::string_view token = tokenizer.NextToken( true ); !token.empty(); token = tokenizer.NextToken( true ) ) numbers.push_back( token );
+			}
+			tokenizer.ToNextLine();
+		}
+	}
+
+	float sum = 0.0f;
+	const double fromCharsMs = Bench::MedianMs( REPEAT, [ & ]()
+	{
+		for ( std::string_view token : numbers )
+		{
+			float value = 0.0f;
+			std::from_chars( token.data(), token.data() + token.size(), value );
+			sum += value;
+		}
+	} );
+	const double fastMs = Bench::MedianMs( REPEAT, [ & ]()
+	{
+		for ( std::string_view token : numbers )
+		{
+			float value = 0.0f;
+			ParseObjFloat( token, value );
+			sum += value;
+		}
+	} );
+	Bench::DoNotOptimize( sum );
+
+	std::printf( "%zu floats: std::from_chars %.1f ms (%.1f M/s), ParseObjFloat %.1f ms (%.1f M/s), %.2fx\n", numbers.size(),
+				 fromCharsMs, numbers.size() / ( fromCharsMs * 1000.0 ), fastMs, numbers.size() / ( fastMs * 1000.0 ), fromCharsMs / fastMs );
+}
@@ -0,0 +1,160 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "GLUtils.hpp"
+#include "ShaderVariants.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The shader startup of CMyApp::InitShaders (3 families x 6 Frag_ZH.frag variants + a fallback each) without the
+// binary cache: status queried after every compile and link (the old synchronous path), every program issued before
+// waiting for any (CompileAll) with and without driver threads (glMaxShaderCompilerThreadsKHR), and the deferred
+// startup: how long until the first frame can draw (every material has its variant or the fallback) and until
+// every variant is finished. Each run adds a define of a new name, so the driver's own shader cache never hits.
+
+namespace
+{
+	using FamilyList = std::vector<std::unique_ptr<ShaderVariants>>;
+
+	int g_salt = 0;
+
+	FamilyList InitFamilies()
+	{
+		// unique across processes too: the driver's cache is on disk
+		static const long long runID = static_cast<long long>( std::chrono::system_clock::now().time_since_epoch().count() );
+		const std::string salt = "BENCH_SALT_" + std::to_string( runID ) + "_" + std::to_string( ++g_salt );
+		const std::vector<ShaderVariants::Option> materialOptions = { { "STATE", 3 }, { "RED_LIGHT", 2 }, { salt, 1 } };
+		const char* vertexShaders[] = { "Shaders/Vert_PosNormTex.vert", "Shaders/Vert_Instanced.vert", "Shaders/Vert_Indirect.vert" };
+
+		FamilyList families;
+		for ( const char* vertexShader : vertexShaders )
+		{
+			families.push_back( std::make_unique<ShaderVariants>() );
+			families.back()->Init( { { GL_VERTEX_SHADER, vertexShader }, { GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" } }, materialOptions );
+		}
+		return families;
+	}
+
+	bool AllLinked( FamilyList& families )
+	{
+		for ( auto& family : families )
+		{
+			for ( ShaderVariants::Key key = 0; key < family->VariantCount(); ++key )
+			{
+				if ( !family->Program( key ).IsLinked() ) return false;
+			}
+		}
+		return true;
+	}
+
+	double OneByOneMs( bool& linked )
+	{
+		FamilyList families = InitFamilies();
+		const Bench::Clock::time_point start = Bench::Clock::now();
+		for ( auto& family : families )
+		{
+			for ( ShaderVariants::Key key = 0; key < family->VariantCount(); ++key ) family->Program( key );
+		}
+		const double ms = Bench::ElapsedMs( start, Bench::Clock::now() );
+		linked = linked && AllLinked( families );
+		return ms;
+	}
+
+	double CompileAllMs( bool& linked )
+	{
+		FamilyList families = InitFamilies();
+		const Bench::Clock::time_point start = Bench::Clock::now();
+		for ( auto& family : families ) family->CompileAll();
+		const double ms = Bench::ElapsedMs( start, Bench::Clock::now() );
+		linked = linked && AllLinked( families );
+		return ms;
+	}
+
+	struct DeferredTimes
+	{
+		double issueMs;
+		double firstFrameMs;
+		double allReadyMs;
+	};
+
+	DeferredTimes Deferred( bool& linked )
+	{
+		FamilyList families = InitFamilies();
+		DeferredTimes times;
+		const Bench::Clock::time_point start = Bench::Clock::now();
+		for ( auto& family : families ) family->StartCompileAll();
+		times.issueMs = Bench::ElapsedMs( start, Bench::Clock::now() );
+
+		// the first frame: every material of every family (red light off), what CMyApp::MaterialProgram asks for
+		for ( auto& family : families )
+		{
+			for ( int state = 0; state < 3; ++state )
+			{
+				linked = linked && family->ReadyProgram( family->MakeKey( { state, 0 } ) ).IsLinked();
+			}
+		}
+		times.firstFrameMs = Bench::ElapsedMs( start, Bench::Clock::now() );
+
+		// later frames poll, the frame loop keeps going in the meantime
+		std::size_t variantCount = 0;
+		for ( auto& family : families ) variantCount += family->VariantCount();
+		for ( ;; )
+		{
+			std::size_t readyCount = 0;
+			for ( auto& family : families ) readyCount += family->FinishReady();
+			if ( readyCount == variantCount ) break;
+		}
+		times.allReadyMs = Bench::ElapsedMs( start, Bench::Clock::now() );
+
+		linked = linked && AllLinked( families );
+		return times;
+	}
+}
+
+BENCHMARK( ParallelShaderCompile, "Shader startup: synchronous compile/link vs deferred with KHR_parallel_shader_compile" )
+{
+	constexpr int REPEAT = 5;
+
+	Bench::GLContext context( 64, 64 );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	const bool parallel = GLEW_KHR_parallel_shader_compile;
+	bool linked = true;
+
+	if ( parallel ) glMaxShaderCompilerThreadsKHR( 0 );
+	const double oneByOneMs = Bench::MedianMs( REPEAT, [ & ]() { OneByOneMs( linked ); } );
+	const double serialMs = Bench::MedianMs( REPEAT, [ & ]() { CompileAllMs( linked ); } );
+
+	double threadedMs = serialMs;
+	std::vector<DeferredTimes> deferred;
+	if ( parallel )
+	{
+		EnableParallelShaderCompile();
+		threadedMs = Bench::MedianMs( REPEAT, [ & ]() { CompileAllMs( linked ); } );
+	}
+	for ( int i = 0; i < REPEAT; ++i ) deferred.push_back( Deferred( linked ) );
+	std::sort( deferred.begin(), deferred.end(), []( const DeferredTimes& a, const DeferredTimes& b ) { return a.firstFrameMs < b.firstFrameMs; } );
+	const DeferredTimes median = deferred[ REPEAT / 2 ];
+
+	GLint maxThreads = 0;
+	if ( parallel ) glGetIntegerv( GL_MAX_SHADER_COMPILER_THREADS_KHR, &maxThreads );
+	std::printf( "KHR_parallel_shader_compile: %s (GL_MAX_SHADER_COMPILER_THREADS_KHR %d), 3 families x 6 variants\n",
+				 parallel ? "yes" : "no, deferred = synchronous", maxThreads );
+	std::printf( "%-44s %12s %9s\n", "startup", "time [ms]", "speedup" );
+	std::printf( "%-44s %12.1f %8.2fx\n", "one by one (status after each)", oneByOneMs, 1.0 );
+	std::printf( "%-44s %12.1f %8.2fx\n", "CompileAll, no driver threads", serialMs, oneByOneMs / serialMs );
+	if ( parallel ) std::printf( "%-44s %12.1f %8.2fx\n", "CompileAll, driver threads", threadedMs, oneByOneMs / threadedMs );
+	std::printf( "%-44s %12.1f\n", "StartCompileAll: issue", median.issueMs );
+	std::printf( "%-44s %12.1f %8.2fx\n", "StartCompileAll: first frame can draw", median.firstFrameMs, oneByOneMs / median.firstFrameMs );
+	std::printf( "%-44s %12.1f %8.2fx\n", "StartCompileAll: every variant finished", median.allReadyMs, oneByOneMs / median.allReadyMs );
+	std::printf( "programs %s\n", linked ? "linked" : "NOT LINKED" );
+}
@@ -0,0 +1,113 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "ProgramBinaryCache.h"
+#include "ShaderVariants.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+// The shader startup of CMyApp::InitShaders (3 families x 6 Frag_ZH.frag variants): compiled from source,
+// compiled + stored into an empty ProgramBinaryCache (first start), loaded back from it (every later start).
+// The driver may cache compiled shaders itself (Mesa keeps one in ~/.cache/mesa_shader_cache): the first compile
+// of the run is reported separately, the repeated ones can be served from that cache already. For a CI-like start
+// (empty driver cache) run it with MESA_SHADER_CACHE_DIR pointing to an empty directory.
+
+namespace
+{
+	using FamilyList = std::vector<std::unique_ptr<ShaderVariants>>;
+
+	FamilyList InitShaders( ProgramBinaryCache* binaryCache )
+	{
+		const std::vector<ShaderVariants::Option> materialOptions = { { "STATE", 3 }, { "RED_LIGHT", 2 } };
+		const char* vertexShaders[] = { "Shaders/Vert_PosNormTex.vert", "Shaders/Vert_Instanced.vert", "Shaders/Vert_Indirect.vert" };
+
+		FamilyList families;
+		for ( const char* vertexShader : vertexShaders )
+		{
+			families.push_back( std::make_unique<ShaderVariants>() );
+			families.back()->Init( { { GL_VERTEX_SHADER, vertexShader }, { GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" } }, materialOptions, binaryCache );
+			families.back()->CompileAll();
+		}
+		glFinish();
+		return families;
+	}
+
+	// every variant linked, with the same active uniforms as the reference
+	bool SameVariants( FamilyList& families, FamilyList& reference )
+	{
+		for ( std::size_t f = 0; f < families.size(); ++f )
+		{
+			for ( ShaderVariants::Key key = 0; key < families[ f ]->VariantCount(); ++key )
+			{
+				const ShaderProgram& program = families[ f ]->Program( key );
+				if ( !program.IsLinked() || program.UniformCount() != reference[ f ]->Program( key ).UniformCount() ) return false;
+			}
+		}
+		return true;
+	}
+}
+
+BENCHMARK( ProgramBinaryCache, "Shader startup of CMyApp: compile from source vs glProgramBinary from the on-disk cache" )
+{
+	constexpr int REPEAT = 5;
+
+	Bench::GLContext context( 64, 64 );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+	if ( !ProgramBinaryCache::IsSupported() )
+	{
+		std::printf( "skipped, the driver has no program binary format\n" );
+		return;
+	}
+
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "ZH_BenchProgramBinaryCache";
+	std::error_code ec;
+	std::filesystem::remove_all( directory, ec );
+
+	const Bench::Clock::time_point firstStart = Bench::Clock::now();
+	FamilyList reference = InitShaders( nullptr );
+	const double firstSourceMs = Bench::ElapsedMs( firstStart, Bench::Clock::now() );
+	const double sourceMs = Bench::MedianMs( REPEAT, [ & ]() { reference = InitShaders( nullptr ); } );
+
+	// first start: nothing on disk, every program is compiled and stored
+	ProgramBinaryCache coldCache( directory );
+	const Bench::Clock::time_point coldStart = Bench::Clock::now();
+	FamilyList cold = InitShaders( &coldCache );
+	const double coldMs = Bench::ElapsedMs( coldStart, Bench::Clock::now() );
+
+	std::uintmax_t cacheBytes = 0;
+	for ( const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator( directory, ec ) ) cacheBytes += entry.file_size( ec );
+
+	// later starts: a new cache object each time, like a new process
+	FamilyList warm;
+	ProgramBinaryCache::Stats warmStats;
+	const double warmMs = Bench::MedianMs( REPEAT, [ & ]()
+	{
+		ProgramBinaryCache warmCache( directory );
+		warm = InitShaders( &warmCache );
+		warmStats = warmCache.GetStats();
+	} );
+
+	const bool same = SameVariants( cold, reference ) && SameVariants( warm, reference );
+
+	std::printf( "%zu programs, cache: %u files, %.1f KiB\n", reference.size() * reference[ 0 ]->VariantCount(),
+				 coldCache.GetStats().stored, cacheBytes / 1024.0 );
+	std::printf( "%-36s %12s %9s\n", "startup", "time [ms]", "speedup" );
+	std::printf( "%-36s %12.1f %8.2fx\n", "from source, first in this run", firstSourceMs, sourceMs / firstSourceMs );
+	std::printf( "%-36s %12.1f %8.2fx\n", "from source", sourceMs, 1.0 );
+	std::printf( "%-36s %12.1f %8.2fx\n", "first start (compile + store)", coldMs, sourceMs / coldMs );
+	std::printf( "%-36s %12.1f %8.2fx\n", "later start (glProgramBinary)", warmMs, sourceMs / warmMs );
+	std::printf( "binary loads: %u hits, %u misses, %u rejected; programs %s\n", warmStats.hits, warmStats.misses, warmStats.rejected,
+				 same ? "match" : "DIFFER" );
+
+	reference.clear();
+	cold.clear();
+	warm.clear();
+	std::filesystem::remove_all( directory, ec );
+}
@@ -0,0 +1,170 @@
+#include "Bench.h"
+
+#include "SceneGraph.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// World and normal matrices of a hierarchy per frame: rebuilt from scratch with glm products and
+// transpose( inverse( world ) ) for every node (the CMyApp::Render / Draw of before), vs SceneGraph::Update with
+// node 0 moved (everything below it dirty, the whole graph except in the CMyApp scene), the last node moved, and nothing moved, with the scalar and the SSE multiply.
+// The matrices of the graph have to match the rebuilt ones.
+
+namespace
+{
+	using MultiplyImpl = SceneGraph::MultiplyImpl;
+
+	struct Hierarchy
+	{
+		const char* name;
+		std::vector<SceneGraph::NodeID> parents; // parents[ i ] < i or NO_PARENT
+	};
+
+	Hierarchy Chain( int depth )
+	{
+		Hierarchy hierarchy = { "deep (chain)", {} };
+		for ( int i = 0; i < depth; ++i ) hierarchy.parents.push_back( i == 0 ? SceneGraph::NO_PARENT : SceneGraph::NodeID( i - 1 ) );
+		return hierarchy;
+	}
+
+	Hierarchy Wide( int childCount )
+	{
+		Hierarchy hierarchy = { "wide (one root)", { SceneGraph::NO_PARENT } };
+		for ( int i = 0; i < childCount; ++i ) hierarchy.parents.push_back( 0 );
+		return hierarchy;
+	}
+
+	// breadth first, like AddNode requires: the children of node i come after it
+	Hierarchy Tree( int branching, int depth )
+	{
+		Hierarchy hierarchy = { "tree", { SceneGraph::NO_PARENT } };
+		std::size_t levelBegin = 0, levelEnd = 1;
+		for ( int level = 1; level < depth; ++level )
+		{
+			for ( std::size_t parent = levelBegin; parent < levelEnd; ++parent )
+			{
+				for ( int c = 0; c < branching; ++c ) hierarchy.parents.push_back( SceneGraph::NodeID( parent ) );
+			}
+			levelBegin = levelEnd;
+			levelEnd = hierarchy.parents.size();
+		}
+		return hierarchy;
+	}
+
+	// the sub -> arm -> claws chain and the two ocean planes of CMyApp
+	Hierarchy MyAppScene()
+	{
+		const SceneGraph::NodeID none = SceneGraph::NO_PARENT;
+		return { "CMyApp scene", { none, none, none, 2, 3, 3 } };
+	}
+
+	// the scale stays near 1: along a 4096 deep chain the product of the scales has to stay in float range
+	SceneGraph::Transform RandomTransform( std::mt19937& random )
+	{
+		std::uniform_real_distribution<float> offset( -2.0f, 2.0f ), angle( -3.14f, 3.14f ), scale( 0.95f, 1.05f );
+		const glm::vec3 axis = glm::normalize( glm::vec3( offset( random ), offset( random ), offset( random ) ) + glm::vec3( 0.0f, 0.0f, 0.01f ) );
+		return { glm::vec3( offset( random ), offset( random ), offset( random ) ), glm::angleAxis( angle( random ), axis ),
+				 glm::vec3( scale( random ), scale( random ), scale( random ) ) };
+	}
+
+	// what CMyApp did per frame: the world matrix product chain, the inverse transpose in Draw
+	void Rebuild( const Hierarchy& hierarchy, const std::vector<SceneGraph::Transform>& locals, std::vector<glm::mat4>& world, std::vector<glm::mat4>& normal )
+	{
+		for ( std::size_t i = 0; i < locals.size(); ++i )
+		{
+			const SceneGraph::Transform& local = locals[ i ];
+			const glm::mat4 localMatrix = glm::translate( local.translation ) * glm::mat4_cast( local.rotation ) * glm::scale( local.scale );
+			world[ i ] = hierarchy.parents[ i ] == SceneGraph::NO_PARENT ? localMatrix : world[ hierarchy.parents[ i ] ] * localMatrix;
+			normal[ i ] = glm::transpose( glm::inverse( world[ i ] ) );
+		}
+	}
+
+	// relative to the largest element, the normal matrices compared on their upper 3x3 (the part the shader uses)
+	float MaxError( const SceneGraph& graph, const std::vector<glm::mat4>& world, const std::vector<glm::mat4>& normal )
+	{
+		float error = 0.0f;
+		for ( std::size_t i = 0; i < world.size(); ++i )
+		{
+			float worldScale = 1e-6f, normalScale = 1e-6f;
+			for ( int c = 0; c < 4; ++c ) for ( int r = 0; r < 4; ++r ) worldScale = std::max( worldScale, std::abs( world[ i ][ c ][ r ] ) );
+			for ( int c = 0; c < 3; ++c ) for ( int r = 0; r < 3; ++r ) normalScale = std::max( normalScale, std::abs( normal[ i ][ c ][ r ] ) );
+			const glm::mat4& graphWorld = graph.World( SceneGraph::NodeID( i ) );
+			const glm::mat4& graphNormal = graph.NormalMatrix( SceneGraph::NodeID( i ) );
+			for ( int c = 0; c < 4; ++c ) for ( int r = 0; r < 4; ++r ) error = std::max( error, std::abs( graphWorld[ c ][ r ] - world[ i ][ c ][ r ] ) / worldScale );
+			for ( int c = 0; c < 3; ++c ) for ( int r = 0; r < 3; ++r ) error = std::max( error, std::abs( graphNormal[ c ][ r ] - normal[ i ][ c ][ r ] ) / normalScale );
+		}
+		return error;
+	}
+}
+
+BENCHMARK( SceneGraph, "Hierarchy transforms per frame: full rebuild + inverse vs SceneGraph dirty propagation (scalar / SSE multiply)" )
+{
+	constexpr int REPEAT = 7;
+
+	const Hierarchy hierarchies[] = { MyAppScene(), Chain( 64 ), Chain( 4096 ), Wide( 10000 ), Tree( 4, 7 ), Tree( 2, 14 ) };
+	const MultiplyImpl impls[] = { MultiplyImpl::SCALAR, MultiplyImpl::SSE };
+	const MultiplyImpl bestImpl = SceneGraph::BestMultiplyImpl();
+
+	std::printf( "%-16s %7s | %12s | %-6s %12s %12s %12s | %9s\n", "hierarchy", "nodes", "rebuild [us]", "mult.", "root [us]", "leaf [us]", "none [us]", "max error" );
+
+	for ( const Hierarchy& hierarchy : hierarchies )
+	{
+		const std::size_t nodeCount = hierarchy.parents.size();
+		const int frames = static_cast<int>( std::max<std::size_t>( 1, 200000 / nodeCount ) );
+
+		std::mt19937 random( 1 );
+		std::vector<SceneGraph::Transform> locals( nodeCount );
+		for ( SceneGraph::Transform& local : locals ) local = RandomTransform( random );
+		// two poses of the root and of the last node, alternated so every frame really changes them
+		const SceneGraph::Transform rootPoses[ 2 ] = { locals.front(), RandomTransform( random ) };
+		const SceneGraph::Transform leafPoses[ 2 ] = { locals.back(), RandomTransform( random ) };
+
+		std::vector<glm::mat4> world( nodeCount ), normal( nodeCount );
+		const double rebuildMs = Bench::MedianMs( REPEAT, [ & ]()
+		{
+			for ( int f = 0; f < frames; ++f )
+			{
+				locals.front() = rootPoses[ f & 1 ];
+				Rebuild( hierarchy, locals, world, normal );
+			}
+			Bench::DoNotOptimize( world );
+		} );
+		const double rebuildUs = rebuildMs * 1000.0 / frames;
+
+		for ( MultiplyImpl impl : impls )
+		{
+			if ( !SceneGraph::SetMultiplyImpl( impl ) ) continue;
+
+			SceneGraph graph;
+			for ( std::size_t i = 0; i < nodeCount; ++i ) graph.AddNode( hierarchy.parents[ i ], locals[ i ] );
+			graph.Update();
+
+			auto perFrameUs = [ & ]( auto&& frame )
+			{
+				return Bench::MedianMs( REPEAT, [ & ]()
+				{
+					for ( int f = 0; f < frames; ++f ) frame( f );
+					Bench::DoNotOptimize( graph );
+				} ) * 1000.0 / frames;
+			};
+			const double rootUs = perFrameUs( [ & ]( int f ) { graph.SetLocal( 0, rootPoses[ f & 1 ] ); graph.Update(); } );
+			const double leafUs = perFrameUs( [ & ]( int f ) { graph.SetLocal( SceneGraph::NodeID( nodeCount - 1 ), leafPoses[ f & 1 ] ); graph.Update(); } );
+			const double noneUs = perFrameUs( [ & ]( int ) { graph.Update(); } );
+
+			// the final pose of both, against a rebuild of the same pose
+			locals.front() = graph.Local( 0 );
+			locals.back() = graph.Local( SceneGraph::NodeID( nodeCount - 1 ) );
+			Rebuild( hierarchy, locals, world, normal );
+			const float error = MaxError( graph, world, normal );
+
+			std::printf( "%-16s %7zu | %12.2f | %-6s %12.2f %12.3f %12.3f | %9.2e\n", hierarchy.name, nodeCount, rebuildUs,
+						 SceneGraph::MultiplyImplName( impl ), rootUs, leafUs, noneUs, error );
+		}
+	}
+	SceneGraph::SetMultiplyImpl( bestImpl );
+}
@@ -0,0 +1,183 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "GLUtils.hpp"
+#include "ShaderProgram.h"
+#include "ShaderVariants.h"
+#include "UniformBlocks.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Frag_ZH.frag at a fill-rate bound load: screen covering quads with overdraw at 1920 x 1080.
+// The runtime branching shader (state uniform, enableRedLight from FrameData) against the precompiled variant of
+// the same material (STATE and RED_LIGHT injected as defines by ShaderVariants). The images have to be the same.
+
+namespace
+{
+	constexpr int WIDTH = 1920;
+	constexpr int HEIGHT = 1080;
+
+	// CMyApp::SHADER_STATE_*
+	constexpr int SHADER_STATE_OCEAN = 0;
+	constexpr int SHADER_STATE_DEFAULT = 1;
+	constexpr int SHADER_STATE_OCEAN_SURFACE = 2;
+}
+
+BENCHMARK( ShaderVariants, "Frag_ZH.frag: runtime state branch vs precompiled permutations (fill-rate bound frame time)" )
+{
+	constexpr int OVERDRAW = 4;
+	constexpr int REPEAT = 5;
+
+	Bench::GLContext context( 64, 64 );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	// the quad covers the whole viewport: identity matrices, positions in NDC
+	MeshObject<Vertex> quadMesh;
+	quadMesh.vertexArray = {
+		{ { -1.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } },
+		{ {  1.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 4.0f, 0.0f } },
+		{ {  1.0f,  1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 4.0f, 4.0f } },
+		{ { -1.0f,  1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 4.0f } },
+	};
+	quadMesh.indexArray = { 0, 1, 2, 2, 3, 0 };
+	OGLObject quad = CreateGLObjectFromMesh( quadMesh, {
+		{ 0, offsetof( Vertex, position ), 3, GL_FLOAT },
+		{ 1, offsetof( Vertex, normal ), 3, GL_FLOAT },
+		{ 2, offsetof( Vertex, texcoord ), 2, GL_FLOAT },
+	} );
+
+	// noise texture, so the samples are not all the same texel
+	std::vector<std::uint32_t> texels( 256 * 256 );
+	std::srand( 1 );
+	for ( std::uint32_t& texel : texels ) texel = 0xFF000000u | ( static_cast<std::uint32_t>( std::rand() ) & 0xFFFFFFu );
+	GLuint texture = 0, sampler = 0;
+	glCreateTextures( GL_TEXTURE_2D_ARRAY, 1, &texture ); // one layer, Frag_ZH.frag samples a texture array
+	glTextureStorage3D( texture, 1, GL_RGBA8, 256, 256, 1 );
+	glTextureSubImage3D( texture, 0, 0, 0, 0, 256, 256, 1, GL_RGBA, GL_UNSIGNED_BYTE, texels.data() );
+	glCreateSamplers( 1, &sampler );
+	glSamplerParameteri( sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	glSamplerParameteri( sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glBindTextureUnit( 0, texture );
+	glBindSampler( 0, sampler );
+
+	// the lights of CMyApp, the red point light in front of the quad
+	FrameUniforms frame = {};
+	frame.viewProj = glm::mat4( 1.0f );
+	frame.cameraPos = glm::vec3( 0.0f, 0.0f, 2.0f );
+	frame.elapsedTimeInSec = 1.0f;
+	frame.lightPos = glm::vec4( 0, 1, 0, 0 );
+	frame.lightPos2 = glm::vec4( 0.3f, 0.2f, 1.0f, 1.0f );
+	frame.Ld = frame.Ls = glm::vec3( 1.0f );
+	frame.lightConstantAttenuation = 1.0f;
+	frame.enableRedLight = 1;
+	const ObjectUniforms object = { glm::mat4( 1.0f ), glm::mat4( 1.0f ), glm::mat4( 1.0f ) };
+
+	GLuint frameBuffer = 0, objectBuffer = 0;
+	glCreateBuffers( 1, &frameBuffer );
+	glNamedBufferStorage( frameBuffer, sizeof( FrameUniforms ), &frame, 0 );
+	glCreateBuffers( 1, &objectBuffer );
+	glNamedBufferStorage( objectBuffer, sizeof( ObjectUniforms ), &object, 0 );
+	glBindBufferBase( GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frameBuffer );
+	glBindBufferBase( GL_UNIFORM_BUFFER, OBJECT_UNIFORM_BINDING, objectBuffer );
+
+	GLuint colorTexture = 0, framebuffer = 0;
+	glCreateTextures( GL_TEXTURE_2D, 1, &colorTexture );
+	glTextureStorage2D( colorTexture, 1, GL_RGBA8, WIDTH, HEIGHT );
+	glCreateFramebuffers( 1, &framebuffer );
+	glNamedFramebufferTexture( framebuffer, GL_COLOR_ATTACHMENT0, colorTexture, 0 );
+	glBindFramebuffer( GL_FRAMEBUFFER, framebuffer );
+	glViewport( 0, 0, WIDTH, HEIGHT );
+	glDisable( GL_DEPTH_TEST );
+	glDisable( GL_CULL_FACE );
+
+	// compile cost: the one branching program against all 3 x 2 variants
+	ShaderProgram uberProgram;
+	ShaderVariants variants;
+	const Bench::Clock::time_point uberStart = Bench::Clock::now();
+	uberProgram.Create();
+	uberProgram.AttachShader( GL_VERTEX_SHADER, "Shaders/Vert_PosNormTex.vert" );
+	uberProgram.AttachShader( GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" );
+	uberProgram.Link();
+	const double uberCompileMs = Bench::ElapsedMs( uberStart, Bench::Clock::now() );
+
+	const Bench::Clock::time_point variantsStart = Bench::Clock::now();
+	variants.Init( { { GL_VERTEX_SHADER, "Shaders/Vert_PosNormTex.vert" }, { GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" } },
+				   { { "STATE", 3 }, { "RED_LIGHT", 2 } } );
+	variants.CompileAll();
+	const double variantsCompileMs = Bench::ElapsedMs( variantsStart, Bench::Clock::now() );
+	std::printf( "compile + link: branching program %.1f ms, %zu variants %.1f ms\n", uberCompileMs, variants.VariantCount(), variantsCompileMs );
+	std::printf( "%d x %d, %d screen covering quads per frame\n", WIDTH, HEIGHT, OVERDRAW );
+
+	auto drawFrame = [ & ]( GLuint programID )
+	{
+		glUseProgram( programID );
+		glBindVertexArray( quad.vaoID );
+		for ( int i = 0; i < OVERDRAW; ++i ) glDrawElements( GL_TRIANGLES, quad.count, GL_UNSIGNED_INT, nullptr );
+		glFinish();
+	};
+
+	auto readImage = [ & ]()
+	{
+		std::vector<std::uint8_t> image( static_cast<std::size_t>( WIDTH ) * HEIGHT * 4 );
+		glReadPixels( 0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, image.data() );
+		return image;
+	};
+
+	struct Material
+	{
+		const char* name;
+		int state;
+	};
+	const Material materials[] = {
+		{ "default (lit) + red", SHADER_STATE_DEFAULT },
+		{ "ocean surface + red", SHADER_STATE_OCEAN_SURFACE },
+		{ "ocean + red", SHADER_STATE_OCEAN },
+	};
+
+	std::printf( "%-22s %14s %14s %9s %12s\n", "material", "branch [ms]", "variant [ms]", "speedup", "image diff" );
+	for ( const Material& material : materials )
+	{
+		glProgramUniform1i( uberProgram.ID(), ul( uberProgram, "state" ), material.state );
+		const GLuint variantID = variants.Program( variants.MakeKey( { material.state, 1 } ) ).ID();
+
+		drawFrame( uberProgram.ID() );
+		const std::vector<std::uint8_t> uberImage = readImage();
+		drawFrame( variantID );
+		const std::vector<std::uint8_t> variantImage = readImage();
+
+		int differentPixels = 0;
+		for ( std::size_t p = 0; p < uberImage.size(); p += 4 )
+		{
+			int maxDiff = 0;
+			for ( int c = 0; c < 3; ++c ) maxDiff = std::max( maxDiff, std::abs( uberImage[ p + c ] - variantImage[ p + c ] ) );
+			differentPixels += maxDiff > 1;
+		}
+
+		const double uberMs = Bench::MedianMs( REPEAT, [ & ]() { drawFrame( uberProgram.ID() ); } );
+		const double variantMs = Bench::MedianMs( REPEAT, [ & ]() { drawFrame( variantID ); } );
+
+		std::printf( "%-22s %14.2f %14.2f %8.2fx %12d\n", material.name, uberMs, variantMs, uberMs / variantMs, differentPixels );
+	}
+
+	glUseProgram( 0 );
+	glBindVertexArray( 0 );
+	glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+	glBindTextureUnit( 0, 0 );
+	glBindSampler( 0, 0 );
+	variants.Clean();
+	uberProgram.Destroy();
+	glDeleteFramebuffers( 1, &framebuffer );
+	glDeleteTextures( 1, &colorTexture );
+	glDeleteTextures( 1, &texture );
+	glDeleteSamplers( 1, &sampler );
+	glDeleteBuffers( 1, &frameBuffer );
+	glDeleteBuffers( 1, &objectBuffer );
+	CleanOGLObject( quad );
+}
@@ -0,0 +1,237 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "GLUtils.hpp"
+#include "MeshBuffer.h"
+#include "ObjParser.h"
+#include "ShaderProgram.h"
+#include "TextureArray.h"
+#include "UniformBlocks.h"
+#include "VertexQuantization.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+// Materials as separate textures (one texture bind + one glMultiDrawElementsIndirect per material, the
+// CMyApp::RenderIndirect of before) vs one TextureArray (one bind, one glMultiDrawElementsIndirect, the layer is in
+// the DrawData record), CPU submission cost vs material count. The first run of every count compares the images.
+// A separate texture is a one layer array here too, Frag_ZH.frag samples a sampler2DArray.
+
+namespace
+{
+	constexpr int IMAGE_SIZE = 128;
+	constexpr int OBJECT_COUNT = 1000;
+	constexpr GLsizei MATERIAL_SIZE = 64;
+
+	// flat colour per material with a checker, so a wrong layer shows up in the image
+	std::vector<std::uint32_t> MaterialTexels( int material )
+	{
+		std::srand( material + 1 );
+		const std::uint32_t colour = 0xFF000000u | ( static_cast<std::uint32_t>( std::rand() ) & 0xFFFFFFu );
+		std::vector<std::uint32_t> texels( MATERIAL_SIZE * MATERIAL_SIZE );
+		for ( GLsizei y = 0; y < MATERIAL_SIZE; ++y )
+		{
+			for ( GLsizei x = 0; x < MATERIAL_SIZE; ++x ) texels[ y * MATERIAL_SIZE + x ] = ( ( x / 8 + y / 8 ) & 1 ) ? colour : 0xFFFFFFFFu;
+		}
+		return texels;
+	}
+
+	std::vector<std::uint8_t> ReadImage()
+	{
+		std::vector<std::uint8_t> pixels( IMAGE_SIZE * IMAGE_SIZE * 4 );
+		glReadPixels( 0, 0, IMAGE_SIZE, IMAGE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data() );
+		return pixels;
+	}
+}
+
+BENCHMARK( TextureArray, "Scene materials: a texture bind + MDI per material vs one texture array bind + one MDI" )
+{
+	constexpr int REPEAT = 5;
+	constexpr int FRAMES = 20;
+	const int materialCounts[] = { 4, 16, 64, 256 };
+
+	Bench::GLContext context( IMAGE_SIZE, IMAGE_SIZE );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	ObjParser::Mesh fish = ObjParser::parse( "Assets/PufferFish.obj" );
+	MeshBuffer meshBuffer;
+	const MeshRange range = meshBuffer.Add( MakeMeshView( fish ), ObjParser::computeBounds( MakeMeshView( fish ) ) );
+	meshBuffer.Upload();
+	meshBuffer.ReserveDrawIndices( OBJECT_COUNT );
+
+	ShaderProgram program;
+	program.Create();
+	program.AttachShader( GL_VERTEX_SHADER, "Shaders/Vert_Indirect.vert" );
+	program.AttachShader( GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" );
+	program.Link();
+	glProgramUniform1i( program.ID(), ul( program, "state" ), 1 ); // SHADER_STATE_DEFAULT
+
+	GLuint sampler = 0;
+	glCreateSamplers( 1, &sampler );
+	glSamplerParameteri( sampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+	glSamplerParameteri( sampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+	glBindSampler( 0, sampler );
+
+	FrameUniforms frame = {};
+	frame.viewProj = glm::perspective( glm::radians( 60.0f ), 1.0f, 0.1f, 100.0f );
+	frame.lightPos = glm::vec4( 0, 1, 1, 0 );
+	frame.Ld = frame.Ls = frame.La = glm::vec3( 1.0f );
+	frame.lightConstantAttenuation = 1.0f;
+	GLuint frameBuffer = 0;
+	glCreateBuffers( 1, &frameBuffer );
+	glNamedBufferStorage( frameBuffer, sizeof( FrameUniforms ), &frame, 0 );
+	glBindBufferBase( GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frameBuffer );
+
+	// objects on a grid, in material order: a material is one contiguous command range for the per material path
+	const int side = static_cast<int>( std::ceil( std::sqrt( static_cast<double>( OBJECT_COUNT ) ) ) );
+	const float spacing = 20.0f / side;
+	std::vector<glm::mat4> worlds( OBJECT_COUNT );
+	for ( int i = 0; i < OBJECT_COUNT; ++i )
+	{
+		const float x = ( i % side + 0.5f ) * spacing - 10.0f;
+		const float y = ( i / side + 0.5f ) * spacing - 10.0f;
+		worlds[ i ] = glm::translate( glm::vec3( x, y, -25.0f ) ) * glm::scale( glm::vec3( 0.8f * spacing ) ) * glm::rotate( 0.3f * i, glm::vec3( 0, 1, 0 ) );
+	}
+
+	GLuint drawDataBuffer = 0, commandBuffer = 0, visibleRecordBuffer = 0;
+	glCreateBuffers( 1, &drawDataBuffer );
+	glCreateBuffers( 1, &commandBuffer );
+	glCreateBuffers( 1, &visibleRecordBuffer );
+	glNamedBufferData( drawDataBuffer, OBJECT_COUNT * sizeof( DrawData ), nullptr, GL_DYNAMIC_DRAW );
+	std::vector<DrawElementsIndirectCommand> commands( OBJECT_COUNT );
+	for ( int i = 0; i < OBJECT_COUNT; ++i ) commands[ i ] = range.Command( 1, i );
+	glNamedBufferStorage( commandBuffer, OBJECT_COUNT * sizeof( DrawElementsIndirectCommand ), commands.data(), 0 );
+	std::vector<GLuint> visibleRecords( OBJECT_COUNT );
+	std::iota( visibleRecords.begin(), visibleRecords.end(), 0u );
+	glNamedBufferStorage( visibleRecordBuffer, OBJECT_COUNT * sizeof( GLuint ), visibleRecords.data(), 0 );
+
+	glUseProgram( program.ID() );
+	glBindVertexArray( meshBuffer.VAO() );
+	glBindBuffer( GL_DRAW_INDIRECT_BUFFER, commandBuffer );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, DRAW_DATA_STORAGE_BINDING, drawDataBuffer );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, VISIBLE_RECORD_STORAGE_BINDING, visibleRecordBuffer );
+
+	std::printf( "%9s | %12s %12s | %12s %12s | %8s | %s\n", "materials", "binds+MDIs", "CPU [ms]", "binds+MDIs", "CPU [ms]", "speedup", "image diff" );
+
+	for ( int materialCount : materialCounts )
+	{
+		std::vector<GLuint> textures( materialCount );
+		glCreateTextures( GL_TEXTURE_2D_ARRAY, materialCount, textures.data() );
+		TextureArray array;
+		array.Init( materialCount, MATERIAL_SIZE, MATERIAL_SIZE, GL_RGBA8 );
+		for ( int m = 0; m < materialCount; ++m )
+		{
+			const std::vector<std::uint32_t> texels = MaterialTexels( m );
+			glTextureStorage3D( textures[ m ], 1, GL_RGBA8, MATERIAL_SIZE, MATERIAL_SIZE, 1 );
+			glTextureSubImage3D( textures[ m ], 0, 0, 0, 0, MATERIAL_SIZE, MATERIAL_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE, texels.data() );
+			glTextureSubImage3D( array.ID(), 0, 0, 0, m, MATERIAL_SIZE, MATERIAL_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE, texels.data() );
+			array.SetLayerLevel( m, 0 );
+		}
+
+		// object i has material i * materialCount / OBJECT_COUNT: contiguous, nearly equal ranges
+		auto firstObject = [ & ]( int material ) { return static_cast<GLsizei>( ( static_cast<long long>( material ) * OBJECT_COUNT + materialCount - 1 ) / materialCount ); };
+		std::vector<DrawData> drawData( OBJECT_COUNT );
+		auto writeDrawData = [ & ]( bool layered )
+		{
+			for ( int m = 0; m < materialCount; ++m )
+			{
+				for ( GLsizei i = firstObject( m ); i < firstObject( m + 1 ); ++i )
+				{
+					drawData[ i ] = { worlds[ i ], range.dequantization };
+					drawData[ i ].material.layer = layered ? m : 0;
+				}
+			}
+			glNamedBufferSubData( drawDataBuffer, 0, OBJECT_COUNT * sizeof( DrawData ), drawData.data() );
+		};
+
+		std::size_t perMaterialCalls = 0, arrayCalls = 0;
+		auto renderPerMaterial = [ & ]()
+		{
+			writeDrawData( false );
+			perMaterialCalls = 1;
+			for ( int m = 0; m < materialCount; ++m )
+			{
+				const GLsizei first = firstObject( m );
+				glBindTextureUnit( 0, textures[ m ] );
+				glMultiDrawElementsIndirect( GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>( first * sizeof( DrawElementsIndirectCommand ) ),
+											 firstObject( m + 1 ) - first, 0 );
+				perMaterialCalls += 2;
+			}
+		};
+		auto renderArray = [ & ]()
+		{
+			writeDrawData( true );
+			glBindTextureUnit( 0, array.ID() );
+			glMultiDrawElementsIndirect( GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, OBJECT_COUNT, 0 );
+			arrayCalls = 3;
+		};
+
+		// both paths have to produce the same image
+		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+		renderPerMaterial();
+		const std::vector<std::uint8_t> perMaterialImage = ReadImage();
+		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+		renderArray();
+		const std::vector<std::uint8_t> arrayImage = ReadImage();
+		int differentPixels = 0, coveredPixels = 0;
+		for ( std::size_t p = 0; p < perMaterialImage.size(); p += 4 )
+		{
+			int maxDiff = 0;
+			for ( int c = 0; c < 3; ++c ) maxDiff = std::max( maxDiff, std::abs( perMaterialImage[ p + c ] - arrayImage[ p + c ] ) );
+			differentPixels += maxDiff > 2;
+			coveredPixels += perMaterialImage[ p ] != 0 || perMaterialImage[ p + 1 ] != 0 || perMaterialImage[ p + 2 ] != 0;
+		}
+
+		// CPU time of issuing the frame, the GPU is waited for outside of the timed part
+		auto cpuMs = [ & ]( auto&& render )
+		{
+			std::vector<double> times;
+			for ( int r = 0; r < REPEAT; ++r )
+			{
+				double ms = 0.0;
+				for ( int f = 0; f < FRAMES; ++f )
+				{
+					glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+					const Bench::Clock::time_point start = Bench::Clock::now();
+					render();
+					ms += Bench::ElapsedMs( start, Bench::Clock::now() );
+					glFinish();
+				}
+				times.push_back( ms / FRAMES );
+			}
+			std::sort( times.begin(), times.end() );
+			return times[ times.size() / 2 ];
+		};
+
+		const double perMaterialMs = cpuMs( renderPerMaterial );
+		const double arrayMs = cpuMs( renderArray );
+
+		std::printf( "%9d | %12zu %12.3f | %12zu %12.3f | %7.2fx | %d of %d covered pixels\n",
+					 materialCount, perMaterialCalls, perMaterialMs, arrayCalls, arrayMs, perMaterialMs / arrayMs, differentPixels, coveredPixels );
+
+		glBindTextureUnit( 0, 0 );
+		glDeleteTextures( materialCount, textures.data() );
+		array.Clean();
+	}
+
+	glBindVertexArray( 0 );
+	glBindBuffer( GL_DRAW_INDIRECT_BUFFER, 0 );
+	glBindSampler( 0, 0 );
+	glUseProgram( 0 );
+	glDeleteSamplers( 1, &sampler );
+	glDeleteBuffers( 1, &drawDataBuffer );
+	glDeleteBuffers( 1, &commandBuffer );
+	glDeleteBuffers( 1, &visibleRecordBuffer );
+	glDeleteBuffers( 1, &frameBuffer );
+	meshBuffer.Clean();
+}
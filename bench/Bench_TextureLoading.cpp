@@ -0,0 +1,117 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "GLUtils.hpp"
+#include "ShaderVariants.h"
+#include "TextureLoader.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The texture startup of CMyApp: the five PNGs of InitTextures decoded and uploaded one after the other on the GL
+// thread (the old InitTextures), against TextureLoader decoding them on worker threads. The loader is measured
+// alone and overlapped with GL thread work (the 18 shader programs of InitShaders, like CMyApp::Init).
+// The files are in the OS file cache after the first run, so "cold" means cold process, not cold disk.
+// TextureLoader loads copies of the PNGs: cooked KTX2 files would skip the decode (see Bench_CompressedTextures).
+
+namespace
+{
+	const std::array<const char*, 5> TEXTURE_FILES = {
+		"Assets/ocean.png", "Assets/oceanbottom.png", "Assets/sub.png", "Assets/Caustics.png", "Assets/PufferFish.png",
+	};
+
+	void DeleteTextures( std::array<GLuint, 5>& textures )
+	{
+		glDeleteTextures( static_cast<GLsizei>( textures.size() ), textures.data() );
+		textures.fill( 0 );
+	}
+
+	void LoadSerial( std::array<GLuint, 5>& textures )
+	{
+		for ( std::size_t i = 0; i < TEXTURE_FILES.size(); ++i )
+		{
+			ImageRGBA image = ImageFromFile( TEXTURE_FILES[ i ] );
+			glCreateTextures( GL_TEXTURE_2D, 1, &textures[ i ] );
+			glTextureStorage2D( textures[ i ], NumberOfMIPLevels( image ), GL_RGBA8, image.width, image.height );
+			glTextureSubImage2D( textures[ i ], 0, 0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, image.data() );
+			glGenerateTextureMipmap( textures[ i ] );
+		}
+		glFinish();
+	}
+
+	// the GL thread work of CMyApp::Init besides the textures; every call compiles new sources (no driver cache hits)
+	void CompileShaders()
+	{
+		static const long long runID = static_cast<long long>( std::chrono::system_clock::now().time_since_epoch().count() );
+		static int salt = 0;
+		const std::string saltDefine = "BENCH_SALT_" + std::to_string( runID ) + "_" + std::to_string( ++salt );
+		const std::vector<ShaderVariants::Option> options = { { "STATE", 3 }, { "RED_LIGHT", 2 }, { saltDefine, 1 } };
+		const char* vertexShaders[] = { "Shaders/Vert_PosNormTex.vert", "Shaders/Vert_Instanced.vert", "Shaders/Vert_Indirect.vert" };
+		for ( const char* vertexShader : vertexShaders )
+		{
+			ShaderVariants family;
+			family.Init( { { GL_VERTEX_SHADER, vertexShader }, { GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" } }, options );
+			family.CompileAll();
+		}
+	}
+
+	std::unique_ptr<TextureLoader> LoadThreaded( const std::vector<std::filesystem::path>& files, std::array<GLuint, 5>& textures,
+												 unsigned int threadCount, bool withShaders )
+	{
+		auto loader = std::make_unique<TextureLoader>( threadCount );
+		for ( std::size_t i = 0; i < files.size(); ++i ) loader->Load( files[ i ], textures[ i ] );
+		if ( withShaders ) CompileShaders();
+		loader->UploadAll();
+		glFinish();
+		return loader;
+	}
+}
+
+BENCHMARK( TextureLoading, "InitTextures: serial ImageFromFile + upload vs TextureLoader (worker decode, GL thread upload)" )
+{
+	constexpr int REPEAT = 5;
+
+	Bench::GLContext context( 64, 64 );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	std::array<GLuint, 5> textures = {};
+	const unsigned int threadCount = ThreadPool::HardwareThreadCount();
+	const std::vector<std::filesystem::path> files = Bench::CopyToTempDirectory( TEXTURE_FILES, "ZH_BenchTextureLoading" );
+
+	const double serialMs = Bench::MedianMs( REPEAT, [ & ]() { LoadSerial( textures ); DeleteTextures( textures ); } );
+	const double threadedMs = Bench::MedianMs( REPEAT, [ & ]() { LoadThreaded( files, textures, threadCount, false ); DeleteTextures( textures ); } );
+	const double shadersMs = Bench::MedianMs( REPEAT, [ & ]() { CompileShaders(); glFinish(); } );
+	const double serialInitMs = Bench::MedianMs( REPEAT, [ & ]() { CompileShaders(); LoadSerial( textures ); DeleteTextures( textures ); } );
+
+	std::unique_ptr<TextureLoader> last;
+	const double overlappedMs = Bench::MedianMs( REPEAT, [ & ]() { last = LoadThreaded( files, textures, threadCount, true ); DeleteTextures( textures ); } );
+
+	std::printf( "%u hardware threads, %u decode threads\n", ThreadPool::HardwareThreadCount(), threadCount );
+	std::printf( "%-44s %12s %9s\n", "startup", "time [ms]", "speedup" );
+	std::printf( "%-44s %12.1f %8.2fx\n", "textures, serial on the GL thread", serialMs, 1.0 );
+	std::printf( "%-44s %12.1f %8.2fx\n", "textures, TextureLoader", threadedMs, serialMs / threadedMs );
+	std::printf( "%-44s %12.1f\n", "shaders alone (18 programs)", shadersMs );
+	std::printf( "%-44s %12.1f %8.2fx\n", "shaders, then serial textures", serialInitMs, 1.0 );
+	std::printf( "%-44s %12.1f %8.2fx\n", "shaders overlapped with TextureLoader", overlappedMs, serialInitMs / overlappedMs );
+
+	// per asset, the last overlapped run
+	std::printf( "%-24s %11s %10s %10s %10s %10s %10s\n", "asset", "size", "queued", "decode", "GL wait", "upload", "ready" );
+	for ( const TextureLoader::Timing& timing : last->Timings() )
+	{
+		const std::string size = std::to_string( timing.width ) + "x" + std::to_string( timing.height );
+		std::printf( "%-24s %11s %10.1f %10.1f %10.1f %10.1f %10.1f\n", timing.fileName.string().c_str(), size.c_str(),
+					 timing.queuedMs, timing.decodeMs, timing.waitMs, timing.uploadMs, timing.readyMs );
+	}
+
+	last.reset();
+	std::error_code ec;
+	std::filesystem::remove_all( files.front().parent_path(), ec );
+}
@@ -0,0 +1,152 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "GLUtils.hpp"
+#include "StagingRing.h"
+#include "TextureLoader.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// GL thread cost per frame of getting the five CMyApp textures onto the GPU once they are decoded: the old
+// InitTextures upload (glTextureSubImage2D from client memory + glGenerateTextureMipmap, one texture per frame at
+// best), and TextureLoader streaming with and without the persistent mapped StagingRing, unlimited and with the
+// per-frame budget of CMyApp. A frame is the UploadReady call plus glFinish, so the driver's copy is counted too.
+// The level 0 texels of every path have to match the ones of ImageFromFile. TextureLoader loads copies of the PNGs,
+// so cooked KTX2 files next to them (ZH_AssetCook) do not replace the path measured here.
+
+namespace
+{
+	const std::array<const char*, 5> TEXTURE_FILES = {
+		"Assets/ocean.png", "Assets/oceanbottom.png", "Assets/sub.png", "Assets/Caustics.png", "Assets/PufferFish.png",
+	};
+
+	struct FrameStats
+	{
+		int    frames = 0;
+		double maxMs = 0.0;
+		double totalMs = 0.0;
+		int    staged = 0; // textures uploaded from the ring
+
+		void Add( double ms )
+		{
+			++frames;
+			maxMs = std::max( maxMs, ms );
+			totalMs += ms;
+		}
+	};
+
+	bool SameLevel0( const std::array<GLuint, 5>& textures, const std::vector<ImageRGBA>& images )
+	{
+		for ( std::size_t i = 0; i < textures.size(); ++i )
+		{
+			const ImageRGBA& image = images[ i ];
+			std::vector<ImageRGBA::TexelRGBA> texels( image.texelData.size() );
+			glGetTextureImage( textures[ i ], 0, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<GLsizei>( texels.size() * sizeof( texels[ 0 ] ) ), texels.data() );
+			if ( texels != image.texelData ) return false;
+		}
+		return true;
+	}
+
+	FrameStats UploadOneShot( const std::vector<ImageRGBA>& images, std::array<GLuint, 5>& textures )
+	{
+		FrameStats stats;
+		for ( std::size_t i = 0; i < images.size(); ++i )
+		{
+			const ImageRGBA& image = images[ i ];
+			const Bench::Clock::time_point start = Bench::Clock::now();
+			glCreateTextures( GL_TEXTURE_2D, 1, &textures[ i ] );
+			glTextureStorage2D( textures[ i ], NumberOfMIPLevels( image ), GL_RGBA8, image.width, image.height );
+			glTextureSubImage2D( textures[ i ], 0, 0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, image.data() );
+			glGenerateTextureMipmap( textures[ i ] );
+			glFinish();
+			stats.Add( Bench::ElapsedMs( start, Bench::Clock::now() ) );
+		}
+		return stats;
+	}
+
+	FrameStats Stream( const std::vector<std::filesystem::path>& files, StagingRing* staging, std::size_t byteBudget, std::array<GLuint, 5>& textures )
+	{
+		TextureLoader loader( ThreadPool::HardwareThreadCount(), staging );
+		for ( std::size_t i = 0; i < files.size(); ++i ) loader.Load( files[ i ], textures[ i ] );
+
+		// only the GL thread part is measured
+		while ( loader.DecodingCount() > 0 ) std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+		FrameStats stats;
+		while ( loader.PendingCount() > 0 )
+		{
+			const Bench::Clock::time_point start = Bench::Clock::now();
+			loader.UploadReady( byteBudget );
+			glFinish();
+			stats.Add( Bench::ElapsedMs( start, Bench::Clock::now() ) );
+		}
+		for ( const TextureLoader::Timing& timing : loader.Timings() ) stats.staged += timing.staged ? 1 : 0;
+		return stats;
+	}
+}
+
+BENCHMARK( TextureStreaming, "Texture upload per frame: client memory + glGenerateTextureMipmap vs TextureLoader over a persistent mapped PBO ring" )
+{
+	constexpr std::size_t BUDGET = 2 * 1024 * 1024; // CMyApp::TEXTURE_UPLOAD_BUDGET
+
+	Bench::GLContext context( 64, 64 );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	std::vector<ImageRGBA> images;
+	for ( const char* fileName : TEXTURE_FILES ) images.push_back( ImageFromFile( fileName ) );
+	const std::vector<std::filesystem::path> files = Bench::CopyToTempDirectory( TEXTURE_FILES, "ZH_BenchTextureStreaming" );
+
+	StagingRing staging;
+	const bool hasStaging = staging.Init( 24 * 1024 * 1024 ); // CMyApp::InitTextures
+
+	struct Row
+	{
+		const char* name;
+		FrameStats  stats;
+		bool        same;
+	};
+	std::vector<Row> rows;
+	std::array<GLuint, 5> textures = {};
+
+	auto run = [ & ]( const char* name, auto&& upload )
+	{
+		FrameStats stats = upload();
+		rows.push_back( { name, stats, SameLevel0( textures, images ) } );
+		glDeleteTextures( static_cast<GLsizei>( textures.size() ), textures.data() );
+		textures.fill( 0 );
+		// the next run starts with an empty ring
+		glFinish();
+		staging.Retire();
+	};
+
+	run( "client memory + glGenerateTextureMipmap", [ & ]() { return UploadOneShot( images, textures ); } );
+	run( "TextureLoader, client memory, unlimited", [ & ]() { return Stream( files, nullptr, TextureLoader::UNLIMITED, textures ); } );
+	run( "TextureLoader, client memory, 2 MiB/frame", [ & ]() { return Stream( files, nullptr, BUDGET, textures ); } );
+	if ( hasStaging )
+	{
+		run( "TextureLoader, staging ring, unlimited", [ & ]() { return Stream( files, &staging, TextureLoader::UNLIMITED, textures ); } );
+		run( "TextureLoader, staging ring, 2 MiB/frame", [ & ]() { return Stream( files, &staging, BUDGET, textures ); } );
+	}
+	else std::printf( "no persistent mapped staging buffer\n" );
+
+	std::printf( "%-44s %7s %14s %14s %12s %6s\n", "upload", "frames", "max frame[ms]", "total [ms]", "from ring", "texels" );
+	for ( const Row& row : rows )
+	{
+		std::printf( "%-44s %7d %14.2f %14.1f %10d/5 %6s\n", row.name, row.stats.frames, row.stats.maxMs, row.stats.totalMs,
+					 row.stats.staged, row.same ? "same" : "DIFFER" );
+	}
+	staging.Retire();
+	std::printf( "staging ring: %lld bytes, %lld in use after the runs\n", static_cast<long long>( staging.Capacity() ), static_cast<long long>( staging.UsedBytes() ) );
+
+	std::error_code ec;
+	std::filesystem::remove_all( files.front().parent_path(), ec );
+}
@@ -0,0 +1,280 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "GLUtils.hpp"
+#include "ObjParser.h"
+#include "UniformBlocks.h"
+#include "VertexQuantization.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Per-draw glProgramUniform* calls (the previous CMyApp::Draw) vs per-frame and per-object uniform buffers (the current one)
+// on the draws of the CMyApp scene. The GL calls are counted where they are issued.
+
+namespace
+{
+	std::size_t s_glCalls = 0;
+
+#define COUNTED_GL( call ) ( ++s_glCalls, call )
+
+	inline GLint CountedUl( GLuint programID, const GLchar* uniformName )
+	{
+		return COUNTED_GL( ul( programID, uniformName ) );
+	}
+
+	struct SceneDraw
+	{
+		const OGLObject* gpu;
+		int state;
+		glm::mat4 world;
+	};
+
+	struct Scene
+	{
+		OGLObject quad, pufferFish, sub, arm, claw;
+		GLuint texture = 0;
+		GLuint sampler = 0;
+		std::vector<SceneDraw> draws;
+
+		// the light and camera values of CMyApp
+		glm::mat4 viewProj = glm::perspective( glm::radians( 60.0f ), 16.0f / 9.0f, 0.01f, 1000.0f ) *
+							 glm::lookAt( glm::vec3( 0.0, -55.0, 100.0 ), glm::vec3( 0.0, 50.0, 105.0 ), glm::vec3( 0.0, 1.0, 0.0 ) );
+		glm::vec3 cameraPos = glm::vec3( 0.0, -55.0, 100.0 );
+		glm::vec4 lightPos = glm::vec4( 0, 1, 0, 0 ), lightPos2 = glm::vec4( 0, 1, 0, 1 );
+		glm::vec3 La = glm::vec3( 0.0 ), Ld = glm::vec3( 1.0 ), Ls = glm::vec3( 1.0 );
+		float elapsedTimeInSec = 1.0f;
+	};
+
+	void InitScene( Scene& scene )
+	{
+		MeshObject<Vertex> quadMesh;
+		quadMesh.vertexArray = {
+			{ { -0.5f,  0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } },
+			{ {  0.5f,  0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f } },
+			{ {  0.5f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f } },
+			{ { -0.5f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f } },
+		};
+		quadMesh.indexArray = { 0, 1, 2, 2, 3, 0, 0, 2, 1, 2, 0, 3 };
+		scene.quad = CreateGLObjectFromMesh( quadMesh, {
+			{ 0, offsetof( Vertex, position ), 3, GL_FLOAT },
+			{ 1, offsetof( Vertex, normal ), 3, GL_FLOAT },
+			{ 2, offsetof( Vertex, texcoord ), 2, GL_FLOAT },
+		} );
+
+		scene.pufferFish = CreateQuantizedGLObjectFromMesh( MakeMeshView( ObjParser::parse( "Assets/PufferFish.obj" ) ) );
+		scene.sub = CreateQuantizedGLObjectFromMesh( MakeMeshView( ObjParser::parse( "Assets/sub.obj" ) ) );
+		scene.arm = CreateQuantizedGLObjectFromMesh( MakeMeshView( ObjParser::parse( "Assets/Arm.obj" ) ) );
+		scene.claw = CreateQuantizedGLObjectFromMesh( MakeMeshView( ObjParser::parse( "Assets/Claw.obj" ) ) );
+
+		const GLuint white = 0xFFFFFFFFu;
+		glCreateTextures( GL_TEXTURE_2D_ARRAY, 1, &scene.texture ); // Frag_ZH.frag samples the material layer of an array
+		glTextureStorage3D( scene.texture, 1, GL_RGBA8, 1, 1, 1 );
+		glTextureSubImage3D( scene.texture, 0, 0, 0, 0, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &white );
+		glCreateSamplers( 1, &scene.sampler );
+
+		// CMyApp::Render: ocean bottom and surface, 5 pufferfish, the sub with its arm and two claws
+		scene.draws.push_back( { &scene.quad, 0, glm::translate( glm::vec3( 0, -150, 0 ) ) * glm::scale( glm::vec3( 1000 ) ) * glm::rotate( glm::half_pi<float>(), glm::vec3( 1, 0, 0 ) ) } );
+		scene.draws.push_back( { &scene.quad, 2, glm::scale( glm::vec3( 1000 ) ) * glm::rotate( glm::half_pi<float>(), glm::vec3( 1, 0, 0 ) ) } );
+		for ( int i = 0; i < 5; ++i )
+		{
+			const float angle = glm::two_pi<float>() * i / 5;
+			scene.draws.push_back( { &scene.pufferFish, 1, glm::translate( glm::vec3( 100 * std::cos( angle ), -140 + 130 * i / 5, 100 * std::sin( angle ) ) ) } );
+		}
+		const glm::mat4 sub = glm::translate( glm::vec3( 0, -140, 0 ) );
+		const glm::mat4 arm = sub * glm::translate( glm::vec3( 18.75, -3.75, 0. ) );
+		scene.draws.push_back( { &scene.sub, 1, sub } );
+		scene.draws.push_back( { &scene.arm, 1, arm } );
+		scene.draws.push_back( { &scene.claw, 1, arm * glm::translate( glm::vec3( 9, 0, 1.75 ) ) * glm::rotate( glm::pi<float>(), glm::vec3( 1, 0, 0 ) ) } );
+		scene.draws.push_back( { &scene.claw, 1, arm * glm::translate( glm::vec3( 9, 0, -1.75 ) ) } );
+	}
+
+	void CleanScene( Scene& scene )
+	{
+		for ( OGLObject* object : { &scene.quad, &scene.pufferFish, &scene.sub, &scene.arm, &scene.claw } ) CleanOGLObject( *object );
+		glDeleteTextures( 1, &scene.texture );
+		glDeleteSamplers( 1, &scene.sampler );
+	}
+
+	GLuint CreateProgram( const char* vertexShader, const char* fragmentShader )
+	{
+		GLuint programID = glCreateProgram();
+		AttachShader( programID, GL_VERTEX_SHADER, vertexShader );
+		AttachShader( programID, GL_FRAGMENT_SHADER, fragmentShader );
+		LinkProgram( programID );
+		return programID;
+	}
+
+	void DrawObject( const Scene& scene, const OGLObject& gpu )
+	{
+		COUNTED_GL( glBindVertexArray( gpu.vaoID ) );
+		COUNTED_GL( glBindTextureUnit( 0, scene.texture ) );
+		COUNTED_GL( glBindSampler( 0, scene.sampler ) );
+		COUNTED_GL( glDrawElements( GL_TRIANGLES, gpu.count, GL_UNSIGNED_INT, nullptr ) );
+		COUNTED_GL( glBindTextureUnit( 0, 0 ) );
+		COUNTED_GL( glBindSampler( 0, 0 ) );
+		COUNTED_GL( glBindVertexArray( 0 ) );
+	}
+
+	// The frame as it was: every Draw sets every common uniform again, each with a location query.
+	void RenderLegacyFrame( const Scene& scene, GLuint programID )
+	{
+		int currentState = -1;
+		for ( const SceneDraw& draw : scene.draws )
+		{
+			if ( draw.state != currentState )
+			{
+				COUNTED_GL( glProgramUniform1i( programID, CountedUl( programID, "state" ), draw.state ) );
+				currentState = draw.state;
+			}
+
+			// SetCommonUniforms
+			COUNTED_GL( glProgramUniformMatrix4fv( programID, CountedUl( programID, "viewProj" ), 1, GL_FALSE, glm::value_ptr( scene.viewProj ) ) );
+			COUNTED_GL( glProgramUniform3fv( programID, CountedUl( programID, "cameraPos" ), 1, glm::value_ptr( scene.cameraPos ) ) );
+			COUNTED_GL( glProgramUniform4fv( programID, CountedUl( programID, "lightPos" ), 1, glm::value_ptr( scene.lightPos ) ) );
+			COUNTED_GL( glProgramUniform4fv( programID, CountedUl( programID, "lightPos2" ), 1, glm::value_ptr( scene.lightPos2 ) ) );
+			COUNTED_GL( glProgramUniform3fv( programID, CountedUl( programID, "La" ), 1, glm::value_ptr( scene.La ) ) );
+			COUNTED_GL( glProgramUniform3fv( programID, CountedUl( programID, "Ld" ), 1, glm::value_ptr( scene.Ld ) ) );
+			COUNTED_GL( glProgramUniform3fv( programID, CountedUl( programID, "Ls" ), 1, glm::value_ptr( scene.Ls ) ) );
+			COUNTED_GL( glProgramUniform1f( programID, CountedUl( programID, "lightConstantAttenuation" ), 1.0f ) );
+			COUNTED_GL( glProgramUniform1f( programID, CountedUl( programID, "lightLinearAttenuation" ), 0.0f ) );
+			COUNTED_GL( glProgramUniform1f( programID, CountedUl( programID, "lightQuadraticAttenuation" ), 0.0f ) );
+			COUNTED_GL( glProgramUniform3fv( programID, CountedUl( programID, "cameraPos" ), 1, glm::value_ptr( scene.cameraPos ) ) );
+			COUNTED_GL( glProgramUniform1f( programID, CountedUl( programID, "m_ElapsedTimeInSec" ), scene.elapsedTimeInSec ) );
+
+			COUNTED_GL( glUseProgram( programID ) );
+			COUNTED_GL( glProgramUniformMatrix4fv( programID, CountedUl( programID, "world" ), 1, GL_FALSE, glm::value_ptr( draw.world ) ) );
+			COUNTED_GL( glProgramUniformMatrix4fv( programID, CountedUl( programID, "worldIT" ), 1, GL_FALSE, glm::value_ptr( glm::transpose( glm::inverse( draw.world ) ) ) ) );
+			COUNTED_GL( glProgramUniformMatrix4fv( programID, CountedUl( programID, "dequant" ), 1, GL_FALSE, glm::value_ptr( draw.gpu->dequantization ) ) );
+			COUNTED_GL( glProgramUniform1i( programID, CountedUl( programID, "texImage" ), 0 ) );
+			DrawObject( scene, *draw.gpu );
+		}
+		// RenderGUI
+		COUNTED_GL( glProgramUniform1i( programID, CountedUl( programID, "enableRedLight" ), 1 ) );
+	}
+
+	struct UniformBuffers
+	{
+		GLuint frameBuffer = 0;
+		GLuint objectBuffer = 0;
+		GLsizeiptr slotStride = 0;
+		GLuint slotCount = 64;
+	};
+
+	// The current CMyApp frame: one FrameUniforms upload, one ObjectUniforms slot per draw.
+	void RenderUniformBufferFrame( const Scene& scene, GLuint programID, const UniformBuffers& buffers )
+	{
+		FrameUniforms frame = {};
+		frame.viewProj = scene.viewProj;
+		frame.cameraPos = scene.cameraPos;
+		frame.elapsedTimeInSec = scene.elapsedTimeInSec;
+		frame.lightPos = scene.lightPos;
+		frame.lightPos2 = scene.lightPos2;
+		frame.La = scene.La;
+		frame.Ld = scene.Ld;
+		frame.Ls = scene.Ls;
+		frame.lightConstantAttenuation = 1.0f;
+		frame.enableRedLight = 1;
+
+		COUNTED_GL( glNamedBufferSubData( buffers.frameBuffer, 0, sizeof( FrameUniforms ), &frame ) );
+		COUNTED_GL( glBindBufferBase( GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, buffers.frameBuffer ) );
+		COUNTED_GL( glNamedBufferData( buffers.objectBuffer, buffers.slotStride * buffers.slotCount, nullptr, GL_STREAM_DRAW ) );
+		COUNTED_GL( glUseProgram( programID ) );
+
+		int currentState = -1;
+		GLuint slot = 0;
+		for ( const SceneDraw& draw : scene.draws )
+		{
+			if ( draw.state != currentState )
+			{
+				COUNTED_GL( glProgramUniform1i( programID, CountedUl( programID, "state" ), draw.state ) );
+				currentState = draw.state;
+			}
+
+			ObjectUniforms object;
+			object.world = draw.world;
+			object.worldIT = glm::transpose( glm::inverse( draw.world ) );
+			object.dequant = draw.gpu->dequantization;
+
+			const GLintptr slotOffset = buffers.slotStride * slot++;
+			COUNTED_GL( glNamedBufferSubData( buffers.objectBuffer, slotOffset, sizeof( ObjectUniforms ), &object ) );
+			COUNTED_GL( glBindBufferRange( GL_UNIFORM_BUFFER, OBJECT_UNIFORM_BINDING, buffers.objectBuffer, slotOffset, sizeof( ObjectUniforms ) ) );
+			DrawObject( scene, *draw.gpu );
+		}
+	}
+}
+
+BENCHMARK( UniformBuffers, "CMyApp scene: per-draw glProgramUniform calls vs per-frame/per-object uniform buffers (GL calls, CPU frame time)" )
+{
+	constexpr int FRAMES = 200;
+	constexpr int REPEAT = 5;
+
+	// small target: the fill rate is not what is measured
+	Bench::GLContext context( 64, 64 );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	Scene scene;
+	InitScene( scene );
+
+	const GLuint legacyProgram = CreateProgram( "bench/Shaders/Legacy_PosNormTex.vert", "bench/Shaders/Legacy_ZH.frag" );
+	const GLuint uniformBufferProgram = CreateProgram( "Shaders/Vert_PosNormTex.vert", "Shaders/Frag_ZH.frag" );
+
+	UniformBuffers buffers;
+	glCreateBuffers( 1, &buffers.frameBuffer );
+	glNamedBufferStorage( buffers.frameBuffer, sizeof( FrameUniforms ), nullptr, GL_DYNAMIC_STORAGE_BIT );
+	buffers.slotStride = UniformSlotStride( sizeof( ObjectUniforms ) );
+	glCreateBuffers( 1, &buffers.objectBuffer );
+	glNamedBufferData( buffers.objectBuffer, buffers.slotStride * buffers.slotCount, nullptr, GL_STREAM_DRAW );
+
+	std::printf( "%zu draws per frame, %d frames\n", scene.draws.size(), FRAMES );
+	std::printf( "%-24s %14s %20s %20s\n", "method", "GL calls/frame", "CPU submit [us/frame]", "with GPU [us/frame]" );
+
+	auto run = [ & ]( const char* name, auto&& renderFrame )
+	{
+		s_glCalls = 0;
+		renderFrame();
+		const std::size_t callsPerFrame = s_glCalls;
+		glFinish();
+
+		// CPU cost of issuing the frame: the GPU work is only waited for after all frames
+		double submitUs = 0.0, totalUs = 0.0;
+		std::vector<double> submitTimes;
+		totalUs = Bench::MedianMs( REPEAT, [ & ]()
+		{
+			double submitMs = 0.0;
+			for ( int f = 0; f < FRAMES; ++f )
+			{
+				glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+				const Bench::Clock::time_point start = Bench::Clock::now();
+				renderFrame();
+				submitMs += Bench::ElapsedMs( start, Bench::Clock::now() );
+				context.Swap();
+			}
+			glFinish();
+			submitTimes.push_back( submitMs );
+		} ) * 1000.0 / FRAMES;
+		std::sort( submitTimes.begin(), submitTimes.end() );
+		submitUs = submitTimes[ submitTimes.size() / 2 ] * 1000.0 / FRAMES;
+
+		std::printf( "%-24s %14zu %20.1f %20.1f\n", name, callsPerFrame, submitUs, totalUs );
+	};
+
+	run( "glProgramUniform/draw", [ & ]() { RenderLegacyFrame( scene, legacyProgram ); } );
+	run( "uniform buffers", [ & ]() { RenderUniformBufferFrame( scene, uniformBufferProgram, buffers ); } );
+
+	glDeleteBuffers( 1, &buffers.frameBuffer );
+	glDeleteBuffers( 1, &buffers.objectBuffer );
+	glDeleteProgram( legacyProgram );
+	glDeleteProgram( uniformBufferProgram );
+	CleanScene( scene );
+}
@@ -0,0 +1,61 @@
+#include "Bench.h"
+#include "BenchGL.h"
+
+#include "GLUtils.hpp"
+#include "ShaderProgram.h"
+
+#include <cstdio>
+
+// Uniform location lookup: glGetUniformLocation (ul( programID, name )), the GL_CURRENT_PROGRAM variant (ul( name ))
+// and the table ShaderProgram reflects at link time (ul( program, name )).
+
+BENCHMARK( UniformLocations, "Uniform location lookup: glGetUniformLocation vs the ShaderProgram table" )
+{
+	constexpr int LOOKUPS = 100000;
+	constexpr int REPEAT = 7;
+
+	Bench::GLContext context( 64, 64 );
+	if ( !context )
+	{
+		std::printf( "skipped, no OpenGL context\n" );
+		return;
+	}
+
+	ShaderProgram program;
+	program.Create();
+	program.AttachShader( GL_VERTEX_SHADER, "Shaders/Vert_PosNormTex.vert" );
+	program.AttachShader( GL_FRAGMENT_SHADER, "Shaders/Frag_ZH.frag" );
+	program.Link();
+	glUseProgram( program.ID() );
+
+	std::printf( "%zu active uniforms with a location, %d lookups of \"state\"\n", program.UniformCount(), LOOKUPS );
+
+	if ( ul( program, "state" ) != ul( program.ID(), "state" ) || ul( program, "notAUniform" ) != -1 )
+	{
+		std::printf( "location mismatch!\n" );
+		return;
+	}
+
+	const GLuint programID = program.ID();
+	GLint sink = 0;
+	const double glMs = Bench::MedianMs( REPEAT, [ & ]()
+	{
+		for ( int i = 0; i < LOOKUPS; ++i ) sink += ul( programID, "state" );
+	} );
+	const double currentProgramMs = Bench::MedianMs( REPEAT, [ & ]()
+	{
+		for ( int i = 0; i < LOOKUPS; ++i ) sink += ul( "state" );
+	} );
+	const double tableMs = Bench::MedianMs( REPEAT, [ & ]()
+	{
+		for ( int i = 0; i < LOOKUPS; ++i ) sink += ul( program, "state" );
+	} );
+	Bench::DoNotOptimize( sink );
+
+	std::printf( "%-32s %12s\n", "method", "ns/lookup" );
+	std::printf( "%-32s %12.1f\n", "glGetUniformLocation", glMs * 1e6 / LOOKUPS );
+	std::printf( "%-32s %12.1f\n", "GL_CURRENT_PROGRAM + glGet...", currentProgramMs * 1e6 / LOOKUPS );
+	std::printf( "%-32s %12.1f\n", "ShaderProgram table", tableMs * 1e6 / LOOKUPS );
+
+	glUseProgram( 0 );
+}
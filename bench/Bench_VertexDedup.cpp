@@ -0,0 +1,200 @@
+#include "Bench.h"
+
+#include "BenchObj.h"
+#include "IndexedVertTable.h"
+
+#include <cstdlib>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// Hash of the former std::unordered_map based deduplication, it only mixed vt and vn.
+	struct PreviousIndexedVertHash
+	{
+		std::size_t operator()( const IndexedVert& iv ) const noexcept
+		{
+			return static_cast<std::size_t>( fasthash64( iv.vt, iv.vn_64 ) );
+		}
+	};
+
+	// Counts the live and peak bytes of the containers using it.
+	struct AllocationCounter
+	{
+		static inline std::size_t currentBytes = 0;
+		static inline std::size_t peakBytes = 0;
+
+		static void Reset() { currentBytes = peakBytes = 0; }
+	};
+
+	template <typename T>
+	struct CountingAllocator
+	{
+		using value_type = T;
+
+		CountingAllocator() = default;
+		template <typename U> CountingAllocator( const CountingAllocator<U>& ) noexcept {}
+
+		T* allocate( std::size_t n )
+		{
+			AllocationCounter::currentBytes += n * sizeof( T );
+			AllocationCounter::peakBytes = std::max( AllocationCounter::peakBytes, AllocationCounter::currentBytes );
+			return static_cast<T*>( ::operator new( n * sizeof( T ) ) );
+		}
+
+		void deallocate( T* ptr, std::size_t n ) noexcept
+		{
+			AllocationCounter::currentBytes -= n * sizeof( T );
+			::operator delete( ptr );
+		}
+
+		template <typename U> bool operator==( const CountingAllocator<U>& ) const noexcept { return true; }
+		template <typename U> bool operator!=( const CountingAllocator<U>& ) const noexcept { return false; }
+	};
+
+	template <typename Hash>
+	using CountedMap = std::unordered_map<IndexedVert, unsigned int, Hash, std::equal_to<IndexedVert>, CountingAllocator<std::pair<const IndexedVert, unsigned int>>>;
+
+	IndexedVert Corner( uint32_t v, uint32_t vt, uint32_t vn )
+	{
+		IndexedVert corner;
+		corner.v = v;
+		corner.vt = vt;
+		corner.vn = vn;
+		return corner;
+	}
+
+	// Triangulated corner stream of a gridSize x gridSize grid, like ObjParser produces it
+	enum class CornerKind
+	{
+		SAME_INDICES,     // f 1/1/1 ... (exported with merged attributes)
+		COMPUTED_NORMALS, // f 1/1 ... every triangle gets its own normal
+		SPLIT_INDICES,    // f 1/3/2 ... the three indices differ
+	};
+
+	std::vector<IndexedVert> MakeCorners( unsigned int gridSize, CornerKind kind )
+	{
+		std::vector<IndexedVert> corners;
+		corners.reserve( std::size_t( gridSize - 1 ) * ( gridSize - 1 ) * 6 );
+
+		const uint32_t vertexCount = gridSize * gridSize;
+		uint32_t triangle = 0;
+		auto add = [ & ]( uint32_t i0, uint32_t i1, uint32_t i2 )
+		{
+			for ( uint32_t i : { i0, i1, i2 } )
+			{
+				switch ( kind )
+				{
+					case CornerKind::SAME_INDICES:     corners.push_back( Corner( i, i, i ) ); break;
+					case CornerKind::COMPUTED_NORMALS: corners.push_back( Corner( i, i, triangle ) ); break;
+					case CornerKind::SPLIT_INDICES:    corners.push_back( Corner( i, vertexCount - 1 - i, ( i * 7 ) % vertexCount ) ); break;
+				}
+			}
+			++triangle;
+		};
+
+		for ( uint32_t y = 0; y + 1 < gridSize; ++y )
+		{
+			for ( uint32_t x = 0; x + 1 < gridSize; ++x )
+			{
+				const uint32_t i0 = y * gridSize + x, i1 = i0 + 1, i2 = i0 + gridSize + 1, i3 = i0 + gridSize;
+				add( i0, i3, i2 );
+				add( i0, i2, i1 );
+			}
+		}
+		return corners;
+	}
+
+	struct DedupResult
+	{
+		std::vector<unsigned int> indices;
+		std::size_t vertexCount = 0;
+		std::size_t peakBytes = 0;
+	};
+
+	template <typename Hash>
+	void DedupUnorderedMap( const std::vector<IndexedVert>& corners, DedupResult& result )
+	{
+		AllocationCounter::Reset();
+		{
+			CountedMap<Hash> vertexIndices;
+			for ( const IndexedVert& corner : corners )
+			{
+				auto [ it, inserted ] = vertexIndices.try_emplace( corner, static_cast<unsigned int>( result.vertexCount ) );
+				if ( inserted ) ++result.vertexCount;
+				result.indices.push_back( it->second );
+			}
+		}
+		result.peakBytes = AllocationCounter::peakBytes;
+	}
+
+	void DedupFlat( const std::vector<IndexedVert>& corners, std::size_t positionCount, bool useDirect, DedupResult& result )
+	{
+		IndexedVertTable vertexIndices( positionCount );
+		DirectIndexedVertTable directVertexIndices;
+		if ( useDirect ) directVertexIndices.Resize( positionCount );
+
+		for ( const IndexedVert& corner : corners )
+		{
+			const unsigned int newIndex = static_cast<unsigned int>( result.vertexCount );
+			auto [ index, inserted ] = directVertexIndices.CanStore( corner ) ? directVertexIndices.TryEmplace( corner, newIndex )
+																			 : vertexIndices.TryEmplace( corner, newIndex );
+			if ( inserted ) ++result.vertexCount;
+			result.indices.push_back( index );
+		}
+		result.peakBytes = vertexIndices.MemoryBytes() + directVertexIndices.MemoryBytes();
+	}
+}
+
+BENCHMARK( VertexDedup, "ObjParser vertex deduplication: std::unordered_map vs flat open addressing table vs direct index" )
+{
+	constexpr int REPEAT = 3;
+	constexpr unsigned int GRID_SIZE = 700;
+
+	const struct { CornerKind kind; const char* name; } inputs[] =
+	{
+		{ CornerKind::SAME_INDICES, "v/vt/vn, same indices" },
+		{ CornerKind::COMPUTED_NORMALS, "v/vt, computed normals" },
+		{ CornerKind::SPLIT_INDICES, "v/vt/vn, different indices" },
+	};
+
+	for ( const auto& input : inputs )
+	{
+		const std::vector<IndexedVert> corners = MakeCorners( GRID_SIZE, input.kind );
+		const std::size_t positionCount = std::size_t( GRID_SIZE ) * GRID_SIZE;
+
+		std::printf( "%s: %zu corners\n", input.name, corners.size() );
+		std::printf( "%-36s %10s %12s %10s %14s %10s\n", "method", "time [ms]", "Mcorners/s", "vertices", "peak mem [MB]", "identical" );
+
+		DedupResult reference;
+		auto run = [ & ]( const char* name, auto&& dedup )
+		{
+			DedupResult result;
+			const double ms = Bench::MedianMs( REPEAT, [ & ]()
+			{
+				result = DedupResult();
+				result.indices.reserve( corners.size() );
+				dedup( result );
+			} );
+			if ( reference.indices.empty() ) reference = result;
+
+			std::printf( "%-36s %10.1f %12.1f %10zu %14.1f %10s\n", name, ms, corners.size() / ( ms * 1000.0 ), result.vertexCount,
+						 result.peakBytes / ( 1024.0 * 1024.0 ), result.indices == reference.indices ? "yes" : "NO" );
+		};
+
+		run( "unordered_map, previous hash (vt,vn)", [ & ]( DedupResult& r ) { DedupUnorderedMap<PreviousIndexedVertHash>( corners, r ); } );
+		run( "unordered_map, IndexedVertHash", [ & ]( DedupResult& r ) { DedupUnorderedMap<IndexedVertHash>( corners, r ); } );
+		run( "IndexedVertTable", [ & ]( DedupResult& r ) { DedupFlat( corners, positionCount, false, r ); } );
+		run( "IndexedVertTable + direct index", [ & ]( DedupResult& r ) { DedupFlat( corners, positionCount, true, r ); } );
+	}
+
+	// the whole parser for reference
+	for ( bool withNormals : { true, false } )
+	{
+		const std::filesystem::path fileName = Bench::WriteSyntheticObj( GRID_SIZE, withNormals );
+		const double fileMB = std::filesystem::file_size( fileName ) / ( 1024.0 * 1024.0 );
+		const double ms = Bench::MedianMs( REPEAT, [ & ]() { Bench::DoNotOptimize( ObjParser::parse( fileName ) ); } );
+		std::printf( "ObjParser::parse %s: %.1f ms (%.1f MB/s)\n", fileName.filename().string().c_str(), ms, fileMB / ( ms / 1000.0 ) );
+	}
+}
@@ -0,0 +1,60 @@
+#include "Bench.h"
+
+#include "ObjParser.h"
+#include "VertexQuantization.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const char* const s_assets[] = { "Assets/Arm.obj", "Assets/sub.obj", "Assets/Claw.obj", "Assets/PufferFish.obj" };
+}
+
+BENCHMARK( VertexQuantization, "Vertex buffer size and decoding error of the 16 byte quantized vertex format" )
+{
+	constexpr int REPEAT = 7;
+
+	std::printf( "%-24s %10s %10s %10s %12s %14s %12s %12s\n",
+				 "asset", "vertices", "float [KB]", "quant [KB]", "encode [ms]", "pos err [%diag]", "normal [deg]", "uv err" );
+
+	for ( const char* asset : s_assets )
+	{
+		const ObjParser::Mesh mesh = ObjParser::parse( asset );
+		const MeshView<Vertex> view = MakeMeshView( mesh );
+
+		QuantizedMesh quantized;
+		const double encodeMs = Bench::MedianMs( REPEAT, [ & ]() { quantized = QuantizeMesh( view ); } );
+
+		glm::vec3 aabbMin( mesh.vertexArray[ 0 ].position ), aabbMax( aabbMin );
+		for ( const Vertex& v : mesh.vertexArray )
+		{
+			aabbMin = glm::min( aabbMin, v.position );
+			aabbMax = glm::max( aabbMax, v.position );
+		}
+		const float diagonal = glm::length( aabbMax - aabbMin );
+
+		float maxPositionError = 0.0f, maxNormalAngle = 0.0f, maxTexcoordError = 0.0f;
+		for ( std::size_t i = 0; i < mesh.vertexArray.size(); ++i )
+		{
+			const Vertex& original = mesh.vertexArray[ i ];
+			const Vertex decoded = DequantizeVertex( quantized.mesh.vertexArray[ i ], quantized.dequantization );
+
+			maxPositionError = std::max( maxPositionError, glm::length( decoded.position - original.position ) );
+
+			const float originalLength = glm::length( original.normal ), decodedLength = glm::length( decoded.normal );
+			if ( originalLength > 0.0f && decodedLength > 0.0f )
+			{
+				const float cosAngle = glm::clamp( glm::dot( original.normal / originalLength, decoded.normal / decodedLength ), -1.0f, 1.0f );
+				maxNormalAngle = std::max( maxNormalAngle, glm::degrees( std::acos( cosAngle ) ) );
+			}
+
+			maxTexcoordError = std::max( { maxTexcoordError, std::abs( decoded.texcoord.x - original.texcoord.x ),
+															 std::abs( decoded.texcoord.y - original.texcoord.y ) } );
+		}
+
+		std::printf( "%-24s %10zu %10.1f %10.1f %12.3f %14.5f %12.3f %12.6f\n", asset, mesh.vertexArray.size(),
+					 mesh.vertexArray.size() * sizeof( Vertex ) / 1024.0, quantized.mesh.vertexArray.size() * sizeof( VertexQuantized ) / 1024.0,
+					 encodeMs, diagonal > 0.0f ? 100.0f * maxPositionError / diagonal : 0.0f, maxNormalAngle, maxTexcoordError );
+	}
+}
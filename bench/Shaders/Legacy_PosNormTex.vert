@@ -0,0 +1,28 @@
+#version 430
+
+// VBO-ból érkező változók
+layout( location = 0 ) in vec3 vs_in_pos;
+layout( location = 1 ) in vec3 vs_in_norm;
+layout( location = 2 ) in vec2 vs_in_tex;
+
+// a pipeline-ban tovább adandó értékek
+out vec3 vs_out_pos;
+out vec3 vs_out_norm;
+out vec2 vs_out_tex;
+
+// shader külső paraméterei - most a három transzformációs mátrixot külön-külön vesszük át
+uniform mat4 world;
+uniform mat4 worldIT;
+uniform mat4 viewProj;
+// kvantált (VertexQuantized) pozíciók visszaalakítása modell térbe, float vertexeknél egységmátrix
+uniform mat4 dequant = mat4( 1 );
+
+void main()
+{
+	vec4 pos = dequant * vec4( vs_in_pos, 1 );
+	gl_Position = viewProj * world * pos;
+	vs_out_pos  = (world   * pos).xyz;
+	vs_out_norm = (worldIT * vec4(vs_in_norm, 0)).xyz;
+
+	vs_out_tex = vs_in_tex;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "BindlessMaterials.h"
+
+#include "UniformBlocks.h"
+
+#include <algorithm>
+
+#include <SDL2/SDL_log.h>
+
+BindlessMaterials::~BindlessMaterials()
+{
+	Clean();
+}
+
+bool BindlessMaterials::IsSupported()
+{
+	return GLEW_ARB_bindless_texture;
+}
+
+bool BindlessMaterials::Init( GLsizei materialCount )
+{
+	Clean();
+	if ( !IsSupported() ) return false;
+
+	m_handles.assign( materialCount, 0 );
+	glCreateBuffers( 1, &m_bufferID );
+	glNamedBufferStorage( m_bufferID, m_handles.size() * sizeof( GLuint64 ), m_handles.data(), GL_DYNAMIC_STORAGE_BIT );
+	return true;
+}
+
+void BindlessMaterials::Clean()
+{
+	for ( GLuint64 handle : m_resident ) glMakeTextureHandleNonResidentARB( handle );
+	m_resident.clear();
+	m_handles.clear();
+	glDeleteBuffers( 1, &m_bufferID );
+	m_bufferID = 0;
+}
+
+bool BindlessMaterials::SetTexture( GLsizei material, GLuint textureID, GLuint samplerID )
+{
+	if ( m_bufferID == 0 ) return false;
+
+	// the same texture + sampler gives the same handle: the materials of a TextureArray share one
+	const GLuint64 handle = glGetTextureSamplerHandleARB( textureID, samplerID );
+	if ( handle == 0 )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_WARN,
+						"[BindlessMaterials] No handle for texture %u, material %d stays on the bound texture", textureID, material );
+		return false;
+	}
+	if ( std::find( m_resident.cbegin(), m_resident.cend(), handle ) == m_resident.cend() )
+	{
+		glMakeTextureHandleResidentARB( handle );
+		m_resident.push_back( handle );
+	}
+
+	m_handles[ material ] = handle;
+	glNamedBufferSubData( m_bufferID, material * sizeof( GLuint64 ), sizeof( GLuint64 ), &handle );
+	return true;
+}
+
+void BindlessMaterials::Bind() const
+{
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, MATERIAL_STORAGE_BINDING, m_bufferID );
+}
+
+bool BindlessMaterials::IsResident() const noexcept
+{
+	return !m_handles.empty() && std::find( m_handles.cbegin(), m_handles.cend(), GLuint64( 0 ) ) == m_handles.cend();
+}
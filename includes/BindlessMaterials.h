@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+// The material textures through GL_ARB_bindless_texture: one 64-bit texture + sampler handle per material in a
+// storage buffer (layout( std430, binding = MATERIAL_STORAGE_BINDING ) readonly buffer MaterialTextures of
+// Frag_ZH.frag, compiled with BINDLESS), so the draws need no glBindTextureUnit / glBindSampler.
+//
+// A handle freezes the state of its texture and sampler (no more glTextureParameter, e.g. GL_TEXTURE_BASE_LEVEL),
+// so SetTexture belongs after the texture is complete: after TextureLoader has streamed every level. Until then the
+// entry of the material is 0 and the shader samples the bound texture instead. Without the extension Init returns
+// false, every entry stays 0 and the binding path is the only one (e.g. Mesa llvmpipe).
+class BindlessMaterials
+{
+public:
+	BindlessMaterials() = default;
+	~BindlessMaterials();
+
+	BindlessMaterials( const BindlessMaterials& ) = delete;
+	BindlessMaterials& operator=( const BindlessMaterials& ) = delete;
+
+	static bool IsSupported();
+
+	// The storage buffer of materialCount entries, all 0. False if the extension is missing.
+	bool Init( GLsizei materialCount );
+	// Makes the handles non-resident, the textures and samplers are not deleted.
+	void Clean();
+
+	// The handle of texture + sampler made resident (once per pair) and written into the entry of material.
+	// False if the driver gave no handle (e.g. incomplete texture), the material keeps the binding path then.
+	bool SetTexture( GLsizei material, GLuint textureID, GLuint samplerID );
+
+	void Bind() const;
+
+	// Every material samples through its handle: the texture unit does not have to be bound.
+	bool IsResident() const noexcept;
+	inline GLuint BufferID() const noexcept { return m_bufferID; }
+	inline GLsizei MaterialCount() const noexcept { return static_cast<GLsizei>( m_handles.size() ); }
+
+private:
+	GLuint m_bufferID = 0;
+	std::vector<GLuint64> m_handles;  // per material, 0 until set
+	std::vector<GLuint64> m_resident; // distinct handles made resident
+};
@@ -0,0 +1,105 @@
+#include "FrameTiming.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+TimingSummary SummarizeTimings( std::vector<double> samplesMs )
+{
+	TimingSummary summary;
+	if ( samplesMs.empty() ) return summary;
+
+	std::sort( samplesMs.begin(), samplesMs.end() );
+	const std::size_t count = samplesMs.size();
+	summary.count  = count;
+	summary.min    = samplesMs.front();
+	summary.median = count % 2 == 1 ? samplesMs[ count / 2 ] : 0.5 * ( samplesMs[ count / 2 - 1 ] + samplesMs[ count / 2 ] );
+	summary.p99    = samplesMs[ static_cast<std::size_t>( std::ceil( 0.99 * count ) ) - 1 ];
+	summary.max    = samplesMs.back();
+	summary.mean   = std::accumulate( samplesMs.begin(), samplesMs.end(), 0.0 ) / count;
+	return summary;
+}
+
+FixedTimestep::FixedTimestep( double stepInSec, double maxFrameTimeInSec )
+	: m_stepInSec( stepInSec )
+	, m_maxFrameTimeInSec( maxFrameTimeInSec )
+{
+}
+
+void FixedTimestep::Advance( double frameTimeInSec )
+{
+	m_accumulator += std::clamp( frameTimeInSec, 0.0, m_maxFrameTimeInSec );
+}
+
+bool FixedTimestep::Step()
+{
+	if ( m_accumulator < m_stepInSec ) return false;
+	m_accumulator -= m_stepInSec;
+	m_simulationTime += m_stepInSec;
+	return true;
+}
+
+GPUFrameTimer::~GPUFrameTimer()
+{
+	Clean();
+}
+
+void GPUFrameTimer::Init( std::size_t framesInFlight )
+{
+	Clean();
+	m_slots.resize( std::max<std::size_t>( framesInFlight, 1 ) );
+	for ( Slot& slot : m_slots ) glCreateQueries( GL_TIME_ELAPSED, 1, &slot.query );
+}
+
+void GPUFrameTimer::Clean()
+{
+	for ( Slot& slot : m_slots ) glDeleteQueries( 1, &slot.query );
+	m_slots.clear();
+	m_next = 0;
+	m_samplesMs.clear();
+}
+
+void GPUFrameTimer::Begin()
+{
+	Slot& slot = m_slots[ m_next ];
+	if ( slot.pending )
+	{
+		// the ring is full: collect what is ready, then wait for the oldest frame
+		Collect( false );
+		if ( slot.pending ) Read( slot, true );
+	}
+	glBeginQuery( GL_TIME_ELAPSED, slot.query );
+}
+
+void GPUFrameTimer::End()
+{
+	glEndQuery( GL_TIME_ELAPSED );
+	m_slots[ m_next ].pending = true;
+	m_next = ( m_next + 1 ) % m_slots.size();
+}
+
+void GPUFrameTimer::Collect( bool wait )
+{
+	// oldest first: m_next is the slot written the longest time ago
+	for ( std::size_t i = 0; i < m_slots.size(); ++i )
+	{
+		Slot& slot = m_slots[ ( m_next + i ) % m_slots.size() ];
+		if ( slot.pending && !Read( slot, wait ) ) return;
+	}
+}
+
+bool GPUFrameTimer::Read( Slot& slot, bool wait )
+{
+	if ( !wait )
+	{
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv( slot.query, GL_QUERY_RESULT_AVAILABLE, &available );
+		if ( available == GL_FALSE ) return false;
+	}
+
+	GLuint64 elapsedNs = 0;
+	glGetQueryObjectui64v( slot.query, GL_QUERY_RESULT, &elapsedNs );
+	m_samplesMs.push_back( static_cast<double>( elapsedNs ) * 1e-6 );
+	slot.pending = false;
+	return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <GL/glew.h>
+
+// Statistics of a series of frame times in milliseconds; all zero for an empty series.
+struct TimingSummary
+{
+	std::size_t count = 0;
+	double min = 0.0;
+	double median = 0.0;
+	double p99 = 0.0; // nearest rank
+	double max = 0.0;
+	double mean = 0.0;
+};
+
+TimingSummary SummarizeTimings( std::vector<double> samplesMs );
+
+// Fixed timestep simulation driven by variable frame times (double precision seconds).
+//
+// Advance adds the frame time to an accumulator; Step then returns true once for every whole step in it, and the
+// caller simulates one step of StepInSec() for each. What is left over is less than one step: Interpolation() is
+// that fraction, the renderer blends the state before the last step (0) with the state after it (1), so the rendered
+// moment, RenderTime(), lags the simulation by at most one step but moves smoothly at any frame rate. A frame time
+// longer than maxFrameTimeInSec is clamped (breakpoint, window drag): the simulation slows down instead of having to
+// catch up with a burst of steps.
+class FixedTimestep
+{
+public:
+	explicit FixedTimestep( double stepInSec, double maxFrameTimeInSec = 0.25 );
+
+	void Advance( double frameTimeInSec );
+	bool Step();
+
+	inline double StepInSec() const noexcept { return m_stepInSec; }
+	// the time after the last step
+	inline double SimulationTime() const noexcept { return m_simulationTime; }
+	inline float Interpolation() const noexcept { return static_cast<float>( m_accumulator / m_stepInSec ); }
+	// before the first step both states are the initial one, the time does not go below 0 then
+	inline double RenderTime() const noexcept { return std::max( m_simulationTime - m_stepInSec + m_accumulator, 0.0 ); }
+
+private:
+	double m_stepInSec;
+	double m_maxFrameTimeInSec;
+	double m_accumulator = 0.0;
+	double m_simulationTime = 0.0;
+};
+
+// GPU time of frames: a ring of GL_TIME_ELAPSED queries, one per frame between Begin and End.
+//
+// The results are read back frames later, so measuring does not stall the pipeline. When every query of the ring is
+// still in flight, Begin waits for the oldest one: the ring size is also the number of frames the CPU may run ahead of
+// the GPU, which bounds an uncapped loop without a swap. Only one GL_TIME_ELAPSED query may be active at a time, the
+// frame must not begin another one.
+class GPUFrameTimer
+{
+public:
+	GPUFrameTimer() = default;
+	~GPUFrameTimer();
+
+	GPUFrameTimer( const GPUFrameTimer& ) = delete;
+	GPUFrameTimer& operator=( const GPUFrameTimer& ) = delete;
+
+	void Init( std::size_t framesInFlight );
+	void Clean();
+
+	void Begin();
+	void End();
+
+	// Reads the finished queries in frame order; with wait it waits for all of them (after the last frame).
+	void Collect( bool wait );
+
+	// One entry per collected frame, in frame order.
+	inline const std::vector<double>& SamplesMs() const noexcept { return m_samplesMs; }
+
+private:
+	struct Slot
+	{
+		GLuint query = 0;
+		bool   pending = false;
+	};
+
+	// false if the result is not available yet and wait is not set
+	bool Read( Slot& slot, bool wait );
+
+	std::vector<Slot>   m_slots;
+	std::size_t         m_next = 0; // the slot of the next Begin, also the oldest pending one
+	std::vector<double> m_samplesMs;
+};
@@ -13,7 +13,7 @@ Az http://www.opengl-tutorial.org/ oldal alapján.
 
 */
 
-static void loadShaderCode( std::string& shaderCode, const std::filesystem::path& _fileName )
+void loadShaderCode( std::string& shaderCode, const std::filesystem::path& _fileName )
 {
 	// shaderkod betoltese _fileName fajlbol
 	shaderCode = "";
@@ -48,6 +48,14 @@ GLuint AttachShader( const GLuint programID, GLenum shaderType, const std::files
 }
 
 GLuint AttachShaderCode( const GLuint programID, GLenum shaderType, std::string_view shaderCode )
+{
+	GLuint shaderID = AttachShaderCodeDeferred( programID, shaderType, shaderCode );
+	if ( shaderID != 0 ) CheckShaderCompileStatus( shaderID );
+
+	return shaderID;
+}
+
+GLuint AttachShaderCodeDeferred( const GLuint programID, GLenum shaderType, std::string_view shaderCode )
 {
 	if (programID == 0)
 	{
@@ -67,8 +75,17 @@ GLuint AttachShaderCode( const GLuint programID, GLenum shaderType, std::string_
 	glShaderSource( shaderID, 1, &sourcePointer, &sourceLength );
 
 	// shader leforditasa
+	// (a statuszt itt nem kerdezzuk le: az megvarna a forditast, KHR_parallel_shader_compile mellett az a hatterben fut)
 	glCompileShader( shaderID );
 
+	// shader hozzarendelese a programhoz
+	glAttachShader( programID, shaderID );
+
+	return shaderID;
+}
+
+bool CheckShaderCompileStatus( const GLuint shaderID )
+{
 	// ellenorizzuk, h minden rendben van-e
 	GLint result = GL_FALSE;
 	int infoLogLength;
@@ -88,11 +105,7 @@ GLuint AttachShaderCode( const GLuint programID, GLenum shaderType, std::string_
 						"[glCompileShader]: %s", ErrorMessage.data() );
 	}
 
-	// shader hozzarendelese a programhoz
-	glAttachShader( programID, shaderID );
-
-	return shaderID;
-
+	return result != GL_FALSE;
 }
 
 void LinkProgram( const GLuint programID, bool OwnShaders )
@@ -100,6 +113,16 @@ void LinkProgram( const GLuint programID, bool OwnShaders )
 	// illesszük össze a shadereket (kimenő-bemenő változók összerendelése stb.)
 	glLinkProgram( programID );
 
+	CheckProgramLinkStatus( programID );
+
+	if ( OwnShaders )
+	{
+		DeleteAttachedShaders( programID );
+	}
+}
+
+bool CheckProgramLinkStatus( const GLuint programID )
+{
 	// linkeles ellenorzese
 	GLint infoLogLength = 0, result = 0;
 
@@ -114,29 +137,41 @@ void LinkProgram( const GLuint programID, bool OwnShaders )
 						"[glLinkProgram]: %s", ErrorMessage.data() );
 	}
 
+	return result != GL_FALSE;
+}
+
+void DeleteAttachedShaders( const GLuint programID )
+{
 	// Ebben az esetben a program objektumhoz tartozik a shader objektum.
 	// Vagyis a shader objektumokat ki tudjuk "törölni".
     // Szabvány szerint (https://registry.khronos.org/OpenGL-Refpages/gl4/html/glDeleteShader.xhtml)
     // a shader objektumok csak akkor törlődnek, ha nincsennek hozzárendelve egyetlen program objektumhoz sem.
 	// Vagyis mikor a program objektumot töröljük, akkor törlődnek a shader objektumok is.
-	if ( OwnShaders )
-	{
-		// kerjuk le a program objektumhoz tartozó shader objektumokat, ...
-        GLint attachedShaders = 0;
-        glGetProgramiv( programID, GL_ATTACHED_SHADERS, &attachedShaders );
-        std::vector<GLuint> shaders( attachedShaders );
 
-        glGetAttachedShaders( programID, attachedShaders, nullptr, shaders.data() );
+	// kerjuk le a program objektumhoz tartozó shader objektumokat, ...
+	GLint attachedShaders = 0;
+	glGetProgramiv( programID, GL_ATTACHED_SHADERS, &attachedShaders );
+	std::vector<GLuint> shaders( attachedShaders );
 
-        // ... es "toroljuk" oket
-        for ( GLuint shader : shaders )
-        {
-            glDeleteShader( shader );
-        }
+	glGetAttachedShaders( programID, attachedShaders, nullptr, shaders.data() );
 
+	// ... es "toroljuk" oket
+	for ( GLuint shader : shaders )
+	{
+		glDeleteShader( shader );
 	}
 }
 
+bool EnableParallelShaderCompile()
+{
+	// KHR_parallel_shader_compile: a driver annyi szalon fordit, amennyin tud (0xFFFFFFFF), a glCompileShader / glLinkProgram
+	// pedig nem var; a GL_COMPLETION_STATUS_KHR lekerdezes megmondja, kesz-e mar
+	if ( !GLEW_KHR_parallel_shader_compile ) return false;
+
+	glMaxShaderCompilerThreadsKHR( 0xFFFFFFFF );
+	return true;
+}
+
 static inline ImageRGBA::TexelRGBA* get_image_row( ImageRGBA& image, int rowIndex )
 {
 	return &image.texelData[  rowIndex * image.width ];
@@ -89,12 +89,39 @@ struct MeshObject
     std::vector<GLuint>  indexArray;
 };
 
+// Nem birtokló nézet egy mesh adataira (pl. memóriába mappelt cache fájlra),
+// így a feltöltéshez nem kell std::vector-okba másolni.
+template<typename VertexT>
+struct MeshView
+{
+    const VertexT* vertexData  = nullptr;
+    std::size_t    vertexCount = 0;
+    const GLuint*  indexData   = nullptr;
+    std::size_t    indexCount  = 0;
+};
+
+template<typename VertexT>
+[[nodiscard]] MeshView<VertexT> MakeMeshView( const MeshObject<VertexT>& mesh ) noexcept
+{
+    return { mesh.vertexArray.data(), mesh.vertexArray.size(), mesh.indexArray.data(), mesh.indexArray.size() };
+}
+
+// Befoglaló térfogatok modell térben (láthatósági vizsgálatokhoz, lásd GPUCulling.h)
+struct MeshBounds
+{
+    glm::vec3 aabbMin      = glm::vec3( 0.0f );
+    glm::vec3 aabbMax      = glm::vec3( 0.0f );
+    glm::vec3 sphereCenter = glm::vec3( 0.0f );
+    float     sphereRadius = 0.0f;
+};
+
 struct OGLObject
 {
     GLuint  vaoID = 0; // vertex array object erőforrás azonosító
     GLuint  vboID = 0; // vertex buffer object erőforrás azonosító
     GLuint  iboID = 0; // index buffer object erőforrás azonosító
     GLsizei count = 0; // mennyi indexet/vertexet kell rajzolnunk
+    glm::mat4 dequantization = glm::mat4( 1.0f ); // kvantált pozíciók visszaalakítása a shaderben (lásd VertexQuantization.h)
 };
 
 
@@ -104,17 +131,27 @@ struct VertexAttributeDescriptor
     GLuint strideInBytes = 0;
 	GLint  numberOfComponents = 0;
 	GLenum glType = GL_NONE;
+	GLboolean normalized = GL_FALSE; // egész típusoknál: [0,1] / [-1,1] tartományra képezze-e le
 };
 
 // Segéd függvények
 
+void loadShaderCode( std::string& shaderCode, const std::filesystem::path& _fileName );
 GLuint AttachShader( const GLuint programID, GLenum shaderType, const std::filesystem::path& _fileName );
 GLuint AttachShaderCode( const GLuint programID, GLenum shaderType, std::string_view shaderCode );
 void LinkProgram( const GLuint programID, bool OwnShaders = true );
 
+// Elhalasztott forditas: a statusz lekerdezese (ami a forditas vegere var) a Check* fuggvenyekkel kesobb.
+GLuint AttachShaderCodeDeferred( const GLuint programID, GLenum shaderType, std::string_view shaderCode );
+bool CheckShaderCompileStatus( const GLuint shaderID );
+bool CheckProgramLinkStatus( const GLuint programID );
+void DeleteAttachedShaders( const GLuint programID );
+// true, ha van KHR_parallel_shader_compile (es be is kapcsoltuk)
+bool EnableParallelShaderCompile();
+
 
 template <typename VertexT>
-[[nodiscard]] OGLObject CreateGLObjectFromMesh( const MeshObject<VertexT>& mesh, std::initializer_list<VertexAttributeDescriptor> vertexAttrDescList )
+[[nodiscard]] OGLObject CreateGLObjectFromMesh( const MeshView<VertexT>& mesh, std::initializer_list<VertexAttributeDescriptor> vertexAttrDescList )
 {
 	OGLObject meshGPU = { 0 };
 
@@ -124,16 +161,16 @@ template <typename VertexT>
 
 	// töltsük fel adatokkal a VBO-t
 	glNamedBufferData(meshGPU.vboID,	// a VBO-ba töltsünk adatokat
-					   mesh.vertexArray.size() * sizeof(VertexT),		// ennyi bájt nagyságban
-					   mesh.vertexArray.data(),	// erről a rendszermemóriabeli címről olvasva
+					   mesh.vertexCount * sizeof(VertexT),		// ennyi bájt nagyságban
+					   mesh.vertexData,	// erről a rendszermemóriabeli címről olvasva
 					   GL_STATIC_DRAW);	// úgy, hogy a VBO-nkba nem tervezünk ezután írni és minden kirajzoláskor felhasnzáljuk a benne lévő adatokat
 
 	// index puffer létrehozása
 	glCreateBuffers(1, &meshGPU.iboID);
 	//glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshGPU.iboID);
-	glNamedBufferData(meshGPU.iboID, mesh.indexArray.size() * sizeof(GLuint), mesh.indexArray.data(), GL_STATIC_DRAW);
+	glNamedBufferData(meshGPU.iboID, mesh.indexCount * sizeof(GLuint), mesh.indexData, GL_STATIC_DRAW);
 
-	meshGPU.count = static_cast<GLsizei>(mesh.indexArray.size());
+	meshGPU.count = static_cast<GLsizei>(mesh.indexCount);
 
 	// 1 db VAO foglalasa
 	glCreateVertexArrays(1, &meshGPU.vaoID);
@@ -152,7 +189,7 @@ template <typename VertexT>
 			vertexAttrDesc.index,				  // a VB-ben található adatok közül a soron következő "indexű" attribútumait állítjuk be
 			vertexAttrDesc.numberOfComponents,	  // komponens szam
 			vertexAttrDesc.glType,				  // adatok tipusa
-			GL_FALSE,							  // normalizalt legyen-e
+			vertexAttrDesc.normalized,			  // normalizalt legyen-e
 			vertexAttrDesc.strideInBytes       // az attribútum hol kezdődik a sizeof(VertexT)-nyi területen belül
 		);
 	}
@@ -161,6 +198,12 @@ template <typename VertexT>
 	return meshGPU;
 }
 
+template <typename VertexT>
+[[nodiscard]] OGLObject CreateGLObjectFromMesh( const MeshObject<VertexT>& mesh, std::initializer_list<VertexAttributeDescriptor> vertexAttrDescList )
+{
+	return CreateGLObjectFromMesh( MakeMeshView( mesh ), vertexAttrDescList );
+}
+
 void CleanOGLObject( OGLObject& ObjectGPU );
 
 [[nodiscard]] ImageRGBA ImageFromFile( const std::filesystem::path& fileName, bool needsFlip = true );
@@ -0,0 +1,175 @@
+#include "GPUCulling.h"
+
+#include "UniformBlocks.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/type_ptr.hpp>
+
+std::array<glm::vec4, 6> ExtractFrustumPlanes( const glm::mat4& viewProj ) noexcept
+{
+	// rows of the matrix (glm is column major)
+	const glm::vec4 row0( viewProj[ 0 ][ 0 ], viewProj[ 1 ][ 0 ], viewProj[ 2 ][ 0 ], viewProj[ 3 ][ 0 ] );
+	const glm::vec4 row1( viewProj[ 0 ][ 1 ], viewProj[ 1 ][ 1 ], viewProj[ 2 ][ 1 ], viewProj[ 3 ][ 1 ] );
+	const glm::vec4 row2( viewProj[ 0 ][ 2 ], viewProj[ 1 ][ 2 ], viewProj[ 2 ][ 2 ], viewProj[ 3 ][ 2 ] );
+	const glm::vec4 row3( viewProj[ 0 ][ 3 ], viewProj[ 1 ][ 3 ], viewProj[ 2 ][ 3 ], viewProj[ 3 ][ 3 ] );
+
+	std::array<glm::vec4, 6> planes = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+
+	// normalized, so the plane distance of a sphere center can be compared to its radius
+	for ( glm::vec4& plane : planes ) plane /= glm::length( glm::vec3( plane ) );
+
+	return planes;
+}
+
+void GPUCulling::Init()
+{
+	m_cullProgram.Create();
+	m_cullProgram.AttachShader( GL_COMPUTE_SHADER, "Shaders/Comp_Cull.comp" );
+	m_cullProgram.Link();
+
+	m_depthPyramidProgram.Create();
+	m_depthPyramidProgram.AttachShader( GL_COMPUTE_SHADER, "Shaders/Comp_DepthPyramid.comp" );
+	m_depthPyramidProgram.Link();
+
+	glCreateSamplers( 1, &m_depthSamplerID );
+	glSamplerParameteri( m_depthSamplerID, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST );
+	glSamplerParameteri( m_depthSamplerID, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+	glSamplerParameteri( m_depthSamplerID, GL_TEXTURE_COMPARE_MODE, GL_NONE );
+
+	glCreateBuffers( 1, &m_statsBufferID );
+	glNamedBufferStorage( m_statsBufferID, sizeof( Stats ), nullptr, GL_DYNAMIC_STORAGE_BIT );
+
+	// the counters are copied here and read a few frames later, so Cull never waits for the GPU
+	const GLbitfield readbackFlags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCreateBuffers( 1, &m_statsReadbackBufferID );
+	glNamedBufferStorage( m_statsReadbackBufferID, sizeof( Stats ), nullptr, readbackFlags | GL_CLIENT_STORAGE_BIT );
+	m_statsReadback = static_cast<const Stats*>( glMapNamedBufferRange( m_statsReadbackBufferID, 0, sizeof( Stats ), readbackFlags ) );
+}
+
+void GPUCulling::Clean()
+{
+	if ( m_statsFence ) glDeleteSync( m_statsFence );
+	m_statsFence = nullptr;
+	if ( m_statsReadback ) glUnmapNamedBuffer( m_statsReadbackBufferID );
+	m_statsReadback = nullptr;
+
+	glDeleteBuffers( 1, &m_statsBufferID );
+	glDeleteBuffers( 1, &m_statsReadbackBufferID );
+	glDeleteSamplers( 1, &m_depthSamplerID );
+	glDeleteTextures( 1, &m_depthPyramidTextureID );
+	m_statsBufferID = m_statsReadbackBufferID = m_depthSamplerID = m_depthPyramidTextureID = 0;
+	m_depthPyramidValid = false;
+
+	m_cullProgram.Destroy();
+	m_depthPyramidProgram.Destroy();
+}
+
+void GPUCulling::Resize( int width, int height )
+{
+	glDeleteTextures( 1, &m_depthPyramidTextureID );
+	m_depthPyramidTextureID = 0;
+	m_depthPyramidValid = false;
+	if ( width <= 0 || height <= 0 ) return;
+
+	m_depthPyramidSize = glm::ivec2( width, height );
+	m_depthPyramidLevels = 1 + static_cast<GLint>( std::floor( std::log2( static_cast<float>( std::max( width, height ) ) ) ) );
+
+	glCreateTextures( GL_TEXTURE_2D, 1, &m_depthPyramidTextureID );
+	glTextureStorage2D( m_depthPyramidTextureID, m_depthPyramidLevels, GL_R32F, width, height );
+}
+
+void GPUCulling::Cull( const Settings& settings, const glm::mat4& viewProj, GLuint recordCount,
+					   GLuint drawDataBuffer, GLuint cullRecordBuffer, GLuint commandBuffer, GLuint visibleRecordBuffer )
+{
+	ReadBackStats();
+
+	glClearNamedBufferData( m_statsBufferID, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr );
+
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, DRAW_DATA_STORAGE_BINDING, drawDataBuffer );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, CULL_RECORD_STORAGE_BINDING, cullRecordBuffer );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, DRAW_COMMAND_STORAGE_BINDING, commandBuffer );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, VISIBLE_RECORD_STORAGE_BINDING, visibleRecordBuffer );
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, CULL_STATS_STORAGE_BINDING, m_statsBufferID );
+
+	const bool occlusionCulling = settings.occlusionCulling && m_depthPyramidValid;
+	if ( occlusionCulling )
+	{
+		glBindTextureUnit( 1, m_depthPyramidTextureID );
+		glBindSampler( 1, m_depthSamplerID );
+	}
+
+	const std::array<glm::vec4, 6> frustumPlanes = ExtractFrustumPlanes( viewProj );
+	const GLuint programID = m_cullProgram.ID();
+	glProgramUniform1ui( programID, ul( m_cullProgram, "recordCount" ), recordCount );
+	glProgramUniform4fv( programID, ul( m_cullProgram, "frustumPlanes" ), 6, glm::value_ptr( frustumPlanes[ 0 ] ) );
+	glProgramUniform1i( programID, ul( m_cullProgram, "frustumCulling" ), settings.frustumCulling );
+	glProgramUniform1i( programID, ul( m_cullProgram, "occlusionCulling" ), occlusionCulling );
+	glProgramUniformMatrix4fv( programID, ul( m_cullProgram, "depthViewProj" ), 1, GL_FALSE, glm::value_ptr( m_depthViewProj ) );
+	glProgramUniform2f( programID, ul( m_cullProgram, "depthPyramidSize" ), static_cast<float>( m_depthPyramidSize.x ), static_cast<float>( m_depthPyramidSize.y ) );
+	glProgramUniform1i( programID, ul( m_cullProgram, "depthPyramidMaxLevel" ), m_depthPyramidLevels - 1 );
+
+	glUseProgram( programID );
+	glDispatchCompute( ( recordCount + 63 ) / 64, 1, 1 );
+	glUseProgram( 0 );
+
+	if ( occlusionCulling )
+	{
+		glBindTextureUnit( 1, 0 );
+		glBindSampler( 1, 0 );
+	}
+
+	// the commands are read by the indirect draw, the visible list by the vertex shader
+	glMemoryBarrier( GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT );
+
+	if ( m_statsFence == nullptr && m_statsReadback != nullptr )
+	{
+		glCopyNamedBufferSubData( m_statsBufferID, m_statsReadbackBufferID, 0, 0, sizeof( Stats ) );
+		m_statsFence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+	}
+}
+
+void GPUCulling::ReadBackStats()
+{
+	if ( m_statsFence == nullptr ) return;
+
+	// not finished yet: the previous numbers stay, no new copy is started until this one arrives
+	const GLenum status = glClientWaitSync( m_statsFence, 0, 0 );
+	if ( status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED ) return;
+
+	m_stats = *m_statsReadback;
+	glDeleteSync( m_statsFence );
+	m_statsFence = nullptr;
+}
+
+void GPUCulling::BuildDepthPyramid( GLuint depthTexture, const glm::mat4& viewProj )
+{
+	if ( m_depthPyramidTextureID == 0 ) return;
+
+	const GLuint programID = m_depthPyramidProgram.ID();
+	glUseProgram( programID );
+	glBindSampler( 0, m_depthSamplerID );
+
+	glm::ivec2 levelSize = m_depthPyramidSize;
+	for ( GLint level = 0; level < m_depthPyramidLevels; ++level )
+	{
+		// level 0 is a copy of the depth texture, every other one reduces the level above it
+		glBindTextureUnit( 0, level == 0 ? depthTexture : m_depthPyramidTextureID );
+		glProgramUniform1i( programID, ul( m_depthPyramidProgram, "sourceLevel" ), level == 0 ? 0 : level - 1 );
+		glBindImageTexture( 0, m_depthPyramidTextureID, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F );
+
+		glDispatchCompute( ( levelSize.x + 7 ) / 8, ( levelSize.y + 7 ) / 8, 1 );
+		glMemoryBarrier( GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
+
+		levelSize = glm::max( levelSize / 2, glm::ivec2( 1 ) );
+	}
+
+	glBindImageTexture( 0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F );
+	glBindTextureUnit( 0, 0 );
+	glBindSampler( 0, 0 );
+	glUseProgram( 0 );
+
+	m_depthViewProj = viewProj;
+	m_depthPyramidValid = true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "ShaderProgram.h"
+
+// The 6 planes (xyz: inward normal, w: distance) of the view frustum of a view-projection matrix (Gribb-Hartmann).
+// A point p is inside when dot( plane.xyz, p ) + plane.w >= 0 for all of them.
+std::array<glm::vec4, 6> ExtractFrustumPlanes( const glm::mat4& viewProj ) noexcept;
+
+// GPU visibility culling of the records of an indirectly drawn scene (Shaders/Comp_Cull.comp).
+//
+// Every record (DrawData + CullRecord, see UniformBlocks.h) is tested against the view frustum and against a
+// hierarchical depth (Hi-Z) pyramid of the previous frame. The visible ones are appended to the instance range of
+// their command: instanceCount is counted up from 0 and the record index goes to
+// visibleRecords[ command.baseInstance + slot ], so the commands have to be uploaded with instanceCount = 0 and with
+// disjoint baseInstance ranges. The vertex shader reads the record through the visible list.
+//
+// The depth pyramid is built from the depth texture of the frame (BuildDepthPyramid) with a max reduction per level,
+// the occlusion test uses it with the view-projection of that frame. Objects that were hidden in the previous frame
+// and got uncovered by a fast camera move may pop in one frame late.
+class GPUCulling
+{
+public:
+	struct Settings
+	{
+		bool frustumCulling = true;
+		bool occlusionCulling = true;
+	};
+
+	struct Stats
+	{
+		GLuint visible = 0;
+		GLuint frustumCulled = 0;
+		GLuint occlusionCulled = 0;
+	};
+
+	GPUCulling() = default;
+	~GPUCulling() = default;
+
+	GPUCulling( const GPUCulling& ) = delete;
+	GPUCulling& operator=( const GPUCulling& ) = delete;
+
+	void Init();
+	void Clean();
+
+	// (Re)creates the depth pyramid for a width x height depth buffer, the first frame after it culls nothing by occlusion.
+	void Resize( int width, int height );
+
+	// Culls recordCount records. The buffers are bound to the storage bindings of UniformBlocks.h,
+	// visibleRecordBuffer needs room for recordCount indices. Ends with the barriers needed by the indirect draw.
+	void Cull( const Settings& settings, const glm::mat4& viewProj, GLuint recordCount,
+			   GLuint drawDataBuffer, GLuint cullRecordBuffer, GLuint commandBuffer, GLuint visibleRecordBuffer );
+
+	// Max reduction of the depth texture (the frame just rendered with viewProj) into the pyramid for the next Cull.
+	void BuildDepthPyramid( GLuint depthTexture, const glm::mat4& viewProj );
+
+	// The counts of a previous Cull, read back without waiting for the GPU (a few frames behind).
+	inline const Stats& LastStats() const noexcept { return m_stats; }
+
+private:
+	void ReadBackStats();
+
+	ShaderProgram m_cullProgram;
+	ShaderProgram m_depthPyramidProgram;
+
+	GLuint m_depthPyramidTextureID = 0;
+	GLuint m_depthSamplerID = 0;
+	glm::ivec2 m_depthPyramidSize = glm::ivec2( 0 );
+	GLint m_depthPyramidLevels = 0;
+	glm::mat4 m_depthViewProj = glm::mat4( 1.0f );
+	bool m_depthPyramidValid = false;
+
+	GLuint m_statsBufferID = 0;
+	GLuint m_statsReadbackBufferID = 0;
+	const Stats* m_statsReadback = nullptr; // persistently mapped
+	GLsync m_statsFence = nullptr;
+	Stats m_stats;
+};
@@ -0,0 +1,130 @@
+#include "HeadlessContext.h"
+
+#include <GL/glew.h>
+
+#ifdef ZH_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+
+namespace
+{
+	bool HasClientExtension( const char* name )
+	{
+		// EGL_EXT_client_extensions: queried on EGL_NO_DISPLAY, null if not supported
+		const char* extensions = eglQueryString( EGL_NO_DISPLAY, EGL_EXTENSIONS );
+		return extensions != nullptr && std::strstr( extensions, name ) != nullptr;
+	}
+
+	EGLDisplay OpenDisplay()
+	{
+		if ( HasClientExtension( "EGL_MESA_platform_surfaceless" ) && HasClientExtension( "EGL_EXT_platform_base" ) )
+		{
+			auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>( eglGetProcAddress( "eglGetPlatformDisplayEXT" ) );
+			if ( getPlatformDisplay != nullptr )
+			{
+				EGLDisplay display = getPlatformDisplay( EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr );
+				if ( display != EGL_NO_DISPLAY ) return display;
+			}
+		}
+		return eglGetDisplay( EGL_DEFAULT_DISPLAY );
+	}
+}
+#endif
+
+HeadlessContext::~HeadlessContext()
+{
+	Clean();
+}
+
+bool HeadlessContext::IsAvailable() noexcept
+{
+#ifdef ZH_HAS_EGL
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool HeadlessContext::Init( bool debugContext )
+{
+	Clean();
+#ifdef ZH_HAS_EGL
+	EGLDisplay display = OpenDisplay();
+	EGLint major = 0, minor = 0;
+	if ( display == EGL_NO_DISPLAY || !eglInitialize( display, &major, &minor ) )
+	{
+		m_error = "no EGL display";
+		return false;
+	}
+	m_display = display;
+
+	if ( !eglBindAPI( EGL_OPENGL_API ) )
+	{
+		m_error = "eglBindAPI(EGL_OPENGL_API) failed";
+		Clean();
+		return false;
+	}
+
+	// no surface is created, the config only has to allow desktop GL
+	const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config = nullptr;
+	EGLint configCount = 0;
+	eglChooseConfig( display, configAttributes, &config, 1, &configCount );
+
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 4,
+		EGL_CONTEXT_MINOR_VERSION, 5,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_CONTEXT_OPENGL_DEBUG, debugContext ? EGL_TRUE : EGL_FALSE,
+		EGL_NONE,
+	};
+	// EGL_KHR_no_config_context: without a matching config the context can still be created
+	EGLContext context = eglCreateContext( display, configCount > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes );
+	if ( context == EGL_NO_CONTEXT )
+	{
+		m_error = "eglCreateContext failed (OpenGL 4.5 core)";
+		Clean();
+		return false;
+	}
+	m_context = context;
+
+	if ( !eglMakeCurrent( display, EGL_NO_SURFACE, EGL_NO_SURFACE, context ) )
+	{
+		m_error = "eglMakeCurrent without a surface failed (EGL_KHR_surfaceless_context)";
+		Clean();
+		return false;
+	}
+
+	glewExperimental = GL_TRUE;
+	if ( glewContextInit() != GLEW_OK )
+	{
+		m_error = "glewContextInit failed";
+		Clean();
+		return false;
+	}
+	// glewContextInit may leave GL_INVALID_ENUM behind (glGetString( GL_EXTENSIONS ) in a core context)
+	while ( glGetError() != GL_NO_ERROR ) {}
+
+	m_error = "";
+	return true;
+#else
+	(void)debugContext;
+	m_error = "built without EGL";
+	return false;
+#endif
+}
+
+void HeadlessContext::Clean()
+{
+#ifdef ZH_HAS_EGL
+	if ( m_display != nullptr )
+	{
+		eglMakeCurrent( m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+		if ( m_context != nullptr ) eglDestroyContext( m_display, m_context );
+		eglTerminate( m_display );
+	}
+#endif
+	m_display = nullptr;
+	m_context = nullptr;
+}
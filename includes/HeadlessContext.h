@@ -0,0 +1,32 @@
+#pragma once
+
+// OpenGL 4.5 core context without a window: EGL with EGL_MESA_platform_surfaceless (falls back to the default EGL
+// display), made current with no surface. Nothing is presented, the caller renders into its own framebuffer objects;
+// framebuffer 0 is incomplete. With Mesa it runs on llvmpipe when there is no GPU (LIBGL_ALWAYS_SOFTWARE=1 forces it).
+//
+// Only built with EGL (ZH_HAS_EGL, set by CMakeLists.txt when OpenGL::EGL is found); otherwise Init always fails.
+// GLEW is initialized with glewContextInit: a GLEW built for GLX fails in glewInit without an X display, the GL entry
+// points themselves are the same.
+class HeadlessContext
+{
+public:
+	HeadlessContext() = default;
+	~HeadlessContext();
+
+	HeadlessContext( const HeadlessContext& ) = delete;
+	HeadlessContext& operator=( const HeadlessContext& ) = delete;
+
+	// False if no context could be created or made current; Error() tells why.
+	bool Init( bool debugContext = false );
+	void Clean();
+
+	inline const char* Error() const noexcept { return m_error; }
+	explicit operator bool() const noexcept { return m_context != nullptr; }
+
+	static bool IsAvailable() noexcept;
+
+private:
+	void* m_display = nullptr; // EGLDisplay
+	void* m_context = nullptr; // EGLContext
+	const char* m_error = "not initialized";
+};
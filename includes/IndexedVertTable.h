@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// Vertex deduplication of the .obj parser: a face corner is a v/vt/vn index triple,
+// every distinct triple becomes one vertex of the mesh.
+
+struct IndexedVert
+{
+	union
+	{
+		struct
+		{
+			uint32_t v,vt;
+		};
+		uint64_t v_vt = 0Ul;
+	}; 
+
+	union
+	{
+		struct
+		{
+			uint32_t dummy;
+			uint32_t vn;
+		};
+		uint64_t vn_64 = 0Ul;
+	}; 
+	
+	inline bool operator==( const IndexedVert& other ) const
+	{
+		return this->v_vt == other.v_vt && this->vn == other.vn;
+	}
+
+	// Corners like "7/7/7" can be deduplicated with an array indexed by v, without hashing.
+	inline bool IsDirectIndexable() const noexcept
+	{
+		return v == vt && v == vn;
+	}
+};
+
+// version of fasthash64 https://github.com/ztanml/fast-hash
+// simplified for using only for 1 64 bit data (seed is the other one).
+
+inline constexpr uint64_t fasthash64_mix(uint64_t h)
+{
+	h ^= h >> 23;
+	h *= 0x2127599bf4325c37ULL;
+	h ^= h >> 47;
+	return h;
+}
+
+inline constexpr uint64_t fasthash64( uint64_t v, uint64_t seed )
+{
+	constexpr uint64_t    m = 0x880355f21e6d1965ULL;
+	constexpr uint64_t    m_size = m * sizeof(uint64_t);
+	constexpr uint64_t    m_p2 = m * m;
+
+	uint64_t h = seed ^ m_size;
+	h ^= fasthash64_mix(v);
+	h *= m_p2;
+
+	return fasthash64_mix(h);
+}
+
+// Full fasthash64 over a byte buffer: the content hash of the cache files (.obj meshes, program binaries).
+inline uint64_t fasthash64( const void* buf, std::size_t len, uint64_t seed )
+{
+	constexpr uint64_t m = 0x880355f21e6d1965ULL;
+
+	const unsigned char* pos = static_cast<const unsigned char*>( buf );
+	const unsigned char* end = pos + ( len & ~std::size_t( 7 ) );
+
+	uint64_t h = seed ^ ( len * m );
+
+	for ( ; pos != end; pos += 8 )
+	{
+		uint64_t v;
+		std::memcpy( &v, pos, sizeof( v ) );
+		h ^= fasthash64_mix( v );
+		h *= m;
+	}
+
+	if ( len & 7 )
+	{
+		uint64_t v = 0;
+		for ( std::size_t i = 0; i < ( len & 7 ); ++i )
+		{
+			v ^= static_cast<uint64_t>( pos[ i ] ) << ( 8 * i );
+		}
+		h ^= fasthash64_mix( v );
+		h *= m;
+	}
+
+	return fasthash64_mix( h );
+}
+
+struct IndexedVertHash
+{
+	inline std::size_t operator()( const IndexedVert& iv ) const noexcept
+	{
+		return static_cast<std::size_t>( fasthash64( iv.v_vt, iv.vn ) );
+	}
+};
+
+// Open addressing (linear probing) hash table from IndexedVert to vertex index.
+// The slots are stored in one flat array, no allocation happens per vertex.
+class IndexedVertTable
+{
+public:
+	IndexedVertTable() = default;
+	explicit IndexedVertTable( std::size_t expectedCount ) { Reserve( expectedCount ); }
+
+	// Sizes the table, so expectedCount vertices fit without rehashing.
+	// The slots are only allocated by the first insertion, an unused table costs no memory.
+	void Reserve( std::size_t expectedCount )
+	{
+		m_expectedCount = std::max( m_expectedCount, expectedCount );
+		if ( !m_slots.empty() && CapacityFor( m_expectedCount ) > m_slots.size() ) Rehash( CapacityFor( m_expectedCount ) );
+	}
+
+	// Returns the index of the vertex and true, if it was not in the table yet (then its index is newIndex).
+	inline std::pair<unsigned int, bool> TryEmplace( const IndexedVert& key, unsigned int newIndex )
+	{
+		if ( ( m_count + 1 ) * MAX_LOAD_DEN > m_slots.size() * MAX_LOAD_NUM ) Rehash( std::max( m_slots.size() * 2, CapacityFor( m_expectedCount ) ) );
+
+		for ( std::size_t i = IndexedVertHash()( key ) & m_mask; ; i = ( i + 1 ) & m_mask )
+		{
+			Slot& slot = m_slots[ i ];
+			if ( slot.indexPlusOne == 0 )
+			{
+				slot.v_vt = key.v_vt;
+				slot.vn = key.vn;
+				slot.indexPlusOne = newIndex + 1;
+				++m_count;
+				return { newIndex, true };
+			}
+			if ( slot.v_vt == key.v_vt && slot.vn == key.vn ) return { slot.indexPlusOne - 1, false };
+		}
+	}
+
+	inline std::size_t Size() const noexcept { return m_count; }
+	inline std::size_t MemoryBytes() const noexcept { return m_slots.capacity() * sizeof( Slot ); }
+
+private:
+	struct Slot
+	{
+		uint64_t v_vt;
+		uint32_t vn;
+		uint32_t indexPlusOne; // 0: empty slot
+	};
+
+	// rehash above 3/4 load
+	static constexpr std::size_t MAX_LOAD_NUM = 3;
+	static constexpr std::size_t MAX_LOAD_DEN = 4;
+	static constexpr std::size_t MIN_CAPACITY = 64;
+
+	static std::size_t CapacityFor( std::size_t count )
+	{
+		std::size_t capacity = MIN_CAPACITY;
+		while ( capacity * MAX_LOAD_NUM < count * MAX_LOAD_DEN ) capacity *= 2;
+		return capacity;
+	}
+
+	void Rehash( std::size_t capacity )
+	{
+		std::vector<Slot> oldSlots( capacity, Slot{ 0, 0, 0 } );
+		oldSlots.swap( m_slots );
+		m_mask = capacity - 1;
+
+		for ( const Slot& old : oldSlots )
+		{
+			if ( old.indexPlusOne == 0 ) continue;
+
+			IndexedVert key;
+			key.v_vt = old.v_vt;
+			key.vn = old.vn;
+			std::size_t i = IndexedVertHash()( key ) & m_mask;
+			while ( m_slots[ i ].indexPlusOne != 0 ) i = ( i + 1 ) & m_mask;
+			m_slots[ i ] = old;
+		}
+	}
+
+	std::vector<Slot> m_slots;
+	std::size_t m_mask = 0;
+	std::size_t m_count = 0;
+	std::size_t m_expectedCount = 0;
+};
+
+// Deduplication of the IsDirectIndexable() corners: the vertex index is stored at the position index.
+class DirectIndexedVertTable
+{
+public:
+	// Makes room for the corners referencing the first positionCount positions.
+	inline void Resize( std::size_t positionCount )
+	{
+		if ( positionCount > m_indexPlusOne.size() ) m_indexPlusOne.resize( positionCount, 0 );
+	}
+
+	inline bool CanStore( const IndexedVert& key ) const noexcept
+	{
+		return key.IsDirectIndexable() && key.v < m_indexPlusOne.size();
+	}
+
+	// Same as IndexedVertTable::TryEmplace, key has to be CanStore().
+	inline std::pair<unsigned int, bool> TryEmplace( const IndexedVert& key, unsigned int newIndex )
+	{
+		unsigned int& indexPlusOne = m_indexPlusOne[ key.v ];
+		if ( indexPlusOne != 0 ) return { indexPlusOne - 1, false };
+
+		indexPlusOne = newIndex + 1;
+		return { newIndex, true };
+	}
+
+	inline std::size_t MemoryBytes() const noexcept { return m_indexPlusOne.capacity() * sizeof( unsigned int ); }
+
+private:
+	std::vector<unsigned int> m_indexPlusOne;
+};
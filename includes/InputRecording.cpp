@@ -0,0 +1,248 @@
+#include "InputRecording.h"
+
+#include "MappedFile.h"
+
+#include <cstring>
+#include <fstream>
+
+// Layout: InputRecordingHeader | FrameRecord[frameCount] | EventRecord[eventCount]
+
+namespace
+{
+	constexpr char          INPUT_RECORDING_MAGIC[ 4 ] = { 'Z', 'H', 'I', 'R' };
+	constexpr std::uint32_t INPUT_RECORDING_VERSION    = 1;
+
+	struct InputRecordingHeader
+	{
+		char          magic[ 4 ];
+		std::uint32_t version;
+		std::int32_t  windowWidth;
+		std::int32_t  windowHeight;
+		std::uint32_t frameCount;
+		std::uint32_t eventCount;
+	};
+
+	struct FrameRecord
+	{
+		double        deltaTimeInSec;
+		std::uint32_t eventCount;
+		std::uint32_t reserved;
+	};
+
+	// The meaning of the fields depends on the type, see ToRecord.
+	struct EventRecord
+	{
+		std::uint32_t type;
+		std::uint32_t code;
+		std::int32_t  x;
+		std::int32_t  y;
+		std::int32_t  xrel;
+		std::int32_t  yrel;
+	};
+
+	static_assert( sizeof( InputRecordingHeader ) == 24 );
+	static_assert( sizeof( FrameRecord ) == 16 );
+	static_assert( sizeof( EventRecord ) == 24 );
+
+	bool ToRecord( const SDL_Event& event, EventRecord& record )
+	{
+		record = {};
+		record.type = event.type;
+		switch ( event.type )
+		{
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			record.code = static_cast<std::uint32_t>( event.key.keysym.sym );
+			record.x    = event.key.keysym.scancode;
+			record.y    = event.key.keysym.mod;
+			record.xrel = event.key.repeat;
+			record.yrel = event.key.state;
+			return true;
+		case SDL_MOUSEMOTION:
+			record.code = event.motion.state;
+			record.x    = event.motion.x;
+			record.y    = event.motion.y;
+			record.xrel = event.motion.xrel;
+			record.yrel = event.motion.yrel;
+			return true;
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			record.code = event.button.button | ( event.button.state << 8 ) | ( event.button.clicks << 16 );
+			record.x    = event.button.x;
+			record.y    = event.button.y;
+			return true;
+		case SDL_MOUSEWHEEL:
+			record.code = event.wheel.direction;
+			record.x    = event.wheel.x;
+			record.y    = event.wheel.y;
+			return true;
+		case SDL_WINDOWEVENT:
+			if ( event.window.event != SDL_WINDOWEVENT_SIZE_CHANGED ) return false;
+			record.code = event.window.event;
+			record.x    = event.window.data1;
+			record.y    = event.window.data2;
+			return true;
+		case SDL_QUIT:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	SDL_Event FromRecord( const EventRecord& record )
+	{
+		SDL_Event event;
+		std::memset( &event, 0, sizeof( event ) );
+		event.type = record.type;
+		switch ( record.type )
+		{
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			event.key.keysym.sym      = static_cast<SDL_Keycode>( record.code );
+			event.key.keysym.scancode = static_cast<SDL_Scancode>( record.x );
+			event.key.keysym.mod      = static_cast<Uint16>( record.y );
+			event.key.repeat          = static_cast<Uint8>( record.xrel );
+			event.key.state           = static_cast<Uint8>( record.yrel );
+			break;
+		case SDL_MOUSEMOTION:
+			event.motion.state = record.code;
+			event.motion.x     = record.x;
+			event.motion.y     = record.y;
+			event.motion.xrel  = record.xrel;
+			event.motion.yrel  = record.yrel;
+			break;
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			event.button.button = static_cast<Uint8>( record.code );
+			event.button.state  = static_cast<Uint8>( record.code >> 8 );
+			event.button.clicks = static_cast<Uint8>( record.code >> 16 );
+			event.button.x      = record.x;
+			event.button.y      = record.y;
+			break;
+		case SDL_MOUSEWHEEL:
+			event.wheel.direction = record.code;
+			event.wheel.x         = record.x;
+			event.wheel.y         = record.y;
+			event.wheel.preciseX  = static_cast<float>( record.x );
+			event.wheel.preciseY  = static_cast<float>( record.y );
+			break;
+		case SDL_WINDOWEVENT:
+			event.window.event = static_cast<Uint8>( record.code );
+			event.window.data1 = record.x;
+			event.window.data2 = record.y;
+			break;
+		default:
+			break;
+		}
+		return event;
+	}
+}
+
+void InputRecording::SetWindowSize( int width, int height ) noexcept
+{
+	m_windowWidth = width;
+	m_windowHeight = height;
+}
+
+bool InputRecording::AddEvent( const SDL_Event& event )
+{
+	EventRecord record;
+	if ( !ToRecord( event, record ) ) return false;
+
+	// stored as it will be read back, so a recording and its replay see exactly the same events
+	m_events.push_back( FromRecord( record ) );
+	return true;
+}
+
+void InputRecording::EndFrame( double deltaTimeInSec )
+{
+	const std::uint32_t eventCount = static_cast<std::uint32_t>( m_events.size() ) - m_frameFirstEvent;
+	m_frames.push_back( { deltaTimeInSec, m_frameFirstEvent, eventCount } );
+	m_frameFirstEvent = static_cast<std::uint32_t>( m_events.size() );
+}
+
+bool InputRecording::Save( const std::filesystem::path& fileName ) const
+{
+	InputRecordingHeader header = {};
+	std::memcpy( header.magic, INPUT_RECORDING_MAGIC, sizeof( header.magic ) );
+	header.version      = INPUT_RECORDING_VERSION;
+	header.windowWidth  = m_windowWidth;
+	header.windowHeight = m_windowHeight;
+	header.frameCount   = static_cast<std::uint32_t>( m_frames.size() );
+	header.eventCount   = m_frameFirstEvent; // the events of an unfinished frame are left out
+
+	std::vector<FrameRecord> frameRecords;
+	frameRecords.reserve( m_frames.size() );
+	for ( const Frame& frame : m_frames ) frameRecords.push_back( { frame.deltaTimeInSec, frame.eventCount, 0 } );
+
+	std::vector<EventRecord> eventRecords( header.eventCount );
+	for ( std::uint32_t i = 0; i < header.eventCount; ++i ) ToRecord( m_events[ i ], eventRecords[ i ] );
+
+	std::ofstream recordingStrm( fileName, std::ios::binary | std::ios::trunc );
+	recordingStrm.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+	recordingStrm.write( reinterpret_cast<const char*>( frameRecords.data() ), frameRecords.size() * sizeof( FrameRecord ) );
+	recordingStrm.write( reinterpret_cast<const char*>( eventRecords.data() ), eventRecords.size() * sizeof( EventRecord ) );
+	if ( !recordingStrm )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_ERROR,
+						"[InputRecording] Could not write %s", fileName.string().c_str() );
+		return false;
+	}
+	return true;
+}
+
+bool InputRecording::Load( const std::filesystem::path& fileName )
+{
+	MappedFile blob;
+	if ( !blob.Open( fileName ) || blob.size() < sizeof( InputRecordingHeader ) )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_ERROR,
+						"[InputRecording] Could not read %s", fileName.string().c_str() );
+		return false;
+	}
+
+	InputRecordingHeader header;
+	std::memcpy( &header, blob.data(), sizeof( header ) );
+	const std::size_t expectedSize = sizeof( InputRecordingHeader )
+		+ static_cast<std::size_t>( header.frameCount ) * sizeof( FrameRecord )
+		+ static_cast<std::size_t>( header.eventCount ) * sizeof( EventRecord );
+
+	if ( std::memcmp( header.magic, INPUT_RECORDING_MAGIC, sizeof( header.magic ) ) != 0
+		 || header.version != INPUT_RECORDING_VERSION
+		 || blob.size() != expectedSize )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_ERROR,
+						"[InputRecording] %s is not an input recording of this version", fileName.string().c_str() );
+		return false;
+	}
+
+	std::vector<FrameRecord> frameRecords( header.frameCount );
+	std::vector<EventRecord> eventRecords( header.eventCount );
+	std::memcpy( frameRecords.data(), blob.data() + sizeof( InputRecordingHeader ), frameRecords.size() * sizeof( FrameRecord ) );
+	std::memcpy( eventRecords.data(), blob.data() + sizeof( InputRecordingHeader ) + frameRecords.size() * sizeof( FrameRecord ),
+				 eventRecords.size() * sizeof( EventRecord ) );
+
+	std::vector<Frame> frames;
+	frames.reserve( frameRecords.size() );
+	std::uint32_t firstEvent = 0;
+	for ( const FrameRecord& record : frameRecords )
+	{
+		if ( record.eventCount > header.eventCount - firstEvent )
+		{
+			SDL_LogMessage( SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_ERROR,
+							"[InputRecording] %s has more events in its frames than stored", fileName.string().c_str() );
+			return false;
+		}
+		frames.push_back( { record.deltaTimeInSec, firstEvent, record.eventCount } );
+		firstEvent += record.eventCount;
+	}
+
+	m_frames = std::move( frames );
+	m_events.clear();
+	m_events.reserve( eventRecords.size() );
+	for ( const EventRecord& record : eventRecords ) m_events.push_back( FromRecord( record ) );
+	m_frameFirstEvent = firstEvent;
+	m_windowWidth = header.windowWidth;
+	m_windowHeight = header.windowHeight;
+	return true;
+}
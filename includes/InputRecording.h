@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+// The input of a session, frame by frame: the SDL events the application received and the delta time of every frame,
+// so a replay renders the same frames as the recorded session, independently of the wall clock.
+//
+// Only the events CMyApp handles are kept (keyboard, mouse, window size, quit), with the fields it reads; everything
+// else (timestamps, window and device ids, other event types) is dropped by AddEvent. On disk:
+// InputRecordingHeader | FrameRecord[frameCount] | EventRecord[eventCount] (24 bytes per event instead of the
+// 56 of SDL_Event), the events of the frames one after the other.
+class InputRecording
+{
+public:
+	struct Frame
+	{
+		double        deltaTimeInSec = 0.0;
+		std::uint32_t firstEvent = 0;
+		std::uint32_t eventCount = 0;
+	};
+
+	// The drawable size when the recording started; a replay renders at this size unless told otherwise.
+	void SetWindowSize( int width, int height ) noexcept;
+
+	// Adds the event to the current frame; false (and nothing is stored) if it is not a recorded type.
+	bool AddEvent( const SDL_Event& event );
+	// Closes the current frame: the events added since the previous EndFrame were handled before its update.
+	void EndFrame( double deltaTimeInSec );
+
+	// Both log the reason when they fail. Load replaces the content.
+	bool Save( const std::filesystem::path& fileName ) const;
+	bool Load( const std::filesystem::path& fileName );
+
+	inline std::size_t FrameCount() const noexcept { return m_frames.size(); }
+	inline const Frame& GetFrame( std::size_t frame ) const noexcept { return m_frames[ frame ]; }
+	inline const SDL_Event& Event( std::size_t index ) const noexcept { return m_events[ index ]; }
+	inline std::size_t EventCount() const noexcept { return m_events.size(); }
+	inline int WindowWidth() const noexcept { return m_windowWidth; }
+	inline int WindowHeight() const noexcept { return m_windowHeight; }
+
+private:
+	std::vector<Frame>     m_frames;
+	std::vector<SDL_Event> m_events; // the stored fields only, the rest is zero
+	std::uint32_t          m_frameFirstEvent = 0;
+	int m_windowWidth = 0;
+	int m_windowHeight = 0;
+};
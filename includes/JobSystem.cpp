@@ -0,0 +1,173 @@
+#include "JobSystem.h"
+
+namespace
+{
+	// the worker of the current thread, set by the worker threads; every other thread is worker 0
+	thread_local const JobSystem* t_jobSystem = nullptr;
+	thread_local unsigned int     t_worker = 0;
+
+	// empty FindJob rounds before an idle worker goes to sleep: a fan-out often follows the previous one shortly
+	constexpr int IDLE_SPIN_ROUNDS = 64;
+}
+
+JobSystem::JobSystem( unsigned int threadCount )
+{
+	threadCount = std::max( threadCount, 1u );
+
+	m_workers.reserve( threadCount );
+	for ( unsigned int i = 0; i < threadCount; ++i )
+	{
+		m_workers.push_back( std::make_unique<Worker>() );
+	}
+
+	m_threads.reserve( threadCount - 1 );
+	for ( unsigned int i = 1; i < threadCount; ++i )
+	{
+		m_threads.emplace_back( &JobSystem::WorkerLoop, this, i );
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	m_quit.store( true );
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+	}
+	m_wakeUp.notify_all();
+
+	for ( std::thread& thread : m_threads )
+	{
+		thread.join();
+	}
+}
+
+unsigned int JobSystem::CurrentWorker() const noexcept
+{
+	return t_jobSystem == this ? t_worker : 0;
+}
+
+JobSystem::Job* JobSystem::AllocateJob( Job* parent )
+{
+	const unsigned int workerIndex = CurrentWorker();
+	Worker& worker = *m_workers[ workerIndex ];
+
+	for ( ;; )
+	{
+		// the next finished job of the ring: unfinished ones (still queued, or parents of running jobs) are skipped
+		for ( std::size_t tried = 0; tried < JOB_RING_SIZE; ++tried )
+		{
+			Job& job = worker.jobs[ worker.nextJob++ % JOB_RING_SIZE ];
+			if ( job.unfinishedJobs.load( std::memory_order_acquire ) != 0 ) continue;
+
+			job.function = nullptr;
+			job.parent = parent;
+			job.unfinishedJobs.store( 1, std::memory_order_relaxed );
+			if ( parent != nullptr ) parent->unfinishedJobs.fetch_add( 1, std::memory_order_relaxed );
+			return &job;
+		}
+
+		// every job of this thread is unfinished: help until one of them finishes
+		if ( Job* other = FindJob( workerIndex ) )
+			Execute( *other );
+		else
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::Run( Job* job )
+{
+	// counted before it is visible, so a sleeping worker never misses it (the count is at worst too high for a moment)
+	m_queuedJobs.fetch_add( 1 );
+	if ( !m_workers[ CurrentWorker() ]->deque.Push( job ) )
+	{
+		m_queuedJobs.fetch_sub( 1 );
+		Execute( *job );
+		return;
+	}
+
+	// same handshake as SpscQueue: the sleeper announces itself before it checks m_queuedJobs under the mutex
+	if ( m_sleepers.load() > 0 )
+	{
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+		}
+		m_wakeUp.notify_one();
+	}
+}
+
+JobSystem::Job* JobSystem::FindJob( unsigned int worker )
+{
+	Job* job = nullptr;
+	if ( !m_workers[ worker ]->deque.Pop( job ) )
+	{
+		// stealing, starting from the next worker, so the thieves spread over the victims
+		const std::size_t workerCount = m_workers.size();
+		bool stolen = false;
+		for ( std::size_t i = 1; i < workerCount && !stolen; ++i )
+		{
+			stolen = m_workers[ ( worker + i ) % workerCount ]->deque.Steal( job );
+		}
+		if ( !stolen ) return nullptr;
+	}
+
+	m_queuedJobs.fetch_sub( 1 );
+	return job;
+}
+
+void JobSystem::Execute( Job& job )
+{
+	job.function( job );
+	Finish( job );
+}
+
+void JobSystem::Finish( Job& job )
+{
+	// the job can be reused as soon as its counter reaches 0: the parent has to be read before
+	Job* parent = job.parent;
+	if ( job.unfinishedJobs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 && parent != nullptr )
+	{
+		Finish( *parent );
+	}
+}
+
+void JobSystem::Wait( const Job* job )
+{
+	const unsigned int worker = CurrentWorker();
+	while ( job->unfinishedJobs.load( std::memory_order_acquire ) > 0 )
+	{
+		if ( Job* other = FindJob( worker ) )
+			Execute( *other );
+		else
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::WorkerLoop( unsigned int worker )
+{
+	t_jobSystem = this;
+	t_worker = worker;
+
+	int idleRounds = 0;
+	while ( !m_quit.load( std::memory_order_relaxed ) )
+	{
+		if ( Job* job = FindJob( worker ) )
+		{
+			Execute( *job );
+			idleRounds = 0;
+			continue;
+		}
+		if ( ++idleRounds < IDLE_SPIN_ROUNDS )
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		idleRounds = 0;
+		++m_sleepers;
+		{
+			std::unique_lock<std::mutex> lock( m_mutex );
+			m_wakeUp.wait( lock, [ this ]() { return m_quit.load() || m_queuedJobs.load() > 0; } );
+		}
+		--m_sleepers;
+	}
+}
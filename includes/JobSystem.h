@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed capacity Chase-Lev work-stealing deque, in the C11 memory model formulation of Le, Pop, Cohen and Zappa Nardelli
+// (Correct and Efficient Work-Stealing for Weak Memory Models, 2013).
+// The owner thread pushes and pops at the bottom (LIFO: the most recently split, cache warm work first), any other thread
+// steals from the top (FIFO: the oldest, usually the largest pieces of work). Only a steal racing for the last item
+// costs a compare-exchange on the owner side.
+template <typename T>
+class WorkStealingDeque
+{
+public:
+	// capacity is rounded up to a power of two.
+	explicit WorkStealingDeque( std::size_t capacity )
+		: m_items( RoundUpToPowerOfTwo( capacity ) )
+		, m_mask( static_cast<std::int64_t>( m_items.size() ) - 1 )
+	{
+	}
+
+	WorkStealingDeque( const WorkStealingDeque& ) = delete;
+	WorkStealingDeque& operator=( const WorkStealingDeque& ) = delete;
+
+	// Owner. Returns false if the deque is full.
+	bool Push( T item )
+	{
+		const std::int64_t bottom = m_bottom.load( std::memory_order_relaxed );
+		const std::int64_t top = m_top.load( std::memory_order_acquire );
+		if ( bottom - top > m_mask ) return false;
+
+		m_items[ bottom & m_mask ].store( item, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );
+		m_bottom.store( bottom + 1, std::memory_order_relaxed );
+		return true;
+	}
+
+	// Owner. The most recently pushed item.
+	bool Pop( T& item )
+	{
+		const std::int64_t bottom = m_bottom.load( std::memory_order_relaxed ) - 1;
+		m_bottom.store( bottom, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		std::int64_t top = m_top.load( std::memory_order_relaxed );
+
+		if ( top > bottom )
+		{
+			m_bottom.store( bottom + 1, std::memory_order_relaxed ); // was empty
+			return false;
+		}
+
+		item = m_items[ bottom & m_mask ].load( std::memory_order_relaxed );
+		if ( top == bottom )
+		{
+			// the last item: whoever moves the top first gets it
+			const bool won = m_top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed );
+			m_bottom.store( bottom + 1, std::memory_order_relaxed );
+			return won;
+		}
+		return true;
+	}
+
+	// Any thread. The least recently pushed item; false if the deque is empty or another thief was faster.
+	bool Steal( T& item )
+	{
+		std::int64_t top = m_top.load( std::memory_order_acquire );
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		const std::int64_t bottom = m_bottom.load( std::memory_order_acquire );
+		if ( top >= bottom ) return false;
+
+		item = m_items[ top & m_mask ].load( std::memory_order_relaxed );
+		return m_top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed );
+	}
+
+private:
+	static std::size_t RoundUpToPowerOfTwo( std::size_t value )
+	{
+		std::size_t result = 1;
+		while ( result < value ) result *= 2;
+		return result;
+	}
+
+	std::vector<std::atomic<T>> m_items;
+	const std::int64_t m_mask;
+	alignas( 64 ) std::atomic<std::int64_t> m_top = 0;    // written by the thieves (and the owner for the last item)
+	alignas( 64 ) std::atomic<std::int64_t> m_bottom = 0; // written by the owner
+};
+
+// Work-stealing job scheduler: threadCount - 1 worker threads plus the thread that created the JobSystem (worker 0),
+// each with its own WorkStealingDeque. A thread runs the jobs of its own deque first and steals from the others when
+// it runs out, so a job split into pieces (ParallelFor) keeps its first half on the splitting thread while the idle
+// threads take the other halves. Idle workers spin for a while, then sleep until a job is queued.
+//
+// A job is a small function (a lambda capturing by reference) with a counter of its unfinished jobs: itself and its
+// children. A child made with CreateChildJob keeps its parent unfinished, so waiting for a parent waits for the whole
+// tree. Wait runs other jobs instead of blocking, so jobs can wait for the jobs they create.
+//
+// Jobs are created, run and waited for by worker 0 and from inside jobs; other threads must not use the JobSystem.
+// Jobs come from a ring of JOB_RING_SIZE jobs per thread and are never freed one by one: a job pointer stays valid
+// until its thread has created about JOB_RING_SIZE more jobs after it finished, so a job is waited for soon after it
+// was run. Job functions must not throw, and every run job has to be waited for before the JobSystem is destroyed.
+class JobSystem
+{
+public:
+	static constexpr std::size_t JOB_PAYLOAD_SIZE = 96;
+	static constexpr std::size_t JOB_RING_SIZE = 4096;
+	static constexpr std::size_t DEQUE_CAPACITY = 4096; // a Run into a full deque executes the job right away
+
+	// Two cache lines, so two workers never write the counters of neighbouring jobs in the same line.
+	struct alignas( 64 ) Job
+	{
+		void ( *function )( Job& ) = nullptr;
+		Job* parent = nullptr;
+		std::atomic<int> unfinishedJobs = 0;
+		alignas( std::max_align_t ) unsigned char payload[ JOB_PAYLOAD_SIZE ];
+	};
+
+	// threadCount is the total parallelism, like the one of ThreadPool.
+	explicit JobSystem( unsigned int threadCount );
+	~JobSystem();
+
+	JobSystem( const JobSystem& ) = delete;
+	JobSystem& operator=( const JobSystem& ) = delete;
+
+	inline unsigned int ThreadCount() const noexcept { return static_cast<unsigned int>( m_workers.size() ); }
+
+	// The job calls func() once it runs. func is copied into the job: it has to be trivially copyable (a lambda
+	// capturing references, pointers and numbers) and fit into JOB_PAYLOAD_SIZE bytes.
+	template <typename F>
+	inline Job* CreateJob( F&& func ) { return CreateChildJob( nullptr, std::forward<F>( func ) ); }
+
+	// parent (if not nullptr) must not have finished yet; it finishes only after the child did.
+	template <typename F>
+	Job* CreateChildJob( Job* parent, F&& func );
+
+	// Queues the job on the deque of the calling thread.
+	void Run( Job* job );
+	// Returns when the job and all of its children finished, running queued jobs in the meantime.
+	void Wait( const Job* job );
+
+	// Calls func( i ) for every i in [0, count) and returns when all calls finished. The range is halved until the
+	// pieces have at most grainSize indices: the second halves become jobs, the calling thread goes on with the first.
+	template <typename F>
+	void ParallelFor( std::size_t count, std::size_t grainSize, const F& func );
+
+private:
+	struct Worker
+	{
+		Worker() : deque( DEQUE_CAPACITY ), jobs( JOB_RING_SIZE ) {}
+
+		WorkStealingDeque<Job*> deque;
+		std::vector<Job> jobs; // the ring of CreateJob, only touched by the thread of the worker
+		std::size_t nextJob = 0;
+	};
+
+	template <typename F>
+	void RunRange( Job* root, const F& func, std::size_t begin, std::size_t end, std::size_t grainSize );
+
+	unsigned int CurrentWorker() const noexcept;
+	Job* AllocateJob( Job* parent );
+	Job* FindJob( unsigned int worker );
+	void Execute( Job& job );
+	void Finish( Job& job );
+	void WorkerLoop( unsigned int worker );
+
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::vector<std::thread> m_threads;
+
+	// queued, not yet taken jobs of all the deques: the idle workers sleep while it is 0
+	alignas( 64 ) std::atomic<std::int64_t> m_queuedJobs = 0;
+	std::atomic<int> m_sleepers = 0;
+	std::atomic<bool> m_quit = false;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+};
+
+template <typename F>
+JobSystem::Job* JobSystem::CreateChildJob( Job* parent, F&& func )
+{
+	using Function = std::decay_t<F>;
+	static_assert( sizeof( Function ) <= JOB_PAYLOAD_SIZE, "The job function does not fit into Job::payload" );
+	static_assert( alignof( Function ) <= alignof( std::max_align_t ), "The job function is overaligned" );
+	static_assert( std::is_trivially_copyable_v<Function> && std::is_trivially_destructible_v<Function>,
+				   "Jobs are never destroyed: the job function must be trivially copyable and destructible" );
+
+	Job* job = AllocateJob( parent );
+	new ( job->payload ) Function( std::forward<F>( func ) );
+	job->function = []( Job& self ) { ( *std::launder( reinterpret_cast<Function*>( self.payload ) ) )(); };
+	return job;
+}
+
+template <typename F>
+void JobSystem::RunRange( Job* root, const F& func, std::size_t begin, std::size_t end, std::size_t grainSize )
+{
+	while ( end - begin > grainSize )
+	{
+		const std::size_t middle = begin + ( end - begin ) / 2;
+		Run( CreateChildJob( root, [ this, root, &func, middle, end, grainSize ]()
+		{
+			RunRange( root, func, middle, end, grainSize );
+		} ) );
+		end = middle;
+	}
+
+	for ( std::size_t i = begin; i < end; ++i )
+	{
+		func( i );
+	}
+}
+
+template <typename F>
+void JobSystem::ParallelFor( std::size_t count, std::size_t grainSize, const F& func )
+{
+	if ( count == 0 ) return;
+
+	// the pieces are the children of an empty root, which finishes when the last one did
+	Job* root = CreateJob( []() {} );
+	RunRange( root, func, 0, count, std::max<std::size_t>( grainSize, 1 ) );
+	Finish( *root );
+	Wait( root );
+}
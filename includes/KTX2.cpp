@@ -0,0 +1,298 @@
+#include "KTX2.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+#include <SDL2/SDL_log.h>
+
+// Layout: Header | LevelIndex[ levelCount ] | DFD | key/value data | levels (smallest first)
+
+namespace
+{
+	constexpr std::uint8_t KTX2_IDENTIFIER[ 12 ] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	struct Header
+	{
+		std::uint8_t  identifier[ 12 ];
+		std::uint32_t vkFormat;
+		std::uint32_t typeSize;
+		std::uint32_t pixelWidth;
+		std::uint32_t pixelHeight;
+		std::uint32_t pixelDepth;
+		std::uint32_t layerCount;
+		std::uint32_t faceCount;
+		std::uint32_t levelCount;
+		std::uint32_t supercompressionScheme;
+		std::uint32_t dfdByteOffset;
+		std::uint32_t dfdByteLength;
+		std::uint32_t kvdByteOffset;
+		std::uint32_t kvdByteLength;
+		std::uint64_t sgdByteOffset;
+		std::uint64_t sgdByteLength;
+	};
+
+	struct LevelIndex
+	{
+		std::uint64_t byteOffset;
+		std::uint64_t byteLength;
+		std::uint64_t uncompressedByteLength;
+	};
+
+	static_assert( sizeof( Header ) == 80 );
+	static_assert( sizeof( LevelIndex ) == 24 );
+
+	// Khronos Data Format Specification: KHR_DF_MODEL_BC1A / BC3 / BC7, KHR_DF_TRANSFER_LINEAR / SRGB,
+	// KHR_DF_CHANNEL_BC* color / alpha
+	constexpr std::uint32_t DF_MODEL_BC1A = 128;
+	constexpr std::uint32_t DF_MODEL_BC3 = 130;
+	constexpr std::uint32_t DF_MODEL_BC7 = 137;
+	constexpr std::uint32_t DF_PRIMARIES_BT709 = 1;
+	constexpr std::uint32_t DF_TRANSFER_LINEAR = 1;
+	constexpr std::uint32_t DF_TRANSFER_SRGB = 2;
+	constexpr std::uint32_t DF_CHANNEL_COLOR = 0;
+	constexpr std::uint32_t DF_CHANNEL_ALPHA = 15;
+
+	std::size_t AlignUp( std::size_t value, std::size_t alignment )
+	{
+		return ( value + alignment - 1 ) / alignment * alignment;
+	}
+
+	void Append32( std::vector<std::uint32_t>& words, std::uint32_t value )
+	{
+		words.push_back( value );
+	}
+
+	// The basic data format descriptor block of a 4x4 block compressed format.
+	std::vector<std::uint32_t> BuildDFD( TextureCooking::BlockFormat format, bool srgb )
+	{
+		struct Sample
+		{
+			std::uint32_t bitOffset, bitLength, channel;
+		};
+		std::vector<Sample> samples;
+		std::uint32_t model = 0;
+		switch ( format )
+		{
+		case TextureCooking::BlockFormat::BC1:
+			model = DF_MODEL_BC1A;
+			samples = { { 0, 64, DF_CHANNEL_COLOR } };
+			break;
+		case TextureCooking::BlockFormat::BC3:
+			model = DF_MODEL_BC3;
+			samples = { { 0, 64, DF_CHANNEL_ALPHA }, { 64, 64, DF_CHANNEL_COLOR } };
+			break;
+		case TextureCooking::BlockFormat::BC7:
+			model = DF_MODEL_BC7;
+			samples = { { 0, 128, DF_CHANNEL_COLOR } };
+			break;
+		}
+
+		const std::uint32_t blockSize = 24 + 16 * static_cast<std::uint32_t>( samples.size() );
+		std::vector<std::uint32_t> words;
+		Append32( words, 4 + blockSize ); // dfdTotalSize
+		Append32( words, 0 );              // vendorId 0 (Khronos), descriptorType 0 (basic)
+		Append32( words, 2 | ( blockSize << 16 ) ); // versionNumber 2, descriptorBlockSize
+		Append32( words, model | ( DF_PRIMARIES_BT709 << 8 ) | ( ( srgb ? DF_TRANSFER_SRGB : DF_TRANSFER_LINEAR ) << 16 ) ); // flags 0: straight alpha
+		Append32( words, 3 | ( 3 << 8 ) );  // texelBlockDimension 4x4x1x1, stored minus one
+		Append32( words, static_cast<std::uint32_t>( TextureCooking::BlockBytes( format ) ) ); // bytesPlane0
+		Append32( words, 0 );              // bytesPlane4..7
+		for ( const Sample& sample : samples )
+		{
+			Append32( words, sample.bitOffset | ( ( sample.bitLength - 1 ) << 16 ) | ( sample.channel << 24 ) );
+			Append32( words, 0 );          // samplePosition 0..3
+			Append32( words, 0 );          // sampleLower
+			Append32( words, 0xFFFFFFFFu ); // sampleUpper
+		}
+		return words;
+	}
+}
+
+std::uint32_t KTX2::VkFormatOf( TextureCooking::BlockFormat format, bool srgb )
+{
+	switch ( format )
+	{
+	case TextureCooking::BlockFormat::BC1: return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+	case TextureCooking::BlockFormat::BC3: return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+	case TextureCooking::BlockFormat::BC7: return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+	}
+	return 0;
+}
+
+bool KTX2::BlockFormatOf( std::uint32_t vkFormat, TextureCooking::BlockFormat& format )
+{
+	switch ( vkFormat )
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK: format = TextureCooking::BlockFormat::BC1; return true;
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK: format = TextureCooking::BlockFormat::BC3; return true;
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK: format = TextureCooking::BlockFormat::BC7; return true;
+	}
+	return false;
+}
+
+GLenum KTX2::GLFormat( std::uint32_t vkFormat )
+{
+	switch ( vkFormat )
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK: return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_NONE;
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK: return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_NONE;
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK: return GL_COMPRESSED_RGBA_BPTC_UNORM; // core since OpenGL 4.2
+	}
+	return GL_NONE;
+}
+
+bool KTX2::Write( const std::filesystem::path& fileName, std::uint32_t vkFormat, unsigned int width, unsigned int height,
+				  const std::vector<std::vector<std::byte>>& levels, std::vector<std::pair<std::string, std::string>> keyValues )
+{
+	TextureCooking::BlockFormat format;
+	if ( !BlockFormatOf( vkFormat, format ) || levels.empty() ) return false;
+	const bool srgb = vkFormat == VK_FORMAT_BC1_RGB_SRGB_BLOCK || vkFormat == VK_FORMAT_BC3_SRGB_BLOCK || vkFormat == VK_FORMAT_BC7_SRGB_BLOCK;
+
+	const std::vector<std::uint32_t> dfd = BuildDFD( format, srgb );
+
+	std::sort( keyValues.begin(), keyValues.end() );
+	std::vector<std::byte> kvd;
+	for ( const auto& [ key, value ] : keyValues )
+	{
+		const std::uint32_t length = static_cast<std::uint32_t>( key.size() + 1 + value.size() + 1 );
+		const std::size_t start = kvd.size();
+		kvd.resize( AlignUp( start + 4 + length, 4 ) );
+		std::memcpy( kvd.data() + start, &length, 4 );
+		std::memcpy( kvd.data() + start + 4, key.c_str(), key.size() + 1 );
+		std::memcpy( kvd.data() + start + 4 + key.size() + 1, value.c_str(), value.size() + 1 );
+	}
+
+	Header header = {};
+	std::memcpy( header.identifier, KTX2_IDENTIFIER, sizeof( KTX2_IDENTIFIER ) );
+	header.vkFormat = vkFormat;
+	header.typeSize = 1;
+	header.pixelWidth = width;
+	header.pixelHeight = height;
+	header.faceCount = 1;
+	header.levelCount = static_cast<std::uint32_t>( levels.size() );
+	header.dfdByteOffset = static_cast<std::uint32_t>( sizeof( Header ) + levels.size() * sizeof( LevelIndex ) );
+	header.dfdByteLength = static_cast<std::uint32_t>( dfd.size() * 4 );
+	header.kvdByteOffset = kvd.empty() ? 0 : header.dfdByteOffset + header.dfdByteLength;
+	header.kvdByteLength = static_cast<std::uint32_t>( kvd.size() );
+
+	// levels from the smallest, each aligned to lcm( block size, 4 ) = the block size
+	const std::size_t alignment = TextureCooking::BlockBytes( format );
+	std::vector<LevelIndex> levelIndex( levels.size() );
+	std::size_t offset = header.dfdByteOffset + header.dfdByteLength + header.kvdByteLength;
+	for ( std::size_t level = levels.size(); level-- > 0; )
+	{
+		offset = AlignUp( offset, alignment );
+		levelIndex[ level ] = { offset, levels[ level ].size(), levels[ level ].size() };
+		offset += levels[ level ].size();
+	}
+
+	std::filesystem::path tmpFileName = fileName;
+	tmpFileName += ".tmp";
+	bool written = false;
+	{
+		std::ofstream file( tmpFileName, std::ios::binary | std::ios::trunc );
+		std::size_t position = 0;
+		auto write = [ &file, &position ]( const void* data, std::size_t size )
+		{
+			file.write( static_cast<const char*>( data ), static_cast<std::streamsize>( size ) );
+			position += size;
+		};
+		write( &header, sizeof( header ) );
+		write( levelIndex.data(), levelIndex.size() * sizeof( LevelIndex ) );
+		write( dfd.data(), dfd.size() * 4 );
+		write( kvd.data(), kvd.size() );
+		for ( std::size_t level = levels.size(); level-- > 0; )
+		{
+			const char padding[ 16 ] = {};
+			write( padding, levelIndex[ level ].byteOffset - position );
+			write( levels[ level ].data(), levels[ level ].size() );
+		}
+		written = static_cast<bool>( file );
+	}
+
+	std::error_code ec;
+	if ( written ) std::filesystem::rename( tmpFileName, fileName, ec );
+	if ( !written || ec )
+	{
+		std::filesystem::remove( tmpFileName, ec );
+		SDL_LogMessage( SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_ERROR, "[KTX2] Could not write %s", fileName.string().c_str() );
+		return false;
+	}
+	return true;
+}
+
+bool KTX2::Parse( const std::byte* data, std::size_t size, Image& image )
+{
+	image = Image();
+
+	Header header;
+	if ( size < sizeof( Header ) ) return false;
+	std::memcpy( &header, data, sizeof( header ) );
+
+	TextureCooking::BlockFormat format;
+	if ( std::memcmp( header.identifier, KTX2_IDENTIFIER, sizeof( KTX2_IDENTIFIER ) ) != 0
+		 || !BlockFormatOf( header.vkFormat, format )
+		 || header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth != 0
+		 || header.layerCount > 1 || header.faceCount != 1 || header.supercompressionScheme != 0
+		 || header.levelCount == 0 || header.levelCount > 32
+		 || sizeof( Header ) + header.levelCount * sizeof( LevelIndex ) > size
+		 || std::uint64_t( header.kvdByteOffset ) + header.kvdByteLength > size )
+	{
+		return false;
+	}
+
+	image.vkFormat = header.vkFormat;
+	image.width = header.pixelWidth;
+	image.height = header.pixelHeight;
+
+	for ( std::uint32_t level = 0; level < header.levelCount; ++level )
+	{
+		LevelIndex index;
+		std::memcpy( &index, data + sizeof( Header ) + level * sizeof( LevelIndex ), sizeof( index ) );
+
+		const unsigned int width = std::max( image.width >> level, 1u );
+		const unsigned int height = std::max( image.height >> level, 1u );
+		if ( index.byteOffset > size || index.byteLength > size - index.byteOffset
+			 || index.byteLength != TextureCooking::CompressedSize( format, width, height ) )
+		{
+			return false;
+		}
+		image.levels.push_back( { data + index.byteOffset, static_cast<std::size_t>( index.byteLength ), width, height } );
+	}
+
+	// key/value pairs: length | key NUL value NUL | padding to 4
+	const std::byte* kvd = data + header.kvdByteOffset;
+	for ( std::size_t position = 0; position + 4 <= header.kvdByteLength; )
+	{
+		std::uint32_t length = 0;
+		std::memcpy( &length, kvd + position, 4 );
+		if ( length > header.kvdByteLength - position - 4 ) break;
+
+		const std::string_view pair( reinterpret_cast<const char*>( kvd + position + 4 ), length );
+		const std::size_t keyEnd = pair.find( '\0' );
+		if ( keyEnd != std::string_view::npos )
+		{
+			std::string_view value = pair.substr( keyEnd + 1 );
+			if ( !value.empty() && value.back() == '\0' ) value.remove_suffix( 1 );
+			image.keyValues.emplace_back( pair.substr( 0, keyEnd ), value );
+		}
+		position = AlignUp( position + 4 + length, 4 );
+	}
+	return true;
+}
+
+std::string_view KTX2::FindValue( const Image& image, std::string_view key )
+{
+	for ( const auto& [ k, v ] : image.keyValues )
+	{
+		if ( k == key ) return v;
+	}
+	return {};
+}
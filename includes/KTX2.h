@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "TextureCooking.h"
+
+// The subset of KTX 2.0 (https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html) the asset pipeline uses:
+// one 2D image (no array layers, no cube faces, no supercompression) with its whole mip chain, block compressed.
+// WriteKTX2 writes a complete file (level index, data format descriptor, key/value data, levels smallest first with
+// the required alignment), ParseKTX2 reads such files back without copying the level data.
+namespace KTX2
+{
+	// VkFormat values of the supported block formats. The cooked texels are sRGB encoded and the files say so;
+	// GLFormat still maps them to the UNORM formats: CMyApp shades the encoded values, like with GL_RGBA8.
+	enum VkFormat : std::uint32_t
+	{
+		VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131,
+		VK_FORMAT_BC1_RGB_SRGB_BLOCK  = 132,
+		VK_FORMAT_BC3_UNORM_BLOCK     = 137,
+		VK_FORMAT_BC3_SRGB_BLOCK      = 138,
+		VK_FORMAT_BC7_UNORM_BLOCK     = 145,
+		VK_FORMAT_BC7_SRGB_BLOCK      = 146,
+	};
+
+	struct Level
+	{
+		const std::byte* data; // into the parsed buffer
+		std::size_t      size;
+		unsigned int     width;
+		unsigned int     height;
+	};
+
+	struct Image
+	{
+		std::uint32_t      vkFormat = 0;
+		unsigned int       width = 0;
+		unsigned int       height = 0;
+		std::vector<Level> levels; // level 0 first
+		std::vector<std::pair<std::string_view, std::string_view>> keyValues; // values without the closing NUL
+	};
+
+	std::uint32_t VkFormatOf( TextureCooking::BlockFormat format, bool srgb );
+	// false for formats this subset does not handle
+	bool BlockFormatOf( std::uint32_t vkFormat, TextureCooking::BlockFormat& format );
+	// GL_NONE for unsupported formats
+	GLenum GLFormat( std::uint32_t vkFormat );
+
+	// levels[ i ] holds the blocks of level i. keyValues are written sorted by key, as the specification requires.
+	bool Write( const std::filesystem::path& fileName, std::uint32_t vkFormat, unsigned int width, unsigned int height,
+				const std::vector<std::vector<std::byte>>& levels,
+				std::vector<std::pair<std::string, std::string>> keyValues );
+
+	// The Level pointers and key/value views point into data. False for anything outside the subset above.
+	bool Parse( const std::byte* data, std::size_t size, Image& image );
+
+	std::string_view FindValue( const Image& image, std::string_view key );
+}
@@ -0,0 +1,154 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile( const std::filesystem::path& fileName )
+{
+	Open( fileName );
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile::MappedFile( MappedFile&& other ) noexcept
+{
+	Swap( other );
+}
+
+MappedFile& MappedFile::operator=( MappedFile&& other ) noexcept
+{
+	if ( this != &other )
+	{
+		Close();
+		Swap( other );
+	}
+	return *this;
+}
+
+void MappedFile::Swap( MappedFile& other ) noexcept
+{
+	std::swap( m_data, other.m_data );
+	std::swap( m_size, other.m_size );
+	std::swap( m_isOpen, other.m_isOpen );
+#ifdef _WIN32
+	std::swap( m_fileHandle, other.m_fileHandle );
+	std::swap( m_mappingHandle, other.m_mappingHandle );
+#endif
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open( const std::filesystem::path& fileName )
+{
+	Close();
+
+	HANDLE file = CreateFileW( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+							   OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+	if ( file == INVALID_HANDLE_VALUE ) return false;
+
+	LARGE_INTEGER fileSize;
+	if ( !GetFileSizeEx( file, &fileSize ) )
+	{
+		CloseHandle( file );
+		return false;
+	}
+
+	m_fileHandle = file;
+	m_size = static_cast<std::size_t>( fileSize.QuadPart );
+	m_isOpen = true;
+
+	// Empty files cannot be mapped, but they are still valid (empty) files.
+	if ( m_size == 0 ) return true;
+
+	HANDLE mapping = CreateFileMappingW( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if ( mapping == nullptr )
+	{
+		Close();
+		return false;
+	}
+	m_mappingHandle = mapping;
+
+	m_data = static_cast<const std::byte*>( MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) );
+	if ( m_data == nullptr )
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close() noexcept
+{
+	if ( m_data ) UnmapViewOfFile( m_data );
+	if ( m_mappingHandle ) CloseHandle( m_mappingHandle );
+	if ( m_fileHandle ) CloseHandle( m_fileHandle );
+
+	m_data = nullptr;
+	m_size = 0;
+	m_isOpen = false;
+	m_mappingHandle = nullptr;
+	m_fileHandle = nullptr;
+}
+
+#else // Linux, mac
+
+bool MappedFile::Open( const std::filesystem::path& fileName )
+{
+	Close();
+
+	int fd = ::open( fileName.c_str(), O_RDONLY );
+	if ( fd < 0 ) return false;
+
+	struct stat fileStat;
+	if ( ::fstat( fd, &fileStat ) != 0 )
+	{
+		::close( fd );
+		return false;
+	}
+
+	m_size = static_cast<std::size_t>( fileStat.st_size );
+	m_isOpen = true;
+
+	if ( m_size != 0 )
+	{
+		void* ptr = ::mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		if ( ptr == MAP_FAILED )
+		{
+			::close( fd );
+			m_size = 0;
+			m_isOpen = false;
+			return false;
+		}
+		m_data = static_cast<const std::byte*>( ptr );
+	}
+
+	// The mapping keeps its own reference to the file.
+	::close( fd );
+
+	return true;
+}
+
+void MappedFile::Close() noexcept
+{
+	if ( m_data ) ::munmap( const_cast<std::byte*>( m_data ), m_size );
+
+	m_data = nullptr;
+	m_size = 0;
+	m_isOpen = false;
+}
+
+#endif
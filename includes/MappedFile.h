@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+// Read-only memory mapping of a whole file.
+// The mapped bytes stay valid until the object is closed or destroyed,
+// so pointers into data() can be handed directly to the GL upload functions.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile( const std::filesystem::path& fileName );
+	~MappedFile();
+
+	MappedFile( const MappedFile& ) = delete;
+	MappedFile& operator=( const MappedFile& ) = delete;
+
+	MappedFile( MappedFile&& other ) noexcept;
+	MappedFile& operator=( MappedFile&& other ) noexcept;
+
+	bool Open( const std::filesystem::path& fileName );
+	void Close() noexcept;
+
+	inline const std::byte* data() const noexcept { return m_data; }
+	inline std::size_t size() const noexcept { return m_size; }
+
+	inline bool IsOpen() const noexcept { return m_isOpen; }
+	explicit operator bool() const noexcept { return m_isOpen; }
+
+private:
+	void Swap( MappedFile& other ) noexcept;
+
+	const std::byte* m_data = nullptr;
+	std::size_t m_size = 0;
+	bool m_isOpen = false;
+
+#ifdef _WIN32
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+#endif
+};
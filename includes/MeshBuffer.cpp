@@ -0,0 +1,87 @@
+#include "MeshBuffer.h"
+
+#include <algorithm>
+#include <numeric>
+
+MeshRange MeshBuffer::Add( const MeshView<Vertex>& mesh, const MeshBounds& bounds )
+{
+	const QuantizedMesh quantized = QuantizeMesh( mesh );
+
+	MeshRange range;
+	range.firstIndex = static_cast<GLuint>( m_indices.size() );
+	range.indexCount = static_cast<GLuint>( quantized.mesh.indexArray.size() );
+	range.baseVertex = static_cast<GLint>( m_vertices.size() );
+	range.dequantization = quantized.dequantization;
+	range.boundingSphere = glm::vec4( bounds.sphereCenter, bounds.sphereRadius );
+
+	// the indices stay mesh relative, baseVertex offsets them at draw time
+	m_vertices.insert( m_vertices.end(), quantized.mesh.vertexArray.begin(), quantized.mesh.vertexArray.end() );
+	m_indices.insert( m_indices.end(), quantized.mesh.indexArray.begin(), quantized.mesh.indexArray.end() );
+
+	return range;
+}
+
+void MeshBuffer::Upload()
+{
+	const GLuint drawIndexCapacity = std::max( m_drawIndexCapacity, 1u );
+	Clean();
+
+	glCreateBuffers( 1, &m_vboID );
+	glNamedBufferStorage( m_vboID, m_vertices.size() * sizeof( VertexQuantized ), m_vertices.data(), 0 );
+	glCreateBuffers( 1, &m_iboID );
+	glNamedBufferStorage( m_iboID, m_indices.size() * sizeof( GLuint ), m_indices.data(), 0 );
+
+	glCreateVertexArrays( 1, &m_vaoID );
+	glVertexArrayVertexBuffer( m_vaoID, 0, m_vboID, 0, sizeof( VertexQuantized ) );
+	glVertexArrayElementBuffer( m_vaoID, m_iboID );
+
+	// same formats as CreateQuantizedGLObjectFromMesh
+	const VertexAttributeDescriptor attributes[] = {
+		{ 0, offsetof( VertexQuantized, position ), 3, GL_UNSIGNED_SHORT, GL_TRUE },
+		{ 1, offsetof( VertexQuantized, normal ), 4, GL_INT_2_10_10_10_REV, GL_TRUE },
+		{ 2, offsetof( VertexQuantized, texcoord ), 2, GL_HALF_FLOAT },
+	};
+	for ( const VertexAttributeDescriptor& attribute : attributes )
+	{
+		glEnableVertexArrayAttrib( m_vaoID, attribute.index );
+		glVertexArrayAttribBinding( m_vaoID, attribute.index, 0 );
+		glVertexArrayAttribFormat( m_vaoID, attribute.index, attribute.numberOfComponents, attribute.glType, attribute.normalized, attribute.strideInBytes );
+	}
+
+	// draw index: binding 1, advancing once per instance
+	glEnableVertexArrayAttrib( m_vaoID, DRAW_INDEX_ATTRIBUTE );
+	glVertexArrayAttribBinding( m_vaoID, DRAW_INDEX_ATTRIBUTE, 1 );
+	glVertexArrayAttribIFormat( m_vaoID, DRAW_INDEX_ATTRIBUTE, 1, GL_UNSIGNED_INT, 0 );
+	glVertexArrayBindingDivisor( m_vaoID, 1, 1 );
+
+	ReserveDrawIndices( drawIndexCapacity );
+
+	m_vertices = {};
+	m_indices = {};
+}
+
+void MeshBuffer::ReserveDrawIndices( GLuint count )
+{
+	if ( count <= m_drawIndexCapacity ) return;
+
+	std::vector<GLuint> drawIndices( std::max( count, 2 * m_drawIndexCapacity ) );
+	std::iota( drawIndices.begin(), drawIndices.end(), 0u );
+
+	glDeleteBuffers( 1, &m_drawIndexBufferID );
+	glCreateBuffers( 1, &m_drawIndexBufferID );
+	glNamedBufferStorage( m_drawIndexBufferID, drawIndices.size() * sizeof( GLuint ), drawIndices.data(), 0 );
+	glVertexArrayVertexBuffer( m_vaoID, 1, m_drawIndexBufferID, 0, sizeof( GLuint ) );
+
+	m_drawIndexCapacity = static_cast<GLuint>( drawIndices.size() );
+}
+
+void MeshBuffer::Clean()
+{
+	glDeleteVertexArrays( 1, &m_vaoID );
+	glDeleteBuffers( 1, &m_vboID );
+	glDeleteBuffers( 1, &m_iboID );
+	glDeleteBuffers( 1, &m_drawIndexBufferID );
+
+	m_vaoID = m_vboID = m_iboID = m_drawIndexBufferID = 0;
+	m_drawIndexCapacity = 0;
+}
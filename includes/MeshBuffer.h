@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+
+#include "VertexQuantization.h"
+
+// One record of the GL_DRAW_INDIRECT_BUFFER for glMultiDrawElementsIndirect (layout fixed by the GL spec).
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint  baseVertex;
+	GLuint baseInstance;
+};
+
+static_assert( sizeof( DrawElementsIndirectCommand ) == 20 );
+
+// Where a mesh was placed inside a MeshBuffer.
+struct MeshRange
+{
+	GLuint    firstIndex = 0;
+	GLuint    indexCount = 0;
+	GLint     baseVertex = 0;
+	glm::mat4 dequantization = glm::mat4( 1.0f );
+	glm::vec4 boundingSphere = glm::vec4( 0.0f ); // model space center (xyz) and radius (w), for culling
+
+	// instanceCount instances reading the per-draw records [baseInstance, baseInstance + instanceCount)
+	DrawElementsIndirectCommand Command( GLuint instanceCount, GLuint baseInstance ) const noexcept
+	{
+		return { indexCount, instanceCount, firstIndex, baseVertex, baseInstance };
+	}
+};
+
+// Every mesh of a scene sub-allocated into one vertex buffer (VertexQuantized) and one index buffer behind a single VAO,
+// so the whole scene can be submitted by glMultiDrawElementsIndirect without rebinding anything between the draws.
+//
+// Besides the mesh attributes (locations 0, 1, 2 like CreateQuantizedGLObjectFromMesh) the VAO has a per-instance
+// uint attribute at DRAW_INDEX_ATTRIBUTE that reads 0, 1, 2, ... from its own buffer. Instanced attributes start at
+// baseInstance, so the shader gets baseInstance + instance index: the index of its per-draw record, without needing
+// gl_DrawID / gl_BaseInstance (GL 4.6 or ARB_shader_draw_parameters).
+class MeshBuffer
+{
+public:
+	static constexpr GLuint DRAW_INDEX_ATTRIBUTE = 3;
+
+	MeshBuffer() = default;
+	~MeshBuffer() = default;
+
+	MeshBuffer( const MeshBuffer& ) = delete;
+	MeshBuffer& operator=( const MeshBuffer& ) = delete;
+
+	// Quantizes the mesh and appends it to the staging arrays, Upload() moves everything to the GPU.
+	// bounds (e.g. ObjParser::computeBounds) is kept in the range for the culling pass.
+	MeshRange Add( const MeshView<Vertex>& mesh, const MeshBounds& bounds );
+
+	// Creates the buffers and the VAO from the added meshes, the staging arrays are freed.
+	void Upload();
+	void Clean();
+
+	// The draw index attribute can address [0, count) records (grows only).
+	void ReserveDrawIndices( GLuint count );
+
+	inline GLuint VAO() const noexcept { return m_vaoID; }
+	inline GLuint DrawIndexCapacity() const noexcept { return m_drawIndexCapacity; }
+
+private:
+	std::vector<VertexQuantized> m_vertices;
+	std::vector<GLuint>          m_indices;
+
+	GLuint m_vaoID = 0;
+	GLuint m_vboID = 0;
+	GLuint m_iboID = 0;
+	GLuint m_drawIndexBufferID = 0;
+	GLuint m_drawIndexCapacity = 0;
+};
@@ -0,0 +1,351 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include <glm/glm.hpp>
+
+namespace
+{
+	// Triangles adjacent to each vertex in one array (compressed sparse rows).
+	struct VertexTriangleAdjacency
+	{
+		std::vector<unsigned int> offsets;   // vertexCount + 1
+		std::vector<unsigned int> triangles; // indexCount
+
+		VertexTriangleAdjacency( const std::vector<GLuint>& indices, std::size_t vertexCount )
+			: offsets( vertexCount + 1, 0 ), triangles( indices.size() )
+		{
+			for ( GLuint index : indices ) ++offsets[ index + 1 ];
+			std::partial_sum( offsets.cbegin(), offsets.cend(), offsets.begin() );
+
+			std::vector<unsigned int> fill( offsets.cbegin(), offsets.cend() - 1 );
+			for ( std::size_t i = 0; i < indices.size(); ++i ) triangles[ fill[ indices[ i ] ]++ ] = static_cast<unsigned int>( i / 3 );
+		}
+	};
+
+	// Simulated FIFO cache, returns the number of misses of the triangle.
+	class FifoCache
+	{
+	public:
+		FifoCache( std::size_t vertexCount, unsigned int cacheSize ) : m_timestamps( vertexCount, 0 ), m_cacheSize( cacheSize ) {}
+
+		// Empties the cache.
+		void Flush() { m_time += m_cacheSize + 1; }
+
+		unsigned int Triangle( GLuint a, GLuint b, GLuint c )
+		{
+			return Access( a ) + Access( b ) + Access( c );
+		}
+
+	private:
+		unsigned int Access( GLuint index )
+		{
+			// a vertex is in the cache, if it was pushed in the last cacheSize misses
+			if ( m_timestamps[ index ] != 0 && m_time - m_timestamps[ index ] < m_cacheSize ) return 0;
+			m_timestamps[ index ] = ++m_time;
+			return 1;
+		}
+
+		std::vector<std::size_t> m_timestamps;
+		std::size_t m_time = 0;
+		unsigned int m_cacheSize;
+	};
+
+	// Forsyth's scoring, see https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+	constexpr int   FORSYTH_CACHE_SIZE       = 32;
+	constexpr float FORSYTH_LAST_TRI_SCORE   = 0.75f;
+	constexpr float FORSYTH_DECAY_POWER      = 1.5f;
+	constexpr float FORSYTH_VALENCE_SCALE    = 2.0f;
+	constexpr float FORSYTH_VALENCE_POWER    = 0.5f;
+
+	float ForsythVertexScore( int cachePosition, unsigned int remainingTriangles )
+	{
+		if ( remainingTriangles == 0 ) return -1.0f; // nothing to draw with it
+
+		float score = 0.0f;
+		if ( cachePosition >= 0 )
+		{
+			if ( cachePosition < 3 )
+			{
+				// the vertices of the last triangle get a fixed score, so the strip-like order is not preferred too much
+				score = FORSYTH_LAST_TRI_SCORE;
+			}
+			else
+			{
+				const float scaler = 1.0f / ( FORSYTH_CACHE_SIZE - 3 );
+				score = std::pow( 1.0f - ( cachePosition - 3 ) * scaler, FORSYTH_DECAY_POWER );
+			}
+		}
+
+		// vertices with few triangles left are preferred, so no lonely triangles stay behind
+		score += FORSYTH_VALENCE_SCALE * std::pow( static_cast<float>( remainingTriangles ), -FORSYTH_VALENCE_POWER );
+		return score;
+	}
+}
+
+void MeshOptimizer::Optimize( MeshObject<Vertex>& mesh, float overdrawThreshold )
+{
+	OptimizeVertexCache( mesh.indexArray, mesh.vertexArray.size() );
+	OptimizeOverdraw( mesh.indexArray, mesh.vertexArray, overdrawThreshold );
+	OptimizeVertexFetch( mesh.vertexArray, mesh.indexArray );
+}
+
+void MeshOptimizer::OptimizeVertexCache( std::vector<GLuint>& indices, std::size_t vertexCount )
+{
+	const std::size_t triangleCount = indices.size() / 3;
+	if ( triangleCount == 0 ) return;
+
+	VertexTriangleAdjacency adjacency( indices, vertexCount );
+
+	std::vector<unsigned int> remainingTriangles( vertexCount );
+	std::vector<int> cachePositions( vertexCount, -1 );
+	std::vector<float> vertexScores( vertexCount );
+	for ( std::size_t v = 0; v < vertexCount; ++v )
+	{
+		remainingTriangles[ v ] = adjacency.offsets[ v + 1 ] - adjacency.offsets[ v ];
+		vertexScores[ v ] = ForsythVertexScore( -1, remainingTriangles[ v ] );
+	}
+
+	std::vector<float> triangleScores( triangleCount );
+	for ( std::size_t t = 0; t < triangleCount; ++t )
+	{
+		triangleScores[ t ] = vertexScores[ indices[ t * 3 ] ] + vertexScores[ indices[ t * 3 + 1 ] ] + vertexScores[ indices[ t * 3 + 2 ] ];
+	}
+
+	std::vector<bool> emitted( triangleCount, false );
+	std::vector<GLuint> result;
+	result.reserve( indices.size() );
+
+	// +3: the new triangle is pushed before the old entries fall out
+	std::vector<GLuint> cache, newCache;
+	cache.reserve( FORSYTH_CACHE_SIZE + 3 );
+	newCache.reserve( FORSYTH_CACHE_SIZE + 3 );
+
+	std::size_t nextCandidate = 0; // triangles before this are all emitted
+	std::size_t bestTriangle = 0;
+	for ( float bestScore = triangleScores[ 0 ]; bestScore >= 0.0f; )
+	{
+		emitted[ bestTriangle ] = true;
+		const GLuint* tri = &indices[ bestTriangle * 3 ];
+		result.insert( result.end(), tri, tri + 3 );
+
+		// the emitted triangle is removed from the adjacency of its vertices
+		for ( int k = 0; k < 3; ++k )
+		{
+			const GLuint v = tri[ k ];
+			unsigned int* first = adjacency.triangles.data() + adjacency.offsets[ v ];
+			unsigned int* last = first + remainingTriangles[ v ];
+			std::iter_swap( std::find( first, last, static_cast<unsigned int>( bestTriangle ) ), last - 1 );
+			--remainingTriangles[ v ];
+		}
+
+		// LRU cache: the triangle goes to the front
+		newCache.clear();
+		for ( int k = 0; k < 3; ++k )
+		{
+			if ( std::find( newCache.cbegin(), newCache.cend(), tri[ k ] ) == newCache.cend() ) newCache.push_back( tri[ k ] );
+		}
+		for ( GLuint v : cache )
+		{
+			if ( v != tri[ 0 ] && v != tri[ 1 ] && v != tri[ 2 ] ) newCache.push_back( v );
+		}
+		cache.swap( newCache );
+
+		for ( std::size_t i = 0; i < cache.size(); ++i )
+		{
+			const GLuint v = cache[ i ];
+			cachePositions[ v ] = ( i < FORSYTH_CACHE_SIZE ) ? static_cast<int>( i ) : -1;
+			const float newScore = ForsythVertexScore( cachePositions[ v ], remainingTriangles[ v ] );
+			const float scoreDelta = newScore - vertexScores[ v ];
+			vertexScores[ v ] = newScore;
+
+			for ( unsigned int a = adjacency.offsets[ v ]; a < adjacency.offsets[ v ] + remainingTriangles[ v ]; ++a )
+			{
+				triangleScores[ adjacency.triangles[ a ] ] += scoreDelta;
+			}
+		}
+		if ( cache.size() > FORSYTH_CACHE_SIZE ) cache.resize( FORSYTH_CACHE_SIZE );
+
+		// the next triangle is the best one, that uses a cached vertex
+		bestScore = -1.0f;
+		for ( GLuint v : cache )
+		{
+			for ( unsigned int a = adjacency.offsets[ v ]; a < adjacency.offsets[ v ] + remainingTriangles[ v ]; ++a )
+			{
+				const unsigned int t = adjacency.triangles[ a ];
+				if ( triangleScores[ t ] > bestScore )
+				{
+					bestScore = triangleScores[ t ];
+					bestTriangle = t;
+				}
+			}
+		}
+
+		// or if the cached vertices have no triangles left, the next one in the original order
+		if ( bestScore < 0.0f )
+		{
+			while ( nextCandidate < triangleCount && emitted[ nextCandidate ] ) ++nextCandidate;
+			if ( nextCandidate < triangleCount )
+			{
+				bestTriangle = nextCandidate;
+				bestScore = triangleScores[ nextCandidate ];
+			}
+		}
+	}
+
+	indices.swap( result );
+}
+
+void MeshOptimizer::OptimizeOverdraw( std::vector<GLuint>& indices, const std::vector<Vertex>& vertices, float threshold )
+{
+	const std::size_t triangleCount = indices.size() / 3;
+	if ( triangleCount == 0 ) return;
+
+	// 1. hard cluster boundaries: triangles, where the cache optimized order jumps (every vertex is a miss)
+	std::vector<unsigned int> triangleMisses( triangleCount );
+	std::vector<std::size_t> hardBoundaries;
+	{
+		FifoCache cache( vertices.size(), ANALYZE_CACHE_SIZE );
+		for ( std::size_t t = 0; t < triangleCount; ++t )
+		{
+			triangleMisses[ t ] = cache.Triangle( indices[ t * 3 ], indices[ t * 3 + 1 ], indices[ t * 3 + 2 ] );
+			if ( t == 0 || triangleMisses[ t ] == 3 ) hardBoundaries.push_back( t );
+		}
+		hardBoundaries.push_back( triangleCount );
+	}
+
+	// 2. soft boundaries: a hard cluster is split further where the part so far is not much worse than the whole cluster
+	std::vector<std::size_t> clusterStarts;
+	{
+		FifoCache cache( vertices.size(), ANALYZE_CACHE_SIZE );
+		for ( std::size_t h = 0; h + 1 < hardBoundaries.size(); ++h )
+		{
+			const std::size_t first = hardBoundaries[ h ], last = hardBoundaries[ h + 1 ];
+
+			unsigned int clusterMisses = 0;
+			for ( std::size_t t = first; t < last; ++t ) clusterMisses += triangleMisses[ t ];
+			const float clusterAcmr = static_cast<float>( clusterMisses ) / ( last - first );
+
+			std::size_t start = first;
+			unsigned int misses = 0;
+			cache.Flush();
+			clusterStarts.push_back( first );
+			for ( std::size_t t = first; t < last; ++t )
+			{
+				misses += cache.Triangle( indices[ t * 3 ], indices[ t * 3 + 1 ], indices[ t * 3 + 2 ] );
+				if ( t + 1 < last && static_cast<float>( misses ) / ( t + 1 - start ) <= clusterAcmr * threshold )
+				{
+					start = t + 1;
+					misses = 0;
+					cache.Flush();
+					clusterStarts.push_back( start );
+				}
+			}
+		}
+		clusterStarts.push_back( triangleCount );
+	}
+
+	// 3. sorting the clusters by how much they face outwards from the mesh center
+	const std::size_t clusterCount = clusterStarts.size() - 1;
+
+	glm::vec3 meshCenter( 0.0f );
+	float meshArea = 0.0f;
+	std::vector<glm::vec3> clusterCenters( clusterCount, glm::vec3( 0.0f ) );
+	std::vector<glm::vec3> clusterNormals( clusterCount, glm::vec3( 0.0f ) );
+
+	for ( std::size_t c = 0; c < clusterCount; ++c )
+	{
+		float clusterArea = 0.0f;
+		for ( std::size_t t = clusterStarts[ c ]; t < clusterStarts[ c + 1 ]; ++t )
+		{
+			const glm::vec3& p0 = vertices[ indices[ t * 3 ] ].position;
+			const glm::vec3& p1 = vertices[ indices[ t * 3 + 1 ] ].position;
+			const glm::vec3& p2 = vertices[ indices[ t * 3 + 2 ] ].position;
+
+			const glm::vec3 areaNormal = glm::cross( p1 - p0, p2 - p0 );
+			const float area = glm::length( areaNormal );
+			const glm::vec3 center = ( p0 + p1 + p2 ) / 3.0f;
+
+			clusterCenters[ c ] += center * area;
+			clusterNormals[ c ] += areaNormal;
+			clusterArea += area;
+		}
+
+		meshCenter += clusterCenters[ c ];
+		meshArea += clusterArea;
+		if ( clusterArea > 0.0f ) clusterCenters[ c ] /= clusterArea;
+	}
+	if ( meshArea > 0.0f ) meshCenter /= meshArea;
+
+	std::vector<float> clusterSortKeys( clusterCount );
+	for ( std::size_t c = 0; c < clusterCount; ++c )
+	{
+		const float normalLength = glm::length( clusterNormals[ c ] );
+		clusterSortKeys[ c ] = normalLength > 0.0f ? glm::dot( clusterCenters[ c ] - meshCenter, clusterNormals[ c ] / normalLength ) : 0.0f;
+	}
+
+	std::vector<std::size_t> clusterOrder( clusterCount );
+	std::iota( clusterOrder.begin(), clusterOrder.end(), std::size_t( 0 ) );
+	std::stable_sort( clusterOrder.begin(), clusterOrder.end(),
+					  [ &clusterSortKeys ]( std::size_t a, std::size_t b ) { return clusterSortKeys[ a ] > clusterSortKeys[ b ]; } );
+
+	std::vector<GLuint> result;
+	result.reserve( indices.size() );
+	for ( std::size_t c : clusterOrder )
+	{
+		result.insert( result.end(), indices.cbegin() + clusterStarts[ c ] * 3, indices.cbegin() + clusterStarts[ c + 1 ] * 3 );
+	}
+
+	indices.swap( result );
+}
+
+void MeshOptimizer::OptimizeVertexFetch( std::vector<Vertex>& vertices, std::vector<GLuint>& indices )
+{
+	constexpr GLuint UNUSED = ~GLuint( 0 );
+
+	std::vector<GLuint> remap( vertices.size(), UNUSED );
+	std::vector<Vertex> result;
+	result.reserve( vertices.size() );
+
+	for ( GLuint& index : indices )
+	{
+		if ( remap[ index ] == UNUSED )
+		{
+			remap[ index ] = static_cast<GLuint>( result.size() );
+			result.push_back( vertices[ index ] );
+		}
+		index = remap[ index ];
+	}
+
+	vertices.swap( result );
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::AnalyzeVertexCache( const GLuint* indices, std::size_t indexCount, std::size_t vertexCount, unsigned int cacheSize )
+{
+	VertexCacheStats stats;
+	const std::size_t triangleCount = indexCount / 3;
+	if ( triangleCount == 0 ) return stats;
+
+	FifoCache cache( vertexCount, cacheSize );
+	std::vector<bool> used( vertexCount, false );
+	std::size_t misses = 0, usedCount = 0;
+
+	for ( std::size_t i = 0; i < triangleCount * 3; i += 3 )
+	{
+		misses += cache.Triangle( indices[ i ], indices[ i + 1 ], indices[ i + 2 ] );
+		for ( std::size_t k = i; k < i + 3; ++k )
+		{
+			if ( !used[ indices[ k ] ] )
+			{
+				used[ indices[ k ] ] = true;
+				++usedCount;
+			}
+		}
+	}
+
+	stats.acmr = static_cast<float>( misses ) / triangleCount;
+	stats.atvr = static_cast<float>( misses ) / usedCount;
+	return stats;
+}
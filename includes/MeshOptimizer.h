@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "GLUtils.hpp"
+
+// Post-load optimization of triangle meshes, run between parsing and the GL upload.
+// None of the passes change the rendered image, only the order of the triangles and vertices.
+class MeshOptimizer
+{
+public:
+	// FIFO post-transform cache size used for the statistics.
+	static constexpr unsigned int ANALYZE_CACHE_SIZE = 16;
+
+	struct VertexCacheStats
+	{
+		float acmr = 0.0f; // average cache miss ratio: transformed vertices / triangles (0.5 .. 3)
+		float atvr = 0.0f; // average transformed vertex ratio: transformed vertices / used vertices (1 .. )
+	};
+
+	// Runs all passes: vertex cache, overdraw, vertex fetch.
+	static void Optimize( MeshObject<Vertex>& mesh, float overdrawThreshold = 1.05f );
+
+	// Reorders the triangles for post-transform vertex cache locality (Tom Forsyth's linear-speed algorithm).
+	static void OptimizeVertexCache( std::vector<GLuint>& indices, std::size_t vertexCount );
+
+	// Reorders clusters of the cache optimized triangles, so outward facing parts are drawn first.
+	// A cluster may only be as much worse for the vertex cache as threshold times the original (Sander et al. 2007).
+	static void OptimizeOverdraw( std::vector<GLuint>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f );
+
+	// Reorders the vertices in the order of their first use and drops unused vertices.
+	static void OptimizeVertexFetch( std::vector<Vertex>& vertices, std::vector<GLuint>& indices );
+
+	static VertexCacheStats AnalyzeVertexCache( const GLuint* indices, std::size_t indexCount, std::size_t vertexCount,
+												unsigned int cacheSize = ANALYZE_CACHE_SIZE );
+};
@@ -2,113 +2,344 @@
 #include <array>
 #include <list>
 #include <string>
-#include <charconv>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "IndexedVertTable.h"
+#include "MeshOptimizer.h"
+#include "ObjTokenizer.h"
+#include "ThreadPool.h"
+
+#include <SDL2/SDL_log.h>
 
 #include <glm/gtx/norm.hpp>
 #include <glm/gtc/constants.hpp>
 
 using namespace std;
 
-class InMemoryTokenizer
+constexpr unsigned short From2Char( const char ch1, const char ch2)
 {
-public:
-	InMemoryTokenizer() = default;
-	void SetData( const char* ptr, size_t Length ) noexcept;
-	std::string_view NextToken( bool onlySameLine = false ) noexcept;
-	void ToNextLine() noexcept;
-	operator bool() const noexcept;
-private:
-	const char* currentPtr = nullptr;
-	const char* endPtr = nullptr;
-};
-
-void InMemoryTokenizer::SetData( const char* ptr, size_t Length ) noexcept
+	unsigned short sh = static_cast<unsigned short>(ch2) << 8 | static_cast<unsigned short>(ch1);
+
+	return sh;
+}
+
+static std::vector<unsigned int> triangulatePolygon( const std::vector<glm::vec2>& );
+
+static inline void parseFloat( std::string_view token, float& value ) noexcept
 {
-	this->currentPtr = ptr;
-	this->endPtr = ptr + Length;
+	ParseObjFloat( token, value );
 }
 
-std::string_view InMemoryTokenizer::NextToken( bool onlySameLine ) noexcept
+// v <x> <y> <z> [<w>]
+static glm::vec3 parsePosition( InMemoryTokenizer& tokenizer ) noexcept
 {
-	for ( ;currentPtr < endPtr 
-			&& std::isspace(static_cast<unsigned char>(*currentPtr) ); ++currentPtr )
-	{
-		if ( onlySameLine && *currentPtr == '\n' )
-		{
-			return std::string_view();
-		}
-	}
-	const char* tPtr = currentPtr;
-	std::size_t tLength = 0;
+	glm::vec3 position( 0.0f );
+
+	parseFloat( tokenizer.NextToken(), position.x );
+	parseFloat( tokenizer.NextToken(), position.y );
+	parseFloat( tokenizer.NextToken(), position.z );
 
-	while ( currentPtr < endPtr 
-			&& !std::isspace(static_cast<unsigned char>(*currentPtr) ) )
+	std::string_view coordT = tokenizer.NextToken( true );
+	if ( !coordT.empty() )
 	{
-		currentPtr++;
-		tLength++;
+		float w = 1.0f;
+		parseFloat( coordT, w );
+		position.x /= w;
+		position.y /= w;
+		position.z /= w;
 	}
 
-	return std::string_view( tPtr, tLength );
+	return position;
 }
 
-void InMemoryTokenizer::ToNextLine() noexcept
+// vn <nx> <ny> <nz>
+static glm::vec3 parseNormal( InMemoryTokenizer& tokenizer ) noexcept
 {
-	while ( currentPtr < endPtr && *currentPtr != '\n' )
-		currentPtr++;
-	currentPtr++;
+	glm::vec3 normal( 0.0f );
+
+	parseFloat( tokenizer.NextToken(), normal.x );
+	parseFloat( tokenizer.NextToken(), normal.y );
+	parseFloat( tokenizer.NextToken(), normal.z );
+
+	return normal;
 }
 
-InMemoryTokenizer::operator bool() const noexcept
+// vt <s> <t>
+static glm::vec2 parseTexcoord( InMemoryTokenizer& tokenizer ) noexcept
 {
-	return currentPtr < endPtr;
+	glm::vec2 texcoord( 0.0f );
+
+	parseFloat( tokenizer.NextToken(), texcoord.x );
+	parseFloat( tokenizer.NextToken(), texcoord.y );
+
+	return texcoord;
 }
 
-constexpr unsigned short From2Char( const char ch1, const char ch2)
+// f (<pi>[/<ti>][/<ni>])3+
+// Returns true, if the face has no normals given, so they have to be computed.
+static bool parseFaceCorners( InMemoryTokenizer& tokenizer, std::vector<IndexedVert>& face_vertIds ) noexcept
 {
-	unsigned short sh = static_cast<unsigned short>(ch2) << 8 | static_cast<unsigned short>(ch1);
+	face_vertIds.clear();
+	bool needsNormalComputation = false;
 
-	return sh;
-}
+	// the '/' separators come with the token, from the vectorized scan of its end
+	size_t firstSlash, secondSlash;
+	std::string_view faceVertT = tokenizer.NextFaceCorner( firstSlash, secondSlash );
+	while ( !faceVertT.empty() )
+	{
+		face_vertIds.emplace_back( IndexedVert{} );
+		IndexedVert& idxVert = face_vertIds.back();
 
-static std::vector<unsigned int> triangulatePolygon( const std::vector<glm::vec2>& );
+		size_t posEndOffs = firstSlash;
+		if ( posEndOffs == std::string_view::npos ) posEndOffs = faceVertT.size();
+
+		ParseObjIndex( faceVertT.data(), faceVertT.data() + posEndOffs, idxVert.v );
+		idxVert.v--;
+
+		size_t texStartOffs = posEndOffs + 1;
+		size_t texEndOffs = secondSlash;
+		if ( texEndOffs == std::string_view::npos ) texEndOffs = faceVertT.size();
+		if ( texEndOffs > texStartOffs ) ParseObjIndex( faceVertT.data() + texStartOffs, faceVertT.data() + texEndOffs, idxVert.vt);
+		if ( idxVert.vt ) idxVert.vt--; 
+		size_t normStartOffs = texEndOffs + 1;
 
-ObjParser::Mesh ObjParser::parse(const std::filesystem::path& fileName)
+		if ( faceVertT.size() > normStartOffs )
+		{
+			ParseObjIndex( faceVertT.data() + normStartOffs, faceVertT.data() + faceVertT.size(), idxVert.vn );
+			idxVert.vn--;
+		}
+		else needsNormalComputation = true;
+		
+		faceVertT = tokenizer.NextFaceCorner( firstSlash, secondSlash );
+	}
+
+	return needsNormalComputation;
+}
+
+// Splits faces with more than 3 corners into triangles.
+static void triangulateFace( const std::vector<glm::vec3>& positions, std::vector<IndexedVert>& face_vertIds )
 {
-	Mesh resultMesh;
+	if ( 3 < face_vertIds.size() )
+	{
+		std::vector<IndexedVert> face_vertIdsFace2Tris;
+		if ( 4 == face_vertIds.size() )
+		{
+			glm::vec3 v10 = positions[ face_vertIds[ 0 ].v ] - positions[ face_vertIds[ 1 ].v ];
+			glm::vec3 v12 = positions[ face_vertIds[ 2 ].v ] - positions[ face_vertIds[ 1 ].v ];
 
-	std::vector<glm::vec3> positions;
-	std::vector<glm::vec3> normals;
-	std::vector<glm::vec2> texcoords;
+			glm::vec3 v32 = positions[ face_vertIds[ 2 ].v ] - positions[ face_vertIds[ 3 ].v ];
+			glm::vec3 v30 = positions[ face_vertIds[ 0 ].v ] - positions[ face_vertIds[ 3 ].v ];
 
-	std::vector<IndexedVert> face_vertIds;
-	face_vertIds.reserve( 4 );
-	bool needsNormalComputation = false;
-	std::unordered_map<IndexedVert, unsigned int, IndexedVertHash> vertexIndices;
+			float angle_012 = ::acosf( glm::dot(v10,v12) / sqrtf( glm::dot(v10,v10) * glm::dot(v12,v12) ) );
+			float angle_230 = ::acosf( glm::dot(v32,v30) / sqrtf( glm::dot(v32,v32) * glm::dot(v30,v30) ) );
+			
+			if ( ( angle_012 + angle_230 ) <= glm::pi<float>() )
+			{
+				face_vertIdsFace2Tris =
+				{ face_vertIds[ 0 ], face_vertIds[ 1 ], face_vertIds[ 2 ],
+				  face_vertIds[ 0 ], face_vertIds[ 2 ], face_vertIds[ 3 ] };
+			}
+			else
+			{
+				face_vertIdsFace2Tris =
+				{ face_vertIds[ 0 ], face_vertIds[ 1 ], face_vertIds[ 3 ],
+				  face_vertIds[ 1 ], face_vertIds[ 2 ], face_vertIds[ 3 ] };
+			}
+		}
+		else 
+		{
+			// Calculate the best fitting plane
+			glm::vec3 MidPoint( 0.0 );
+			for ( const auto& vertex : face_vertIds )
+			{
+				MidPoint += positions[ vertex.v ];
+			}
+			MidPoint /= float( face_vertIds.size() );
 
-	std::error_code ec;
-	std::size_t fileSize = std::filesystem::file_size( fileName, ec );
+			std::vector<glm::vec3> centeredPoints( face_vertIds.size() );
 
-	if ( ec ) throw(EXC_FILENOTFOUND);
+			std::transform( face_vertIds.cbegin(), face_vertIds.cend(), centeredPoints.begin(),
+							[&positions,MidPoint]( const IndexedVert& faceV )->glm::vec3
+							{ return positions[ faceV.v ] - MidPoint;}
+							);
 
-	std::vector<char> objRawData( fileSize );
+			float cov_xx = 0.0f, cov_xy = 0.0f;
+			float cov_yy = 0.0f, cov_yz = 0.0f;
+			float cov_xz = 0.0f, cov_zz = 0.0f;
 
-	std::ifstream objFileStrm( fileName, std::ios::binary );
+			for ( const glm::vec3& centeredP : centeredPoints )
+			{
+				cov_xx += centeredP.x * centeredP.x;
+				cov_xy += centeredP.x * centeredP.y;
+				
+				cov_yy += centeredP.y * centeredP.y;
+				cov_yz += centeredP.y * centeredP.z;
 
-	if ( !objFileStrm ) throw(EXC_FILENOTFOUND);
+				cov_xz += centeredP.x * centeredP.z;
+				cov_zz += centeredP.z * centeredP.z;
+			}
 
-	objFileStrm.read( objRawData.data(), fileSize );
+			// viktor-vad: Very strange, but the pca.hpp and pca.inc disappeared from glm/gtx.
+			// Did not find any explanation for this.
+			// Instead of some header file copy-hacking, I implemented a 3x3 verion of eigen decomposition.
+			// It was not intended, but most likely it is faster than the original glm pca, since that is a general method with Housholder and QR.
+			// https://dl.acm.org/doi/epdf/10.1145/355578.366316
+			// https://en.wikipedia.org/wiki/Eigenvalue_algorithm#2%C3%972_matrices
+			glm::vec3 eigenVectors[2];
+			{
+				glm::vec3 eigenVectors_[3];
+				float p1 = cov_xy * cov_xy + cov_xz * cov_xz + cov_yz * cov_yz;
+				float trC = cov_xx + cov_yy + cov_zz;
+				float eig1 = 0.0f, eig2 = 0.0f, eig3 = 0.0f;
 
-	InMemoryTokenizer tokenizer;
+				// normal case
+				if ( p1 > 1e-15f )
+				{
+					float q = trC / 3.0f;
+					float p2 = ( cov_xx - q ) * ( cov_xx - q ) + ( cov_yy - q ) * ( cov_yy - q ) + ( cov_zz - q ) * ( cov_zz - q ) + 2.0f * p1;
+					float p = std::sqrt( p2 / 6.0f );
+
+					float cov_xx_q = cov_xx - q;
+					float cov_yy_q = cov_yy - q;
+					float cov_zz_q = cov_zz - q;
+
+					float r = glm::clamp( ( cov_xx_q * cov_yy_q * cov_zz_q + 2.0f * cov_xy * cov_yz * cov_xz - cov_xx_q * cov_yz * cov_yz - cov_yy_q * cov_xz * cov_xz - cov_zz_q * cov_xy * cov_xy ) / ( 2.0f * p * p * p ),
+										  -1.0f, 1.0f );
+
+					float phi = ::acosf( r ) / 3.0f;
 
-	tokenizer.SetData( objRawData.data(), fileSize );
+					eig1 = q + 2.0f * p * std::cos( phi );
+					eig2 = q + 2.0f * p * std::cos( phi + ( 2.0f * glm::pi<float>() / 3.0f ) );
+					eig3 = trC - eig1 - eig2;
+				}
+				else // covariance matrix is numericaly diagonal. We assume eigen values are the diagonal values.
+				{
+					eig1 = std::max( { cov_xx, cov_yy, cov_zz } );
+					eig3 = std::min( { cov_xx, cov_yy, cov_zz } );
+					eig2 = trC - eig1 - eig2;
+				}
 
-	unsigned int nIndexedVerts = 0;
+				eigenVectors_[ 0 ] = glm::vec3( cov_xy * cov_xy + cov_xz * cov_xz + ( cov_xx - eig2 ) * ( cov_xx - eig3 ),
+											   cov_xy * ( ( cov_xx - eig3 ) + ( cov_yy - eig2 ) ) + cov_xz * cov_yz,
+											   cov_xz * ( ( cov_xx - eig3 ) + ( cov_zz - eig2 ) ) + cov_xy * cov_yz );
+
+				eigenVectors_[ 1 ] = glm::vec3( cov_xy * ( ( cov_xx - eig1 ) + ( cov_yy - eig3 ) ) + cov_xz * cov_yz,
+											   cov_yz * cov_yz + cov_xy * cov_xy + ( cov_yy - eig1 ) * ( cov_yy - eig3 ),
+											   cov_yz * ( ( cov_yy - eig3 ) + ( cov_zz - eig1 ) ) + cov_xy * cov_xz );
+
+				eigenVectors_[ 2 ] = glm::vec3( cov_xz * ( ( cov_xx - eig1 ) + ( cov_zz - eig2 ) ) + cov_xy * cov_yz,
+											   cov_yz * ( ( cov_yy - eig1 ) + ( cov_zz - eig2 ) ) + cov_xy * cov_xz,
+											   cov_yz * cov_yz + cov_xz * cov_xz + ( cov_zz - eig1 ) * ( cov_zz - eig2 ) );
+				
+				// Simplification of original method.
+				// We only need the first 2 eigen vectors for 2D projection.
+				// Therefor we are not intereted, which is bigger, but in leaving the smallest out.
+				float minEig = std::min( { eig1, eig2, eig3 } );
+
+				if ( eig3 == minEig )
+				{
+					eigenVectors[ 0 ] = glm::normalize( eigenVectors_[ 0 ] );
+					eigenVectors[ 1 ] = glm::normalize( eigenVectors_[ 1 ] );
+				}
+				else if ( eig2 == minEig )
+				{
+                                eigenVectors[ 0 ] = glm::normalize( eigenVectors_[ 0 ] );
+                                eigenVectors[ 1 ] = glm::normalize( eigenVectors_[ 2 ] );
+                            }
+				else //if ( eig1 == minEig ) most unlikly case
+				{
+                                eigenVectors[ 0 ] = glm::normalize( eigenVectors_[ 1 ] );
+                                eigenVectors[ 1 ] = glm::normalize( eigenVectors_[ 2 ] );
+                            }
+			}
+
+			std::vector<glm::vec2> facePointsProjected( face_vertIds.size() );
+			
+
+			std::transform(centeredPoints.cbegin(),centeredPoints.cend(),facePointsProjected.begin(),
+							[ &eigenVectors ]( const glm::vec3& cp )->glm::vec2
+							{
+								return glm::vec2(
+									glm::dot( cp, eigenVectors[0] ),
+									glm::dot( cp, eigenVectors[1] )
+								);
+							} );
+
+			// checking the orientation. CCW should be kept
+			float sum = 0.0;
+			for ( int i = 0; i < facePointsProjected.size() - 1; ++i )
+			{
+				sum += ( facePointsProjected[ i + 1 ].x - facePointsProjected[ i ].x ) *
+					( facePointsProjected[ i + 1 ].y + facePointsProjected[ i ].y );
+			}
+			sum += ( facePointsProjected.front().x - facePointsProjected.back().x ) *
+				( facePointsProjected.front().y + facePointsProjected.back().y );
+
+			if ( sum > 0.0f )
+			{
+				for ( int i = 0; i < facePointsProjected.size(); ++i )
+					facePointsProjected[ i ].y *= -1.0f;
+			}
+
+			std::vector<unsigned int> triIndices = triangulatePolygon( facePointsProjected );
+			
+			face_vertIdsFace2Tris.resize( triIndices.size() );
+			std::transform( triIndices.cbegin(), triIndices.cend(), face_vertIdsFace2Tris.begin(),
+							[ &face_vertIds ]( const unsigned int fTriId )->IndexedVert
+							{
+								return face_vertIds[ fTriId ];
+							} );
+
+		}
+		face_vertIds = std::move( face_vertIdsFace2Tris );
+	}
+}
+
+// Number of normals computeFaceNormals generates for an already triangulated face.
+static inline unsigned int faceNormalCount( const std::vector<IndexedVert>& face_vertIds ) noexcept
+{
+	return static_cast<unsigned int>( ( face_vertIds.size() + 2 ) / 3 );
+}
+
+// Computes one flat normal per triangle into normalsOut and points the corners to them.
+// firstNormalIdx is the index of normalsOut[0] in the normal array of the mesh.
+static void computeFaceNormals( const std::vector<glm::vec3>& positions, std::vector<IndexedVert>& face_vertIds, glm::vec3* normalsOut, unsigned int firstNormalIdx )
+{
+	for ( int i = 0; i < face_vertIds.size(); i += 3 )
+	{
+		glm::vec3 n = glm::normalize( glm::cross(
+			positions[face_vertIds[i + 1].v] - positions[face_vertIds[i].v],
+			positions[face_vertIds[i + 2].v] - positions[face_vertIds[i].v]
+		) );
+
+		unsigned int n_idx = firstNormalIdx + i / 3;
+		normalsOut[ i / 3 ] = n;
+		face_vertIds[ i ].vn = face_vertIds[ i + 1 ].vn = face_vertIds[ i + 2 ].vn = n_idx;
+	}
+}
+
+// Walks the records of an in-memory .obj file and hands the geometry records to the consumer:
+//   consumer.position( glm::vec3 ), consumer.normal( glm::vec3 ), consumer.texcoord( glm::vec2 ),
+//   consumer.face( std::vector<IndexedVert>& face_vertIds, bool needsNormalComputation )
+template <typename Consumer>
+static void parseRecords( const char* data, std::size_t size, Consumer& consumer )
+{
+	std::vector<IndexedVert> face_vertIds;
+	face_vertIds.reserve( 4 );
+
+	InMemoryTokenizer tokenizer;
+
+	tokenizer.SetData( data, size );
 
 	while ( tokenizer )
 	{
 		std::string_view token = tokenizer.NextToken();
 
+		// only trailing whitespace was left
+		if ( token.empty() ) break;
+
 		if ( token[ 0 ] == '#' )
 		{
 			tokenizer.ToNextLine();
@@ -141,340 +372,516 @@ ObjParser::Mesh ObjParser::parse(const std::filesystem::path& fileName)
 			case From2Char('v',' '):
 			case From2Char('v','\t'): // v <x> <y> <z> [<w>]
 			{
-				positions.emplace_back(glm::vec3());
-
-				float& x = positions.back().x;
-				float& y = positions.back().y;
-				float& z = positions.back().z;
-
-				std::string_view coordT = tokenizer.NextToken();
-				std::from_chars( coordT.data(), coordT.data() + coordT.size(), x );
-				coordT = tokenizer.NextToken();
-				std::from_chars( coordT.data(), coordT.data() + coordT.size(), y );
-				coordT = tokenizer.NextToken();
-				std::from_chars( coordT.data(), coordT.data() + coordT.size(), z );
-				coordT = tokenizer.NextToken(true);
-
-				if ( !coordT.empty() )
-				{
-					float w;
-					std::from_chars( coordT.data(), coordT.data() + coordT.size(), w );
-					x /= w;
-					y /= w;
-					z /= w;
-				}
+				consumer.position( parsePosition( tokenizer ) );
 			}break;
 			case From2Char('v','n'): // vn <nx> <ny> <nz>
 			{
-				normals.emplace_back(glm::vec3());
-
-				float& x = normals.back().x;
-				float& y = normals.back().y;
-				float& z = normals.back().z;
-
-				std::string_view coordT = tokenizer.NextToken();
-				std::from_chars( coordT.data(), coordT.data() + coordT.size(), x );
-				coordT = tokenizer.NextToken();
-				std::from_chars( coordT.data(), coordT.data() + coordT.size(), y );
-				coordT = tokenizer.NextToken();
-				std::from_chars( coordT.data(), coordT.data() + coordT.size(), z );
-				
+				consumer.normal( parseNormal( tokenizer ) );
 			}break;
 			case From2Char('v','t'): // vt <s> <t>
 			{
-				texcoords.emplace_back(glm::vec2());
-
-				float& s = texcoords.back().x;
-				float& t = texcoords.back().y;
-
-				std::string_view coordT = tokenizer.NextToken();
-				std::from_chars( coordT.data(), coordT.data() + coordT.size(), s );
-				coordT = tokenizer.NextToken();
-				std::from_chars( coordT.data(), coordT.data() + coordT.size(), t );
-	
+				consumer.texcoord( parseTexcoord( tokenizer ) );
 			}break;
 			case From2Char('f',' '):
 			case From2Char('f','\t'): // f (<pi>[/<ti>][/<ni>])3+
 			{
-				face_vertIds.clear();
-				needsNormalComputation = false;
+				bool needsNormalComputation = parseFaceCorners( tokenizer, face_vertIds );
+				consumer.face( face_vertIds, needsNormalComputation );
+			}break;
+		}
 
-				std::string_view faceVertT = tokenizer.NextToken( true );
-				while ( !faceVertT.empty() )
-				{
-					face_vertIds.emplace_back( IndexedVert{} );
-					IndexedVert& idxVert = face_vertIds.back();
-
-					size_t posEndOffs = faceVertT.find_first_of( '/', 0 );
-					if ( posEndOffs == std::string_view::npos ) posEndOffs = faceVertT.size();
-
-					std::from_chars( faceVertT.data(), faceVertT.data() + posEndOffs, idxVert.v );
-					idxVert.v--;
-
-					size_t texStartOffs = posEndOffs + 1;
-					size_t texEndOffs = faceVertT.find_first_of( '/', texStartOffs );
-					if ( texEndOffs == std::string_view::npos ) texEndOffs = faceVertT.size();
-					if ( texEndOffs > texStartOffs ) std::from_chars( faceVertT.data() + texStartOffs, faceVertT.data() + texEndOffs, idxVert.vt);
-					if ( idxVert.vt ) idxVert.vt--; 
-					size_t normStartOffs = texEndOffs + 1;
-
-					if ( faceVertT.size() > normStartOffs )
-					{
-						std::from_chars( faceVertT.data() + normStartOffs, faceVertT.data() + faceVertT.size(), idxVert.vn );
-						idxVert.vn--;
-					}
-					else needsNormalComputation = true;
-					
-					faceVertT = tokenizer.NextToken( true );
-				}
+		tokenizer.ToNextLine();
+	}
+}
 
-				if ( 3 < face_vertIds.size() )
-				{
-					std::vector<IndexedVert> face_vertIdsFace2Tris;
-					if ( 4 == face_vertIds.size() )
-					{
-						glm::vec3 v10 = positions[ face_vertIds[ 0 ].v ] - positions[ face_vertIds[ 1 ].v ];
-						glm::vec3 v12 = positions[ face_vertIds[ 2 ].v ] - positions[ face_vertIds[ 1 ].v ];
-
-						glm::vec3 v32 = positions[ face_vertIds[ 2 ].v ] - positions[ face_vertIds[ 3 ].v ];
-						glm::vec3 v30 = positions[ face_vertIds[ 0 ].v ] - positions[ face_vertIds[ 3 ].v ];
-
-						float angle_012 = ::acosf( glm::dot(v10,v12) / sqrtf( glm::dot(v10,v10) * glm::dot(v12,v12) ) );
-						float angle_230 = ::acosf( glm::dot(v32,v30) / sqrtf( glm::dot(v32,v32) * glm::dot(v30,v30) ) );
-						
-						if ( ( angle_012 + angle_230 ) <= glm::pi<float>() )
-						{
-							face_vertIdsFace2Tris =
-							{ face_vertIds[ 0 ], face_vertIds[ 1 ], face_vertIds[ 2 ],
-							  face_vertIds[ 0 ], face_vertIds[ 2 ], face_vertIds[ 3 ] };
-						}
-						else
-						{
-							face_vertIdsFace2Tris =
-							{ face_vertIds[ 0 ], face_vertIds[ 1 ], face_vertIds[ 3 ],
-							  face_vertIds[ 1 ], face_vertIds[ 2 ], face_vertIds[ 3 ] };
-						}
-					}
-					else 
-					{
-						// Calculate the best fitting plane
-						glm::vec3 MidPoint( 0.0 );
-						for ( const auto& vertex : face_vertIds )
-						{
-							MidPoint += positions[ vertex.v ];
-						}
-						MidPoint /= float( face_vertIds.size() );
-
-						std::vector<glm::vec3> centeredPoints( face_vertIds.size() );
-
-						std::transform( face_vertIds.cbegin(), face_vertIds.cend(), centeredPoints.begin(),
-										[&positions,MidPoint]( const IndexedVert& faceV )->glm::vec3
-										{ return positions[ faceV.v ] - MidPoint;}
-										);
-
-						float cov_xx = 0.0f, cov_xy = 0.0f;
-						float cov_yy = 0.0f, cov_yz = 0.0f;
-						float cov_xz = 0.0f, cov_zz = 0.0f;
-
-						for ( const glm::vec3& centeredP : centeredPoints )
-						{
-							cov_xx += centeredP.x * centeredP.x;
-							cov_xy += centeredP.x * centeredP.y;
-							
-							cov_yy += centeredP.y * centeredP.y;
-							cov_yz += centeredP.y * centeredP.z;
-
-							cov_xz += centeredP.x * centeredP.z;
-							cov_zz += centeredP.z * centeredP.z;
-						}
-
-						// viktor-vad: Very strange, but the pca.hpp and pca.inc disappeared from glm/gtx.
-						// Did not find any explanation for this.
-						// Instead of some header file copy-hacking, I implemented a 3x3 verion of eigen decomposition.
-						// It was not intended, but most likely it is faster than the original glm pca, since that is a general method with Housholder and QR.
-						// https://dl.acm.org/doi/epdf/10.1145/355578.366316
-						// https://en.wikipedia.org/wiki/Eigenvalue_algorithm#2%C3%972_matrices
-						glm::vec3 eigenVectors[2];
-						{
-							glm::vec3 eigenVectors_[3];
-							float p1 = cov_xy * cov_xy + cov_xz * cov_xz + cov_yz * cov_yz;
-							float trC = cov_xx + cov_yy + cov_zz;
-							float eig1 = 0.0f, eig2 = 0.0f, eig3 = 0.0f;
-
-							// normal case
-							if ( p1 > 1e-15f )
-							{
-								float q = trC / 3.0f;
-								float p2 = ( cov_xx - q ) * ( cov_xx - q ) + ( cov_yy - q ) * ( cov_yy - q ) + ( cov_zz - q ) * ( cov_zz - q ) + 2.0f * p1;
-								float p = std::sqrt( p2 / 6.0f );
+namespace
+{
+	// Builds the mesh while the records are read (serial path).
+	struct MeshBuilder
+	{
+		ObjParser::Mesh resultMesh;
 
-								float cov_xx_q = cov_xx - q;
-								float cov_yy_q = cov_yy - q;
-								float cov_zz_q = cov_zz - q;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> normals;
+		std::vector<glm::vec2> texcoords;
 
-								float r = glm::clamp( ( cov_xx_q * cov_yy_q * cov_zz_q + 2.0f * cov_xy * cov_yz * cov_xz - cov_xx_q * cov_yz * cov_yz - cov_yy_q * cov_xz * cov_xz - cov_zz_q * cov_xy * cov_xy ) / ( 2.0f * p * p * p ),
-													  -1.0f, 1.0f );
+		IndexedVertTable vertexIndices;
+		DirectIndexedVertTable directVertexIndices;
+		unsigned int nIndexedVerts = 0;
 
-								float phi = ::acosf( r ) / 3.0f;
+		void position( const glm::vec3& p ) { positions.push_back( p ); }
+		void normal( const glm::vec3& n ) { normals.push_back( n ); }
+		void texcoord( const glm::vec2& t ) { texcoords.push_back( t ); }
 
-								eig1 = q + 2.0f * p * std::cos( phi );
-								eig2 = q + 2.0f * p * std::cos( phi + ( 2.0f * glm::pi<float>() / 3.0f ) );
-								eig3 = trC - eig1 - eig2;
-							}
-							else // covariance matrix is numericaly diagonal. We assume eigen values are the diagonal values.
-							{
-								eig1 = std::max( { cov_xx, cov_yy, cov_zz } );
-								eig3 = std::min( { cov_xx, cov_yy, cov_zz } );
-								eig2 = trC - eig1 - eig2;
-							}
-
-							eigenVectors_[ 0 ] = glm::vec3( cov_xy * cov_xy + cov_xz * cov_xz + ( cov_xx - eig2 ) * ( cov_xx - eig3 ),
-														   cov_xy * ( ( cov_xx - eig3 ) + ( cov_yy - eig2 ) ) + cov_xz * cov_yz,
-														   cov_xz * ( ( cov_xx - eig3 ) + ( cov_zz - eig2 ) ) + cov_xy * cov_yz );
-
-							eigenVectors_[ 1 ] = glm::vec3( cov_xy * ( ( cov_xx - eig1 ) + ( cov_yy - eig3 ) ) + cov_xz * cov_yz,
-														   cov_yz * cov_yz + cov_xy * cov_xy + ( cov_yy - eig1 ) * ( cov_yy - eig3 ),
-														   cov_yz * ( ( cov_yy - eig3 ) + ( cov_zz - eig1 ) ) + cov_xy * cov_xz );
-
-							eigenVectors_[ 2 ] = glm::vec3( cov_xz * ( ( cov_xx - eig1 ) + ( cov_zz - eig2 ) ) + cov_xy * cov_yz,
-														   cov_yz * ( ( cov_yy - eig1 ) + ( cov_zz - eig2 ) ) + cov_xy * cov_xz,
-														   cov_yz * cov_yz + cov_xz * cov_xz + ( cov_zz - eig1 ) * ( cov_zz - eig2 ) );
-							
-							// Simplification of original method.
-							// We only need the first 2 eigen vectors for 2D projection.
-							// Therefor we are not intereted, which is bigger, but in leaving the smallest out.
-							float minEig = std::min( { eig1, eig2, eig3 } );
-
-							if ( eig3 == minEig )
-							{
-								eigenVectors[ 0 ] = glm::normalize( eigenVectors_[ 0 ] );
-								eigenVectors[ 1 ] = glm::normalize( eigenVectors_[ 1 ] );
-							}
-							else if ( eig2 == minEig )
-							{
-                                eigenVectors[ 0 ] = glm::normalize( eigenVectors_[ 0 ] );
-                                eigenVectors[ 1 ] = glm::normalize( eigenVectors_[ 2 ] );
-                            }
-							else //if ( eig1 == minEig ) most unlikly case
-							{
-                                eigenVectors[ 0 ] = glm::normalize( eigenVectors_[ 1 ] );
-                                eigenVectors[ 1 ] = glm::normalize( eigenVectors_[ 2 ] );
-                            }
-						}
-
-						std::vector<glm::vec2> facePointsProjected( face_vertIds.size() );
-						
-
-						std::transform(centeredPoints.cbegin(),centeredPoints.cend(),facePointsProjected.begin(),
-										[ &eigenVectors ]( const glm::vec3& cp )->glm::vec2
-										{
-											return glm::vec2(
-												glm::dot( cp, eigenVectors[0] ),
-												glm::dot( cp, eigenVectors[1] )
-											);
-										} );
-
-						// checking the orientation. CCW should be kept
-						float sum = 0.0;
-						for ( int i = 0; i < facePointsProjected.size() - 1; ++i )
-						{
-							sum += ( facePointsProjected[ i + 1 ].x - facePointsProjected[ i ].x ) *
-								( facePointsProjected[ i + 1 ].y + facePointsProjected[ i ].y );
-						}
-						sum += ( facePointsProjected.front().x - facePointsProjected.back().x ) *
-							( facePointsProjected.front().y + facePointsProjected.back().y );
-
-						if ( sum > 0.0f )
-						{
-							for ( int i = 0; i < facePointsProjected.size(); ++i )
-								facePointsProjected[ i ].y *= -1.0f;
-						}
-
-						std::vector<unsigned int> triIndices = triangulatePolygon( facePointsProjected );
-						
-						face_vertIdsFace2Tris.resize( triIndices.size() );
-						std::transform( triIndices.cbegin(), triIndices.cend(), face_vertIdsFace2Tris.begin(),
-										[ &face_vertIds ]( const unsigned int fTriId )->IndexedVert
-										{
-											return face_vertIds[ fTriId ];
-										} );
-
-					}
-					face_vertIds = std::move( face_vertIdsFace2Tris );
-				}
-				
-				if ( texcoords.empty() ) texcoords.emplace_back( glm::vec2( 0.0 ) );
-				
-				if ( needsNormalComputation )
-				{
-					for ( int i = 0; i < face_vertIds.size(); i += 3 )
-					{
-						glm::vec3 n = glm::normalize( glm::cross(
-							positions[face_vertIds[i + 1].v] - positions[face_vertIds[i].v],
-							positions[face_vertIds[i + 2].v] - positions[face_vertIds[i].v]
-						) );
-
-						unsigned int n_idx = static_cast<unsigned int>( normals.size() );
-						normals.push_back( n );
-						face_vertIds[ i ].vn = face_vertIds[ i + 1 ].vn = face_vertIds[ i + 2 ].vn = n_idx;
-					}
-				}
+		void face( std::vector<IndexedVert>& face_vertIds, bool needsNormalComputation )
+		{
+			triangulateFace( positions, face_vertIds );
+
+			if ( texcoords.empty() ) texcoords.emplace_back( glm::vec2( 0.0 ) );
+
+			// most files have every position before the first face, about that many vertices are expected
+			if ( vertexIndices.Size() == 0 ) vertexIndices.Reserve( positions.size() );
+			directVertexIndices.Resize( positions.size() );
 
+			if ( needsNormalComputation )
+			{
+				unsigned int firstNormalIdx = static_cast<unsigned int>( normals.size() );
+				normals.resize( normals.size() + faceNormalCount( face_vertIds ) );
+				computeFaceNormals( positions, face_vertIds, normals.data() + firstNormalIdx, firstNormalIdx );
+			}
 
-				for ( const auto& vertex : face_vertIds )
+			for ( const auto& vertex : face_vertIds )
+			{
+				auto [ vIndex, isNew ] = directVertexIndices.CanStore( vertex ) ? directVertexIndices.TryEmplace( vertex, nIndexedVerts )
+																				: vertexIndices.TryEmplace( vertex, nIndexedVerts );
+				if ( isNew )
 				{
-					unsigned int& vIndex = vertexIndices[ vertex ];
-					if (vIndex == 0) // new vertex
-					{
-						Vertex v;
-						v.position = positions[vertex.v];
-						v.texcoord = texcoords[vertex.vt];
-						v.normal = normals[vertex.vn];
-
-						resultMesh.vertexArray.push_back(v);
-						resultMesh.indexArray.push_back(nIndexedVerts++);
-						vIndex = nIndexedVerts;	
-					} else {
-						resultMesh.indexArray.push_back(vIndex-1);
-					}
+					Vertex v;
+					v.position = positions[vertex.v];
+					v.texcoord = texcoords[vertex.vt];
+					v.normal = normals[vertex.vn];
+
+					resultMesh.vertexArray.push_back(v);
+					nIndexedVerts++;
 				}
-			}break;
+				resultMesh.indexArray.push_back(vIndex);
+			}
 		}
+	};
 
-		tokenizer.ToNextLine();
+	// One line aligned piece of the file for the parallel parser.
+	// The first phase only collects the records, the indices are resolved after every chunk was read,
+	// so the result is exactly the same as the one of the serial MeshBuilder.
+	struct ObjChunk
+	{
+		struct Face
+		{
+			unsigned int firstCorner;
+			unsigned int cornerCount;
+			unsigned int firstNormalSlot; // only valid if needsNormalComputation
+			bool needsNormalComputation;
+		};
+
+		const char* data = nullptr;
+		std::size_t size = 0;
+
+		// phase 1: records of this chunk
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> normals;
+		std::vector<unsigned int> normalSlots; // position of each vn record among the normals of this chunk
+		std::vector<glm::vec2> texcoords;
+		std::vector<IndexedVert> corners;
+		std::vector<Face> faces;
+
+		// Computed normals are appended to the normal array in file order, interleaved with the vn records.
+		unsigned int normalSlotCount = 0;
+		// The serial parser inserts a (0,0) texcoord if a face comes before any vt record.
+		bool faceBeforeTexcoord = false;
+
+		// phase 2: offsets in the merged arrays
+		std::size_t positionBase = 0;
+		std::size_t texcoordBase = 0;
+		std::size_t normalBase = 0;
+		std::size_t indexBase = 0;
+
+		// phase 3: triangulated corners and their local deduplication
+		std::vector<IndexedVert> triCorners;
+		std::vector<IndexedVert> uniqueVerts;
+		std::vector<unsigned int> localIndices;
+		std::vector<unsigned int> globalIds;
+
+		void position( const glm::vec3& p ) { positions.push_back( p ); }
+		void normal( const glm::vec3& n )
+		{
+			normals.push_back( n );
+			normalSlots.push_back( normalSlotCount++ );
+		}
+		void texcoord( const glm::vec2& t ) { texcoords.push_back( t ); }
+
+		void face( std::vector<IndexedVert>& face_vertIds, bool needsNormalComputation )
+		{
+			if ( texcoords.empty() ) faceBeforeTexcoord = true;
+
+			Face f;
+			f.firstCorner = static_cast<unsigned int>( corners.size() );
+			f.cornerCount = static_cast<unsigned int>( face_vertIds.size() );
+			f.firstNormalSlot = normalSlotCount;
+			f.needsNormalComputation = needsNormalComputation;
+			faces.push_back( f );
+
+			corners.insert( corners.end(), face_vertIds.cbegin(), face_vertIds.cend() );
+
+			if ( needsNormalComputation )
+			{
+				// polygons are split into n-2 triangles, each gets its own normal
+				const std::size_t triCornerCount = ( f.cornerCount > 3 ) ? 3 * ( f.cornerCount - 2 ) : f.cornerCount;
+				normalSlotCount += static_cast<unsigned int>( ( triCornerCount + 2 ) / 3 );
+			}
+		}
+	};
+
+	// Splits the buffer into about chunkCount pieces, each starting at the beginning of a line.
+	std::vector<ObjChunk> splitIntoChunks( const char* data, std::size_t size, std::size_t chunkCount )
+	{
+		std::vector<ObjChunk> chunks;
+		chunks.reserve( chunkCount );
+
+		const char* end = data + size;
+		const char* chunkStart = data;
+		for ( std::size_t i = 1; i <= chunkCount && chunkStart < end; ++i )
+		{
+			const char* chunkEnd = end;
+			if ( i < chunkCount )
+			{
+				chunkEnd = std::max( chunkStart, data + size / chunkCount * i );
+				const char* lineEnd = static_cast<const char*>( std::memchr( chunkEnd, '\n', end - chunkEnd ) );
+				chunkEnd = lineEnd ? lineEnd + 1 : end;
+			}
+
+			ObjChunk chunk;
+			chunk.data = chunkStart;
+			chunk.size = chunkEnd - chunkStart;
+			chunks.push_back( std::move( chunk ) );
+
+			chunkStart = chunkEnd;
+		}
+
+		return chunks;
+	}
+}
+
+ObjParser::Mesh ObjParser::parse(const std::filesystem::path& fileName, unsigned int threadCount)
+{
+	std::error_code ec;
+	std::size_t fileSize = std::filesystem::file_size( fileName, ec );
+
+	if ( ec ) throw(EXC_FILENOTFOUND);
+
+	std::vector<char> objRawData( fileSize );
+
+	std::ifstream objFileStrm( fileName, std::ios::binary );
+
+	if ( !objFileStrm ) throw(EXC_FILENOTFOUND);
+
+	objFileStrm.read( objRawData.data(), fileSize );
+
+	return parseBuffer( objRawData.data(), fileSize, threadCount );
+}
+
+ObjParser::Mesh ObjParser::parseBuffer(const char* data, std::size_t size, unsigned int threadCount)
+{
+	if ( threadCount > 1 ) return parseBufferParallel( data, size, threadCount );
+
+	MeshBuilder builder;
+	parseRecords( data, size, builder );
+
+	return std::move( builder.resultMesh );
+}
+
+ObjParser::Mesh ObjParser::parseBufferParallel(const char* data, std::size_t size, unsigned int threadCount)
+{
+	// A few chunks per thread balance the uneven record mix (e.g. all faces at the end of the file).
+	constexpr std::size_t MIN_CHUNK_SIZE = 64 * 1024;
+	const std::size_t chunkCount = std::clamp<std::size_t>( size / MIN_CHUNK_SIZE, 1, std::size_t( threadCount ) * 4 );
+
+	std::vector<ObjChunk> chunks = splitIntoChunks( data, size, chunkCount );
+
+	ThreadPool pool( threadCount );
+
+	// 1. reading the records of each chunk
+	pool.ParallelFor( chunks.size(), [ &chunks ]( std::size_t c )
+	{
+		ObjChunk& chunk = chunks[ c ];
+		parseRecords( chunk.data, chunk.size, chunk );
+	} );
+
+	// 2. offsets of the chunks in the merged attribute arrays
+	std::size_t positionCount = 0, texcoordCount = 0, normalCount = 0;
+	bool hasDefaultTexcoord = false;
+	for ( ObjChunk& chunk : chunks )
+	{
+		if ( texcoordCount == 0 && chunk.faceBeforeTexcoord ) hasDefaultTexcoord = true;
+
+		chunk.positionBase = positionCount;
+		chunk.texcoordBase = texcoordCount;
+		chunk.normalBase = normalCount;
+
+		positionCount += chunk.positions.size();
+		texcoordCount += chunk.texcoords.size();
+		normalCount += chunk.normalSlotCount;
+	}
+
+	std::vector<glm::vec3> positions( positionCount );
+	std::vector<glm::vec3> normals( normalCount );
+	std::vector<glm::vec2> texcoords( texcoordCount + ( hasDefaultTexcoord ? 1 : 0 ), glm::vec2( 0.0 ) );
+	const std::size_t texcoordOffset = hasDefaultTexcoord ? 1 : 0;
+
+	pool.ParallelFor( chunks.size(), [ & ]( std::size_t c )
+	{
+		ObjChunk& chunk = chunks[ c ];
+		std::copy( chunk.positions.cbegin(), chunk.positions.cend(), positions.begin() + chunk.positionBase );
+		std::copy( chunk.texcoords.cbegin(), chunk.texcoords.cend(), texcoords.begin() + texcoordOffset + chunk.texcoordBase );
+		for ( std::size_t i = 0; i < chunk.normals.size(); ++i )
+		{
+			normals[ chunk.normalBase + chunk.normalSlots[ i ] ] = chunk.normals[ i ];
+		}
+	} );
+
+	// 3. triangulation, computed normals and deduplication inside the chunks
+	pool.ParallelFor( chunks.size(), [ & ]( std::size_t c )
+	{
+		ObjChunk& chunk = chunks[ c ];
+
+		std::vector<IndexedVert> face_vertIds;
+		for ( const ObjChunk::Face& face : chunk.faces )
+		{
+			face_vertIds.assign( chunk.corners.cbegin() + face.firstCorner, chunk.corners.cbegin() + face.firstCorner + face.cornerCount );
+			triangulateFace( positions, face_vertIds );
+
+			if ( face.needsNormalComputation )
+			{
+				const std::size_t firstNormalIdx = chunk.normalBase + face.firstNormalSlot;
+				computeFaceNormals( positions, face_vertIds, normals.data() + firstNormalIdx, static_cast<unsigned int>( firstNormalIdx ) );
+			}
+
+			chunk.triCorners.insert( chunk.triCorners.end(), face_vertIds.cbegin(), face_vertIds.cend() );
+		}
+
+		// a triangulated mesh has about half as many vertices as triangles
+		IndexedVertTable localIndices( chunk.triCorners.size() / 6 );
+		chunk.localIndices.reserve( chunk.triCorners.size() );
+		for ( const IndexedVert& vertex : chunk.triCorners )
+		{
+			auto [ localIdx, inserted ] = localIndices.TryEmplace( vertex, static_cast<unsigned int>( chunk.uniqueVerts.size() ) );
+			if ( inserted ) chunk.uniqueVerts.push_back( vertex );
+			chunk.localIndices.push_back( localIdx );
+		}
+
+		std::vector<glm::vec3>().swap( chunk.positions );
+		std::vector<IndexedVert>().swap( chunk.corners );
+	} );
+
+	// 4. global deduplication in chunk order: a vertex gets its index in the chunk, where it was seen first,
+	//    in the order of its first occurrence there - the same order as the serial parser assigns them.
+	std::vector<IndexedVert> vertexKeys;
+	std::size_t indexCount = 0;
+	{
+		std::size_t uniqueVertCount = 0;
+		for ( const ObjChunk& chunk : chunks ) uniqueVertCount += chunk.uniqueVerts.size();
+
+		IndexedVertTable globalIndices;
+		DirectIndexedVertTable directGlobalIndices;
+		directGlobalIndices.Resize( positions.size() );
+		vertexKeys.reserve( uniqueVertCount );
+
+		for ( ObjChunk& chunk : chunks )
+		{
+			chunk.indexBase = indexCount;
+			indexCount += chunk.localIndices.size();
+
+			chunk.globalIds.resize( chunk.uniqueVerts.size() );
+			for ( std::size_t i = 0; i < chunk.uniqueVerts.size(); ++i )
+			{
+				const IndexedVert& vertex = chunk.uniqueVerts[ i ];
+				const unsigned int newIndex = static_cast<unsigned int>( vertexKeys.size() );
+				auto [ globalIdx, inserted ] = directGlobalIndices.CanStore( vertex ) ? directGlobalIndices.TryEmplace( vertex, newIndex )
+																					 : globalIndices.TryEmplace( vertex, newIndex );
+				if ( inserted ) vertexKeys.push_back( vertex );
+				chunk.globalIds[ i ] = globalIdx;
+			}
+		}
 	}
 
+	// 5. building the vertex and index arrays
+	Mesh resultMesh;
+	resultMesh.vertexArray.resize( vertexKeys.size() );
+	resultMesh.indexArray.resize( indexCount );
+
+	const std::size_t vertexRangeCount = std::max<std::size_t>( chunks.size(), 1 );
+	pool.ParallelFor( vertexRangeCount, [ & ]( std::size_t r )
+	{
+		const std::size_t first = vertexKeys.size() * r / vertexRangeCount;
+		const std::size_t last = vertexKeys.size() * ( r + 1 ) / vertexRangeCount;
+		for ( std::size_t i = first; i < last; ++i )
+		{
+			const IndexedVert& vertex = vertexKeys[ i ];
+			Vertex& v = resultMesh.vertexArray[ i ];
+			v.position = positions[vertex.v];
+			v.texcoord = texcoords[vertex.vt];
+			v.normal = normals[vertex.vn];
+		}
+	} );
+
+	pool.ParallelFor( chunks.size(), [ & ]( std::size_t c )
+	{
+		const ObjChunk& chunk = chunks[ c ];
+		std::transform( chunk.localIndices.cbegin(), chunk.localIndices.cend(), resultMesh.indexArray.begin() + chunk.indexBase,
+						[ &chunk ]( unsigned int localIdx ) { return chunk.globalIds[ localIdx ]; } );
+	} );
+
 	return resultMesh;
 }
 
-// Hash function for IndexedVert
-// version of fasthash64 https://github.com/ztanml/fast-hash
-// simplified for using only for 1 64 bit data (seed is the other one).
+// Binary mesh cache
+// Layout: MeshCacheHeader | Vertex[vertexCount] | GLuint[indexCount]
 
-static inline constexpr uint64_t fasthash64_mix(uint64_t h)
+namespace
 {
-	h ^= h >> 23;
-	h *= 0x2127599bf4325c37ULL;
-	h ^= h >> 47;
-	return h;
+	constexpr char     MESH_CACHE_MAGIC[ 4 ] = { 'Z', 'H', 'M', 'C' };
+	constexpr uint32_t MESH_CACHE_VERSION    = 1;
+	constexpr uint64_t MESH_CACHE_HASH_SEED  = 0x5a484d6573680001ULL;
+
+	struct MeshCacheHeader
+	{
+		char     magic[ 4 ];
+		uint32_t version;
+		uint64_t sourceHash;
+		uint64_t sourceSize;
+		uint32_t vertexSize;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t flags; // ObjParser::ParseFlags
+		uint32_t reserved[ 2 ];
+	};
+
+	static_assert( sizeof( MeshCacheHeader ) == 48 );
+	static_assert( sizeof( MeshCacheHeader ) % alignof( Vertex ) == 0 );
+	static_assert( sizeof( Vertex ) % alignof( GLuint ) == 0 );
 }
 
-static inline constexpr uint64_t fasthash64( uint64_t v, uint64_t seed )
+std::filesystem::path ObjParser::cachePath(const std::filesystem::path& fileName)
 {
-	constexpr uint64_t    m = 0x880355f21e6d1965ULL;
-	constexpr uint64_t    m_size = m * sizeof(uint64_t);
-	constexpr uint64_t    m_p2 = m * m;
+	std::filesystem::path cacheFileName = fileName;
+	cacheFileName += ".meshcache";
+	return cacheFileName;
+}
 
-	uint64_t h = seed ^ m_size;
-	h ^= fasthash64_mix(v);
-	h *= m_p2;
+bool ObjParser::mapCache(const std::filesystem::path& cacheFileName, uint64_t sourceHash, uint64_t sourceSize, unsigned int flags, CachedMesh& result)
+{
+	MappedFile blob;
+	if ( !blob.Open( cacheFileName ) || blob.size() < sizeof( MeshCacheHeader ) ) return false;
+
+	MeshCacheHeader header;
+	std::memcpy( &header, blob.data(), sizeof( header ) );
+
+	if ( std::memcmp( header.magic, MESH_CACHE_MAGIC, sizeof( header.magic ) ) != 0
+		 || header.version != MESH_CACHE_VERSION
+		 || header.sourceHash != sourceHash
+		 || header.sourceSize != sourceSize
+		 || header.flags != flags
+		 || header.vertexSize != sizeof( Vertex ) )
+	{
+		return false;
+	}
 
-	return fasthash64_mix(h);
+	const std::size_t vertexBytes = std::size_t( header.vertexCount ) * sizeof( Vertex );
+	const std::size_t indexBytes = std::size_t( header.indexCount ) * sizeof( GLuint );
+	if ( blob.size() != sizeof( MeshCacheHeader ) + vertexBytes + indexBytes ) return false;
+
+	const std::byte* vertexData = blob.data() + sizeof( MeshCacheHeader );
+
+	result.view.vertexData  = reinterpret_cast<const Vertex*>( vertexData );
+	result.view.vertexCount = header.vertexCount;
+	result.view.indexData   = reinterpret_cast<const GLuint*>( vertexData + vertexBytes );
+	result.view.indexCount  = header.indexCount;
+	result.blob = std::move( blob );
+
+	return true;
+}
+
+bool ObjParser::writeCache(const std::filesystem::path& cacheFileName, uint64_t sourceHash, uint64_t sourceSize, unsigned int flags, const Mesh& mesh)
+{
+	MeshCacheHeader header = {};
+	std::memcpy( header.magic, MESH_CACHE_MAGIC, sizeof( header.magic ) );
+	header.version     = MESH_CACHE_VERSION;
+	header.sourceHash  = sourceHash;
+	header.sourceSize  = sourceSize;
+	header.flags       = flags;
+	header.vertexSize  = sizeof( Vertex );
+	header.vertexCount = static_cast<uint32_t>( mesh.vertexArray.size() );
+	header.indexCount  = static_cast<uint32_t>( mesh.indexArray.size() );
+
+	// Write into a temporary file first, so a concurrently starting instance never maps a half written cache.
+	std::filesystem::path tmpFileName = cacheFileName;
+	tmpFileName += ".tmp";
+
+	{
+		std::ofstream cacheStrm( tmpFileName, std::ios::binary | std::ios::trunc );
+		if ( !cacheStrm ) return false;
+
+		cacheStrm.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+		cacheStrm.write( reinterpret_cast<const char*>( mesh.vertexArray.data() ), mesh.vertexArray.size() * sizeof( Vertex ) );
+		cacheStrm.write( reinterpret_cast<const char*>( mesh.indexArray.data() ), mesh.indexArray.size() * sizeof( GLuint ) );
+
+		if ( !cacheStrm ) return false;
+	}
+
+	std::error_code ec;
+	std::filesystem::rename( tmpFileName, cacheFileName, ec );
+	if ( ec )
+	{
+		std::filesystem::remove( tmpFileName, ec );
+		return false;
+	}
+
+	return true;
+}
+
+MeshBounds ObjParser::computeBounds(const MeshView<Vertex>& mesh)
+{
+	MeshBounds bounds;
+	if ( mesh.vertexCount == 0 ) return bounds;
+
+	bounds.aabbMin = bounds.aabbMax = mesh.vertexData[ 0 ].position;
+	for ( std::size_t i = 1; i < mesh.vertexCount; ++i )
+	{
+		bounds.aabbMin = glm::min( bounds.aabbMin, mesh.vertexData[ i ].position );
+		bounds.aabbMax = glm::max( bounds.aabbMax, mesh.vertexData[ i ].position );
+	}
+
+	// tighter than half of the AABB diagonal: the farthest vertex from the AABB center
+	bounds.sphereCenter = ( bounds.aabbMin + bounds.aabbMax ) * 0.5f;
+	float radiusSquared = 0.0f;
+	for ( std::size_t i = 0; i < mesh.vertexCount; ++i )
+	{
+		const glm::vec3 d = mesh.vertexData[ i ].position - bounds.sphereCenter;
+		radiusSquared = std::max( radiusSquared, glm::dot( d, d ) );
+	}
+	bounds.sphereRadius = std::sqrt( radiusSquared );
+
+	return bounds;
 }
 
-std::size_t ObjParser::IndexedVertHash::operator()( const IndexedVert& iv ) const noexcept
+ObjParser::CachedMesh ObjParser::parseCached(const std::filesystem::path& fileName, unsigned int flags, unsigned int threadCount)
 {
-	return fasthash64( iv.vt, iv.vn_64 );
+	MappedFile source( fileName );
+	if ( !source ) throw(EXC_FILENOTFOUND);
+
+	const uint64_t sourceHash = fasthash64( source.data(), source.size(), MESH_CACHE_HASH_SEED );
+	const uint64_t sourceSize = source.size();
+
+	const std::filesystem::path cacheFileName = cachePath( fileName );
+
+	CachedMesh result;
+	if ( mapCache( cacheFileName, sourceHash, sourceSize, flags, result ) )
+	{
+		result.bounds = computeBounds( result.view );
+		return result;
+	}
+
+	result.mesh = parseBuffer( reinterpret_cast<const char*>( source.data() ), source.size(), threadCount );
+	if ( flags & PARSE_OPTIMIZE_MESH ) MeshOptimizer::Optimize( result.mesh );
+	result.view = MakeMeshView( result.mesh );
+	result.bounds = computeBounds( result.view );
+
+	if ( !writeCache( cacheFileName, sourceHash, sourceSize, flags, result.mesh ) )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_ERROR,
+						SDL_LOG_PRIORITY_WARN,
+						"[ObjParser] Could not write mesh cache file %s", cacheFileName.string().c_str() );
+	}
+
+	return result;
 }
 
 static std::vector<unsigned int> triangulatePolygon( const std::vector<glm::vec2>& polygon )
@@ -7,6 +7,7 @@
 #include <functional>
 
 #include "GLUtils.hpp"
+#include "MappedFile.h"
 
 
 class ObjParser
@@ -15,41 +16,49 @@ public:
 
 	typedef MeshObject<Vertex> Mesh;
 
-	static Mesh parse(const std::filesystem::path& fileName);
-
-	enum Exception { EXC_FILENOTFOUND };
-
-private:
-	struct IndexedVert
+	// Mesh loaded through the binary mesh cache.
+	// The data is either a read-only mapping of the cache file or, if the cache
+	// could not be used, the freshly parsed mesh. View() is valid while the object lives.
+	class CachedMesh
 	{
-		union
-		{
-			struct
-			{
-				uint32_t v,vt;
-			};
-			uint64_t v_vt = 0Ul;
-		}; 
-
-		union
-		{
-			struct
-			{
-				uint32_t dummy;
-				uint32_t vn;
-			};
-			uint64_t vn_64 = 0Ul;
-		}; 
-		
-		inline bool operator==( const IndexedVert& other ) const
-		{
-			return this->v_vt == other.v_vt && this->vn == other.vn;
-		}
+	public:
+		inline MeshView<Vertex> View() const noexcept { return view; }
+		inline const MeshBounds& Bounds() const noexcept { return bounds; }
+		inline bool IsMapped() const noexcept { return blob.IsOpen(); }
+
+	private:
+		friend class ObjParser;
 
+		MappedFile blob;
+		Mesh mesh;
+		MeshView<Vertex> view;
+		MeshBounds bounds;
 	};
 
-	struct IndexedVertHash
+	// threadCount > 1 parses line aligned chunks of the file in parallel.
+	// The result is exactly the same as the one of the serial (threadCount = 1) parser.
+	static Mesh parse(const std::filesystem::path& fileName, unsigned int threadCount = 1);
+
+	// Optional processing after parsing, the cache file remembers which ones were applied.
+	enum ParseFlags : unsigned int
 	{
-		std::size_t operator()( const IndexedVert& iv ) const noexcept;
+		PARSE_DEFAULT       = 0,
+		PARSE_OPTIMIZE_MESH = 1 << 0, // vertex cache, overdraw and vertex fetch order (MeshOptimizer::Optimize)
 	};
+
+	// Same as parse, but stores the result next to the .obj file (<name>.obj.meshcache)
+	// and on later calls maps that file instead of parsing, as long as the .obj content and the flags are unchanged.
+	static CachedMesh parseCached(const std::filesystem::path& fileName, unsigned int flags = PARSE_DEFAULT, unsigned int threadCount = 1);
+	static std::filesystem::path cachePath(const std::filesystem::path& fileName);
+
+	// AABB and a bounding sphere (centered on the AABB) of the vertex positions.
+	static MeshBounds computeBounds(const MeshView<Vertex>& mesh);
+
+	enum Exception { EXC_FILENOTFOUND };
+
+private:
+	static Mesh parseBuffer(const char* data, std::size_t size, unsigned int threadCount);
+	static Mesh parseBufferParallel(const char* data, std::size_t size, unsigned int threadCount);
+	static bool writeCache(const std::filesystem::path& cacheFileName, uint64_t sourceHash, uint64_t sourceSize, unsigned int flags, const Mesh& mesh);
+	static bool mapCache(const std::filesystem::path& cacheFileName, uint64_t sourceHash, uint64_t sourceSize, unsigned int flags, CachedMesh& result);
 };
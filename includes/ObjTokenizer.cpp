@@ -0,0 +1,446 @@
+#include "ObjTokenizer.h"
+
+#include <atomic>
+#include <charconv>
+#include <cstring>
+
+#if defined( __x86_64__ ) || defined( _M_X64 ) || defined( __i386__ ) || defined( _M_IX86 )
+#define OBJTOKENIZER_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define OBJTOKENIZER_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#else
+#define OBJTOKENIZER_TARGET_AVX2
+#endif
+
+namespace
+{
+	inline bool IsSpace( char ch ) noexcept
+	{
+		const unsigned char c = static_cast<unsigned char>( ch );
+		return c == ' ' || static_cast<unsigned char>( c - '\t' ) <= '\r' - '\t';
+	}
+
+	// Scalar implementation
+
+	const char* SkipSpaceScalar( const char* ptr, const char* end ) noexcept
+	{
+		while ( ptr < end && IsSpace( *ptr ) ) ++ptr;
+		return ptr;
+	}
+
+	const char* FindSpaceScalar( const char* ptr, const char* end ) noexcept
+	{
+		while ( ptr < end && !IsSpace( *ptr ) ) ++ptr;
+		return ptr;
+	}
+
+	// slashMask: bit i is set where ptr[ i ] == '/', for the first SLASH_SCAN_LENGTH bytes of the token
+	const char* FindSpaceAndSlashesScalar( const char* ptr, const char* end, uint32_t& slashMask ) noexcept
+	{
+		const char* const start = ptr;
+		slashMask = 0;
+		for ( ; ptr < end && !IsSpace( *ptr ); ++ptr )
+		{
+			if ( *ptr == '/' && ptr - start < static_cast<std::ptrdiff_t>( InMemoryTokenizer::SLASH_SCAN_LENGTH ) )
+			{
+				slashMask |= uint32_t( 1 ) << ( ptr - start );
+			}
+		}
+		return ptr;
+	}
+
+	// mask must not be 0
+	inline unsigned int CountTrailingZeros( uint32_t mask ) noexcept
+	{
+#if defined( _MSC_VER ) && defined( OBJTOKENIZER_X86 )
+		unsigned long index;
+		_BitScanForward( &index, mask );
+		return index;
+#elif defined( __GNUC__ ) || defined( __clang__ )
+		return __builtin_ctz( mask );
+#else
+		unsigned int index = 0;
+		for ( ; ( mask & 1 ) == 0; mask >>= 1 ) ++index;
+		return index;
+#endif
+	}
+
+#ifdef OBJTOKENIZER_X86
+
+	// SSE2 implementation: one bit per byte, set where the byte is whitespace.
+
+	inline uint32_t SpaceMaskSSE2( const char* ptr ) noexcept
+	{
+		const __m128i bytes = _mm_loadu_si128( reinterpret_cast<const __m128i*>( ptr ) );
+		const __m128i isBlank = _mm_cmpeq_epi8( bytes, _mm_set1_epi8( ' ' ) );
+		// '\t'..'\r' <=> unsigned( byte - '\t' ) <= 4
+		const __m128i shifted = _mm_sub_epi8( bytes, _mm_set1_epi8( '\t' ) );
+		const __m128i isControl = _mm_cmpeq_epi8( _mm_min_epu8( shifted, _mm_set1_epi8( '\r' - '\t' ) ), shifted );
+		return static_cast<uint32_t>( _mm_movemask_epi8( _mm_or_si128( isBlank, isControl ) ) );
+	}
+
+	const char* SkipSpaceSSE2( const char* ptr, const char* end ) noexcept
+	{
+		for ( ; end - ptr >= 16; ptr += 16 )
+		{
+			const uint32_t nonSpace = ~SpaceMaskSSE2( ptr ) & 0xFFFFu;
+			if ( nonSpace ) return ptr + CountTrailingZeros( nonSpace );
+		}
+		return SkipSpaceScalar( ptr, end );
+	}
+
+	const char* FindSpaceSSE2( const char* ptr, const char* end ) noexcept
+	{
+		for ( ; end - ptr >= 16; ptr += 16 )
+		{
+			const uint32_t space = SpaceMaskSSE2( ptr );
+			if ( space ) return ptr + CountTrailingZeros( space );
+		}
+		return FindSpaceScalar( ptr, end );
+	}
+
+	inline uint32_t SlashMaskSSE2( const char* ptr ) noexcept
+	{
+		const __m128i bytes = _mm_loadu_si128( reinterpret_cast<const __m128i*>( ptr ) );
+		return static_cast<uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( bytes, _mm_set1_epi8( '/' ) ) ) );
+	}
+
+	// Two blocks cover the slash mask (and nearly every face corner), the rest of a longer token is only searched
+	// for its end. The AVX2 table uses this one too: a corner is rarely longer than 16 bytes.
+	const char* FindSpaceAndSlashesSSE2( const char* ptr, const char* end, uint32_t& slashMask ) noexcept
+	{
+		slashMask = 0;
+		unsigned int offset = 0;
+		for ( ; offset < InMemoryTokenizer::SLASH_SCAN_LENGTH && end - ptr >= 16; offset += 16, ptr += 16 )
+		{
+			const uint32_t space = SpaceMaskSSE2( ptr );
+			const uint32_t slash = SlashMaskSSE2( ptr );
+			if ( space )
+			{
+				const unsigned int length = CountTrailingZeros( space );
+				slashMask |= ( slash & ( ( uint32_t( 1 ) << length ) - 1 ) ) << offset;
+				return ptr + length;
+			}
+			slashMask |= slash << offset;
+		}
+		if ( offset == InMemoryTokenizer::SLASH_SCAN_LENGTH ) return FindSpaceSSE2( ptr, end );
+
+		// the end of the text is closer than a block
+		uint32_t tailMask;
+		const char* tokenEnd = FindSpaceAndSlashesScalar( ptr, end, tailMask );
+		slashMask |= tailMask << offset;
+		return tokenEnd;
+	}
+
+	// AVX2 implementation, same as SSE2 with 32 bytes.
+	// Most .obj tokens are shorter than 16 bytes, so the first block is still checked with SSE2,
+	// the wider loads only pay off on the longer runs.
+
+	OBJTOKENIZER_TARGET_AVX2 inline uint32_t SpaceMaskAVX2( const char* ptr ) noexcept
+	{
+		const __m256i bytes = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( ptr ) );
+		const __m256i isBlank = _mm256_cmpeq_epi8( bytes, _mm256_set1_epi8( ' ' ) );
+		const __m256i shifted = _mm256_sub_epi8( bytes, _mm256_set1_epi8( '\t' ) );
+		const __m256i isControl = _mm256_cmpeq_epi8( _mm256_min_epu8( shifted, _mm256_set1_epi8( '\r' - '\t' ) ), shifted );
+		return static_cast<uint32_t>( _mm256_movemask_epi8( _mm256_or_si256( isBlank, isControl ) ) );
+	}
+
+	OBJTOKENIZER_TARGET_AVX2 const char* SkipSpaceAVX2( const char* ptr, const char* end ) noexcept
+	{
+		if ( end - ptr >= 16 )
+		{
+			const uint32_t nonSpace = ~SpaceMaskSSE2( ptr ) & 0xFFFFu;
+			if ( nonSpace ) return ptr + CountTrailingZeros( nonSpace );
+			ptr += 16;
+		}
+		for ( ; end - ptr >= 32; ptr += 32 )
+		{
+			const uint32_t nonSpace = ~SpaceMaskAVX2( ptr );
+			if ( nonSpace ) return ptr + CountTrailingZeros( nonSpace );
+		}
+		return SkipSpaceSSE2( ptr, end );
+	}
+
+	OBJTOKENIZER_TARGET_AVX2 const char* FindSpaceAVX2( const char* ptr, const char* end ) noexcept
+	{
+		if ( end - ptr >= 16 )
+		{
+			const uint32_t space = SpaceMaskSSE2( ptr );
+			if ( space ) return ptr + CountTrailingZeros( space );
+			ptr += 16;
+		}
+		for ( ; end - ptr >= 32; ptr += 32 )
+		{
+			const uint32_t space = SpaceMaskAVX2( ptr );
+			if ( space ) return ptr + CountTrailingZeros( space );
+		}
+		return FindSpaceSSE2( ptr, end );
+	}
+
+	bool CpuSupportsAVX2() noexcept
+	{
+#ifdef _MSC_VER
+		int info[ 4 ];
+		__cpuid( info, 0 );
+		if ( info[ 0 ] < 7 ) return false;
+
+		__cpuid( info, 1 );
+		const bool osUsesXSave = ( info[ 2 ] & ( 1 << 27 ) ) != 0;
+		const bool cpuHasAVX = ( info[ 2 ] & ( 1 << 28 ) ) != 0;
+		if ( !osUsesXSave || !cpuHasAVX ) return false;
+
+		// the OS has to save the YMM registers on context switch
+		if ( ( _xgetbv( 0 ) & 0x6 ) != 0x6 ) return false;
+
+		__cpuidex( info, 7, 0 );
+		return ( info[ 1 ] & ( 1 << 5 ) ) != 0;
+#else
+		return __builtin_cpu_supports( "avx2" );
+#endif
+	}
+
+#endif // OBJTOKENIZER_X86
+}
+
+struct ObjScanFunctions
+{
+	InMemoryTokenizer::ScanImpl impl;
+	const char* ( *skipSpace )( const char*, const char* ) noexcept;
+	const char* ( *findSpace )( const char*, const char* ) noexcept;
+	const char* ( *findSpaceAndSlashes )( const char*, const char*, uint32_t& ) noexcept;
+};
+
+namespace
+{
+	constexpr ObjScanFunctions s_scalarFunctions = { InMemoryTokenizer::ScanImpl::SCALAR, &SkipSpaceScalar, &FindSpaceScalar, &FindSpaceAndSlashesScalar };
+#ifdef OBJTOKENIZER_X86
+	constexpr ObjScanFunctions s_sse2Functions = { InMemoryTokenizer::ScanImpl::SSE2, &SkipSpaceSSE2, &FindSpaceSSE2, &FindSpaceAndSlashesSSE2 };
+	constexpr ObjScanFunctions s_avx2Functions = { InMemoryTokenizer::ScanImpl::AVX2, &SkipSpaceAVX2, &FindSpaceAVX2, &FindSpaceAndSlashesSSE2 };
+#endif
+
+	const ObjScanFunctions* DetectScanFunctions() noexcept
+	{
+#ifdef OBJTOKENIZER_X86
+		return CpuSupportsAVX2() ? &s_avx2Functions : &s_sse2Functions;
+#else
+		return &s_scalarFunctions;
+#endif
+	}
+
+	// the tables are constant, only the pointer changes: a relaxed load is enough to read a whole table
+	std::atomic<const ObjScanFunctions*> s_scan = DetectScanFunctions();
+}
+
+InMemoryTokenizer::ScanImpl InMemoryTokenizer::BestScanImpl() noexcept
+{
+	return DetectScanFunctions()->impl;
+}
+
+bool InMemoryTokenizer::SetScanImpl( ScanImpl impl ) noexcept
+{
+	switch ( impl )
+	{
+		case ScanImpl::SCALAR:
+			s_scan.store( &s_scalarFunctions, std::memory_order_relaxed );
+			return true;
+#ifdef OBJTOKENIZER_X86
+		case ScanImpl::SSE2:
+			s_scan.store( &s_sse2Functions, std::memory_order_relaxed );
+			return true;
+		case ScanImpl::AVX2:
+			if ( !CpuSupportsAVX2() ) return false;
+			s_scan.store( &s_avx2Functions, std::memory_order_relaxed );
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+InMemoryTokenizer::ScanImpl InMemoryTokenizer::GetScanImpl() noexcept
+{
+	return s_scan.load( std::memory_order_relaxed )->impl;
+}
+
+const char* InMemoryTokenizer::ScanImplName( ScanImpl impl ) noexcept
+{
+	switch ( impl )
+	{
+		case ScanImpl::SCALAR: return "scalar";
+		case ScanImpl::SSE2:   return "SSE2";
+		case ScanImpl::AVX2:   return "AVX2";
+	}
+	return "unknown";
+}
+
+InMemoryTokenizer::InMemoryTokenizer() noexcept
+	: scan( s_scan.load( std::memory_order_relaxed ) )
+{
+}
+
+void InMemoryTokenizer::SetData( const char* ptr, size_t Length ) noexcept
+{
+	this->currentPtr = ptr;
+	this->endPtr = ptr + Length;
+	this->scan = s_scan.load( std::memory_order_relaxed );
+}
+
+const char* InMemoryTokenizer::TokenStart( bool onlySameLine ) noexcept
+{
+	// Most tokens are separated by a single space, that is checked without the vectorized scan.
+	const char* tPtr = currentPtr;
+	if ( tPtr < endPtr && IsSpace( *tPtr ) )
+	{
+		tPtr = ( tPtr + 1 < endPtr && IsSpace( tPtr[ 1 ] ) ) ? scan->skipSpace( tPtr + 2, endPtr ) : tPtr + 1;
+
+		if ( onlySameLine )
+		{
+			const void* newLine = std::memchr( currentPtr, '\n', tPtr - currentPtr );
+			if ( newLine )
+			{
+				// stay on the line end, like the token would be empty
+				currentPtr = static_cast<const char*>( newLine );
+				return nullptr;
+			}
+		}
+	}
+	return tPtr;
+}
+
+std::string_view InMemoryTokenizer::NextToken( bool onlySameLine ) noexcept
+{
+	const char* tPtr = TokenStart( onlySameLine );
+	if ( tPtr == nullptr ) return std::string_view();
+
+	currentPtr = scan->findSpace( tPtr, endPtr );
+
+	return std::string_view( tPtr, currentPtr - tPtr );
+}
+
+std::string_view InMemoryTokenizer::NextFaceCorner( size_t& firstSlash, size_t& secondSlash ) noexcept
+{
+	firstSlash = secondSlash = std::string_view::npos;
+	const char* tPtr = TokenStart( true );
+	if ( tPtr == nullptr ) return std::string_view();
+
+	uint32_t slashMask;
+	currentPtr = scan->findSpaceAndSlashes( tPtr, endPtr, slashMask );
+	const std::string_view token( tPtr, currentPtr - tPtr );
+
+	if ( token.size() > SLASH_SCAN_LENGTH )
+	{
+		firstSlash = token.find( '/' );
+		if ( firstSlash != std::string_view::npos ) secondSlash = token.find( '/', firstSlash + 1 );
+		return token;
+	}
+
+	if ( slashMask )
+	{
+		firstSlash = CountTrailingZeros( slashMask );
+		slashMask &= slashMask - 1;
+		if ( slashMask ) secondSlash = CountTrailingZeros( slashMask );
+	}
+	return token;
+}
+
+void InMemoryTokenizer::ToNextLine() noexcept
+{
+	const void* newLine = ( currentPtr < endPtr ) ? std::memchr( currentPtr, '\n', endPtr - currentPtr ) : nullptr;
+	currentPtr = newLine ? static_cast<const char*>( newLine ) + 1 : endPtr + 1;
+}
+
+InMemoryTokenizer::operator bool() const noexcept
+{
+	return currentPtr < endPtr;
+}
+
+// Float parsing
+
+namespace
+{
+	// Exactly representable powers of 10 in double.
+	constexpr double s_exactPowersOf10[] =
+	{
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+		1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+	};
+
+	constexpr int MAX_FAST_DIGITS = 15; // 10^15 < 2^53, so the mantissa is exact in double
+
+	// The double rounding (decimal -> double -> float) can only differ from the correctly rounded float,
+	// if the double lands exactly halfway between two floats.
+	inline bool IsFloatHalfway( double d ) noexcept
+	{
+		uint64_t bits;
+		std::memcpy( &bits, &d, sizeof( bits ) );
+		return ( bits & ( ( uint64_t( 1 ) << 29 ) - 1 ) ) == ( uint64_t( 1 ) << 28 );
+	}
+}
+
+void ParseObjFloat( std::string_view token, float& value ) noexcept
+{
+	const char* ptr = token.data();
+	const char* const end = ptr + token.size();
+
+	const bool negative = ( ptr < end && *ptr == '-' );
+	if ( negative ) ++ptr;
+
+	uint64_t mantissa = 0;
+	int digitCount = 0;
+	int fractionDigitCount = 0;
+
+	for ( ; ptr < end && static_cast<unsigned char>( *ptr - '0' ) <= 9; ++ptr, ++digitCount )
+	{
+		mantissa = mantissa * 10 + static_cast<unsigned char>( *ptr - '0' );
+	}
+
+	if ( ptr < end && *ptr == '.' )
+	{
+		++ptr;
+		for ( ; ptr < end && static_cast<unsigned char>( *ptr - '0' ) <= 9; ++ptr, ++digitCount, ++fractionDigitCount )
+		{
+			mantissa = mantissa * 10 + static_cast<unsigned char>( *ptr - '0' );
+		}
+	}
+
+	if ( ptr == end && digitCount > 0 && digitCount <= MAX_FAST_DIGITS )
+	{
+		// both operands are exact, so the quotient is the correctly rounded double
+		const double d = static_cast<double>( mantissa ) / s_exactPowersOf10[ fractionDigitCount ];
+		if ( !IsFloatHalfway( d ) )
+		{
+			const float f = static_cast<float>( d );
+			value = negative ? -f : f;
+			return;
+		}
+	}
+
+	std::from_chars( token.data(), token.data() + token.size(), value );
+}
+
+const char* ParseObjIndex( const char* first, const char* last, uint32_t& value ) noexcept
+{
+	// up to 9 digits can not overflow, longer numbers are left to std::from_chars
+	constexpr int MAX_FAST_DIGITS = 9;
+
+	uint32_t result = 0;
+	const char* ptr = first;
+	for ( ; ptr < last && ptr - first < MAX_FAST_DIGITS && static_cast<unsigned char>( *ptr - '0' ) <= 9; ++ptr )
+	{
+		result = result * 10 + static_cast<unsigned char>( *ptr - '0' );
+	}
+
+	if ( ptr < last && ptr - first == MAX_FAST_DIGITS && static_cast<unsigned char>( *ptr - '0' ) <= 9 )
+	{
+		return std::from_chars( first, last, value ).ptr;
+	}
+
+	if ( ptr != first ) value = result;
+	return ptr;
+}
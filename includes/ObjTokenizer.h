@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+struct ObjScanFunctions; // one scan implementation, ObjTokenizer.cpp
+
+// Splits in-memory .obj text into whitespace separated tokens.
+// Whitespace is the "C" locale set: ' ', '\t', '\n', '\v', '\f', '\r'.
+// The scanning is done 16 (SSE2) or 32 (AVX2) bytes at a time on x86, the implementation
+// is chosen at runtime from the CPU features, with a scalar fallback everywhere else.
+class InMemoryTokenizer
+{
+public:
+	enum class ScanImpl { SCALAR, SSE2, AVX2 };
+
+	InMemoryTokenizer() noexcept;
+	// Also picks up the current scan implementation (SetScanImpl) for the whole text.
+	void SetData( const char* ptr, size_t Length ) noexcept;
+	std::string_view NextToken( bool onlySameLine = false ) noexcept;
+	// A face corner ("12/7/3", "12//3", "12"): NextToken( true ), and the offsets of the first two '/' of the token
+	// (std::string_view::npos if there are fewer). The '/' come from the same vector compares as the end of the token
+	// for the first SLASH_SCAN_LENGTH bytes, only a longer corner is searched again.
+	std::string_view NextFaceCorner( size_t& firstSlash, size_t& secondSlash ) noexcept;
+	static constexpr size_t SLASH_SCAN_LENGTH = 32;
+	void ToNextLine() noexcept;
+	operator bool() const noexcept;
+
+	// The fastest implementation the CPU supports.
+	static ScanImpl BestScanImpl() noexcept;
+	// Returns false, if the CPU does not support the requested implementation.
+	// Only meant for benchmarks and correctness checks. Safe to call from any thread: tokenizers that already have
+	// their data keep the implementation they started with, the next SetData uses the new one.
+	static bool SetScanImpl( ScanImpl impl ) noexcept;
+	static ScanImpl GetScanImpl() noexcept;
+	static const char* ScanImplName( ScanImpl impl ) noexcept;
+
+private:
+	// Skips the whitespace before the next token; nullptr (staying on the line end) if onlySameLine and the line ended.
+	const char* TokenStart( bool onlySameLine ) noexcept;
+
+	const char* currentPtr = nullptr;
+	const char* endPtr = nullptr;
+	const ObjScanFunctions* scan;
+};
+
+// Parses a whole token as float with the result of std::from_chars.
+// The common "-12.345678" shape (no exponent, at most 15 digits) is converted directly,
+// everything else is handed to std::from_chars. On error value is left unchanged.
+void ParseObjFloat( std::string_view token, float& value ) noexcept;
+
+// Parses the decimal digits at the beginning of [first, last) like std::from_chars does for uint32_t
+// and returns the pointer to the first character after them (e.g. the '/' of a face corner).
+const char* ParseObjIndex( const char* first, const char* last, uint32_t& value ) noexcept;
@@ -0,0 +1,165 @@
+#include "ProgramBinaryCache.h"
+
+#include "IndexedVertTable.h"
+#include "MappedFile.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include <SDL2/SDL_log.h>
+
+// Layout: ProgramBinaryHeader | byte[binarySize]
+
+namespace
+{
+	constexpr char          PROGRAM_BINARY_MAGIC[ 4 ] = { 'Z', 'H', 'P', 'B' };
+	constexpr std::uint32_t PROGRAM_BINARY_VERSION    = 1;
+	constexpr std::uint64_t PROGRAM_BINARY_HASH_SEED  = 0x5a4850726f670001ULL;
+
+	struct ProgramBinaryHeader
+	{
+		char          magic[ 4 ];
+		std::uint32_t version;
+		std::uint64_t key;
+		std::uint32_t binaryFormat; // GLenum of glGetProgramBinary
+		std::uint32_t binarySize;
+	};
+
+	static_assert( sizeof( ProgramBinaryHeader ) == 24 );
+
+	std::uint64_t HashString( std::string_view text, std::uint64_t seed )
+	{
+		return fasthash64( text.data(), text.size(), seed );
+	}
+
+	std::string_view GLString( GLenum name )
+	{
+		const GLubyte* value = glGetString( name );
+		return value != nullptr ? std::string_view( reinterpret_cast<const char*>( value ) ) : std::string_view();
+	}
+}
+
+ProgramBinaryCache::ProgramBinaryCache( std::filesystem::path directory )
+	: m_directory( std::move( directory ) )
+{
+}
+
+bool ProgramBinaryCache::IsSupported()
+{
+	GLint formatCount = 0;
+	glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount );
+	return formatCount > 0;
+}
+
+std::uint64_t ProgramBinaryCache::Key( const std::vector<std::pair<GLenum, std::string_view>>& stageSources ) const
+{
+	std::uint64_t key = PROGRAM_BINARY_HASH_SEED;
+	key = HashString( GLString( GL_VENDOR ), key );
+	key = HashString( GLString( GL_RENDERER ), key );
+	key = HashString( GLString( GL_VERSION ), key );
+	for ( const auto& [ shaderType, source ] : stageSources )
+	{
+		key = fasthash64( static_cast<std::uint64_t>( shaderType ), key );
+		key = HashString( source, key );
+	}
+	return key;
+}
+
+std::filesystem::path ProgramBinaryCache::BinaryPath( std::uint64_t key ) const
+{
+	char fileName[ 32 ];
+	std::snprintf( fileName, sizeof( fileName ), "%016" PRIx64 ".progbin", key );
+	return m_directory / fileName;
+}
+
+void ProgramBinaryCache::PrepareForStore( const ShaderProgram& program )
+{
+	glProgramParameteri( program.ID(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+}
+
+bool ProgramBinaryCache::Load( ShaderProgram& program, std::uint64_t key )
+{
+	MappedFile blob;
+	if ( !IsSupported() || !blob.Open( BinaryPath( key ) ) || blob.size() < sizeof( ProgramBinaryHeader ) )
+	{
+		++m_stats.misses;
+		return false;
+	}
+
+	ProgramBinaryHeader header;
+	std::memcpy( &header, blob.data(), sizeof( header ) );
+
+	if ( std::memcmp( header.magic, PROGRAM_BINARY_MAGIC, sizeof( header.magic ) ) != 0
+		 || header.version != PROGRAM_BINARY_VERSION
+		 || header.key != key
+		 || blob.size() != sizeof( ProgramBinaryHeader ) + header.binarySize )
+	{
+		++m_stats.misses;
+		return false;
+	}
+
+	if ( !program.LoadBinary( header.binaryFormat, blob.data() + sizeof( ProgramBinaryHeader ), static_cast<GLsizei>( header.binarySize ) ) )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+						"[ProgramBinaryCache] Binary %s rejected by the driver, compiling", BinaryPath( key ).string().c_str() );
+		++m_stats.rejected;
+		return false;
+	}
+
+	++m_stats.hits;
+	return true;
+}
+
+bool ProgramBinaryCache::Store( const ShaderProgram& program, std::uint64_t key )
+{
+	if ( !IsSupported() || !program.IsLinked() ) return false;
+
+	GLint binaryLength = 0;
+	glGetProgramiv( program.ID(), GL_PROGRAM_BINARY_LENGTH, &binaryLength );
+	if ( binaryLength <= 0 ) return false;
+
+	std::vector<char> binary( static_cast<std::size_t>( binaryLength ) );
+	GLenum binaryFormat = GL_NONE;
+	GLsizei writtenLength = 0;
+	glGetProgramBinary( program.ID(), binaryLength, &writtenLength, &binaryFormat, binary.data() );
+	if ( writtenLength <= 0 ) return false;
+
+	ProgramBinaryHeader header = {};
+	std::memcpy( header.magic, PROGRAM_BINARY_MAGIC, sizeof( header.magic ) );
+	header.version      = PROGRAM_BINARY_VERSION;
+	header.key          = key;
+	header.binaryFormat = binaryFormat;
+	header.binarySize   = static_cast<std::uint32_t>( writtenLength );
+
+	std::error_code ec;
+	std::filesystem::create_directories( m_directory, ec );
+
+	// Write into a temporary file first, like the mesh cache: a concurrently starting instance never reads half a binary.
+	const std::filesystem::path binaryFileName = BinaryPath( key );
+	std::filesystem::path tmpFileName = binaryFileName;
+	tmpFileName += ".tmp";
+
+	bool written = false;
+	{
+		std::ofstream binaryStrm( tmpFileName, std::ios::binary | std::ios::trunc );
+		binaryStrm.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+		binaryStrm.write( binary.data(), writtenLength );
+		written = static_cast<bool>( binaryStrm );
+	}
+
+	if ( written ) std::filesystem::rename( tmpFileName, binaryFileName, ec );
+	if ( !written || ec )
+	{
+		std::filesystem::remove( tmpFileName, ec );
+		SDL_LogMessage( SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_WARN,
+						"[ProgramBinaryCache] Could not write program binary %s", binaryFileName.string().c_str() );
+		return false;
+	}
+
+	++m_stats.stored;
+	return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "ShaderProgram.h"
+
+// On-disk cache of linked programs: glGetProgramBinary output, restored by glProgramBinary.
+//
+// A binary is only valid for the driver that produced it, so the key is the hash of GL_VENDOR, GL_RENDERER,
+// GL_VERSION and of every stage source (defines already injected, see ShaderVariants). One file per program,
+// <directory>/<key in hex>.progbin: ProgramBinaryHeader | binary. The driver may still reject a binary that matches
+// (e.g. after a driver update with the same version string), Load returns false then and the caller compiles;
+// storing the new binary overwrites the rejected one.
+class ProgramBinaryCache
+{
+public:
+	struct Stats
+	{
+		unsigned int hits = 0;     // loaded from a binary
+		unsigned int misses = 0;   // no usable file
+		unsigned int rejected = 0; // file found, glProgramBinary failed
+		unsigned int stored = 0;
+	};
+
+	explicit ProgramBinaryCache( std::filesystem::path directory );
+
+	// Needs a current context. Without any binary format (GL_NUM_PROGRAM_BINARY_FORMATS == 0) Load and Store do nothing.
+	std::uint64_t Key( const std::vector<std::pair<GLenum, std::string_view>>& stageSources ) const;
+
+	// program has to be created and empty. True if it is linked from the cached binary.
+	bool Load( ShaderProgram& program, std::uint64_t key );
+
+	// The program has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set, see PrepareForStore.
+	bool Store( const ShaderProgram& program, std::uint64_t key );
+
+	// Before linking a program that will be stored.
+	static void PrepareForStore( const ShaderProgram& program );
+
+	std::filesystem::path BinaryPath( std::uint64_t key ) const;
+	inline const std::filesystem::path& Directory() const noexcept { return m_directory; }
+	inline const Stats& GetStats() const noexcept { return m_stats; }
+
+	static bool IsSupported();
+
+private:
+	std::filesystem::path m_directory;
+	Stats m_stats;
+};
@@ -0,0 +1,180 @@
+#include "SceneGraph.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined( __x86_64__ ) || defined( _M_X64 ) || defined( __i386__ ) || defined( _M_IX86 )
+#define SCENEGRAPH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// out = a * b, column major like glm; out must not alias a or b
+
+	void MultiplyScalar( const glm::mat4& a, const glm::mat4& b, glm::mat4& out ) noexcept
+	{
+		out = a * b;
+	}
+
+#ifdef SCENEGRAPH_X86
+
+	// column j of the product is the columns of a weighted by the elements of column j of b
+	void MultiplySSE( const glm::mat4& a, const glm::mat4& b, glm::mat4& out ) noexcept
+	{
+		const __m128 a0 = _mm_loadu_ps( &a[ 0 ][ 0 ] );
+		const __m128 a1 = _mm_loadu_ps( &a[ 1 ][ 0 ] );
+		const __m128 a2 = _mm_loadu_ps( &a[ 2 ][ 0 ] );
+		const __m128 a3 = _mm_loadu_ps( &a[ 3 ][ 0 ] );
+		for ( int j = 0; j < 4; ++j )
+		{
+			const __m128 column = _mm_loadu_ps( &b[ j ][ 0 ] );
+			__m128 result = _mm_mul_ps( a0, _mm_shuffle_ps( column, column, _MM_SHUFFLE( 0, 0, 0, 0 ) ) );
+			result = _mm_add_ps( result, _mm_mul_ps( a1, _mm_shuffle_ps( column, column, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+			result = _mm_add_ps( result, _mm_mul_ps( a2, _mm_shuffle_ps( column, column, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+			result = _mm_add_ps( result, _mm_mul_ps( a3, _mm_shuffle_ps( column, column, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) );
+			_mm_storeu_ps( &out[ j ][ 0 ], result );
+		}
+	}
+
+#endif // SCENEGRAPH_X86
+
+	struct MultiplyFunction
+	{
+		SceneGraph::MultiplyImpl impl;
+		void ( *multiply )( const glm::mat4&, const glm::mat4&, glm::mat4& ) noexcept;
+	};
+
+	constexpr MultiplyFunction s_scalarMultiply = { SceneGraph::MultiplyImpl::SCALAR, &MultiplyScalar };
+#ifdef SCENEGRAPH_X86
+	constexpr MultiplyFunction s_sseMultiply = { SceneGraph::MultiplyImpl::SSE, &MultiplySSE };
+#endif
+
+	const MultiplyFunction* DetectMultiplyFunction() noexcept
+	{
+#ifdef SCENEGRAPH_X86
+		return &s_sseMultiply;
+#else
+		return &s_scalarMultiply;
+#endif
+	}
+
+	// the entries are constant, only the pointer changes (like the scan selection of InMemoryTokenizer)
+	std::atomic<const MultiplyFunction*> s_multiply = DetectMultiplyFunction();
+
+	// translation * rotation * scale, and its inverse transpose without the translation: rotation * inverse( scale )
+	void LocalMatrices( const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& local, glm::mat4& normal ) noexcept
+	{
+		const glm::mat3 r = glm::mat3_cast( rotation );
+		const glm::vec3 inverseScale = 1.0f / scale;
+		local = glm::mat4( glm::vec4( r[ 0 ] * scale.x, 0.0f ), glm::vec4( r[ 1 ] * scale.y, 0.0f ), glm::vec4( r[ 2 ] * scale.z, 0.0f ), glm::vec4( translation, 1.0f ) );
+		normal = glm::mat4( glm::vec4( r[ 0 ] * inverseScale.x, 0.0f ), glm::vec4( r[ 1 ] * inverseScale.y, 0.0f ), glm::vec4( r[ 2 ] * inverseScale.z, 0.0f ), glm::vec4( 0.0f, 0.0f, 0.0f, 1.0f ) );
+	}
+}
+
+SceneGraph::NodeID SceneGraph::AddNode( NodeID parent, const Transform& local )
+{
+	const NodeID node = static_cast<NodeID>( m_parent.size() );
+	m_translation.push_back( local.translation );
+	m_rotation.push_back( local.rotation );
+	m_scale.push_back( local.scale );
+	m_parent.push_back( parent < node ? parent : NO_PARENT );
+	m_world.emplace_back( 1.0f );
+	m_normal.emplace_back( 1.0f );
+	m_dirty.push_back( 1 );
+	m_firstDirty = std::min<std::size_t>( m_firstDirty, node );
+	return node;
+}
+
+void SceneGraph::Clear()
+{
+	m_translation.clear();
+	m_rotation.clear();
+	m_scale.clear();
+	m_parent.clear();
+	m_world.clear();
+	m_normal.clear();
+	m_dirty.clear();
+	m_firstDirty = 0;
+}
+
+void SceneGraph::SetLocal( NodeID node, const Transform& local )
+{
+	if ( m_translation[ node ] == local.translation && m_rotation[ node ] == local.rotation && m_scale[ node ] == local.scale ) return;
+
+	m_translation[ node ] = local.translation;
+	m_rotation[ node ] = local.rotation;
+	m_scale[ node ] = local.scale;
+	m_dirty[ node ] = 1;
+	m_firstDirty = std::min<std::size_t>( m_firstDirty, node );
+}
+
+std::size_t SceneGraph::Update()
+{
+	const std::size_t nodeCount = m_parent.size();
+	const auto multiply = s_multiply.load( std::memory_order_relaxed )->multiply; // one implementation for the whole pass
+
+	std::size_t updatedCount = 0;
+	glm::mat4 local, localNormal;
+	for ( std::size_t i = m_firstDirty; i < nodeCount; ++i )
+	{
+		const NodeID parent = m_parent[ i ];
+		// the parent comes earlier: its flag already says whether it was recomputed in this pass
+		if ( parent != NO_PARENT && m_dirty[ parent ] ) m_dirty[ i ] = 1;
+		if ( !m_dirty[ i ] ) continue;
+
+		LocalMatrices( m_translation[ i ], m_rotation[ i ], m_scale[ i ], local, localNormal );
+		if ( parent == NO_PARENT )
+		{
+			m_world[ i ] = local;
+			m_normal[ i ] = localNormal;
+		}
+		else
+		{
+			multiply( m_world[ parent ], local, m_world[ i ] );
+			multiply( m_normal[ parent ], localNormal, m_normal[ i ] );
+		}
+		++updatedCount;
+	}
+
+	if ( m_firstDirty < nodeCount ) std::fill( m_dirty.begin() + m_firstDirty, m_dirty.end(), std::uint8_t( 0 ) );
+	m_firstDirty = nodeCount;
+	return updatedCount;
+}
+
+SceneGraph::MultiplyImpl SceneGraph::BestMultiplyImpl() noexcept
+{
+	return DetectMultiplyFunction()->impl;
+}
+
+bool SceneGraph::SetMultiplyImpl( MultiplyImpl impl ) noexcept
+{
+	switch ( impl )
+	{
+		case MultiplyImpl::SCALAR:
+			s_multiply.store( &s_scalarMultiply, std::memory_order_relaxed );
+			return true;
+#ifdef SCENEGRAPH_X86
+		case MultiplyImpl::SSE:
+			s_multiply.store( &s_sseMultiply, std::memory_order_relaxed );
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+SceneGraph::MultiplyImpl SceneGraph::GetMultiplyImpl() noexcept
+{
+	return s_multiply.load( std::memory_order_relaxed )->impl;
+}
+
+const char* SceneGraph::MultiplyImplName( MultiplyImpl impl ) noexcept
+{
+	switch ( impl )
+	{
+		case MultiplyImpl::SCALAR: return "scalar";
+		case MultiplyImpl::SSE:    return "SSE";
+	}
+	return "unknown";
+}
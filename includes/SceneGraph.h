@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Transform hierarchy with cached world and normal matrices, stored as flat arrays indexed by node (structure of
+// arrays: the update walks each array front to back).
+//
+// A node can only be added under an existing one, so a parent always has a smaller index than its children and the
+// index order is a topological order: Update is one pass from the first dirty node to the end, where a node is
+// recomputed if its own local transform changed or its parent was recomputed in the same pass. The rest of the graph
+// keeps its matrices, so an unchanged scene costs nothing and a changed leaf costs one multiply pair.
+//
+// Local transforms are translation * rotation * scale, the scale non-zero. The normal matrix is the
+// transpose( inverse( world ) ) of the upper 3x3 with a zero translation, enough for ( normal * vec4( n, 0 ) ).xyz,
+// built from the parent's normal matrix and rotation * inverse( scale ) without any inverse.
+// The 4x4 multiplies run on SSE on x86, chosen like the scan of InMemoryTokenizer, with a scalar fallback elsewhere.
+class SceneGraph
+{
+public:
+	using NodeID = std::uint32_t;
+	static constexpr NodeID NO_PARENT = ~NodeID( 0 );
+
+	enum class MultiplyImpl { SCALAR, SSE };
+
+	struct Transform
+	{
+		glm::vec3 translation = glm::vec3( 0.0f );
+		glm::quat rotation = glm::quat( 1.0f, 0.0f, 0.0f, 0.0f );
+		glm::vec3 scale = glm::vec3( 1.0f );
+	};
+
+	// parent: NO_PARENT or an already added node. The new node is dirty, the IDs are 0, 1, 2... in adding order.
+	NodeID AddNode( NodeID parent, const Transform& local );
+	inline NodeID AddNode( NodeID parent ) { return AddNode( parent, Transform() ); }
+	void Clear();
+
+	// Marks the node dirty if the transform differs from its current one.
+	void SetLocal( NodeID node, const Transform& local );
+	inline Transform Local( NodeID node ) const { return { m_translation[ node ], m_rotation[ node ], m_scale[ node ] }; }
+
+	// Recomputes the dirty nodes and their descendants, returns their number.
+	std::size_t Update();
+
+	// Valid after Update.
+	inline const glm::mat4& World( NodeID node ) const { return m_world[ node ]; }
+	inline const glm::mat4& NormalMatrix( NodeID node ) const { return m_normal[ node ]; }
+	inline NodeID Parent( NodeID node ) const { return m_parent[ node ]; }
+	inline std::size_t NodeCount() const noexcept { return m_parent.size(); }
+
+	// The fastest implementation the CPU supports.
+	static MultiplyImpl BestMultiplyImpl() noexcept;
+	// Returns false, if the CPU does not support the requested implementation.
+	// Only meant for benchmarks and correctness checks. Safe to call from any thread: an Update already running
+	// finishes with the implementation it started with.
+	static bool SetMultiplyImpl( MultiplyImpl impl ) noexcept;
+	static MultiplyImpl GetMultiplyImpl() noexcept;
+	static const char* MultiplyImplName( MultiplyImpl impl ) noexcept;
+
+private:
+	std::vector<glm::vec3>    m_translation;
+	std::vector<glm::quat>    m_rotation;
+	std::vector<glm::vec3>    m_scale;
+	std::vector<NodeID>       m_parent;
+	std::vector<glm::mat4>    m_world;
+	std::vector<glm::mat4>    m_normal;
+	std::vector<std::uint8_t> m_dirty;
+	std::size_t               m_firstDirty = 0; // NodeCount() when nothing is dirty
+};
@@ -0,0 +1,188 @@
+#include "ShaderProgram.h"
+
+#include "GLUtils.hpp"
+
+#include <algorithm>
+#include <utility>
+
+ShaderProgram::~ShaderProgram()
+{
+	Destroy();
+}
+
+ShaderProgram::ShaderProgram( ShaderProgram&& other ) noexcept
+{
+	Swap( other );
+}
+
+ShaderProgram& ShaderProgram::operator=( ShaderProgram&& other ) noexcept
+{
+	if ( this != &other )
+	{
+		Destroy();
+		Swap( other );
+	}
+	return *this;
+}
+
+void ShaderProgram::Swap( ShaderProgram& other ) noexcept
+{
+	std::swap( m_programID, other.m_programID );
+	std::swap( m_linkPending, other.m_linkPending );
+	std::swap( m_uniformHashes, other.m_uniformHashes );
+	std::swap( m_uniforms, other.m_uniforms );
+}
+
+void ShaderProgram::Create()
+{
+	Destroy();
+	m_programID = glCreateProgram();
+}
+
+void ShaderProgram::Destroy() noexcept
+{
+	if ( m_programID != 0 ) glDeleteProgram( m_programID );
+	m_programID = 0;
+	m_linkPending = false;
+	m_uniformHashes.clear();
+	m_uniforms.clear();
+}
+
+GLuint ShaderProgram::AttachShader( GLenum shaderType, const std::filesystem::path& fileName )
+{
+	return ::AttachShader( m_programID, shaderType, fileName );
+}
+
+GLuint ShaderProgram::AttachShaderCode( GLenum shaderType, std::string_view shaderCode )
+{
+	return ::AttachShaderCode( m_programID, shaderType, shaderCode );
+}
+
+void ShaderProgram::Link( bool ownShaders )
+{
+	LinkProgram( m_programID, ownShaders );
+	ReflectUniforms();
+}
+
+GLuint ShaderProgram::AttachShaderCodeDeferred( GLenum shaderType, std::string_view shaderCode )
+{
+	return ::AttachShaderCodeDeferred( m_programID, shaderType, shaderCode );
+}
+
+void ShaderProgram::LinkDeferred()
+{
+	glLinkProgram( m_programID );
+	m_linkPending = true;
+}
+
+bool ShaderProgram::IsReady() const noexcept
+{
+	if ( !m_linkPending ) return true;
+	// without the extension there is nothing to poll: the first status query waits anyway
+	if ( !GLEW_KHR_parallel_shader_compile ) return true;
+
+	GLint completed = GL_FALSE;
+	glGetProgramiv( m_programID, GL_COMPLETION_STATUS_KHR, &completed );
+	return completed != GL_FALSE;
+}
+
+void ShaderProgram::FinishLink()
+{
+	if ( !m_linkPending ) return;
+	m_linkPending = false;
+
+	// the compile logs were not read when the shaders were attached
+	GLint attachedShaders = 0;
+	glGetProgramiv( m_programID, GL_ATTACHED_SHADERS, &attachedShaders );
+	std::vector<GLuint> shaders( attachedShaders );
+	glGetAttachedShaders( m_programID, attachedShaders, nullptr, shaders.data() );
+	for ( GLuint shader : shaders ) CheckShaderCompileStatus( shader );
+
+	CheckProgramLinkStatus( m_programID );
+	DeleteAttachedShaders( m_programID );
+	ReflectUniforms();
+}
+
+bool ShaderProgram::LoadBinary( GLenum binaryFormat, const void* binary, GLsizei length )
+{
+	glProgramBinary( m_programID, binaryFormat, binary, length );
+	ReflectUniforms();
+	return IsLinked();
+}
+
+bool ShaderProgram::IsLinked() const noexcept
+{
+	if ( m_programID == 0 ) return false;
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv( m_programID, GL_LINK_STATUS, &linked );
+	return linked != GL_FALSE;
+}
+
+void ShaderProgram::ReflectUniforms()
+{
+	m_uniformHashes.clear();
+	m_uniforms.clear();
+
+	if ( !IsLinked() ) return;
+
+	GLint uniformCount = 0, maxNameLength = 0;
+	glGetProgramInterfaceiv( m_programID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniformCount );
+	glGetProgramInterfaceiv( m_programID, GL_UNIFORM, GL_MAX_NAME_LENGTH, &maxNameLength );
+
+	std::string nameBuffer( static_cast<std::size_t>( std::max( maxNameLength, 1 ) ), '\0' );
+	const GLenum properties[] = { GL_LOCATION, GL_ARRAY_SIZE };
+
+	struct Reflected
+	{
+		std::uint32_t hash;
+		UniformEntry  entry;
+	};
+	std::vector<Reflected> reflected;
+	reflected.reserve( uniformCount );
+
+	for ( GLint i = 0; i < uniformCount; ++i )
+	{
+		GLint values[ 2 ] = {};
+		glGetProgramResourceiv( m_programID, GL_UNIFORM, i, 2, properties, 2, nullptr, values );
+
+		// uniform block members have no location, they are set through their buffer
+		if ( values[ 0 ] < 0 ) continue;
+
+		GLsizei nameLength = 0;
+		glGetProgramResourceName( m_programID, GL_UNIFORM, i, maxNameLength, &nameLength, nameBuffer.data() );
+		std::string_view name( nameBuffer.data(), nameLength );
+
+		reflected.push_back( { UniformNameHash( name ), { values[ 0 ], std::string( name ) } } );
+
+		// arrays are reported as "name[0]", glGetUniformLocation accepts the bare name too
+		if ( values[ 1 ] > 1 && name.size() > 3 && name.substr( name.size() - 3 ) == "[0]" )
+		{
+			name.remove_suffix( 3 );
+			reflected.push_back( { UniformNameHash( name ), { values[ 0 ], std::string( name ) } } );
+		}
+	}
+
+	std::sort( reflected.begin(), reflected.end(), []( const Reflected& a, const Reflected& b ) { return a.hash < b.hash; } );
+
+	m_uniformHashes.reserve( reflected.size() );
+	m_uniforms.reserve( reflected.size() );
+	for ( Reflected& uniform : reflected )
+	{
+		m_uniformHashes.push_back( uniform.hash );
+		m_uniforms.push_back( std::move( uniform.entry ) );
+	}
+}
+
+GLint ShaderProgram::Location( UniformName uniform ) const noexcept
+{
+	const std::size_t count = m_uniformHashes.size();
+	std::size_t i = std::lower_bound( m_uniformHashes.begin(), m_uniformHashes.end(), uniform.hash ) - m_uniformHashes.begin();
+
+	// the name comparison resolves hash collisions, and unknown names whose hash happens to match
+	for ( ; i < count && m_uniformHashes[ i ] == uniform.hash; ++i )
+	{
+		if ( m_uniforms[ i ].name == uniform.name ) return m_uniforms[ i ].location;
+	}
+	return -1;
+}
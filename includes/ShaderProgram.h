@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <GL/glew.h>
+
+// FNV-1a hash of a uniform name. constexpr, so the hash of a string literal is folded into the call site.
+constexpr std::uint32_t UniformNameHash( std::string_view name ) noexcept
+{
+	std::uint32_t hash = 2166136261u;
+	for ( char c : name )
+	{
+		hash ^= static_cast<unsigned char>( c );
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// Uniform name with its precomputed hash. Implicitly constructible from string literals:
+// m_program.Location( "state" ) hashes "state" at compile time.
+struct UniformName
+{
+	std::string_view name;
+	std::uint32_t    hash;
+
+	template <std::size_t N>
+	constexpr UniformName( const char ( &literal )[ N ] ) noexcept
+		: name( literal, N - 1 )
+		, hash( UniformNameHash( name ) )
+	{
+	}
+
+	constexpr explicit UniformName( std::string_view _name ) noexcept
+		: name( _name )
+		, hash( UniformNameHash( _name ) )
+	{
+	}
+};
+
+// Owning wrapper of a GL program object.
+// Link() reflects every active uniform once (glGetProgramResource*), after that
+// Location() answers from a small hash sorted table without calling into GL.
+// Relinking (e.g. reloading the shaders) rebuilds the table.
+//
+// Deferred build: AttachShaderCodeDeferred + LinkDeferred only issue the work. With KHR_parallel_shader_compile the
+// driver compiles in the background and IsReady() polls GL_COMPLETION_STATUS_KHR; FinishLink() checks the logs and
+// reflects the uniforms, blocking if the link is still running. Without the extension the work happens (or waits)
+// in FinishLink, the result is the same.
+class ShaderProgram
+{
+public:
+	ShaderProgram() = default;
+	~ShaderProgram();
+
+	ShaderProgram( const ShaderProgram& ) = delete;
+	ShaderProgram& operator=( const ShaderProgram& ) = delete;
+
+	ShaderProgram( ShaderProgram&& other ) noexcept;
+	ShaderProgram& operator=( ShaderProgram&& other ) noexcept;
+
+	// Creates a new, empty program object (destroying the previous one).
+	void Create();
+	void Destroy() noexcept;
+
+	GLuint AttachShader( GLenum shaderType, const std::filesystem::path& fileName );
+	GLuint AttachShaderCode( GLenum shaderType, std::string_view shaderCode );
+
+	// LinkProgram() and the uniform reflection.
+	void Link( bool ownShaders = true );
+
+	// No status query, nothing waits for the driver. The program owns its shaders, FinishLink deletes them.
+	GLuint AttachShaderCodeDeferred( GLenum shaderType, std::string_view shaderCode );
+	void LinkDeferred();
+	// false while a deferred link is still being compiled/linked by the driver; never blocks.
+	bool IsReady() const noexcept;
+	// Completes a deferred link (no-op otherwise): compile and link logs, shader deletion, uniform reflection.
+	void FinishLink();
+	inline bool IsLinkPending() const noexcept { return m_linkPending; }
+
+	// glProgramBinary (a glGetProgramBinary result of the same driver) instead of compiling and linking, then the
+	// uniform reflection. false if the driver rejects the binary: the program is unlinked then, shaders can be attached.
+	bool LoadBinary( GLenum binaryFormat, const void* binary, GLsizei length );
+	bool IsLinked() const noexcept;
+
+	inline GLuint ID() const noexcept { return m_programID; }
+	explicit operator bool() const noexcept { return m_programID != 0; }
+
+	// -1, like glGetUniformLocation, if the program has no such active uniform.
+	// Array uniforms can be looked up both as "name" and "name[0]".
+	GLint Location( UniformName uniform ) const noexcept;
+
+	inline std::size_t UniformCount() const noexcept { return m_uniforms.size(); }
+
+private:
+	void ReflectUniforms();
+	void Swap( ShaderProgram& other ) noexcept;
+
+	struct UniformEntry
+	{
+		GLint       location;
+		std::string name;
+	};
+
+	GLuint m_programID = 0;
+	bool   m_linkPending = false;
+	// parallel arrays, sorted by hash: a lookup scans only the packed hashes
+	std::vector<std::uint32_t> m_uniformHashes;
+	std::vector<UniformEntry>  m_uniforms;
+};
+
+// The ul() of GLUtils.hpp for wrapped programs: no glGetUniformLocation / glGetIntegerv round-trip.
+inline GLint ul( const ShaderProgram& program, UniformName uniformName ) noexcept
+{
+	return program.Location( uniformName );
+}
@@ -0,0 +1,198 @@
+#include "ShaderVariants.h"
+
+#include "GLUtils.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include <SDL2/SDL.h>
+
+std::string InjectShaderDefines( std::string_view shaderCode, const std::vector<std::pair<std::string, int>>& defines )
+{
+	// the defines go to the line after "#version ..."; without a #version line to the very beginning
+	std::size_t insertAt = 0;
+	std::size_t versionLine = 0;
+	const std::size_t version = shaderCode.find( "#version" );
+	if ( version != std::string_view::npos )
+	{
+		const std::size_t lineEnd = shaderCode.find( '\n', version );
+		insertAt = lineEnd == std::string_view::npos ? shaderCode.size() : lineEnd + 1;
+		versionLine = static_cast<std::size_t>( std::count( shaderCode.begin(), shaderCode.begin() + version, '\n' ) ) + 1;
+	}
+
+	std::string result;
+	result.reserve( shaderCode.size() + 32 * ( defines.size() + 1 ) );
+	result.append( shaderCode.substr( 0, insertAt ) );
+	if ( insertAt > 0 && result.back() != '\n' ) result += '\n';
+
+	for ( const auto& [ name, value ] : defines )
+	{
+		result += "#define " + name + " " + std::to_string( value ) + "\n";
+	}
+	// #line N: the next line is line N of the file
+	result += "#line " + std::to_string( versionLine + 1 ) + "\n";
+
+	result.append( shaderCode.substr( insertAt ) );
+	return result;
+}
+
+void ShaderVariants::Init( std::vector<Stage> stages, std::vector<Option> options, ProgramBinaryCache* binaryCache,
+							std::vector<std::pair<std::string, int>> commonDefines )
+{
+	Clean();
+
+	m_binaryCache = binaryCache;
+	m_stages = std::move( stages );
+	m_options = std::move( options );
+	m_commonDefines = std::move( commonDefines );
+
+	m_sources.resize( m_stages.size() );
+	for ( std::size_t i = 0; i < m_stages.size(); ++i )
+	{
+		loadShaderCode( m_sources[ i ], m_stages[ i ].fileName );
+	}
+
+	std::size_t variantCount = 1;
+	for ( const Option& option : m_options ) variantCount *= static_cast<std::size_t>( std::max( option.valueCount, 1 ) );
+	m_variants.resize( variantCount );
+}
+
+void ShaderVariants::Clean()
+{
+	m_variants.clear();
+	m_fallback = Variant();
+	m_sources.clear();
+	m_stages.clear();
+	m_options.clear();
+	m_commonDefines.clear();
+	m_binaryCache = nullptr;
+	m_compiledCount = 0;
+}
+
+ShaderVariants::Key ShaderVariants::MakeKey( std::initializer_list<int> values ) const noexcept
+{
+	// the first option is the lowest digit
+	Key key = 0;
+	Key radix = 1;
+	auto value = values.begin();
+	for ( const Option& option : m_options )
+	{
+		const int valueCount = std::max( option.valueCount, 1 );
+		const int digit = value != values.end() ? std::clamp( *value++, 0, valueCount - 1 ) : 0;
+		key += static_cast<Key>( digit ) * radix;
+		radix *= static_cast<Key>( valueCount );
+	}
+	return key;
+}
+
+const ShaderProgram& ShaderVariants::Program( Key key )
+{
+	if ( key >= m_variants.size() )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_ERROR, "Shader variant %u does not exist!", key );
+		key = 0;
+	}
+	Variant& variant = m_variants[ key ];
+	if ( !variant.program ) Start( variant, Defines( key ) );
+	Finish( variant );
+	return variant.program;
+}
+
+void ShaderVariants::CompileAll()
+{
+	for ( Key key = 0; key < m_variants.size(); ++key )
+	{
+		if ( !m_variants[ key ].program ) Start( m_variants[ key ], Defines( key ) );
+	}
+	for ( Variant& variant : m_variants ) Finish( variant );
+}
+
+void ShaderVariants::StartCompileAll()
+{
+	// the fallback first: the first frames wait for that one
+	if ( !m_fallback.program ) Start( m_fallback, m_commonDefines );
+	for ( Key key = 0; key < m_variants.size(); ++key )
+	{
+		if ( !m_variants[ key ].program ) Start( m_variants[ key ], Defines( key ) );
+	}
+}
+
+const ShaderProgram& ShaderVariants::ReadyProgram( Key key )
+{
+	if ( key >= m_variants.size() ) return Program( key );
+
+	Variant& variant = m_variants[ key ];
+	if ( !variant.program ) Start( variant, Defines( key ) );
+	if ( variant.program.IsLinkPending() && variant.program.IsReady() ) Finish( variant );
+	if ( !variant.program.IsLinkPending() ) return variant.program;
+
+	if ( !m_fallback.program ) Start( m_fallback, m_commonDefines );
+	Finish( m_fallback );
+	return m_fallback.program;
+}
+
+std::size_t ShaderVariants::FinishReady()
+{
+	std::size_t readyCount = 0;
+	for ( Variant& variant : m_variants )
+	{
+		if ( variant.program.IsLinkPending() && variant.program.IsReady() ) Finish( variant );
+		if ( variant.program && !variant.program.IsLinkPending() ) ++readyCount;
+	}
+	return readyCount;
+}
+
+std::vector<std::pair<std::string, int>> ShaderVariants::Defines( Key key ) const
+{
+	// the digits of the key back to define values
+	std::vector<std::pair<std::string, int>> defines = m_commonDefines;
+	defines.reserve( m_commonDefines.size() + m_options.size() );
+	Key rest = key;
+	for ( const Option& option : m_options )
+	{
+		const Key valueCount = static_cast<Key>( std::max( option.valueCount, 1 ) );
+		defines.emplace_back( option.define, static_cast<int>( rest % valueCount ) );
+		rest /= valueCount;
+	}
+	return defines;
+}
+
+void ShaderVariants::Start( Variant& variant, const std::vector<std::pair<std::string, int>>& defines )
+{
+	std::vector<std::string> sources;
+	std::vector<std::pair<GLenum, std::string_view>> stageSources;
+	sources.reserve( m_stages.size() );
+	stageSources.reserve( m_stages.size() );
+	for ( std::size_t i = 0; i < m_stages.size(); ++i )
+	{
+		sources.push_back( defines.empty() ? m_sources[ i ] : InjectShaderDefines( m_sources[ i ], defines ) );
+		stageSources.emplace_back( m_stages[ i ].shaderType, sources.back() );
+	}
+
+	ShaderProgram& program = variant.program;
+	program.Create();
+	variant.store = false;
+	++m_compiledCount;
+
+	// the binary of an earlier run, if the sources and the driver are the same
+	variant.binaryKey = m_binaryCache != nullptr ? m_binaryCache->Key( stageSources ) : 0;
+	if ( m_binaryCache != nullptr && m_binaryCache->Load( program, variant.binaryKey ) ) return;
+
+	// glShaderSource copies the sources, they can go once issued
+	for ( const auto& [ shaderType, source ] : stageSources )
+	{
+		program.AttachShaderCodeDeferred( shaderType, source );
+	}
+	if ( m_binaryCache != nullptr ) ProgramBinaryCache::PrepareForStore( program );
+	program.LinkDeferred();
+	variant.store = m_binaryCache != nullptr;
+}
+
+void ShaderVariants::Finish( Variant& variant )
+{
+	if ( !variant.program.IsLinkPending() ) return;
+
+	variant.program.FinishLink();
+	if ( variant.store ) m_binaryCache->Store( variant.program, variant.binaryKey );
+	variant.store = false;
+}
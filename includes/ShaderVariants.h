@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "ProgramBinaryCache.h"
+#include "ShaderProgram.h"
+
+// Inserts a "#define name value" line per define right after the #version directive of a GLSL source
+// (GLSL allows nothing before #version), then a #line, so the compile errors still point at the lines of the file.
+std::string InjectShaderDefines( std::string_view shaderCode, const std::vector<std::pair<std::string, int>>& defines );
+
+// Compile time permutations of one shader family (e.g. Vert_PosNormTex.vert + Frag_ZH.frag).
+//
+// Every option is an integer define with valueCount possible values (a boolean feature has 2), a variant is one value
+// per option. Its key is the mixed radix number of the values, so the programs of the family sit in a flat array of
+// valueCount0 * valueCount1 * ... slots, a lookup is an index. The sources are read once by Init, every stage of a
+// variant is compiled with the defines of the variant injected, on first use or up front by CompileAll.
+// Adding an option multiplies the number of variants: keep them few, and compile the used ones before the first frame.
+// With a ProgramBinaryCache the linked variants are stored on disk and loaded from there on the next start.
+//
+// The programs are built with the deferred ShaderProgram calls: CompileAll issues every variant before waiting for
+// any, so a driver with KHR_parallel_shader_compile (see EnableParallelShaderCompile) compiles them side by side.
+// StartCompileAll does not wait at all; ReadyProgram then hands out the finished variants and, until one is done, the
+// fallback: the sources compiled without any option define, which have to work on their own (runtime uniforms instead).
+//
+// The common defines go into every program, the fallback included, without multiplying the variants: features the
+// context decides once, at Init (e.g. BINDLESS when the driver has GL_ARB_bindless_texture).
+class ShaderVariants
+{
+public:
+	using Key = std::uint32_t;
+
+	struct Stage
+	{
+		GLenum                shaderType;
+		std::filesystem::path fileName;
+	};
+
+	struct Option
+	{
+		std::string define;
+		int         valueCount;
+	};
+
+	ShaderVariants() = default;
+	~ShaderVariants() = default;
+
+	ShaderVariants( const ShaderVariants& ) = delete;
+	ShaderVariants& operator=( const ShaderVariants& ) = delete;
+
+	// Reads the sources, destroys the programs compiled so far. binaryCache (optional) has to outlive the variants.
+	void Init( std::vector<Stage> stages, std::vector<Option> options, ProgramBinaryCache* binaryCache = nullptr,
+			   std::vector<std::pair<std::string, int>> commonDefines = {} );
+	void Clean();
+
+	// values[ i ] is the value of options[ i ] (the missing ones are 0), clamped to [0, valueCount).
+	Key MakeKey( std::initializer_list<int> values ) const noexcept;
+
+	// The program of the variant, compiled and linked on the first call. Waits for a variant still being compiled.
+	const ShaderProgram& Program( Key key );
+
+	// Every variant, issued all at once, then waits for each.
+	void CompileAll();
+	// The fallback and every variant issued, returns without waiting.
+	void StartCompileAll();
+
+	// Never waits for the variant: the variant if it is finished, the fallback otherwise (waiting for that one if needed).
+	const ShaderProgram& ReadyProgram( Key key );
+
+	inline std::size_t VariantCount() const noexcept { return m_variants.size(); }
+	inline std::size_t CompiledCount() const noexcept { return m_compiledCount; }
+
+	// Finishes the variants the driver is done with (without waiting for the others), returns the number of
+	// finished variants. Polled once a frame after StartCompileAll, so the unused variants get stored too.
+	std::size_t FinishReady();
+
+private:
+	struct Variant
+	{
+		ShaderProgram program;        // empty (ID 0) until started
+		std::uint64_t binaryKey = 0;  // stored into the binary cache once linked
+		bool          store = false;
+	};
+
+	std::vector<std::pair<std::string, int>> Defines( Key key ) const;
+	void Start( Variant& variant, const std::vector<std::pair<std::string, int>>& defines );
+	void Finish( Variant& variant );
+
+	std::vector<Stage>       m_stages;
+	std::vector<std::string> m_sources; // per stage, as read from the file
+	std::vector<Option>      m_options;
+	std::vector<std::pair<std::string, int>> m_commonDefines; // before the option defines, in the fallback too
+	std::vector<Variant>     m_variants; // indexed by Key
+	Variant                  m_fallback; // no defines
+	ProgramBinaryCache*      m_binaryCache = nullptr;
+	std::size_t              m_compiledCount = 0;
+};
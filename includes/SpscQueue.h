@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Bounded single producer / single consumer queue of reusable slots, for handing frame packets between two threads.
+//
+// The producer fills the slot returned by BeginPush in place and hands it over with EndPush; the consumer reads the
+// slot returned by BeginPop and gives it back with EndPop. Slots are never copied or reallocated, so the containers
+// inside a packet keep their capacity from frame to frame, and a pushed slot belongs to the consumer alone until it
+// is popped: it is immutable for the producer. The capacity is the number of slots that can be in flight at once.
+//
+// The handoff itself is two atomic indices. A thread only touches the mutex when it has to sleep (full or empty queue)
+// or when it wakes one that sleeps, never on the path where both keep up with each other.
+template <typename T>
+class SpscQueue
+{
+public:
+	explicit SpscQueue( std::size_t capacity )
+		: m_slots( capacity > 0 ? capacity : 1 )
+	{
+	}
+
+	SpscQueue( const SpscQueue& ) = delete;
+	SpscQueue& operator=( const SpscQueue& ) = delete;
+
+	inline std::size_t Capacity() const noexcept { return m_slots.size(); }
+
+	// Producer. The next free slot, nullptr if every slot is in flight (TryBeginPush) or after Close.
+	T* TryBeginPush()
+	{
+		const std::size_t tail = m_tail.load( std::memory_order_relaxed );
+		if ( m_closed.load() || tail - m_head.load( std::memory_order_acquire ) == m_slots.size() ) return nullptr;
+		return &m_slots[ tail % m_slots.size() ];
+	}
+
+	// Producer. Waits for a free slot; nullptr only after Close.
+	T* BeginPush()
+	{
+		Sleep( [ this ]() { return m_closed.load() || m_tail.load( std::memory_order_relaxed ) - m_head.load() < m_slots.size(); } );
+		return TryBeginPush();
+	}
+
+	void EndPush()
+	{
+		m_tail.store( m_tail.load( std::memory_order_relaxed ) + 1 );
+		Wake();
+	}
+
+	// Consumer. The oldest pushed slot, nullptr if there is none (TryBeginPop) or after Close.
+	T* TryBeginPop()
+	{
+		const std::size_t head = m_head.load( std::memory_order_relaxed );
+		if ( m_closed.load() || head == m_tail.load( std::memory_order_acquire ) ) return nullptr;
+		return &m_slots[ head % m_slots.size() ];
+	}
+
+	// Consumer. Waits for a pushed slot; nullptr only after Close.
+	T* BeginPop()
+	{
+		Sleep( [ this ]() { return m_closed.load() || m_head.load( std::memory_order_relaxed ) != m_tail.load(); } );
+		return TryBeginPop();
+	}
+
+	void EndPop()
+	{
+		m_head.store( m_head.load( std::memory_order_relaxed ) + 1 );
+		Wake();
+	}
+
+	// Either thread. Wakes the waiting side; from now on every Begin returns nullptr.
+	void Close()
+	{
+		m_closed.store( true );
+		Wake();
+	}
+
+	inline bool IsClosed() const noexcept { return m_closed.load(); }
+
+private:
+	// The sleeper announces itself before it checks the condition under the mutex, the waker publishes its index
+	// before it looks for sleepers (both sequentially consistent): either the sleeper sees the new index, or the
+	// waker sees the sleeper and notifies it under the mutex, so no wake-up is lost.
+	template <typename Ready>
+	void Sleep( Ready ready )
+	{
+		if ( ready() ) return;
+		++m_sleepers;
+		{
+			std::unique_lock<std::mutex> lock( m_mutex );
+			m_wakeUp.wait( lock, ready );
+		}
+		--m_sleepers;
+	}
+
+	void Wake()
+	{
+		if ( m_sleepers.load() == 0 ) return;
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+		}
+		m_wakeUp.notify_all();
+	}
+
+	std::vector<T> m_slots;
+	alignas( 64 ) std::atomic<std::size_t> m_head = 0; // next slot to pop, written by the consumer
+	alignas( 64 ) std::atomic<std::size_t> m_tail = 0; // next slot to push, written by the producer
+	std::atomic<bool> m_closed = false;
+	std::atomic<int>  m_sleepers = 0;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+};
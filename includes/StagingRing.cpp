@@ -0,0 +1,133 @@
+#include "StagingRing.h"
+
+#include <algorithm>
+
+#include <SDL2/SDL_log.h>
+
+namespace
+{
+	constexpr GLsizeiptr AlignUp( GLsizeiptr size, GLsizeiptr alignment )
+	{
+		return ( size + alignment - 1 ) / alignment * alignment;
+	}
+}
+
+StagingRing::~StagingRing()
+{
+	Clean();
+}
+
+bool StagingRing::Init( GLsizeiptr capacity )
+{
+	Clean();
+
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	m_capacity = AlignUp( capacity, ALIGNMENT );
+
+	glCreateBuffers( 1, &m_bufferID );
+	glNamedBufferStorage( m_bufferID, m_capacity, nullptr, flags );
+	m_mapped = static_cast<std::byte*>( glMapNamedBufferRange( m_bufferID, 0, m_capacity, flags ) );
+
+	if ( m_mapped == nullptr )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_WARN, "[StagingRing] Could not map a %lld byte buffer persistently",
+						static_cast<long long>( m_capacity ) );
+		Clean();
+		return false;
+	}
+	return true;
+}
+
+void StagingRing::Clean()
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	for ( Block& block : m_blocks )
+	{
+		if ( block.fence == nullptr ) continue;
+		glClientWaitSync( block.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED );
+		glDeleteSync( block.fence );
+	}
+	m_blocks.clear();
+	m_head = 0;
+
+	// deleting the buffer unmaps it
+	if ( m_bufferID != 0 ) glDeleteBuffers( 1, &m_bufferID );
+	m_bufferID = 0;
+	m_mapped = nullptr;
+	m_capacity = 0;
+}
+
+StagingRing::Region StagingRing::TryAllocate( GLsizeiptr size )
+{
+	size = AlignUp( std::max<GLsizeiptr>( size, 1 ), ALIGNMENT );
+
+	std::lock_guard<std::mutex> lock( m_mutex );
+	if ( m_mapped == nullptr || size > m_capacity ) return Region();
+
+	GLintptr offset = 0;
+	if ( m_blocks.empty() )
+	{
+		offset = 0;
+	}
+	else
+	{
+		// free space: [head, tail) if the ring wrapped around, [head, capacity) + [0, tail) otherwise
+		const GLintptr tail = m_blocks.front().offset;
+		if ( m_head > tail )
+		{
+			if ( m_capacity - m_head >= size )
+			{
+				offset = m_head;
+			}
+			else if ( tail >= size )
+			{
+				// the end of the buffer is too short: the last region keeps it until it is freed
+				m_blocks.back().size += m_capacity - m_head;
+				offset = 0;
+			}
+			else return Region();
+		}
+		else if ( m_head < tail && tail - m_head >= size )
+		{
+			offset = m_head;
+		}
+		else return Region(); // head == tail: full
+	}
+
+	m_blocks.push_back( { offset, size } );
+	m_head = offset + size;
+	return { offset, size, m_mapped + offset };
+}
+
+void StagingRing::Release( const Region& region )
+{
+	if ( !region ) return;
+
+	std::lock_guard<std::mutex> lock( m_mutex );
+	auto block = std::find_if( m_blocks.begin(), m_blocks.end(), [ &region ]( const Block& b ) { return b.offset == region.offset; } );
+	if ( block == m_blocks.end() || block->fence != nullptr ) return;
+
+	block->fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+void StagingRing::Retire()
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	while ( !m_blocks.empty() && m_blocks.front().fence != nullptr )
+	{
+		const GLenum status = glClientWaitSync( m_blocks.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0 );
+		if ( status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED ) break;
+
+		glDeleteSync( m_blocks.front().fence );
+		m_blocks.pop_front();
+	}
+	if ( m_blocks.empty() ) m_head = 0;
+}
+
+GLsizeiptr StagingRing::UsedBytes()
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	GLsizeiptr used = 0;
+	for ( const Block& block : m_blocks ) used += block.size;
+	return used;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+#include <GL/glew.h>
+
+// Persistently mapped pixel unpack buffer, handed out as a ring of regions.
+//
+// The buffer is created with glNamedBufferStorage( GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT )
+// and mapped once, so any thread can write into a region: TryAllocate is thread safe and never waits. The GL thread
+// binds Buffer() as GL_PIXEL_UNPACK_BUFFER and passes Region::offset instead of a client pointer, the driver copies
+// from its own memory. When the last copy command reading a region is issued, Release puts a fence behind it; Retire
+// frees the regions whose fences signalled, oldest first (the ring frees in allocation order, a region still in use
+// holds back the ones behind it). A coherent mapping needs no flush: the writes are visible to commands issued later.
+class StagingRing
+{
+public:
+	struct Region
+	{
+		GLintptr   offset = 0;
+		GLsizeiptr size = 0;
+		std::byte* data = nullptr; // mapped, write only
+
+		explicit operator bool() const noexcept { return data != nullptr; }
+	};
+
+	StagingRing() = default;
+	~StagingRing();
+
+	StagingRing( const StagingRing& ) = delete;
+	StagingRing& operator=( const StagingRing& ) = delete;
+
+	// GL thread. False if the buffer could not be created or mapped.
+	bool Init( GLsizeiptr capacity );
+	// GL thread. Waits for the fences of the released regions; the other regions are dropped.
+	void Clean();
+
+	// Any thread. An empty Region if there is no room right now (or size > Capacity()).
+	Region TryAllocate( GLsizeiptr size );
+
+	// GL thread, after the copy commands reading the region.
+	void Release( const Region& region );
+	// GL thread, never waits. Frees the released regions the GPU is done with.
+	void Retire();
+
+	inline GLuint Buffer() const noexcept { return m_bufferID; }
+	inline GLsizeiptr Capacity() const noexcept { return m_capacity; }
+	GLsizeiptr UsedBytes();
+
+	// Region offsets are multiples of this: any pixel type can be unpacked from them.
+	static constexpr GLsizeiptr ALIGNMENT = 64;
+
+private:
+	struct Block
+	{
+		GLintptr   offset;
+		GLsizeiptr size;     // with the padding up to the end of the buffer when the next region wrapped around
+		GLsync     fence = nullptr;
+	};
+
+	GLuint     m_bufferID = 0;
+	std::byte* m_mapped = nullptr;
+	GLsizeiptr m_capacity = 0;
+
+	std::mutex        m_mutex;
+	std::deque<Block> m_blocks; // allocation order, the front is the oldest
+	GLintptr          m_head = 0; // where the next region starts
+};
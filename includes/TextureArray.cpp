@@ -0,0 +1,76 @@
+#include "TextureArray.h"
+
+#include "TextureCooking.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include <SDL2/SDL_log.h>
+
+TextureArray::~TextureArray()
+{
+	Clean();
+}
+
+bool TextureArray::Init( GLsizei layerCount, GLsizei width, GLsizei height, GLenum internalFormat )
+{
+	Clean();
+
+	const std::vector<TextureCooking::MipLevel> levels = TextureCooking::MipLevels( width, height );
+	m_width = width;
+	m_height = height;
+	m_levelCount = static_cast<GLsizei>( levels.size() );
+	m_internalFormat = internalFormat;
+
+	glCreateTextures( GL_TEXTURE_2D_ARRAY, 1, &m_textureID );
+	glTextureStorage3D( m_textureID, m_levelCount, internalFormat, width, height, layerCount );
+	if ( glGetError() != GL_NO_ERROR )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_ERROR, SDL_LOG_PRIORITY_ERROR,
+						"[TextureArray] Could not create %d layers of %dx%d (format 0x%04x)", layerCount, width, height, internalFormat );
+		Clean();
+		return false;
+	}
+
+	// the storage is undefined until written: black everywhere, so a layer not loaded (yet) is black
+	if ( !IsCompressed() )
+	{
+		for ( GLsizei level = 0; level < m_levelCount; ++level ) glClearTexImage( m_textureID, level, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+	}
+	else
+	{
+		// glClearTexImage does not take compressed formats; all zero BC1/BC3 blocks are black, BC7 ones transparent black
+		GLint compressedSize = 0;
+		std::vector<std::byte> zeros;
+		for ( GLsizei level = 0; level < m_levelCount; ++level )
+		{
+			glGetTextureLevelParameteriv( m_textureID, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressedSize );
+			zeros.assign( static_cast<std::size_t>( compressedSize ), std::byte( 0 ) );
+			glCompressedTextureSubImage3D( m_textureID, level, 0, 0, 0, levels[ level ].width, levels[ level ].height, layerCount,
+										   internalFormat, compressedSize, zeros.data() );
+		}
+	}
+
+	m_layerLevels.assign( layerCount, 0 );
+	m_baseLevel = 0;
+	return true;
+}
+
+void TextureArray::Clean()
+{
+	glDeleteTextures( 1, &m_textureID );
+	m_textureID = 0;
+	m_layerLevels.clear();
+}
+
+void TextureArray::SetLayerLevel( GLsizei layer, GLsizei finestLevel )
+{
+	m_layerLevels[ layer ] = finestLevel;
+
+	const GLint baseLevel = std::min( *std::max_element( m_layerLevels.cbegin(), m_layerLevels.cend() ), m_levelCount - 1 );
+	if ( baseLevel != m_baseLevel )
+	{
+		glTextureParameteri( m_textureID, GL_TEXTURE_BASE_LEVEL, baseLevel );
+		m_baseLevel = baseLevel;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+// A GL_TEXTURE_2D_ARRAY of equally sized layers with every mip level: the material textures of the scene in one
+// texture object, so every draw samples it through the same binding and picks its layer (the MaterialUniforms of
+// ObjectUniforms and DrawData). TextureLoader::Load( fileName, array, layer ) fills a layer.
+//
+// The layers are cleared to black at Init. Images stream in from their coarsest level, but GL_TEXTURE_BASE_LEVEL is
+// shared by the layers: it follows the coarsest of their finest complete levels (SetLayerLevel), so the array only
+// sharpens as far as its slowest layer has arrived.
+class TextureArray
+{
+public:
+	TextureArray() = default;
+	~TextureArray();
+
+	TextureArray( const TextureArray& ) = delete;
+	TextureArray& operator=( const TextureArray& ) = delete;
+
+	// internalFormat: GL_RGBA8 or a block compressed format (the layers then need a size divisible by 4).
+	bool Init( GLsizei layerCount, GLsizei width, GLsizei height, GLenum internalFormat );
+	void Clean();
+
+	// The finest level of layer holding its image; LevelCount() while it has none yet.
+	void SetLayerLevel( GLsizei layer, GLsizei finestLevel );
+
+	inline GLuint ID() const noexcept { return m_textureID; }
+	inline GLsizei LayerCount() const noexcept { return static_cast<GLsizei>( m_layerLevels.size() ); }
+	inline GLsizei Width() const noexcept { return m_width; }
+	inline GLsizei Height() const noexcept { return m_height; }
+	inline GLsizei LevelCount() const noexcept { return m_levelCount; }
+	inline GLenum InternalFormat() const noexcept { return m_internalFormat; }
+	inline bool IsCompressed() const noexcept { return m_internalFormat != GL_RGBA8; }
+
+private:
+	GLuint  m_textureID = 0;
+	GLsizei m_width = 0;
+	GLsizei m_height = 0;
+	GLsizei m_levelCount = 0;
+	GLenum  m_internalFormat = GL_NONE;
+	GLint   m_baseLevel = 0;
+	std::vector<GLsizei> m_layerLevels;
+};
@@ -0,0 +1,645 @@
+#include "TextureCooking.h"
+
+#include "GLUtils.hpp"
+#include "IndexedVertTable.h"
+#include "KTX2.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	// --- sRGB ---
+
+	// sRGB encoded byte -> linear [0, 1]
+	const std::array<float, 256>& SRGBToLinearTable()
+	{
+		static const std::array<float, 256> table = []()
+		{
+			std::array<float, 256> result;
+			for ( int i = 0; i < 256; ++i )
+			{
+				const float c = i / 255.0f;
+				result[ i ] = c <= 0.04045f ? c / 12.92f : std::pow( ( c + 0.055f ) / 1.055f, 2.4f );
+			}
+			return result;
+		}();
+		return table;
+	}
+
+	// linear [0, 1] in 1/65535 steps -> sRGB encoded byte; fine enough for the steep dark end of the curve
+	const std::vector<std::uint8_t>& LinearToSRGBTable()
+	{
+		static const std::vector<std::uint8_t> table = []()
+		{
+			std::vector<std::uint8_t> result( 65536 );
+			for ( std::size_t i = 0; i < result.size(); ++i )
+			{
+				const float l = i / 65535.0f;
+				const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow( l, 1.0f / 2.4f ) - 0.055f;
+				result[ i ] = static_cast<std::uint8_t>( std::clamp( c * 255.0f + 0.5f, 0.0f, 255.0f ) );
+			}
+			return result;
+		}();
+		return table;
+	}
+
+	// --- block encoding ---
+
+	using Block = std::array<std::array<float, 4>, 16>; // 4x4 texels, RGBA 0..255
+
+	Block LoadBlock( const std::uint32_t* texels, unsigned int width, unsigned int height, unsigned int blockX, unsigned int blockY )
+	{
+		Block block;
+		for ( unsigned int y = 0; y < 4; ++y )
+		{
+			// the texels outside the level repeat the edge
+			const unsigned int sy = std::min( blockY * 4 + y, height - 1 );
+			for ( unsigned int x = 0; x < 4; ++x )
+			{
+				const unsigned int sx = std::min( blockX * 4 + x, width - 1 );
+				const std::uint32_t texel = texels[ std::size_t( sy ) * width + sx ];
+				for ( unsigned int c = 0; c < 4; ++c ) block[ y * 4 + x ][ c ] = static_cast<float>( ( texel >> ( 8 * c ) ) & 0xFFu );
+			}
+		}
+		return block;
+	}
+
+	// Principal axis of the first channelCount channels (power iteration on the covariance), endpoints at the extreme
+	// projections. The usual starting point of the endpoint search, refined by LeastSquaresEndpoints.
+	void PrincipalEndpoints( const Block& block, unsigned int channelCount, float e0[ 4 ], float e1[ 4 ] )
+	{
+		float mean[ 4 ] = {};
+		for ( const auto& texel : block )
+			for ( unsigned int c = 0; c < channelCount; ++c ) mean[ c ] += texel[ c ] / 16.0f;
+
+		float cov[ 4 ][ 4 ] = {};
+		for ( const auto& texel : block )
+			for ( unsigned int i = 0; i < channelCount; ++i )
+				for ( unsigned int j = 0; j < channelCount; ++j ) cov[ i ][ j ] += ( texel[ i ] - mean[ i ] ) * ( texel[ j ] - mean[ j ] );
+
+		float axis[ 4 ] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		for ( int iteration = 0; iteration < 8; ++iteration )
+		{
+			float next[ 4 ] = {};
+			for ( unsigned int i = 0; i < channelCount; ++i )
+				for ( unsigned int j = 0; j < channelCount; ++j ) next[ i ] += cov[ i ][ j ] * axis[ j ];
+
+			float length = 0.0f;
+			for ( unsigned int i = 0; i < channelCount; ++i ) length = std::max( length, std::fabs( next[ i ] ) );
+			if ( length < 1e-6f ) break; // flat block: any axis does
+			for ( unsigned int i = 0; i < channelCount; ++i ) axis[ i ] = next[ i ] / length;
+		}
+
+		float minT = 0.0f, maxT = 0.0f, axisLength2 = 0.0f;
+		for ( unsigned int i = 0; i < channelCount; ++i ) axisLength2 += axis[ i ] * axis[ i ];
+		for ( const auto& texel : block )
+		{
+			float t = 0.0f;
+			for ( unsigned int i = 0; i < channelCount; ++i ) t += ( texel[ i ] - mean[ i ] ) * axis[ i ];
+			t /= axisLength2;
+			minT = std::min( minT, t );
+			maxT = std::max( maxT, t );
+		}
+		for ( unsigned int i = 0; i < channelCount; ++i )
+		{
+			e0[ i ] = std::clamp( mean[ i ] + maxT * axis[ i ], 0.0f, 255.0f );
+			e1[ i ] = std::clamp( mean[ i ] + minT * axis[ i ], 0.0f, 255.0f );
+		}
+	}
+
+	// Endpoints minimising the error for fixed indices: texel ~ weight0 * e0 + ( 1 - weight0 ) * e1.
+	// false if the indices do not determine them (every texel on the same weight).
+	bool LeastSquaresEndpoints( const Block& block, unsigned int channelCount, const float* weight0, float e0[ 4 ], float e1[ 4 ] )
+	{
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ax[ 4 ] = {}, bx[ 4 ] = {};
+		for ( std::size_t i = 0; i < block.size(); ++i )
+		{
+			const float a = weight0[ i ], b = 1.0f - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for ( unsigned int c = 0; c < channelCount; ++c )
+			{
+				ax[ c ] += a * block[ i ][ c ];
+				bx[ c ] += b * block[ i ][ c ];
+			}
+		}
+		const float det = aa * bb - ab * ab;
+		if ( std::fabs( det ) < 1e-6f ) return false;
+
+		for ( unsigned int c = 0; c < channelCount; ++c )
+		{
+			e0[ c ] = std::clamp( ( bb * ax[ c ] - ab * bx[ c ] ) / det, 0.0f, 255.0f );
+			e1[ c ] = std::clamp( ( aa * bx[ c ] - ab * ax[ c ] ) / det, 0.0f, 255.0f );
+		}
+		return true;
+	}
+
+	// - BC1 color block -
+
+	std::uint16_t To565( const float color[ 4 ] )
+	{
+		const unsigned int r = static_cast<unsigned int>( color[ 0 ] * 31.0f / 255.0f + 0.5f );
+		const unsigned int g = static_cast<unsigned int>( color[ 1 ] * 63.0f / 255.0f + 0.5f );
+		const unsigned int b = static_cast<unsigned int>( color[ 2 ] * 31.0f / 255.0f + 0.5f );
+		return static_cast<std::uint16_t>( ( r << 11 ) | ( g << 5 ) | b );
+	}
+
+	void From565( std::uint16_t packed, float color[ 3 ] )
+	{
+		const unsigned int r = ( packed >> 11 ) & 31, g = ( packed >> 5 ) & 63, b = packed & 31;
+		color[ 0 ] = static_cast<float>( ( r << 3 ) | ( r >> 2 ) );
+		color[ 1 ] = static_cast<float>( ( g << 2 ) | ( g >> 4 ) );
+		color[ 2 ] = static_cast<float>( ( b << 3 ) | ( b >> 2 ) );
+	}
+
+	// Indices of the 4 color palette for the quantised endpoints, returns the squared error.
+	float BC1Indices( const Block& block, std::uint16_t q0, std::uint16_t q1, std::uint8_t indices[ 16 ] )
+	{
+		float palette[ 4 ][ 3 ];
+		From565( q0, palette[ 0 ] );
+		From565( q1, palette[ 1 ] );
+		for ( int c = 0; c < 3; ++c )
+		{
+			palette[ 2 ][ c ] = ( 2.0f * palette[ 0 ][ c ] + palette[ 1 ][ c ] ) / 3.0f;
+			palette[ 3 ][ c ] = ( palette[ 0 ][ c ] + 2.0f * palette[ 1 ][ c ] ) / 3.0f;
+		}
+
+		float total = 0.0f;
+		for ( std::size_t i = 0; i < block.size(); ++i )
+		{
+			float best = 1e30f;
+			for ( std::uint8_t p = 0; p < 4; ++p )
+			{
+				float error = 0.0f;
+				for ( int c = 0; c < 3; ++c ) error += ( block[ i ][ c ] - palette[ p ][ c ] ) * ( block[ i ][ c ] - palette[ p ][ c ] );
+				if ( error < best )
+				{
+					best = error;
+					indices[ i ] = p;
+				}
+			}
+			total += best;
+		}
+		return total;
+	}
+
+	void EncodeBC1Color( const Block& block, std::byte* out )
+	{
+		constexpr float WEIGHT0[ 4 ] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+		float e0[ 4 ] = {}, e1[ 4 ] = {};
+		PrincipalEndpoints( block, 3, e0, e1 );
+
+		std::uint16_t best0 = To565( e0 ), best1 = To565( e1 );
+		std::uint8_t bestIndices[ 16 ];
+		float bestError = BC1Indices( block, best0, best1, bestIndices );
+
+		for ( int iteration = 0; iteration < 2; ++iteration )
+		{
+			float weights[ 16 ];
+			for ( int i = 0; i < 16; ++i ) weights[ i ] = WEIGHT0[ bestIndices[ i ] ];
+			if ( !LeastSquaresEndpoints( block, 3, weights, e0, e1 ) ) break;
+
+			const std::uint16_t q0 = To565( e0 ), q1 = To565( e1 );
+			std::uint8_t indices[ 16 ];
+			const float error = BC1Indices( block, q0, q1, indices );
+			if ( error >= bestError ) break;
+			best0 = q0;
+			best1 = q1;
+			bestError = error;
+			std::copy( indices, indices + 16, bestIndices );
+		}
+
+		// color0 > color1 selects the 4 color mode (BC1 would treat the other order as 3 colors + transparent)
+		if ( best0 < best1 )
+		{
+			std::swap( best0, best1 );
+			constexpr std::uint8_t SWAPPED[ 4 ] = { 1, 0, 3, 2 };
+			for ( std::uint8_t& index : bestIndices ) index = SWAPPED[ index ];
+		}
+		else if ( best0 == best1 )
+		{
+			std::fill( bestIndices, bestIndices + 16, std::uint8_t( 0 ) );
+		}
+
+		std::uint32_t packedIndices = 0;
+		for ( int i = 0; i < 16; ++i ) packedIndices |= std::uint32_t( bestIndices[ i ] ) << ( 2 * i );
+
+		const std::uint8_t bytes[ 8 ] = {
+			std::uint8_t( best0 ), std::uint8_t( best0 >> 8 ), std::uint8_t( best1 ), std::uint8_t( best1 >> 8 ),
+			std::uint8_t( packedIndices ), std::uint8_t( packedIndices >> 8 ), std::uint8_t( packedIndices >> 16 ), std::uint8_t( packedIndices >> 24 ),
+		};
+		std::memcpy( out, bytes, sizeof( bytes ) );
+	}
+
+	// - BC3 alpha block -
+
+	void EncodeBC3Alpha( const Block& block, std::byte* out )
+	{
+		float minAlpha = 255.0f, maxAlpha = 0.0f;
+		for ( const auto& texel : block )
+		{
+			minAlpha = std::min( minAlpha, texel[ 3 ] );
+			maxAlpha = std::max( maxAlpha, texel[ 3 ] );
+		}
+		const std::uint8_t a0 = static_cast<std::uint8_t>( maxAlpha + 0.5f );
+		const std::uint8_t a1 = static_cast<std::uint8_t>( minAlpha + 0.5f );
+
+		// a0 > a1: 8 interpolated values
+		float palette[ 8 ] = { float( a0 ), float( a1 ) };
+		for ( int i = 1; i < 7; ++i ) palette[ i + 1 ] = ( ( 7 - i ) * float( a0 ) + i * float( a1 ) ) / 7.0f;
+
+		std::uint64_t packedIndices = 0;
+		if ( a0 != a1 )
+		{
+			for ( int i = 0; i < 16; ++i )
+			{
+				std::uint64_t bestIndex = 0;
+				float best = 1e30f;
+				for ( std::uint64_t p = 0; p < 8; ++p )
+				{
+					const float error = std::fabs( block[ i ][ 3 ] - palette[ p ] );
+					if ( error < best )
+					{
+						best = error;
+						bestIndex = p;
+					}
+				}
+				packedIndices |= bestIndex << ( 3 * i );
+			}
+		}
+
+		std::uint8_t bytes[ 8 ] = { a0, a1 };
+		for ( int i = 0; i < 6; ++i ) bytes[ 2 + i ] = static_cast<std::uint8_t>( packedIndices >> ( 8 * i ) );
+		std::memcpy( out, bytes, sizeof( bytes ) );
+	}
+
+	// - BC7 mode 6 -
+
+	constexpr int BC7_WEIGHTS4[ 16 ] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct BC7Endpoint
+	{
+		int value[ 4 ]; // 7 bits per channel
+		int pBit;
+	};
+
+	// 7 bit channels + the shared lowest bit, the p-bit with the smaller error
+	BC7Endpoint QuantizeBC7Endpoint( const float e[ 4 ] )
+	{
+		BC7Endpoint best = {};
+		float bestError = 1e30f;
+		for ( int p = 0; p < 2; ++p )
+		{
+			BC7Endpoint candidate = {};
+			candidate.pBit = p;
+			float error = 0.0f;
+			for ( int c = 0; c < 4; ++c )
+			{
+				candidate.value[ c ] = std::clamp( static_cast<int>( std::lround( ( e[ c ] - p ) / 2.0f ) ), 0, 127 );
+				const float decoded = static_cast<float>( ( candidate.value[ c ] << 1 ) | p );
+				error += ( decoded - e[ c ] ) * ( decoded - e[ c ] );
+			}
+			if ( error < bestError )
+			{
+				bestError = error;
+				best = candidate;
+			}
+		}
+		return best;
+	}
+
+	float BC7Indices( const Block& block, const BC7Endpoint& q0, const BC7Endpoint& q1, std::uint8_t indices[ 16 ] )
+	{
+		float palette[ 16 ][ 4 ];
+		for ( int p = 0; p < 16; ++p )
+		{
+			for ( int c = 0; c < 4; ++c )
+			{
+				const int v0 = ( q0.value[ c ] << 1 ) | q0.pBit;
+				const int v1 = ( q1.value[ c ] << 1 ) | q1.pBit;
+				palette[ p ][ c ] = static_cast<float>( ( ( 64 - BC7_WEIGHTS4[ p ] ) * v0 + BC7_WEIGHTS4[ p ] * v1 + 32 ) >> 6 );
+			}
+		}
+
+		float total = 0.0f;
+		for ( std::size_t i = 0; i < block.size(); ++i )
+		{
+			float best = 1e30f;
+			for ( std::uint8_t p = 0; p < 16; ++p )
+			{
+				float error = 0.0f;
+				for ( int c = 0; c < 4; ++c ) error += ( block[ i ][ c ] - palette[ p ][ c ] ) * ( block[ i ][ c ] - palette[ p ][ c ] );
+				if ( error < best )
+				{
+					best = error;
+					indices[ i ] = p;
+				}
+			}
+			total += best;
+		}
+		return total;
+	}
+
+	class BitWriter
+	{
+	public:
+		explicit BitWriter( std::byte* out ) : m_out( out ) { std::memset( out, 0, 16 ); }
+
+		void Write( std::uint32_t value, int bitCount )
+		{
+			for ( int i = 0; i < bitCount; ++i, ++m_position )
+			{
+				if ( ( value >> i ) & 1u ) m_out[ m_position / 8 ] |= std::byte( 1u << ( m_position % 8 ) );
+			}
+		}
+
+	private:
+		std::byte* m_out;
+		int        m_position = 0;
+	};
+
+	void EncodeBC7Mode6( const Block& block, std::byte* out )
+	{
+		float e0[ 4 ] = {}, e1[ 4 ] = {};
+		// e0 gets weight 0 in BC7: start from the minimum
+		PrincipalEndpoints( block, 4, e1, e0 );
+
+		BC7Endpoint best0 = QuantizeBC7Endpoint( e0 ), best1 = QuantizeBC7Endpoint( e1 );
+		std::uint8_t bestIndices[ 16 ];
+		float bestError = BC7Indices( block, best0, best1, bestIndices );
+
+		for ( int iteration = 0; iteration < 2; ++iteration )
+		{
+			float weights[ 16 ];
+			for ( int i = 0; i < 16; ++i ) weights[ i ] = 1.0f - BC7_WEIGHTS4[ bestIndices[ i ] ] / 64.0f;
+			if ( !LeastSquaresEndpoints( block, 4, weights, e0, e1 ) ) break;
+
+			const BC7Endpoint q0 = QuantizeBC7Endpoint( e0 ), q1 = QuantizeBC7Endpoint( e1 );
+			std::uint8_t indices[ 16 ];
+			const float error = BC7Indices( block, q0, q1, indices );
+			if ( error >= bestError ) break;
+			best0 = q0;
+			best1 = q1;
+			bestError = error;
+			std::copy( indices, indices + 16, bestIndices );
+		}
+
+		// the anchor (texel 0) index is stored without its highest bit, it has to be < 8
+		if ( bestIndices[ 0 ] >= 8 )
+		{
+			std::swap( best0, best1 );
+			for ( std::uint8_t& index : bestIndices ) index = static_cast<std::uint8_t>( 15 - index );
+		}
+
+		BitWriter bits( out );
+		bits.Write( 1u << 6, 7 ); // mode 6
+		for ( int c = 0; c < 4; ++c )
+		{
+			bits.Write( best0.value[ c ], 7 );
+			bits.Write( best1.value[ c ], 7 );
+		}
+		bits.Write( best0.pBit, 1 );
+		bits.Write( best1.pBit, 1 );
+		bits.Write( bestIndices[ 0 ], 3 );
+		for ( int i = 1; i < 16; ++i ) bits.Write( bestIndices[ i ], 4 );
+	}
+}
+
+std::vector<TextureCooking::MipLevel> TextureCooking::MipLevels( unsigned int width, unsigned int height )
+{
+	std::vector<MipLevel> levels;
+	std::size_t offset = 0;
+	for ( unsigned int level = 0; ; ++level )
+	{
+		const unsigned int levelWidth = std::max( width >> level, 1u );
+		const unsigned int levelHeight = std::max( height >> level, 1u );
+		const std::size_t size = std::size_t( levelWidth ) * levelHeight;
+		levels.push_back( { offset, size, levelWidth, levelHeight } );
+		offset += size;
+		if ( levelWidth == 1 && levelHeight == 1 ) break;
+	}
+	return levels;
+}
+
+void TextureCooking::DownsampleSRGB( const std::uint32_t* src, unsigned int srcWidth, unsigned int srcHeight,
+									 std::uint32_t* dst, unsigned int dstWidth, unsigned int dstHeight )
+{
+	const std::array<float, 256>& toLinear = SRGBToLinearTable();
+	const std::vector<std::uint8_t>& toSRGB = LinearToSRGBTable();
+
+	for ( unsigned int y = 0; y < dstHeight; ++y )
+	{
+		const std::uint32_t* row0 = src + std::size_t( std::min( 2 * y, srcHeight - 1 ) ) * srcWidth;
+		const std::uint32_t* row1 = src + std::size_t( std::min( 2 * y + 1, srcHeight - 1 ) ) * srcWidth;
+		for ( unsigned int x = 0; x < dstWidth; ++x )
+		{
+			const unsigned int x0 = std::min( 2 * x, srcWidth - 1 );
+			const unsigned int x1 = std::min( 2 * x + 1, srcWidth - 1 );
+			const std::uint32_t texels[ 4 ] = { row0[ x0 ], row0[ x1 ], row1[ x0 ], row1[ x1 ] };
+
+			std::uint32_t result = 0;
+			for ( unsigned int c = 0; c < 3; ++c )
+			{
+				float sum = 0.0f;
+				for ( std::uint32_t texel : texels ) sum += toLinear[ ( texel >> ( 8 * c ) ) & 0xFFu ];
+				result |= std::uint32_t( toSRGB[ static_cast<std::size_t>( sum * ( 65535.0f / 4.0f ) + 0.5f ) ] ) << ( 8 * c );
+			}
+			std::uint32_t alpha = 2; // rounding
+			for ( std::uint32_t texel : texels ) alpha += texel >> 24;
+			result |= ( alpha / 4 ) << 24;
+
+			dst[ std::size_t( y ) * dstWidth + x ] = result;
+		}
+	}
+}
+
+void TextureCooking::ResizeSRGB( const std::uint32_t* src, unsigned int srcWidth, unsigned int srcHeight,
+								 std::uint32_t* dst, unsigned int dstWidth, unsigned int dstHeight )
+{
+	const std::array<float, 256>& toLinear = SRGBToLinearTable();
+	const std::vector<std::uint8_t>& toSRGB = LinearToSRGBTable();
+
+	// per destination texel of one axis: the source texels and their normalized weights
+	using Taps = std::vector<std::vector<std::pair<unsigned int, float>>>;
+	auto tentTaps = []( unsigned int srcSize, unsigned int dstSize )
+	{
+		const float scale = float( srcSize ) / dstSize;
+		const float radius = std::max( 1.0f, scale );
+		Taps taps( dstSize );
+		for ( unsigned int d = 0; d < dstSize; ++d )
+		{
+			const float center = ( d + 0.5f ) * scale - 0.5f;
+			float sum = 0.0f;
+			for ( int s = static_cast<int>( std::ceil( center - radius ) ); s <= static_cast<int>( std::floor( center + radius ) ); ++s )
+			{
+				const float weight = 1.0f - std::abs( s - center ) / radius;
+				if ( weight <= 0.0f ) continue;
+				taps[ d ].emplace_back( static_cast<unsigned int>( std::clamp( s, 0, static_cast<int>( srcSize ) - 1 ) ), weight );
+				sum += weight;
+			}
+			for ( auto& tap : taps[ d ] ) tap.second /= sum;
+		}
+		return taps;
+	};
+	const Taps columns = tentTaps( srcWidth, dstWidth );
+	const Taps rows = tentTaps( srcHeight, dstHeight );
+
+	// horizontal pass into linear RGBA floats, srcHeight x dstWidth
+	std::vector<std::array<float, 4>> horizontal( std::size_t( srcHeight ) * dstWidth );
+	for ( unsigned int y = 0; y < srcHeight; ++y )
+	{
+		const std::uint32_t* srcRow = src + std::size_t( y ) * srcWidth;
+		for ( unsigned int x = 0; x < dstWidth; ++x )
+		{
+			std::array<float, 4>& sum = horizontal[ std::size_t( y ) * dstWidth + x ];
+			sum = {};
+			for ( const auto& [ s, weight ] : columns[ x ] )
+			{
+				const std::uint32_t texel = srcRow[ s ];
+				for ( unsigned int c = 0; c < 3; ++c ) sum[ c ] += weight * toLinear[ ( texel >> ( 8 * c ) ) & 0xFFu ];
+				sum[ 3 ] += weight * ( texel >> 24 ) / 255.0f;
+			}
+		}
+	}
+
+	for ( unsigned int y = 0; y < dstHeight; ++y )
+	{
+		for ( unsigned int x = 0; x < dstWidth; ++x )
+		{
+			std::array<float, 4> sum = {};
+			for ( const auto& [ s, weight ] : rows[ y ] )
+			{
+				const std::array<float, 4>& texel = horizontal[ std::size_t( s ) * dstWidth + x ];
+				for ( unsigned int c = 0; c < 4; ++c ) sum[ c ] += weight * texel[ c ];
+			}
+
+			std::uint32_t result = 0;
+			for ( unsigned int c = 0; c < 3; ++c )
+			{
+				result |= std::uint32_t( toSRGB[ static_cast<std::size_t>( std::clamp( sum[ c ], 0.0f, 1.0f ) * 65535.0f + 0.5f ) ] ) << ( 8 * c );
+			}
+			result |= static_cast<std::uint32_t>( std::clamp( sum[ 3 ], 0.0f, 1.0f ) * 255.0f + 0.5f ) << 24;
+			dst[ std::size_t( y ) * dstWidth + x ] = result;
+		}
+	}
+}
+
+void TextureCooking::BuildMipChain( const std::uint32_t* texels, unsigned int width, unsigned int height, std::uint32_t* chain )
+{
+	const std::vector<MipLevel> levels = MipLevels( width, height );
+	std::memcpy( chain, texels, levels[ 0 ].size * sizeof( std::uint32_t ) );
+	for ( std::size_t level = 1; level < levels.size(); ++level )
+	{
+		const MipLevel& src = levels[ level - 1 ];
+		const MipLevel& dst = levels[ level ];
+		DownsampleSRGB( chain + src.offset, src.width, src.height, chain + dst.offset, dst.width, dst.height );
+	}
+}
+
+bool TextureCooking::IsOpaque( const std::uint32_t* texels, std::size_t count )
+{
+	return std::all_of( texels, texels + count, []( std::uint32_t texel ) { return ( texel >> 24 ) == 0xFFu; } );
+}
+
+std::size_t TextureCooking::BlockBytes( BlockFormat format )
+{
+	return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+std::size_t TextureCooking::CompressedSize( BlockFormat format, unsigned int width, unsigned int height )
+{
+	return std::size_t( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * BlockBytes( format );
+}
+
+void TextureCooking::Compress( BlockFormat format, const std::uint32_t* texels, unsigned int width, unsigned int height, std::byte* blocks )
+{
+	const std::size_t blockBytes = BlockBytes( format );
+	for ( unsigned int blockY = 0; blockY < ( height + 3 ) / 4; ++blockY )
+	{
+		for ( unsigned int blockX = 0; blockX < ( width + 3 ) / 4; ++blockX, blocks += blockBytes )
+		{
+			const Block block = LoadBlock( texels, width, height, blockX, blockY );
+			switch ( format )
+			{
+			case BlockFormat::BC1:
+				EncodeBC1Color( block, blocks );
+				break;
+			case BlockFormat::BC3:
+				EncodeBC3Alpha( block, blocks );
+				EncodeBC1Color( block, blocks + 8 );
+				break;
+			case BlockFormat::BC7:
+				EncodeBC7Mode6( block, blocks );
+				break;
+			}
+		}
+	}
+}
+
+std::string TextureCooking::SourceStamp( const std::filesystem::path& imageFile, bool flipped )
+{
+	constexpr std::uint64_t SOURCE_HASH_SEED = 0x5a48546578000001ULL;
+
+	MappedFile source;
+	if ( !source.Open( imageFile ) ) return {};
+
+	char stamp[ 64 ];
+	std::snprintf( stamp, sizeof( stamp ), "%zu %016" PRIx64 " %d", source.size(),
+				   fasthash64( source.data(), source.size(), SOURCE_HASH_SEED ), flipped ? 1 : 0 );
+	return stamp;
+}
+
+std::filesystem::path TextureCooking::CookedPath( const std::filesystem::path& imageFile )
+{
+	std::filesystem::path cooked = imageFile;
+	return cooked.replace_extension( ".ktx2" );
+}
+
+std::optional<TextureCooking::BlockFormat> TextureCooking::Cook( const std::filesystem::path& imageFile, const std::filesystem::path& ktx2File,
+																  const CookOptions& options )
+{
+	// ImageFromFile logged the error already
+	const ImageRGBA image = ImageFromFile( imageFile, options.flipped );
+	if ( image.texelData.empty() ) return std::nullopt;
+
+	const std::uint32_t* texels = reinterpret_cast<const std::uint32_t*>( image.data() );
+	const unsigned int width = options.width != 0 ? options.width : image.width;
+	const unsigned int height = options.height != 0 ? options.height : image.height;
+	std::vector<std::uint32_t> resized;
+	if ( width != image.width || height != image.height )
+	{
+		resized.resize( std::size_t( width ) * height );
+		ResizeSRGB( texels, image.width, image.height, resized.data(), width, height );
+		texels = resized.data();
+	}
+
+	const std::vector<MipLevel> mipLevels = MipLevels( width, height );
+	std::vector<std::uint32_t> chain( mipLevels.back().offset + mipLevels.back().size );
+	BuildMipChain( texels, width, height, chain.data() );
+
+	const BlockFormat blockFormat = options.format.value_or( IsOpaque( chain.data(), mipLevels[ 0 ].size ) ? BlockFormat::BC1 : BlockFormat::BC7 );
+
+	std::vector<std::vector<std::byte>> levels;
+	for ( const MipLevel& level : mipLevels )
+	{
+		levels.emplace_back( CompressedSize( blockFormat, level.width, level.height ) );
+		Compress( blockFormat, chain.data() + level.offset, level.width, level.height, levels.back().data() );
+	}
+
+	const std::string stamp = SourceStamp( imageFile, options.flipped );
+	if ( !KTX2::Write( ktx2File, KTX2::VkFormatOf( blockFormat, true ), width, height, levels,
+					   { { "KTXwriter", "ZH_AssetCook" }, { SOURCE_KEY, stamp } } ) )
+	{
+		return std::nullopt;
+	}
+	return blockFormat;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Offline texture processing shared by the asset cooker (tools/AssetCook.cpp) and TextureLoader:
+// mip chains of RGBA8 images and their block compression.
+//
+// The texels are sRGB encoded (like every PNG of Assets/), so BuildMipChain averages them in linear space and
+// encodes the result back: a plain average of the encoded values darkens the smaller levels.
+namespace TextureCooking
+{
+	struct MipLevel
+	{
+		std::size_t  offset; // in texels (RGBA8) or bytes (blocks) from the start of the chain
+		std::size_t  size;   // in the same unit
+		unsigned int width;
+		unsigned int height;
+	};
+
+	enum class BlockFormat
+	{
+		BC1, // RGB, 8 bytes / 4x4 block, no alpha
+		BC3, // RGBA, 16 bytes / block, BC1 color + interpolated alpha
+		BC7, // RGBA, 16 bytes / block, mode 6 only (one subset, 7 bit endpoints + p-bits, 4 bit indices)
+	};
+
+	// Levels from width x height down to 1x1, each dimension halved (rounded down, at least 1).
+	std::vector<MipLevel> MipLevels( unsigned int width, unsigned int height );
+
+	// 2x2 box filter in linear space (sRGB decoded, alpha as is); odd sizes repeat the last row / column.
+	void DownsampleSRGB( const std::uint32_t* src, unsigned int srcWidth, unsigned int srcHeight,
+						 std::uint32_t* dst, unsigned int dstWidth, unsigned int dstHeight );
+
+	// Resampling to any size in linear space with a tent filter: bilinear when enlarging, wide enough to cover every
+	// source texel when shrinking.
+	void ResizeSRGB( const std::uint32_t* src, unsigned int srcWidth, unsigned int srcHeight,
+					 std::uint32_t* dst, unsigned int dstWidth, unsigned int dstHeight );
+
+	// Every level of MipLevels( width, height ) into chain (level 0 copied from texels).
+	void BuildMipChain( const std::uint32_t* texels, unsigned int width, unsigned int height, std::uint32_t* chain );
+
+	// true if every alpha is 255: BC1 keeps all the information.
+	bool IsOpaque( const std::uint32_t* texels, std::size_t count );
+
+	std::size_t BlockBytes( BlockFormat format );
+	std::size_t CompressedSize( BlockFormat format, unsigned int width, unsigned int height );
+
+	// One level, texels row by row (RGBA8, R in the lowest byte), blocks row by row into blocks.
+	void Compress( BlockFormat format, const std::uint32_t* texels, unsigned int width, unsigned int height, std::byte* blocks );
+
+	// --- cooked files ---
+
+	// The KTX2 key/value entry naming the source of a cooked file: "<byte size> <fasthash64 in hex> <flipped 0/1>".
+	// A cooked file is stale if the stamp of its source image differs.
+	inline constexpr const char* SOURCE_KEY = "ZH.source";
+	// Empty if the file cannot be read.
+	std::string SourceStamp( const std::filesystem::path& imageFile, bool flipped );
+
+	// Assets/ocean.png -> Assets/ocean.ktx2
+	std::filesystem::path CookedPath( const std::filesystem::path& imageFile );
+
+	struct CookOptions
+	{
+		std::optional<BlockFormat> format; // nullopt: BC1 for opaque images, BC7 otherwise
+		bool         flipped = true;       // like ImageFromFile
+		unsigned int width = 0;            // resized to width x height (ResizeSRGB), 0: the size of the image
+		unsigned int height = 0;
+	};
+
+	// Loads imageFile like ImageFromFile( imageFile, options.flipped ), builds its mip chain, compresses every level
+	// and writes them into ktx2File as sRGB.
+	// Returns the format used; nullopt (logged) if the image cannot be loaded or the file cannot be written.
+	std::optional<BlockFormat> Cook( const std::filesystem::path& imageFile, const std::filesystem::path& ktx2File,
+									 const CookOptions& options = {} );
+}
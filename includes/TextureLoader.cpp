@@ -0,0 +1,388 @@
+#include "TextureLoader.h"
+
+#include "KTX2.h"
+#include "MappedFile.h"
+#include "TextureCooking.h"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+#include <SDL2/SDL_log.h>
+
+namespace
+{
+	double ElapsedMs( TextureLoader::Clock::time_point start, TextureLoader::Clock::time_point end )
+	{
+		return std::chrono::duration<double, std::milli>( end - start ).count();
+	}
+
+	// the block format of a compressed GL format TextureCooking can encode
+	std::optional<TextureCooking::BlockFormat> BlockFormatOf( GLenum internalFormat )
+	{
+		switch ( internalFormat )
+		{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return TextureCooking::BlockFormat::BC1;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return TextureCooking::BlockFormat::BC3;
+		case GL_COMPRESSED_RGBA_BPTC_UNORM: return TextureCooking::BlockFormat::BC7;
+		}
+		return std::nullopt;
+	}
+}
+
+TextureLoader::TextureLoader( unsigned int threadCount, StagingRing* staging )
+	: m_staging( staging )
+	// the ThreadPool counts the submitting thread too, but that one does not decode here
+	, m_pool( std::make_unique<ThreadPool>( std::max( threadCount, 1u ) + 1 ) )
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+	// joins the workers before the members they write go away
+	m_pool.reset();
+
+	for ( Decoded& decoded : m_decoded )
+	{
+		if ( m_staging != nullptr ) m_staging->Release( decoded.region );
+	}
+	for ( Streaming& streaming : m_streaming )
+	{
+		// an array belongs to the caller
+		if ( !streaming.handedOut && m_targets[ streaming.decoded.index ].array == nullptr ) glDeleteTextures( 1, &streaming.texture );
+		if ( m_staging != nullptr ) m_staging->Release( streaming.decoded.region );
+	}
+}
+
+void TextureLoader::Load( const std::filesystem::path& fileName, GLuint& textureID, bool needsFlip )
+{
+	textureID = 0;
+	Queue( fileName, { &textureID }, {}, needsFlip );
+}
+
+void TextureLoader::Load( const std::filesystem::path& fileName, TextureArray& array, GLsizei layer, bool needsFlip )
+{
+	// nothing of the layer is in yet
+	array.SetLayerLevel( layer, array.LevelCount() );
+	const LayerFormat layerFormat = { static_cast<unsigned int>( array.Width() ), static_cast<unsigned int>( array.Height() ), array.InternalFormat() };
+	Queue( fileName, { nullptr, &array, layer }, layerFormat, needsFlip );
+}
+
+void TextureLoader::Queue( const std::filesystem::path& fileName, const Target& target, const LayerFormat& layer, bool needsFlip )
+{
+	const std::size_t index = m_timings.size();
+	const Clock::time_point loadTime = Clock::now();
+
+	m_timings.push_back( Timing{ fileName } );
+	m_targets.push_back( target );
+	m_loadTimes.push_back( loadTime );
+	++m_pendingCount;
+	++m_decodingCount;
+
+	// the task gets its own copies, the per-asset vectors belong to the GL thread
+	m_pool->Submit( [ this, index, fileName, needsFlip, layer, loadTime, staging = m_staging ]()
+	{
+		const Clock::time_point start = Clock::now();
+		Decoded decoded = Decode( index, fileName, needsFlip, layer, staging );
+		const Clock::time_point end = Clock::now();
+		decoded.queuedMs = ElapsedMs( loadTime, start );
+		decoded.decodeMs = ElapsedMs( start, end );
+
+		{
+			std::lock_guard<std::mutex> lock( m_decodedMutex );
+			m_decoded.push_back( std::move( decoded ) );
+			--m_decodingCount;
+		}
+		m_decodedCondition.notify_one();
+	} );
+}
+
+TextureLoader::Decoded TextureLoader::Decode( std::size_t index, const std::filesystem::path& fileName, bool needsFlip, const LayerFormat& layer, StagingRing* staging )
+{
+	Decoded decoded = { index };
+	if ( DecodeCooked( decoded, fileName, needsFlip, layer, staging ) ) return decoded;
+
+	// ImageFromFile logged the error already, the texture stays 0
+	const ImageRGBA image = ImageFromFile( fileName, needsFlip );
+	if ( image.texelData.empty() ) return decoded;
+
+	// an array layer has its own size
+	const unsigned int width = layer.width != 0 ? layer.width : image.width;
+	const unsigned int height = layer.width != 0 ? layer.height : image.height;
+	const std::uint32_t* texels = reinterpret_cast<const std::uint32_t*>( image.data() );
+	std::vector<std::uint32_t> resized;
+	if ( width != image.width || height != image.height )
+	{
+		resized.resize( std::size_t( width ) * height );
+		TextureCooking::ResizeSRGB( texels, image.width, image.height, resized.data(), width, height );
+		texels = resized.data();
+	}
+
+	// The mapping is write only: the chain is filtered in client memory and copied (or compressed) into the ring.
+	const std::vector<TextureCooking::MipLevel> mipLevels = TextureCooking::MipLevels( width, height );
+	std::vector<std::uint32_t> chain( mipLevels.back().offset + mipLevels.back().size );
+	TextureCooking::BuildMipChain( texels, width, height, chain.data() );
+
+	// the chain: level 0 .. 1x1, packed
+	const std::optional<TextureCooking::BlockFormat> blockFormat = BlockFormatOf( layer.internalFormat );
+	if ( !blockFormat )
+	{
+		for ( const TextureCooking::MipLevel& level : mipLevels )
+		{
+			decoded.levels.push_back( { level.offset * sizeof( std::uint32_t ), level.size * sizeof( std::uint32_t ), level.width, level.height } );
+		}
+		const std::size_t byteSize = chain.size() * sizeof( std::uint32_t );
+		std::memcpy( AllocateChain( decoded, byteSize, staging ), chain.data(), byteSize );
+		return decoded;
+	}
+
+	// an array in a block format: compressed here, like ZH_AssetCook would have done
+	if ( *blockFormat == TextureCooking::BlockFormat::BC1 && !TextureCooking::IsOpaque( chain.data(), mipLevels[ 0 ].size ) )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN,
+						"[TextureLoader] %s has alpha, BC1 drops it", fileName.string().c_str() );
+	}
+	std::size_t byteSize = 0;
+	for ( const TextureCooking::MipLevel& level : mipLevels )
+	{
+		const std::size_t levelSize = TextureCooking::CompressedSize( *blockFormat, level.width, level.height );
+		decoded.levels.push_back( { byteSize, levelSize, level.width, level.height } );
+		byteSize += levelSize;
+	}
+	std::byte* blocks = AllocateChain( decoded, byteSize, staging );
+	for ( std::size_t level = 0; level < mipLevels.size(); ++level )
+	{
+		TextureCooking::Compress( *blockFormat, chain.data() + mipLevels[ level ].offset, mipLevels[ level ].width, mipLevels[ level ].height,
+								  blocks + decoded.levels[ level ].offset );
+	}
+	decoded.internalFormat = layer.internalFormat;
+	return decoded;
+}
+
+bool TextureLoader::DecodeCooked( Decoded& decoded, const std::filesystem::path& fileName, bool needsFlip, const LayerFormat& layer, StagingRing* staging )
+{
+	const std::filesystem::path cookedFileName = TextureCooking::CookedPath( fileName );
+	MappedFile cooked;
+	KTX2::Image image;
+	if ( !cooked.Open( cookedFileName ) ) return false;
+
+	GLenum internalFormat = GL_NONE;
+	if ( !KTX2::Parse( cooked.data(), cooked.size(), image ) || ( internalFormat = KTX2::GLFormat( image.vkFormat ) ) == GL_NONE )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN,
+						"[TextureLoader] %s is not a KTX2 file this driver can load, decoding %s", cookedFileName.string().c_str(), fileName.string().c_str() );
+		return false;
+	}
+
+	// without the image (only the cooked files shipped) there is nothing to be stale against
+	const std::string stamp = TextureCooking::SourceStamp( fileName, needsFlip );
+	if ( !stamp.empty() && KTX2::FindValue( image, TextureCooking::SOURCE_KEY ) != stamp )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+						"[TextureLoader] %s was not cooked from the current %s, decoding the image", cookedFileName.string().c_str(), fileName.string().c_str() );
+		return false;
+	}
+
+	// the layer of an array takes the cooked levels only as they are: every level, in the size and format of the array
+	if ( layer.width != 0 && ( image.width != layer.width || image.height != layer.height || internalFormat != layer.internalFormat
+							   || image.levels.size() != TextureCooking::MipLevels( layer.width, layer.height ).size() ) )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+						"[TextureLoader] %s is %ux%u (format 0x%04x), the texture array %ux%u (format 0x%04x): decoding %s",
+						cookedFileName.string().c_str(), image.width, image.height, internalFormat, layer.width, layer.height,
+						layer.internalFormat, fileName.string().c_str() );
+		return false;
+	}
+
+	std::size_t byteSize = 0;
+	for ( const KTX2::Level& level : image.levels )
+	{
+		decoded.levels.push_back( { byteSize, level.size, level.width, level.height } );
+		byteSize += level.size;
+	}
+
+	// level 0 first, like the decoded chains (the file stores the smallest first)
+	std::byte* chain = AllocateChain( decoded, byteSize, staging );
+	for ( std::size_t level = 0; level < image.levels.size(); ++level )
+	{
+		std::memcpy( chain + decoded.levels[ level ].offset, image.levels[ level ].data, image.levels[ level ].size );
+	}
+	decoded.internalFormat = internalFormat;
+	decoded.cooked = true;
+	return true;
+}
+
+std::byte* TextureLoader::AllocateChain( Decoded& decoded, std::size_t byteSize, StagingRing* staging )
+{
+	if ( staging != nullptr ) decoded.region = staging->TryAllocate( static_cast<GLsizeiptr>( byteSize ) );
+	if ( decoded.region ) return decoded.region.data;
+
+	decoded.bytes.resize( byteSize );
+	return decoded.bytes.data();
+}
+
+std::size_t TextureLoader::UploadReady( std::size_t byteBudget )
+{
+	if ( m_staging != nullptr ) m_staging->Retire();
+
+	{
+		std::lock_guard<std::mutex> lock( m_decodedMutex );
+		for ( Decoded& decoded : m_decoded ) m_streaming.push_back( { std::move( decoded ) } );
+		m_decoded.clear();
+	}
+
+	const std::size_t fullBudget = byteBudget;
+	auto streaming = m_streaming.begin();
+	while ( streaming != m_streaming.end() && byteBudget > 0 )
+	{
+		if ( Upload( *streaming, byteBudget ) )
+		{
+			if ( m_staging != nullptr ) m_staging->Release( streaming->decoded.region );
+			streaming = m_streaming.erase( streaming );
+			--m_pendingCount;
+		}
+		else ++streaming;
+	}
+	glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+
+	return fullBudget - byteBudget;
+}
+
+bool TextureLoader::Upload( Streaming& streaming, std::size_t& byteBudget )
+{
+	const Decoded& decoded = streaming.decoded;
+	const Target& target = m_targets[ decoded.index ];
+	Timing& timing = m_timings[ decoded.index ];
+	const Clock::time_point start = Clock::now();
+
+	if ( decoded.levels.empty() )
+	{
+		// the layer stays black, it must not hold back the base level of the others
+		if ( target.array != nullptr ) target.array->SetLayerLevel( target.layer, 0 );
+		timing.queuedMs = decoded.queuedMs;
+		timing.decodeMs = decoded.decodeMs;
+		timing.readyMs = ElapsedMs( m_loadTimes[ decoded.index ], start );
+		return true;
+	}
+
+	if ( streaming.texture == 0 )
+	{
+		const Level& level0 = decoded.levels.front();
+		const GLsizei levelCount = static_cast<GLsizei>( decoded.levels.size() );
+		if ( target.array != nullptr )
+		{
+			// the storage is there, Decode made the levels match it
+			streaming.texture = target.array->ID();
+		}
+		else
+		{
+			glCreateTextures( GL_TEXTURE_2D, 1, &streaming.texture );
+			glTextureStorage2D( streaming.texture, levelCount, decoded.internalFormat, level0.width, level0.height );
+			glTextureParameteri( streaming.texture, GL_TEXTURE_BASE_LEVEL, levelCount - 1 );
+		}
+		streaming.level = levelCount - 1;
+		streaming.row = 0;
+
+		timing.width = level0.width;
+		timing.height = level0.height;
+		for ( const Level& level : decoded.levels ) timing.byteSize += level.size;
+		timing.cooked = decoded.cooked;
+		timing.staged = static_cast<bool>( decoded.region );
+		timing.queuedMs = decoded.queuedMs;
+		timing.decodeMs = decoded.decodeMs;
+	}
+
+	// from the ring: offsets into the bound unpack buffer instead of pointers
+	glBindBuffer( GL_PIXEL_UNPACK_BUFFER, decoded.region ? m_staging->Buffer() : 0 );
+	const std::byte* base = decoded.region ? reinterpret_cast<const std::byte*>( decoded.region.offset ) : decoded.bytes.data();
+	// block compressed levels are uploaded in whole rows of 4x4 blocks
+	const bool compressed = decoded.internalFormat != GL_RGBA8;
+	const GLsizei rowHeight = compressed ? 4 : 1;
+
+	while ( streaming.level >= 0 && byteBudget > 0 )
+	{
+		const Level& level = decoded.levels[ streaming.level ];
+		const GLsizei rowCount = ( static_cast<GLsizei>( level.height ) + rowHeight - 1 ) / rowHeight;
+		const std::size_t rowBytes = level.size / rowCount;
+		const GLsizei firstRow = streaming.row / rowHeight;
+		// at least one row, even if the budget is smaller
+		const GLsizei rows = static_cast<GLsizei>( std::clamp<std::size_t>( byteBudget / rowBytes, 1, rowCount - firstRow ) );
+		const GLsizei height = std::min( rows * rowHeight, static_cast<GLsizei>( level.height ) - streaming.row );
+
+		const std::byte* source = base + level.offset + firstRow * rowBytes;
+		const GLsizei sourceSize = static_cast<GLsizei>( rows * rowBytes );
+		if ( target.array != nullptr && compressed )
+		{
+			glCompressedTextureSubImage3D( streaming.texture, streaming.level, 0, streaming.row, target.layer, level.width, height, 1,
+										   decoded.internalFormat, sourceSize, source );
+		}
+		else if ( target.array != nullptr )
+		{
+			glTextureSubImage3D( streaming.texture, streaming.level, 0, streaming.row, target.layer, level.width, height, 1,
+								 GL_RGBA, GL_UNSIGNED_BYTE, source );
+		}
+		else if ( compressed )
+		{
+			glCompressedTextureSubImage2D( streaming.texture, streaming.level, 0, streaming.row, level.width, height, decoded.internalFormat,
+										   sourceSize, source );
+		}
+		else glTextureSubImage2D( streaming.texture, streaming.level, 0, streaming.row, level.width, height, GL_RGBA, GL_UNSIGNED_BYTE, source );
+
+		byteBudget -= std::min( byteBudget, rows * rowBytes );
+		streaming.row += height;
+		if ( streaming.row < static_cast<GLsizei>( level.height ) ) continue;
+
+		// the level is complete: sample it from now on
+		if ( target.array != nullptr ) target.array->SetLayerLevel( target.layer, streaming.level );
+		else glTextureParameteri( streaming.texture, GL_TEXTURE_BASE_LEVEL, streaming.level );
+		if ( !streaming.handedOut )
+		{
+			if ( target.textureID != nullptr ) *target.textureID = streaming.texture;
+			streaming.handedOut = true;
+			timing.visibleMs = ElapsedMs( m_loadTimes[ decoded.index ], Clock::now() );
+		}
+		--streaming.level;
+		streaming.row = 0;
+	}
+
+	const Clock::time_point end = Clock::now();
+	timing.uploadMs += ElapsedMs( start, end );
+	++timing.uploadCalls;
+
+	if ( streaming.level >= 0 ) return false;
+	timing.readyMs = ElapsedMs( m_loadTimes[ decoded.index ], end );
+	return true;
+}
+
+void TextureLoader::UploadAll()
+{
+	UploadReady();
+	while ( m_pendingCount > 0 )
+	{
+		const Clock::time_point waitStart = Clock::now();
+		std::size_t waitedFor = 0;
+		{
+			std::unique_lock<std::mutex> lock( m_decodedMutex );
+			m_decodedCondition.wait( lock, [ this ]() { return !m_decoded.empty(); } );
+			waitedFor = m_decoded.front().index;
+		}
+		// the wait is charged to the image that ended it
+		m_timings[ waitedFor ].waitMs += ElapsedMs( waitStart, Clock::now() );
+
+		UploadReady();
+	}
+}
+
+void TextureLoader::LogTimings() const
+{
+	for ( const Timing& timing : m_timings )
+	{
+		SDL_LogMessage( SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO,
+						"[TextureLoader] %s %ux%u (%s, %.1f KiB): queued %.1f ms, decode %.1f ms, GL thread waited %.1f ms, "
+						"upload %.1f ms in %u calls (%s), visible after %.1f ms, complete after %.1f ms",
+						timing.fileName.string().c_str(), timing.width, timing.height,
+						timing.cooked ? "cooked KTX2" : "decoded", timing.byteSize / 1024.0,
+						timing.queuedMs, timing.decodeMs, timing.waitMs, timing.uploadMs, timing.uploadCalls,
+						timing.staged ? "staging ring" : "client memory", timing.visibleMs, timing.readyMs );
+	}
+}
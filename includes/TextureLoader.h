@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "GLUtils.hpp"
+#include "StagingRing.h"
+#include "TextureArray.h"
+#include "ThreadPool.h"
+
+// Decodes image files on worker threads and streams them into textures on the GL thread.
+//
+// Load queues the decode (file read, PNG decode, RGBA conversion, flip: ImageFromFile) and returns at once, so the
+// GL thread can compile shaders and load meshes meanwhile. The worker also builds the mip chain (2x2 box filter in
+// linear space, TextureCooking::BuildMipChain) and, with a StagingRing, writes the levels into its mapped memory;
+// without one, or when the ring is full, they stay in client memory.
+// If the cooked version of the image (TextureCooking::CookedPath, written by ZH_AssetCook) is there and was cooked
+// from the same file, the worker only copies its block compressed levels instead, and they are uploaded with
+// glCompressedTextureSubImage2D. A stale or unreadable cooked file, or a block format the driver lacks, falls back
+// to the image.
+//
+// UploadReady / UploadAll are the only calls touching GL. A texture is created with immutable storage for every
+// level and filled from the coarsest level towards level 0, at most byteBudget bytes per UploadReady call (large
+// levels are split into row ranges), so a frame calling it never uploads a whole large texture at once.
+// GL_TEXTURE_BASE_LEVEL follows the finest complete level: the texture is written to the GLuint given to Load as
+// soon as its coarsest level is in, and sharpens over the next calls. The GLuint stays 0 until then, and if the
+// image could not be loaded.
+// An image can go into a layer of a TextureArray instead: the worker resizes it to the layer size (in linear space)
+// and compresses the levels to the format of the array if it is a block format, unless the cooked file already has
+// that size and format (ZH_AssetCook --size). The array's base level follows its layers (TextureArray::SetLayerLevel).
+class TextureLoader
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr std::size_t UNLIMITED = std::numeric_limits<std::size_t>::max();
+
+	// Per asset, milliseconds.
+	struct Timing
+	{
+		std::filesystem::path fileName;
+		unsigned int width = 0;
+		unsigned int height = 0;
+		std::size_t byteSize = 0; // of every level on the GPU
+		bool   cooked = false;    // from the KTX2 file (not decoded from the image)
+		bool   staged = false;    // uploaded from the StagingRing (not from client memory)
+		double queuedMs = 0.0;    // from Load until a worker picked it up
+		double decodeMs = 0.0;    // ImageFromFile and the mip chain (or the KTX2 read) on the worker
+		double waitMs = 0.0;      // the GL thread blocked in UploadAll for this image
+		double uploadMs = 0.0;    // upload calls on the GL thread, summed over the calls
+		unsigned int uploadCalls = 0;
+		double visibleMs = 0.0;   // from Load until the coarsest level was in (the texture was handed out)
+		double readyMs = 0.0;     // from Load until level 0 was in
+	};
+
+	// threadCount decode threads (at least one, so decoding always runs beside the GL thread).
+	// staging (optional) has to outlive the loader.
+	explicit TextureLoader( unsigned int threadCount = ThreadPool::HardwareThreadCount(), StagingRing* staging = nullptr );
+	// GL thread. Waits for the decodes still running; the textures not handed out yet are deleted.
+	~TextureLoader();
+
+	TextureLoader( const TextureLoader& ) = delete;
+	TextureLoader& operator=( const TextureLoader& ) = delete;
+
+	// textureID has to stay valid until the texture is complete (or the loader is destroyed).
+	void Load( const std::filesystem::path& fileName, GLuint& textureID, bool needsFlip = true );
+	// Into layer of array (initialized, it has to outlive the loading). A layer that cannot be loaded stays black.
+	void Load( const std::filesystem::path& fileName, TextureArray& array, GLsizei layer, bool needsFlip = true );
+
+	// GL thread, never waits. Uploads at most byteBudget bytes of the decoded images, returns the number of bytes.
+	std::size_t UploadReady( std::size_t byteBudget = UNLIMITED );
+	// GL thread. Uploads every image completely, waiting for the decodes still running.
+	void UploadAll();
+
+	// Loaded, but level 0 not uploaded yet.
+	inline std::size_t PendingCount() const noexcept { return m_pendingCount; }
+	// Still on the worker threads.
+	inline std::size_t DecodingCount() const noexcept { return m_decodingCount; }
+	// In Load order.
+	inline const std::vector<Timing>& Timings() const noexcept { return m_timings; }
+
+	// One line per asset through SDL_LogMessage.
+	void LogTimings() const;
+
+private:
+	struct Level
+	{
+		std::size_t  offset; // in bytes from the start of the chain
+		std::size_t  size;   // in bytes
+		unsigned int width;
+		unsigned int height;
+	};
+
+	struct Decoded
+	{
+		std::size_t            index; // into m_timings / m_targets
+		std::vector<Level>     levels; // empty if the image could not be loaded
+		GLenum                 internalFormat = GL_RGBA8; // or a block compressed one from the KTX2 file
+		bool                   cooked = false;
+		StagingRing::Region    region; // the chain in the ring ...
+		std::vector<std::byte> bytes;  // ... or in client memory
+		double                 queuedMs = 0.0;
+		double                 decodeMs = 0.0;
+	};
+
+	// where an image goes: *textureID, or a layer of array
+	struct Target
+	{
+		GLuint*       textureID = nullptr;
+		TextureArray* array = nullptr;
+		GLsizei       layer = 0;
+	};
+
+	// what Decode has to produce for an array layer; width 0: an own texture, the image as it is
+	struct LayerFormat
+	{
+		unsigned int width = 0;
+		unsigned int height = 0;
+		GLenum       internalFormat = GL_RGBA8;
+	};
+
+	struct Streaming
+	{
+		Decoded decoded;
+		GLuint  texture = 0;
+		int     level = -1; // the next level to upload, from the coarsest one down to 0
+		GLsizei row = 0;    // the next row of that level
+		bool    handedOut = false;
+	};
+
+	void Queue( const std::filesystem::path& fileName, const Target& target, const LayerFormat& layer, bool needsFlip );
+	static Decoded Decode( std::size_t index, const std::filesystem::path& fileName, bool needsFlip, const LayerFormat& layer, StagingRing* staging );
+	// false if there is no current cooked file of fileName with a block format the driver supports (and the size and
+	// format of the layer)
+	static bool DecodeCooked( Decoded& decoded, const std::filesystem::path& fileName, bool needsFlip, const LayerFormat& layer, StagingRing* staging );
+	// The chain of byteSize bytes: allocated in the ring if there is room, in decoded.bytes otherwise.
+	static std::byte* AllocateChain( Decoded& decoded, std::size_t byteSize, StagingRing* staging );
+	// true once level 0 is complete
+	bool Upload( Streaming& streaming, std::size_t& byteBudget );
+
+	std::vector<Timing>            m_timings;
+	std::vector<Target>            m_targets;
+	std::vector<Clock::time_point> m_loadTimes;
+	std::vector<Streaming>         m_streaming; // decoded, being uploaded, oldest first
+	std::size_t                    m_pendingCount = 0;
+	std::atomic<std::size_t>       m_decodingCount = 0;
+	StagingRing*                   m_staging = nullptr;
+
+	// the only state the workers write
+	std::mutex              m_decodedMutex;
+	std::condition_variable m_decodedCondition;
+	std::vector<Decoded>    m_decoded;
+
+	std::unique_ptr<ThreadPool> m_pool;
+};
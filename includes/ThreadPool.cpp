@@ -0,0 +1,109 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool( unsigned int threadCount )
+{
+	threadCount = std::max( threadCount, 1u );
+
+	m_workers.reserve( threadCount - 1 );
+	for ( unsigned int i = 1; i < threadCount; ++i )
+	{
+		m_workers.emplace_back( &ThreadPool::WorkerLoop, this );
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_quit = true;
+	}
+	m_wakeUp.notify_all();
+
+	for ( std::thread& worker : m_workers )
+	{
+		worker.join();
+	}
+}
+
+unsigned int ThreadPool::HardwareThreadCount() noexcept
+{
+	return std::max( std::thread::hardware_concurrency(), 1u );
+}
+
+void ThreadPool::WorkerLoop()
+{
+	for ( ;; )
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock( m_mutex );
+			m_wakeUp.wait( lock, [ this ]() { return m_quit || !m_tasks.empty(); } );
+
+			if ( m_tasks.empty() ) return; // m_quit
+
+			task = std::move( m_tasks.front() );
+			m_tasks.pop();
+		}
+		task();
+	}
+}
+
+void ThreadPool::Submit( std::function<void()> task )
+{
+	if ( m_workers.empty() )
+	{
+		task();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_tasks.push( std::move( task ) );
+	}
+	m_wakeUp.notify_one();
+}
+
+void ThreadPool::ParallelFor( std::size_t count, const std::function<void( std::size_t )>& func )
+{
+	if ( count == 0 ) return;
+
+	// Every participating thread grabs the next index until all of them are taken.
+	std::atomic<std::size_t> nextIndex = 0;
+	auto work = [ &nextIndex, count, &func ]()
+	{
+		for ( std::size_t i = nextIndex++; i < count; i = nextIndex++ )
+		{
+			func( i );
+		}
+	};
+
+	const std::size_t helperCount = std::min<std::size_t>( m_workers.size(), count - 1 );
+
+	std::mutex doneMutex;
+	std::condition_variable doneCondition;
+	std::size_t helpersRunning = helperCount;
+
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		for ( std::size_t i = 0; i < helperCount; ++i )
+		{
+			m_tasks.push( [ &work, &doneMutex, &doneCondition, &helpersRunning ]()
+			{
+				work();
+
+				std::lock_guard<std::mutex> doneLock( doneMutex );
+				if ( --helpersRunning == 0 ) doneCondition.notify_one();
+			} );
+		}
+	}
+	m_wakeUp.notify_all();
+
+	work();
+
+	// The helper tasks reference this stack frame, so wait for all of them, even for those that found no work.
+	std::unique_lock<std::mutex> doneLock( doneMutex );
+	doneCondition.wait( doneLock, [ &helpersRunning ]() { return helpersRunning == 0; } );
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed size pool of worker threads.
+class ThreadPool
+{
+public:
+	// threadCount is the total parallelism: the thread calling ParallelFor works too,
+	// so threadCount - 1 worker threads are started.
+	explicit ThreadPool( unsigned int threadCount );
+	~ThreadPool();
+
+	ThreadPool( const ThreadPool& ) = delete;
+	ThreadPool& operator=( const ThreadPool& ) = delete;
+
+	inline unsigned int ThreadCount() const noexcept { return static_cast<unsigned int>( m_workers.size() ) + 1; }
+
+	// Calls func( i ) for every i in [0, count) and returns when all calls finished.
+	// func must not throw.
+	void ParallelFor( std::size_t count, const std::function<void( std::size_t )>& func );
+
+	// Queues task for a worker thread and returns immediately; without worker threads it runs on the calling thread.
+	// The destructor finishes the queued tasks before it joins. task must not throw.
+	void Submit( std::function<void()> task );
+
+	static unsigned int HardwareThreadCount() noexcept;
+
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+	std::queue<std::function<void()>> m_tasks;
+	bool m_quit = false;
+};
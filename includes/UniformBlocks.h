@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// CPU side of the std140 uniform blocks of Vert_PosNormTex.vert and Frag_ZH.frag.
+// The member order and the padding have to match the GLSL declarations exactly.
+
+// FrameUniforms::elapsedTimeInSec wraps around after this many seconds, so it keeps its precision in sessions that run
+// for weeks. Every time dependent pattern of the shaders has to repeat with this period: the ocean surface scrolls by
+// t / 150 with GL_MIRRORED_REPEAT (period 2 in texture space), i.e. every 300 s.
+constexpr double SHADER_TIME_PERIOD_IN_SEC = 300.0;
+
+// layout( std140, binding = FRAME_UNIFORM_BINDING ) uniform FrameData, uploaded once per frame
+struct FrameUniforms
+{
+	glm::mat4 viewProj;
+	glm::vec3 cameraPos;
+	float     elapsedTimeInSec;
+	glm::vec4 lightPos;
+	glm::vec4 lightPos2;
+	glm::vec3 La;
+	float     lightConstantAttenuation;
+	glm::vec3 Ld;
+	float     lightLinearAttenuation;
+	glm::vec3 Ls;
+	float     lightQuadraticAttenuation;
+	int32_t   enableRedLight; // GLSL bool
+	int32_t   padding[ 3 ];
+};
+
+// Where a draw samples the material TextureArray: texcoord * uvTransform.xy + uvTransform.zw, in layer.
+// Part of both the per-draw uniform block and the indirect draw records.
+struct MaterialUniforms
+{
+	glm::vec4 uvTransform = glm::vec4( 1.0f, 1.0f, 0.0f, 0.0f );
+	int32_t   layer = 0;
+	int32_t   padding[ 3 ] = {};
+};
+
+// layout( std140, binding = OBJECT_UNIFORM_BINDING ) uniform ObjectData, one slot per draw
+struct ObjectUniforms
+{
+	glm::mat4 world;
+	glm::mat4 worldIT;
+	glm::mat4 dequant;
+	MaterialUniforms material;
+};
+
+constexpr GLuint FRAME_UNIFORM_BINDING  = 0;
+constexpr GLuint OBJECT_UNIFORM_BINDING = 1;
+
+// layout( std430, binding = INSTANCE_STORAGE_BINDING ) readonly buffer InstanceData of Vert_Instanced.vert:
+// one world matrix (glm::mat4) per instance, indexed by gl_InstanceID
+constexpr GLuint INSTANCE_STORAGE_BINDING = 0;
+
+// layout( std430, binding = DRAW_DATA_STORAGE_BINDING ) readonly buffer DrawDataBuffer of Vert_Indirect.vert:
+// one record per indirect draw instance, addressed by the draw index attribute (see MeshBuffer.h)
+struct DrawData
+{
+	glm::mat4 world;
+	glm::mat4 dequant;
+	MaterialUniforms material;
+};
+
+constexpr GLuint DRAW_DATA_STORAGE_BINDING = 1;
+
+// Culling input of the records of DrawDataBuffer (Comp_Cull.comp), same indexing as DrawData.
+struct CullRecord
+{
+	glm::vec4 boundingSphere; // model space center and radius of the mesh
+	GLuint    command;        // the indirect command the record is drawn by
+	GLuint    padding[ 3 ];
+};
+
+// Storage buffer bindings of the culling pass (see GPUCulling.h)
+constexpr GLuint CULL_RECORD_STORAGE_BINDING    = 2;
+constexpr GLuint DRAW_COMMAND_STORAGE_BINDING   = 3;
+constexpr GLuint VISIBLE_RECORD_STORAGE_BINDING = 4; // also read by Vert_Indirect.vert
+constexpr GLuint CULL_STATS_STORAGE_BINDING     = 5;
+
+// layout( std430, binding = MATERIAL_STORAGE_BINDING ) readonly buffer MaterialTextures of Frag_ZH.frag (BINDLESS):
+// one GLuint64 texture handle (GLSL uvec2) per material, indexed by MaterialUniforms::layer (see BindlessMaterials.h)
+constexpr GLuint MATERIAL_STORAGE_BINDING = 6;
+
+static_assert( offsetof( FrameUniforms, cameraPos ) == 64 );
+static_assert( offsetof( FrameUniforms, elapsedTimeInSec ) == 76 );
+static_assert( offsetof( FrameUniforms, lightPos ) == 80 );
+static_assert( offsetof( FrameUniforms, La ) == 112 );
+static_assert( offsetof( FrameUniforms, lightConstantAttenuation ) == 124 );
+static_assert( offsetof( FrameUniforms, Ls ) == 144 );
+static_assert( offsetof( FrameUniforms, enableRedLight ) == 160 );
+static_assert( sizeof( FrameUniforms ) == 176 );
+static_assert( sizeof( MaterialUniforms ) == 32 );
+static_assert( sizeof( ObjectUniforms ) == 224 );
+static_assert( sizeof( DrawData ) == 160 );
+static_assert( sizeof( CullRecord ) == 32 );
+
+// Offset of a per-draw slot in a buffer of ObjectUniforms, glBindBufferRange needs the offsets aligned.
+inline GLsizeiptr UniformSlotStride( GLsizeiptr blockSize )
+{
+	GLint alignment = 256;
+	glGetIntegerv( GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment );
+	return ( blockSize + alignment - 1 ) / alignment * alignment;
+}
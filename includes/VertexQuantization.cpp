@@ -0,0 +1,91 @@
+#include "VertexQuantization.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/packing.hpp>
+#include <glm/gtx/transform.hpp>
+
+QuantizedMesh QuantizeMesh( const MeshView<Vertex>& mesh )
+{
+	QuantizedMesh result;
+	if ( mesh.vertexCount == 0 ) return result;
+
+	glm::vec3 aabbMin( mesh.vertexData[ 0 ].position );
+	glm::vec3 aabbMax( mesh.vertexData[ 0 ].position );
+	for ( std::size_t i = 1; i < mesh.vertexCount; ++i )
+	{
+		aabbMin = glm::min( aabbMin, mesh.vertexData[ i ].position );
+		aabbMax = glm::max( aabbMax, mesh.vertexData[ i ].position );
+	}
+
+	// a flat mesh still needs an invertible matrix
+	glm::vec3 aabbSize = aabbMax - aabbMin;
+	for ( int c = 0; c < 3; ++c )
+	{
+		if ( aabbSize[ c ] <= 0.0f ) aabbSize[ c ] = 1.0f;
+	}
+
+	result.dequantization = glm::translate( aabbMin ) * glm::scale( aabbSize );
+
+	result.mesh.vertexArray.resize( mesh.vertexCount );
+	for ( std::size_t i = 0; i < mesh.vertexCount; ++i )
+	{
+		const Vertex& in = mesh.vertexData[ i ];
+		VertexQuantized& out = result.mesh.vertexArray[ i ];
+
+		const glm::vec3 unitPosition = ( in.position - aabbMin ) / aabbSize;
+		for ( int c = 0; c < 3; ++c )
+		{
+			out.position[ c ] = static_cast<uint16_t>( std::lround( glm::clamp( unitPosition[ c ], 0.0f, 1.0f ) * 65535.0f ) );
+		}
+		out.position[ 3 ] = 0;
+
+		const float normalLength = glm::length( in.normal );
+		const glm::vec3 normal = normalLength > 0.0f ? in.normal / normalLength : glm::vec3( 0.0f );
+		out.normal = glm::packSnorm3x10_1x2( glm::vec4( normal, 0.0f ) );
+
+		out.texcoord[ 0 ] = glm::packHalf1x16( in.texcoord.x );
+		out.texcoord[ 1 ] = glm::packHalf1x16( in.texcoord.y );
+	}
+
+	result.mesh.indexArray.assign( mesh.indexData, mesh.indexData + mesh.indexCount );
+
+	return result;
+}
+
+Vertex DequantizeVertex( const VertexQuantized& vertex, const glm::mat4& dequantization )
+{
+	Vertex result;
+
+	const glm::vec3 unitPosition( vertex.position[ 0 ] / 65535.0f, vertex.position[ 1 ] / 65535.0f, vertex.position[ 2 ] / 65535.0f );
+	result.position = glm::vec3( dequantization * glm::vec4( unitPosition, 1.0f ) );
+
+	// GL 4.2+ snorm conversion: max( c / 511, -1 )
+	auto snorm10 = [ &vertex ]( int shift )
+	{
+		const int bits = static_cast<int>( ( vertex.normal >> shift ) & 0x3FFu );
+		const int value = ( bits & 0x200 ) ? bits - 0x400 : bits;
+		return std::max( value / 511.0f, -1.0f );
+	};
+	result.normal = glm::vec3( snorm10( 0 ), snorm10( 10 ), snorm10( 20 ) );
+
+	result.texcoord = glm::vec2( glm::unpackHalf1x16( vertex.texcoord[ 0 ] ), glm::unpackHalf1x16( vertex.texcoord[ 1 ] ) );
+
+	return result;
+}
+
+OGLObject CreateQuantizedGLObjectFromMesh( const MeshView<Vertex>& mesh )
+{
+	const QuantizedMesh quantized = QuantizeMesh( mesh );
+
+	OGLObject meshGPU = CreateGLObjectFromMesh( quantized.mesh,
+	{
+		{ 0, offsetof( VertexQuantized, position ), 3, GL_UNSIGNED_SHORT, GL_TRUE },
+		{ 1, offsetof( VertexQuantized, normal ), 4, GL_INT_2_10_10_10_REV, GL_TRUE },
+		{ 2, offsetof( VertexQuantized, texcoord ), 2, GL_HALF_FLOAT },
+	} );
+	meshGPU.dequantization = quantized.dequantization;
+
+	return meshGPU;
+}
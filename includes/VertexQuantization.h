@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+#include "GLUtils.hpp"
+
+// Compact, 16 byte version of Vertex for bandwidth bound scenes.
+//   position: 3 x unorm16 relative to the AABB of the mesh (+ padding), decoded by the dequantization matrix
+//   normal:   snorm 10_10_10_2 (GL_INT_2_10_10_10_REV)
+//   texcoord: 2 x half float
+struct VertexQuantized
+{
+	uint16_t position[ 4 ];
+	uint32_t normal;
+	uint16_t texcoord[ 2 ];
+};
+
+static_assert( sizeof( VertexQuantized ) == 16 );
+
+struct QuantizedMesh
+{
+	MeshObject<VertexQuantized> mesh;
+	// maps the normalized [0,1] positions back to model space (AABB min + unorm * AABB size)
+	glm::mat4 dequantization = glm::mat4( 1.0f );
+};
+
+[[nodiscard]] QuantizedMesh QuantizeMesh( const MeshView<Vertex>& mesh );
+
+// Decodes one vertex like the vertex shader gets it, for error measurements.
+[[nodiscard]] Vertex DequantizeVertex( const VertexQuantized& vertex, const glm::mat4& dequantization );
+
+// Quantizes the mesh and uploads it with the matching attribute formats (locations 0, 1, 2 like Vertex),
+// the returned object carries the dequantization matrix for the vertex shader.
+[[nodiscard]] OGLObject CreateQuantizedGLObjectFromMesh( const MeshView<Vertex>& mesh );
@@ -11,13 +11,45 @@
 #include "imgui/backends/imgui_impl_opengl3.h"
 
 // standard
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include "MyApp.h"
+#include "Headless.h"
+#include "FrameTiming.h"
+#include "InputRecording.h"
+#include "SpscQueue.h"
 
 int main( int argc, char* args[] )
 {
+	// ablak nélküli futás (--headless): képkockaidők mérése, ablak, vsync és ImGui nélkül
+	if ( IsHeadlessRun( argc, args ) )
+		return RunHeadless( argc, args );
+
+	// --record <fájl>: az alkalmazásnak továbbított események és a képkockák időlépései kerülnek a fájlba,
+	// a --replay <fájl> ugyanezeket a képkockákat rajzolja újra ablak nélkül (Headless.h)
+	const char* recordFileName = nullptr;
+	// --frames-in-flight <N>: ennyi kész csomaggal járhat a szimuláció a rajzolás előtt (1-8, alapból 2)
+	// --no-render-thread: a szimuláció és a rajzolás egy szálon, egymás után (az összevetéshez)
+	int framesInFlight = 2;
+	bool renderThread = true;
+	for ( int i = 1; i < argc; ++i )
+	{
+		if ( std::strcmp( args[i], "--record" ) == 0 && i + 1 < argc )
+			recordFileName = args[i + 1];
+		else if ( std::strcmp( args[i], "--frames-in-flight" ) == 0 && i + 1 < argc )
+			framesInFlight = std::min( std::max( std::atoi( args[i + 1] ), 1 ), 8 );
+		else if ( std::strcmp( args[i], "--no-render-thread" ) == 0 )
+			renderThread = false;
+	}
+	InputRecording recording;
+
 	//
 	// 1. lépés: inicializáljuk az SDL-t
 	//
@@ -159,6 +191,88 @@ int main( int argc, char* args[] )
 		// ImGui ablak megjelenítése
 		bool ShowImGui = true;
 
+		// A szimuláció rögzített lépésekben halad, a rajzolás a két utolsó lépés állapota közé interpolál,
+		// így a mozgás a képfrissítési frekvenciától független és mégis folyamatos.
+		FixedTimestep timestep( CMyApp::SIMULATION_STEP_IN_SEC );
+		// nagy felbontású óra: a különbségek egészben, a másodpercek double-ben (SDL_GetTicks csak ms pontos)
+		const Uint64 counterFrequency = SDL_GetPerformanceFrequency();
+		Uint64 lastCounter = SDL_GetPerformanceCounter();
+
+		// Két szál: ez (a fő szál) birtokolja a GL contextet és az ablakot, itt fut az eseménykezelés, a Render,
+		// az ImGui és a SwapWindow; a szimulációs szál lépteti az alkalmazást, és képkockánként egy SFramePacket-et
+		// tölt ki. A csomagok egy SPSC sorban jutnak át (framesInFlight hely), így a szimuláció a következő
+		// képkockán dolgozik, amíg ez az előzőt rajzolja és a vsync-re vár.
+		// Az ImGui is itt marad: a draw data a font atlasz textúrájára hivatkozik, amit az ImGui_ImplOpenGL3 frissít.
+		SpscQueue<SFramePacket> packets( framesInFlight );
+
+		// az alkalmazásnak szánt események: az eseménykezelés gyűjti, a szimuláció veszi át képkockánként
+		std::mutex forwardedEventsMutex;
+		std::vector<SDL_Event> forwardedEvents;
+		auto forward = [&]( const SDL_Event& forwardedEvent )
+		{
+			std::lock_guard<std::mutex> lock( forwardedEventsMutex );
+			forwardedEvents.push_back( forwardedEvent );
+		};
+
+		{
+			int w, h;
+			SDL_GetWindowSize( win, &w, &h );
+			recording.SetWindowSize( w, h );
+		}
+
+		// egy szimulációs képkocka: események, annyi lépés, amennyi belefér (lehet 0 is), végül a csomag
+		std::vector<SDL_Event> simulationEvents;
+		auto simulateFrame = [&]( SFramePacket& packet )
+		{
+			{
+				std::lock_guard<std::mutex> lock( forwardedEventsMutex );
+				simulationEvents.swap( forwardedEvents );
+			}
+			for ( const SDL_Event& forwardedEvent : simulationEvents )
+			{
+				app.HandleInput( forwardedEvent );
+				// amit az alkalmazás megkap, az kerül a felvételbe (az ImGui-nak szánt események nem)
+				if ( recordFileName != nullptr )
+					recording.AddEvent( forwardedEvent );
+			}
+			simulationEvents.clear();
+
+			// Mennyi idő telt el az előző képkocka óta?
+			const Uint64 currentCounter = SDL_GetPerformanceCounter();
+			const double frameTimeInSec = static_cast<double>( currentCounter - lastCounter ) / counterFrequency;
+			lastCounter = currentCounter;
+			if ( recordFileName != nullptr )
+				recording.EndFrame( frameTimeInSec );
+
+			timestep.Advance( frameTimeInSec );
+			while ( timestep.Step() )
+			{
+				SUpdateInfo updateInfo
+				{
+					timestep.SimulationTime(),
+					static_cast<float>( timestep.StepInSec() )
+				};
+				app.Update( updateInfo );
+			}
+
+			app.BuildFramePacket( SRenderInfo{ timestep.RenderTime(), timestep.Interpolation() }, packet );
+		};
+
+		// a Close után a BeginPush nullptr-t ad, a szál kilép
+		std::thread simulationThread;
+		if ( renderThread )
+		{
+			simulationThread = std::thread( [&]()
+			{
+				while ( SFramePacket* packet = packets.BeginPush() )
+				{
+					simulateFrame( *packet );
+					packets.EndPush();
+				}
+			} );
+		}
+		SFramePacket serialPacket; // --no-render-thread
+
 		while (!quit)
 		{
 			// amíg van feldolgozandó üzenet dolgozzuk fel mindet:
@@ -195,57 +309,52 @@ int main( int argc, char* args[] )
 							is_keyboard_captured = true; // A CTRL+F1-t ne kapja meg az alkalmazás.
 						}
 						if ( !is_keyboard_captured )
-							app.KeyboardDown(ev.key);
+							forward(ev);
 						break;
 					case SDL_KEYUP:
 						if ( !is_keyboard_captured )
-							app.KeyboardUp(ev.key);
+							forward(ev);
 						break;
 					case SDL_MOUSEBUTTONDOWN:
-						if ( !is_mouse_captured )
-							app.MouseDown(ev.button);
-						break;
 					case SDL_MOUSEBUTTONUP:
-						if ( !is_mouse_captured )
-							app.MouseUp(ev.button);
-						break;
 					case SDL_MOUSEWHEEL:
-						if ( !is_mouse_captured )
-							app.MouseWheel(ev.wheel);
-						break;
 					case SDL_MOUSEMOTION:
 						if ( !is_mouse_captured )
-							app.MouseMove(ev.motion);
+							forward(ev);
 						break;
 					case SDL_WINDOWEVENT:
 						// Néhány platformon (pl. Windows) a SIZE_CHANGED nem hívódik meg az első megjelenéskor.
 						// Szerintünk ez bug az SDL könytárban.
 						// Ezért ezt az esetet külön lekezeljük, 
 						// mivel a MyApp esetlegesen tartalmazhat ablak méret függő beállításokat, pl. a kamera aspect ratioját a perspective() hívásnál.
+						// (az alkalmazás a SIZE_CHANGED eseményt kapja meg, a méretet a data1, data2 viszi)
 						if ( ( ev.window.event == SDL_WINDOWEVENT_SIZE_CHANGED ) || ( ev.window.event == SDL_WINDOWEVENT_SHOWN ) )
 						{
 							int w, h;
 							SDL_GetWindowSize( win, &w, &h );
-							app.Resize( w, h );
+
+							SDL_Event sizeEvent = ev;
+							sizeEvent.window.event = SDL_WINDOWEVENT_SIZE_CHANGED;
+							sizeEvent.window.data1 = w;
+							sizeEvent.window.data2 = h;
+							forward(sizeEvent);
 						}
 						break;
 					default:
-						app.OtherEvent( ev );
+						forward(ev);
 				}
 			}
 
-			// Számoljuk ki az update-hez szükséges idő mennyiségeket!
-			static Uint32 LastTick = SDL_GetTicks(); // statikusan tároljuk, mi volt az előző "tick".
-			Uint32 CurrentTick = SDL_GetTicks(); // Mi az aktuális.
-			SUpdateInfo updateInfo // Váltsuk át másodpercekre!
-			{ 
-				static_cast<float>(CurrentTick) / 1000.0f, 
-				static_cast<float>(CurrentTick - LastTick) / 1000.0f 
-			};
-			LastTick = CurrentTick; // Mentsük el utolsóként az aktuális "tick"-et!
+			// a legrégebbi kész csomag (vár rá, ha a szimuláció még nem végzett vele), egy szálon most készül el
+			SFramePacket* packet = &serialPacket;
+			if ( simulationThread.joinable() )
+				packet = packets.BeginPop();
+			else
+				simulateFrame( serialPacket );
 
-			app.Update( updateInfo );
-			app.Render();
+			app.Render( *packet );
+			if ( simulationThread.joinable() )
+				packets.EndPop(); // a Render után a csomag helye újra a szimulációé
 
 			ImGui_ImplOpenGL3_NewFrame();
 			ImGui_ImplSDL2_NewFrame(); //Ezután lehet imgui parancsokat hívni, egészen az ImGui::Render()-ig
@@ -258,8 +367,16 @@ int main( int argc, char* args[] )
 			SDL_GL_SwapWindow(win);
 		}
 
+		// a szimulációs szál leállítása, mielőtt az alkalmazás erőforrásai megszűnnek
+		packets.Close();
+		if ( simulationThread.joinable() )
+			simulationThread.join();
+
 		// takarítson el maga után az objektumunk
 		app.Clean();
+
+		if ( recordFileName != nullptr && recording.Save( recordFileName ) )
+			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Recorded %zu frames, %zu events into %s", recording.FrameCount(), recording.EventCount(), recordFileName);
 	} // így az app destruktora még úgy fut le, hogy él a contextünk => a GPU erőforrásokat befoglaló osztályok destruktorai is itt futnak le
 
 	//
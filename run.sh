@@ -33,5 +33,5 @@ rsync -a "$ROOT_DIR/Assets" "$BUILD_DIR/"
 # --- RUN FROM ROOT ---
 cd "$ROOT_DIR"
 echo ">>> Running program from project root..."
-./build/ZH_Base
+./build/ZH_Base "$@"
 
@@ -0,0 +1,107 @@
+#include "KTX2.h"
+#include "MappedFile.h"
+#include "TextureCooking.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+// Usage: ZH_AssetCook [--format auto|bc1|bc3|bc7] [--size WxH] [--no-flip] <image files...>
+// Writes <image>.ktx2 next to every image (see TextureCooking::Cook): the file TextureLoader loads instead of the
+// image while the image does not change. auto: BC1 for opaque images, BC7 otherwise. --size resizes every image,
+// e.g. to the layer size of the TextureArray it is loaded into. The images are flipped like ImageFromFile does by
+// default; --no-flip for the ones loaded with needsFlip = false.
+// Images whose cooked file is current are skipped. Returns 1 if any image could not be cooked.
+
+namespace
+{
+	const char* FormatName( TextureCooking::BlockFormat format )
+	{
+		switch ( format )
+		{
+		case TextureCooking::BlockFormat::BC1: return "BC1";
+		case TextureCooking::BlockFormat::BC3: return "BC3";
+		case TextureCooking::BlockFormat::BC7: return "BC7";
+		}
+		return "?";
+	}
+
+	bool ParseFormat( std::string_view name, std::optional<TextureCooking::BlockFormat>& format )
+	{
+		if ( name == "auto" ) format = std::nullopt;
+		else if ( name == "bc1" ) format = TextureCooking::BlockFormat::BC1;
+		else if ( name == "bc3" ) format = TextureCooking::BlockFormat::BC3;
+		else if ( name == "bc7" ) format = TextureCooking::BlockFormat::BC7;
+		else return false;
+		return true;
+	}
+
+	bool ParseSize( const char* text, unsigned int& width, unsigned int& height )
+	{
+		return std::sscanf( text, "%ux%u", &width, &height ) == 2 && width > 0 && height > 0;
+	}
+
+	// the cooked file exists, was cooked from this image, in the requested format and size
+	bool IsCurrent( const std::filesystem::path& imageFile, const std::filesystem::path& cookedFile, const TextureCooking::CookOptions& options )
+	{
+		MappedFile cooked;
+		KTX2::Image image;
+		TextureCooking::BlockFormat cookedFormat;
+		if ( !cooked.Open( cookedFile ) || !KTX2::Parse( cooked.data(), cooked.size(), image ) || !KTX2::BlockFormatOf( image.vkFormat, cookedFormat ) )
+		{
+			return false;
+		}
+		return ( !options.format || *options.format == cookedFormat )
+			   && ( options.width == 0 || ( image.width == options.width && image.height == options.height ) )
+			   && KTX2::FindValue( image, TextureCooking::SOURCE_KEY ) == TextureCooking::SourceStamp( imageFile, options.flipped );
+	}
+}
+
+int main( int argc, char* argv[] )
+{
+	TextureCooking::CookOptions options;
+	int firstFile = 1;
+	for ( ; firstFile < argc && argv[ firstFile ][ 0 ] == '-'; ++firstFile )
+	{
+		const bool hasValue = firstFile + 1 < argc;
+		if ( std::strcmp( argv[ firstFile ], "--format" ) == 0 && hasValue && ParseFormat( argv[ firstFile + 1 ], options.format ) ) ++firstFile;
+		else if ( std::strcmp( argv[ firstFile ], "--size" ) == 0 && hasValue && ParseSize( argv[ firstFile + 1 ], options.width, options.height ) ) ++firstFile;
+		else if ( std::strcmp( argv[ firstFile ], "--no-flip" ) == 0 ) options.flipped = false;
+		else
+		{
+			std::fprintf( stderr, "Usage: %s [--format auto|bc1|bc3|bc7] [--size WxH] [--no-flip] <image files...>\n", argv[ 0 ] );
+			return 1;
+		}
+	}
+
+	int result = 0;
+	for ( int i = firstFile; i < argc; ++i )
+	{
+		const std::filesystem::path imageFile = argv[ i ];
+		const std::filesystem::path cookedFile = TextureCooking::CookedPath( imageFile );
+		if ( IsCurrent( imageFile, cookedFile, options ) )
+		{
+			std::printf( "%s is up to date\n", cookedFile.string().c_str() );
+			continue;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const std::optional<TextureCooking::BlockFormat> cookedFormat = TextureCooking::Cook( imageFile, cookedFile, options );
+		const double ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+		if ( !cookedFormat )
+		{
+			std::fprintf( stderr, "Could not cook %s\n", imageFile.string().c_str() );
+			result = 1;
+			continue;
+		}
+
+		std::error_code ec;
+		std::printf( "%s: %s, %.1f KiB -> %.1f KiB in %.0f ms\n", cookedFile.string().c_str(), FormatName( *cookedFormat ),
+					 std::filesystem::file_size( imageFile, ec ) / 1024.0, std::filesystem::file_size( cookedFile, ec ) / 1024.0, ms );
+	}
+	return result;
+}